@@ -0,0 +1,175 @@
+'use strict';
+
+// Footprint and scan-time benchmark of the columnar archive
+// (src/services/archiveWriter.js, archiveReader.js).
+//
+// Archives --days days of synthetic readings of the five device types, every
+// device reporting every --interval seconds with up to --jitter-ms of arrival
+// jitter, through ArchiveWriter.applyBlock as committed blocks would, one
+// flush per day. Then it reports the archive's size against the same events
+// as ledger JSON, and times range and aggregate queries over the whole span
+// (each run twice, the second with chunk headers cached and files in the page
+// cache).
+//
+// usage: node benchmark/archive-benchmark.js [--days 90] [--devices 10]
+//        [--interval 60] [--jitter-ms 250] [--dir path] [--keep]
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const ArchiveWriter = require('../src/services/archiveWriter');
+const ArchiveReader = require('../src/services/archiveReader');
+
+const DAY_MS = 86400000;
+const START = Date.parse('2025-01-01T00:00:00Z');
+const BLOCK_MS = 2000;
+
+const option = (args, name, fallback) => {
+  const index = args.indexOf(`--${name}`);
+  return index === -1 ? fallback : args[index + 1];
+};
+
+const pad = (value, width) => String(value).padStart(width, '0');
+const randomInt = (min, max) => Math.floor(Math.random() * (max - min + 1)) + min;
+const clamp = (value, min, max) => Math.min(max, Math.max(min, value));
+
+// Per device type: the record fields of one reading, from the previous state
+// of the device; readings drift like the physical quantities they measure.
+const DEVICE_TYPES = {
+  co2_sensor: (state) => {
+    state.co2 = clamp((state.co2 ?? 600) + randomInt(-15, 15), 400, 2000);
+    state.temperature = clamp((state.temperature ?? 21) + (Math.random() < 0.05 ? randomInt(-1, 1) : 0), 15, 30);
+    return { eventType: 'reading', location: 'Building C - Lab', metadata: `co2Level:${state.co2}; temperature:${state.temperature}` };
+  },
+  light: (state) => {
+    state.on = Math.random() < 0.02 ? !state.on : Boolean(state.on);
+    const brightness = state.on ? 80 : 0;
+    return { eventType: state.on ? 'on' : 'off', location: 'Building B - Corridor', metadata: `brightness:${brightness}; energyConsumption:${state.on ? 6 : 0}W` };
+  },
+  card_reader: () => ({
+    eventType: Math.random() < 0.95 ? 'access_granted' : 'access_denied',
+    location: 'Building A - Main Entrance',
+    metadata: `userID:user${randomInt(1, 200)}; cardID:card${randomInt(1000, 1200)}`
+  }),
+  printer: (state) => {
+    state.job = (state.job ?? 0) + 1;
+    return {
+      eventType: 'print_job',
+      location: 'Library - Floor 2',
+      metadata: `jobID:job_${pad(state.job, 3)}; pagesPrinted:${randomInt(1, 20)}; userID:student${randomInt(1, 500)}`
+    };
+  },
+  cctv: (state) => {
+    state.image = (state.image ?? 0) + 1;
+    return { eventType: 'motion_detected', location: 'Building A - Lobby', metadata: `imageReference:img_${pad(state.image, 8)}.jpg` };
+  }
+};
+
+const formatBytes = (bytes) => {
+  const units = ['B', 'KiB', 'MiB', 'GiB'];
+  let value = bytes;
+  let unit = 0;
+  while (value >= 1024 && unit < units.length - 1) {
+    value /= 1024;
+    unit++;
+  }
+  return `${value.toFixed(1)} ${units[unit]}`;
+};
+
+/**
+ * Archives the synthetic readings and returns the number of events.
+ */
+async function fill(writer, { days, devices, intervalMs, jitterMs }) {
+  const states = new Map();
+  let blockNumber = 0;
+  let events = 0;
+  for (let day = 0; day < days; day++) {
+    const dayStart = START + day * DAY_MS;
+    for (let blockStart = dayStart; blockStart < dayStart + DAY_MS; blockStart += BLOCK_MS) {
+      const written = [];
+      for (const [deviceType, build] of Object.entries(DEVICE_TYPES)) {
+        for (let device = 0; device < devices; device++) {
+          // Each device reports once per interval, at its own phase
+          const phase = (device * 7919) % intervalMs;
+          const due = Math.ceil((blockStart - phase) / intervalMs) * intervalMs + phase;
+          if (due >= blockStart + BLOCK_MS) {
+            continue;
+          }
+          const deviceID = `${deviceType}_${pad(device, 2)}`;
+          if (!states.has(deviceID)) {
+            states.set(deviceID, {});
+          }
+          written.push({
+            eventID: `${deviceID}-${due}`,
+            deviceType,
+            deviceID,
+            timestamp: new Date(due + randomInt(0, jitterMs)).toISOString(),
+            ...build(states.get(deviceID))
+          });
+        }
+      }
+      if (written.length > 0) {
+        writer.applyBlock(blockNumber++, [{ deleted: [], written }]);
+        events += written.length;
+      }
+    }
+    await writer.flush();
+  }
+  return events;
+}
+
+const timed = async (run) => {
+  const startedAt = process.hrtime.bigint();
+  const result = await run();
+  return { result, ms: Number(process.hrtime.bigint() - startedAt) / 1e6 };
+};
+
+async function main() {
+  const args = process.argv.slice(2);
+  const config = {
+    days: Number(option(args, 'days', 90)),
+    devices: Number(option(args, 'devices', 10)),
+    intervalMs: Number(option(args, 'interval', 60)) * 1000,
+    jitterMs: Number(option(args, 'jitter-ms', 250))
+  };
+  const dirOption = option(args, 'dir', null);
+  const dir = dirOption ? path.resolve(dirOption) : fs.mkdtempSync(path.join(os.tmpdir(), 'sensor-archive-'));
+  const keep = args.includes('--keep');
+
+  console.log(`Archiving ${config.days} days, ${config.devices} devices per type, one reading per ${config.intervalMs / 1000}s into ${dir}`);
+  const writer = new ArchiveWriter({ dir, maxBufferedRows: Infinity }).open();
+  const filled = await timed(() => fill(writer, config));
+  await writer.close();
+  console.log(`${filled.result} events archived in ${(filled.ms / 1000).toFixed(1)}s (${Math.round(filled.result / (filled.ms / 1000))} events/s)`);
+
+  const reader = new ArchiveReader({ dir });
+  const status = reader.getStatus();
+  console.log(`ledger JSON ${formatBytes(status.rawBytes)}, archive ${formatBytes(status.encodedBytes)} in ${status.chunks} chunks: ${status.compressionRatio}x smaller`);
+
+  const end = new Date(START + config.days * DAY_MS - 1).toISOString();
+  const begin = new Date(START).toISOString();
+  const lastDay = new Date(START + (config.days - 1) * DAY_MS).toISOString();
+  const queries = [
+    ['range: one device, last day', () => reader.range({ deviceType: 'co2_sensor', deviceID: 'co2_sensor_03', startTime: lastDay, endTime: end, limit: Infinity })],
+    ['range: one type, first 1000', () => reader.range({ deviceType: 'printer', startTime: begin, endTime: end })],
+    ['aggregate: co2Level, all, total', () => reader.aggregate({ field: 'co2Level', startTime: begin, endTime: end })],
+    ['aggregate: co2Level, all, hourly', () => reader.aggregate({ field: 'co2Level', startTime: begin, endTime: end, interval: 'hour' })],
+    ['aggregate: co2Level, one device, daily', () => reader.aggregate({ field: 'co2Level', deviceID: 'co2_sensor_03', startTime: begin, endTime: end, interval: 'day' })],
+    ['aggregate: pagesPrinted, window, hourly', () => reader.aggregate({ field: 'pagesPrinted', startTime: '2025-01-10T06:30:00Z', endTime: lastDay, interval: 'hour' })]
+  ];
+  for (const [name, run] of queries) {
+    for (const pass of ['first', 'again']) {
+      const { result, ms } = await timed(run);
+      const rows = (result.events || result.aggregates).length;
+      const { chunksRead, chunksSkipped, chunksFromHeader, rowsScanned, bytesRead } = result.scan;
+      console.log(`${name.padEnd(42)} ${pass.padEnd(5)}  ${ms.toFixed(1).padStart(8)} ms  ${String(rows).padStart(6)} rows out, `
+        + `${rowsScanned} scanned, chunks ${chunksRead} read / ${chunksFromHeader} from header / ${chunksSkipped} skipped, ${formatBytes(bytesRead)} read`);
+    }
+  }
+
+  if (!keep) {
+    fs.rmSync(dir, { recursive: true, force: true });
+  }
+}
+
+main();
@@ -0,0 +1,340 @@
+'use strict';
+
+// Attack-replay harness for the gateway's admission control
+// (udp_receivers/admission.js) and the backend's load shedding
+// (src/services/loadShedder.js).
+//
+// Legitimate motes, each sending from its own loopback address as real motes
+// do, report at a steady rate while an attacker floods the gateway. Every run
+// starts a fresh backend and gateway on the mock ledger in async ingest mode,
+// whose bounded drain makes the ledger the bottleneck a flood competes for.
+// After the run and a short drain, the committed events are read back and the
+// legitimate ones counted: goodput is legitimate events committed per second,
+// and delivery is reported per admission class (alarm, access, bulk).
+//
+// Attacks:
+//   none     legitimate traffic only (baseline)
+//   flood    one address sending readings of made-up devices
+//   spoofed  many addresses, a made-up device in every datagram
+//   replay   legitimate datagrams captured in flight, sent again from many addresses
+// Every attack runs with admission control on, then off (INGEST_SOURCE_RATE,
+// INGEST_DEVICE_RATE and INGEST_SHED_BACKLOG set to 0; the forward queue
+// stays).
+//
+// usage: node benchmark/attack-replay.js [--seconds 10] [--rate 100]
+//        [--flood 3000] [--devices 10] [--format json|binary]
+//        [--attacks flood,spoofed,replay] [--shed-backlog 2000] [--out dir]
+
+const dgram = require('dgram');
+const fs = require('fs');
+const http = require('http');
+const os = require('os');
+const path = require('path');
+const { DEVICE_TYPES, encodeBinary } = require('./traffic');
+const { round } = require('./processStats');
+const { sleep, getJSON, waitForHttp, startProcess, stopProcess, sumPortCounters } = require('./run-benchmark');
+const { classifyEvent, PRIORITIES } = require('../udp_receivers/admission');
+
+const API_PORT = 5110;
+const STATS_PORT = 8861;
+const GATEWAY = '127.0.0.1';
+const DRAIN_SECONDS = 3;
+// Attack event counters start here so their eventIDs never collide with legitimate ones
+const ATTACK_COUNTER_BASE = 10000000;
+const ATTACK_DEVICE_BASE = 9000;
+const REPLAY_BUFFER = 1000;
+// Boot id of every simulated mote, drawn per run like a mote draws one per boot
+const BOOT_ID = Math.floor(Math.random() * 256);
+const TICK_MS = 10;
+
+const option = (args, name, fallback) => {
+  const index = args.indexOf(`--${name}`);
+  return index === -1 ? fallback : args[index + 1];
+};
+
+/**
+ * Opens a UDP socket bound to a loopback address, so the gateway sees it as
+ * its own source.
+ */
+const openSocket = (address) => new Promise((resolve, reject) => {
+  const socket = dgram.createSocket('udp4');
+  socket.once('error', reject);
+  socket.bind({ address, port: 0 }, () => resolve(socket));
+});
+
+/**
+ * One datagram carrying one reading, as the motes send it.
+ */
+function encodeReading(format, typeName, deviceNum, counter, moteTime) {
+  const device = DEVICE_TYPES[typeName];
+  const reading = device.build(counter);
+  const event = {
+    eventID: device.eventID(deviceNum, BOOT_ID, counter),
+    deviceType: typeName,
+    deviceID: device.deviceID(deviceNum),
+    moteTime,
+    eventType: reading.json.eventType,
+    location: reading.json.location,
+    metadata: reading.json.metadata
+  };
+  const message = format === 'binary'
+    ? encodeBinary(device, deviceNum, BOOT_ID, counter, reading, moteTime)
+    : Buffer.from(JSON.stringify(event));
+  return { event, message, port: device.port };
+}
+
+/**
+ * Calls send() ratePerSecond times a second, in ticks, until the returned
+ * stop function is called.
+ */
+function pace(ratePerSecond, send) {
+  let last = Date.now();
+  let due = 0;
+  const timer = setInterval(() => {
+    const now = Date.now();
+    due += ((now - last) / 1000) * ratePerSecond;
+    last = now;
+    for (; due >= 1; due--) {
+      send();
+    }
+  }, TICK_MS);
+  return () => clearInterval(timer);
+}
+
+/**
+ * The legitimate motes: devicesPerType of every device type, each on its own
+ * address, reporting round-robin at ratePerSecond in total. Every event sent
+ * is recorded with its admission class, and the latest datagrams are kept
+ * for the replay attack.
+ */
+async function startMotes({ format, devicesPerType, ratePerSecond }) {
+  const motes = [];
+  let host = 1;
+  for (const typeName of Object.keys(DEVICE_TYPES)) {
+    for (let deviceNum = 1; deviceNum <= devicesPerType; deviceNum++, host++) {
+      motes.push({ typeName, deviceNum, socket: await openSocket(`127.0.1.${host}`) });
+    }
+  }
+  const counters = Object.fromEntries(Object.keys(DEVICE_TYPES).map((typeName) => [typeName, 0]));
+  const bootedAt = Date.now();
+  const sent = new Map(); // eventID -> class
+  const captured = [];
+  let next = 0;
+
+  const stop = pace(ratePerSecond, () => {
+    const mote = motes[next];
+    next = (next + 1) % motes.length;
+    const { event, message, port } = encodeReading(format, mote.typeName, mote.deviceNum,
+      ++counters[mote.typeName], Date.now() - bootedAt);
+    mote.socket.send(message, port, GATEWAY);
+    sent.set(event.eventID, classifyEvent(event));
+    captured[(sent.size - 1) % REPLAY_BUFFER] = { message, port };
+  });
+
+  return {
+    sent,
+    captured,
+    stop,
+    close() {
+      stop();
+      motes.forEach(({ socket }) => socket.close());
+    }
+  };
+}
+
+/**
+ * Starts an attack at ratePerSecond datagrams; returns { stats, stop, close }.
+ */
+async function startAttack(attack, { format, ratePerSecond, captured }) {
+  const addresses = {
+    flood: ['127.0.2.1'],
+    spoofed: Array.from({ length: 250 }, (_, i) => `127.0.3.${i + 1}`),
+    replay: Array.from({ length: 50 }, (_, i) => `127.0.4.${i + 1}`)
+  }[attack];
+  const sockets = await Promise.all(addresses.map(openSocket));
+  const stats = { sent: 0 };
+  let counter = ATTACK_COUNTER_BASE;
+  let next = 0;
+
+  const stop = pace(ratePerSecond, () => {
+    const socket = sockets[next];
+    next = (next + 1) % sockets.length;
+    let datagram;
+    if (attack === 'replay') {
+      datagram = captured[stats.sent % Math.max(1, captured.length)];
+      if (!datagram) {
+        return;
+      }
+    } else {
+      // flood cycles through 1000 made-up devices, spoofed never repeats one
+      const deviceNum = ATTACK_DEVICE_BASE + (attack === 'flood' ? stats.sent % 1000 : stats.sent);
+      datagram = encodeReading(format, 'co2_sensor', deviceNum, ++counter, stats.sent);
+    }
+    socket.send(datagram.message, datagram.port, GATEWAY);
+    stats.sent++;
+  });
+
+  return {
+    stats,
+    stop,
+    close() {
+      stop();
+      sockets.forEach((socket) => socket.close());
+    }
+  };
+}
+
+/**
+ * eventIDs of every committed event, read from GET /api/sensor-events.
+ */
+const getCommittedIDs = (url) => new Promise((resolve, reject) => {
+  http.get(url, (res) => {
+    const ids = new Set();
+    let rest = '';
+    res.setEncoding('utf8');
+    res.on('data', (chunk) => {
+      const lines = (rest + chunk).split('\n');
+      rest = lines.pop();
+      for (const line of lines.filter(Boolean)) {
+        ids.add(JSON.parse(line).eventID);
+      }
+    });
+    res.on('end', () => resolve(ids));
+  }).on('error', reject);
+});
+
+/**
+ * Runs one attack, with admission control on or off, on fresh processes.
+ */
+async function runAttack(attack, admission, config, logDir) {
+  const walDir = fs.mkdtempSync(path.join(os.tmpdir(), 'attack-wal-'));
+  const env = {
+    FABRIC_MODE: 'mock',
+    INGEST_MODE: 'async',
+    WAL_DIR: walDir,
+    PORT: String(API_PORT),
+    INGEST_HOST: '::',
+    INGEST_STATS_PORT: String(STATS_PORT),
+    API_ENDPOINT: `http://localhost:${API_PORT}/api/sensor-events`,
+    INGEST_SHED_BACKLOG: String(config.shedBacklog),
+    ...(!admission && { INGEST_SOURCE_RATE: '0', INGEST_DEVICE_RATE: '0', INGEST_SHED_BACKLOG: '0' })
+  };
+  const apiURL = `http://localhost:${API_PORT}`;
+  const statsURL = `http://localhost:${STATS_PORT}/stats`;
+  const logPath = path.join(logDir, `${attack}-${admission ? 'on' : 'off'}.log`);
+
+  const backend = startProcess('src/app.js', env, logPath);
+  const gateway = startProcess('udp_receivers/ingest_gateway.js', env, logPath);
+  let motes = null;
+  let attacker = null;
+  try {
+    await waitForHttp(`${apiURL}/`);
+    await waitForHttp(statsURL);
+
+    motes = await startMotes(config);
+    if (attack !== 'none') {
+      attacker = await startAttack(attack, { ...config, ratePerSecond: config.floodRate, captured: motes.captured });
+    }
+    await sleep(config.seconds * 1000);
+    motes.stop();
+    if (attacker) {
+      attacker.stop();
+    }
+    await sleep(DRAIN_SECONDS * 1000);
+
+    const gatewayStats = await getJSON(statsURL);
+    const { ingest } = await getJSON(`${apiURL}/api/ingest/status`);
+    const committed = await getCommittedIDs(`${apiURL}/api/sensor-events`);
+
+    const classes = Object.fromEntries(PRIORITIES.map((priority) => [priority, { sent: 0, committed: 0 }]));
+    for (const [eventID, priority] of motes.sent) {
+      classes[priority].sent++;
+      if (committed.has(eventID)) {
+        classes[priority].committed++;
+      }
+    }
+    const legitCommitted = PRIORITIES.reduce((sum, priority) => sum + classes[priority].committed, 0);
+    const gatewayTotals = sumPortCounters(gatewayStats);
+    return {
+      attack,
+      admission,
+      legitSentPerSecond: round(motes.sent.size / config.seconds),
+      goodputPerSecond: round(legitCommitted / config.seconds),
+      delivered: round(legitCommitted / motes.sent.size, 3),
+      classes,
+      attackSentPerSecond: round((attacker ? attacker.stats.sent : 0) / config.seconds),
+      // Replayed events are copies of legitimate ones and count as those
+      attackCommittedPerSecond: round((committed.size - legitCommitted) / config.seconds),
+      gateway: {
+        packets: gatewayTotals.packets,
+        sourceLimited: gatewayTotals.sourceLimited,
+        deviceLimited: gatewayTotals.deviceLimited,
+        dropped: gatewayTotals.dropped,
+        shed: gatewayTotals.shed,
+        duplicateEvents: gatewayTotals.duplicateEvents,
+        queue: gatewayStats.admission.queue
+      },
+      backend: {
+        backlog: ingest.backlog,
+        shedding: ingest.shedding || null
+      }
+    };
+  } finally {
+    if (motes) {
+      motes.close();
+    }
+    if (attacker) {
+      attacker.close();
+    }
+    await Promise.all([stopProcess(gateway), stopProcess(backend)]);
+    fs.rmSync(walDir, { recursive: true, force: true });
+  }
+}
+
+const formatRow = (cells) => cells.map((cell, i) => String(cell).padStart(i === 0 ? 8 : 10)).join(' ');
+const percent = ({ sent, committed }) => (sent > 0 ? `${round((committed / sent) * 100, 1)}%` : '-');
+
+async function main() {
+  const args = process.argv.slice(2);
+  const config = {
+    seconds: Number(option(args, 'seconds', 10)),
+    ratePerSecond: Number(option(args, 'rate', 100)),
+    floodRate: Number(option(args, 'flood', 3000)),
+    devicesPerType: Number(option(args, 'devices', 10)),
+    format: option(args, 'format', 'json'),
+    shedBacklog: Number(option(args, 'shed-backlog', 2000))
+  };
+  const attacks = option(args, 'attacks', 'flood,spoofed,replay').split(',');
+  const outDir = path.resolve(option(args, 'out', path.join(__dirname, 'results')));
+  const stamp = new Date().toISOString().replace(/[:.]/g, '-');
+  const logDir = path.join(outDir, `attack-replay-${stamp}-logs`);
+  fs.mkdirSync(logDir, { recursive: true });
+
+  console.log(`Attack replay: ${config.ratePerSecond} legitimate events/s from ${config.devicesPerType * Object.keys(DEVICE_TYPES).length} motes, `
+    + `${config.floodRate} attack datagrams/s, ${config.seconds}s per run, ${config.format} payloads`);
+  console.log(formatRow(['attack', 'admission', 'legit/s', 'goodput/s', 'alarm', 'access', 'bulk', 'attack/s', 'atk commit', 'limited', 'dropped', 'shed']));
+
+  const results = [];
+  const runs = [['none', true], ...attacks.flatMap((attack) => [[attack, true], [attack, false]])];
+  for (const [attack, admission] of runs) {
+    const result = await runAttack(attack, admission, config, logDir);
+    const { gateway } = result;
+    console.log(formatRow([
+      attack, admission ? 'on' : 'off',
+      result.legitSentPerSecond, result.goodputPerSecond,
+      percent(result.classes.alarm), percent(result.classes.access), percent(result.classes.bulk),
+      result.attackSentPerSecond, result.attackCommittedPerSecond,
+      gateway.sourceLimited + gateway.deviceLimited, gateway.dropped, gateway.shed
+    ]));
+    results.push(result);
+  }
+
+  const outPath = path.join(outDir, `attack-replay-${stamp}.json`);
+  fs.writeFileSync(outPath, `${JSON.stringify({ benchmark: 'attack-replay', config, results }, null, 2)}\n`);
+  console.log(`Results written to ${outPath}`);
+}
+
+main().catch((error) => {
+  console.error(`Attack replay failed: ${error.message}`);
+  process.exit(1);
+});
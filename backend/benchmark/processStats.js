@@ -0,0 +1,97 @@
+'use strict';
+
+// CPU and memory of the benchmarked processes, read from /proc (Linux only).
+
+const fs = require('fs');
+const { execSync } = require('child_process');
+
+let clockTicks = 100;
+try {
+  clockTicks = Number(execSync('getconf CLK_TCK').toString().trim()) || clockTicks;
+} catch (error) {
+  // getconf missing: keep the usual Linux default
+}
+
+/**
+ * CPU seconds (user + system) and resident set size in MB of one process.
+ */
+function readProcess(pid) {
+  const stat = fs.readFileSync(`/proc/${pid}/stat`, 'utf8');
+  // Fields after the parenthesised command name, which may contain spaces
+  const fields = stat.slice(stat.lastIndexOf(')') + 2).split(' ');
+  const cpuSeconds = (Number(fields[11]) + Number(fields[12])) / clockTicks;
+  const status = fs.readFileSync(`/proc/${pid}/status`, 'utf8');
+  const rss = /VmRSS:\s+(\d+) kB/.exec(status);
+  return { cpuSeconds, rssMB: rss ? Number(rss[1]) / 1024 : 0 };
+}
+
+/**
+ * Samples a set of named processes every second over a measurement window.
+ */
+class ProcessSampler {
+  /**
+   * @param {Object<string, number>} pids - Process id per stage name.
+   */
+  constructor(pids) {
+    this.pids = pids;
+    this.timer = null;
+  }
+
+  start() {
+    this.startedAt = Date.now();
+    this.first = {};
+    this.peakRssMB = {};
+    this.rssSamples = {};
+    for (const [name, pid] of Object.entries(this.pids)) {
+      const sample = readProcess(pid);
+      this.first[name] = sample;
+      this.peakRssMB[name] = sample.rssMB;
+      this.rssSamples[name] = [sample.rssMB];
+    }
+    this.timer = setInterval(() => this._sample(), 1000);
+  }
+
+  _sample() {
+    for (const [name, pid] of Object.entries(this.pids)) {
+      try {
+        const { rssMB } = readProcess(pid);
+        this.peakRssMB[name] = Math.max(this.peakRssMB[name], rssMB);
+        this.rssSamples[name].push(rssMB);
+      } catch (error) {
+        // Process exited; its summary reports what was sampled so far
+      }
+    }
+  }
+
+  /**
+   * Stops sampling and returns per-process CPU (% of one core) and RSS.
+   */
+  stop() {
+    clearInterval(this.timer);
+    const elapsedSeconds = (Date.now() - this.startedAt) / 1000;
+    const result = {};
+    for (const [name, pid] of Object.entries(this.pids)) {
+      let last;
+      try {
+        last = readProcess(pid);
+      } catch (error) {
+        last = this.first[name];
+      }
+      const samples = this.rssSamples[name];
+      result[name] = {
+        cpuPercent: round(((last.cpuSeconds - this.first[name].cpuSeconds) / elapsedSeconds) * 100),
+        avgRssMB: round(samples.reduce((sum, value) => sum + value, 0) / samples.length),
+        peakRssMB: round(this.peakRssMB[name])
+      };
+    }
+    return result;
+  }
+}
+
+const round = (value, digits = 2) => Math.round(value * 10 ** digits) / 10 ** digits;
+
+module.exports = {
+  ProcessSampler,
+  readProcess,
+  round
+};
@@ -0,0 +1,306 @@
+'use strict';
+
+// End-to-end throughput benchmark: synthetic mote traffic → ingest gateway
+// (UDP) → backend API (/api/sensor-events) → FabricClient → ledger.
+//
+// Each step of a scenario starts a fresh backend and gateway, offers a fixed
+// event rate at a given forwarding concurrency, and measures over a window
+// after warm-up: sustained committed events/s, per-stage latency percentiles
+// (from GET /api/metrics), drops at every hop, and CPU/RSS of each process.
+// With FABRIC_MODE=mock (the default scenario setting) the ledger is the
+// in-process mock, so a full run needs nothing but this machine.
+//
+// usage: node benchmark/run-benchmark.js [scenario.json] [--out dir]
+//        node benchmark/run-benchmark.js --compare base.json head.json
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const http = require('http');
+const { spawn, execSync } = require('child_process');
+const { TrafficGenerator } = require('./traffic');
+const { ProcessSampler, round } = require('./processStats');
+
+const BACKEND_DIR = path.resolve(__dirname, '..');
+const DEFAULT_SCENARIO = path.join(__dirname, 'scenarios', 'default.json');
+const DEFAULT_OUT_DIR = path.join(__dirname, 'results');
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+const getJSON = (url) => new Promise((resolve, reject) => {
+  http.get(url, (res) => {
+    let body = '';
+    res.setEncoding('utf8');
+    res.on('data', (chunk) => { body += chunk; });
+    res.on('end', () => {
+      try {
+        resolve(JSON.parse(body));
+      } catch (error) {
+        reject(new Error(`${url} returned invalid JSON (HTTP ${res.statusCode})`));
+      }
+    });
+  }).on('error', reject);
+});
+
+/**
+ * Polls url until it answers, or fails after timeoutMs.
+ */
+async function waitForHttp(url, timeoutMs = 15000) {
+  const deadline = Date.now() + timeoutMs;
+  for (;;) {
+    try {
+      return await getJSON(url);
+    } catch (error) {
+      if (Date.now() > deadline) {
+        throw new Error(`${url} did not come up: ${error.message}`);
+      }
+      await sleep(200);
+    }
+  }
+}
+
+function startProcess(script, env, logPath) {
+  const log = fs.openSync(logPath, 'a');
+  const child = spawn(process.execPath, [script], {
+    cwd: BACKEND_DIR,
+    env: { ...process.env, ...env },
+    stdio: ['ignore', log, log]
+  });
+  fs.closeSync(log);
+  child.exited = new Promise((resolve) => child.on('exit', resolve));
+  return child;
+}
+
+async function stopProcess(child) {
+  if (child.exitCode === null && child.signalCode === null) {
+    child.kill('SIGTERM');
+    const timeout = sleep(5000).then(() => child.kill('SIGKILL'));
+    await Promise.race([child.exited, timeout]);
+  }
+}
+
+const sumPortCounters = (stats) => {
+  const total = {};
+  for (const counters of Object.values(stats.ports)) {
+    for (const [name, value] of Object.entries(counters)) {
+      if (typeof value === 'number') {
+        total[name] = (total[name] || 0) + value;
+      }
+    }
+  }
+  return total;
+};
+
+const diffCounters = (after, before) => Object.fromEntries(
+  Object.entries(after).map(([name, value]) => [name, value - (before[name] || 0)]));
+
+/**
+ * Runs one (rate, concurrency) step with fresh processes.
+ */
+async function runStep(scenario, rate, concurrency, logDir) {
+  const apiPort = scenario.apiPort || 5100;
+  const statsPort = scenario.statsPort || 8860;
+  const host = scenario.host || '::1';
+  const walDir = fs.mkdtempSync(path.join(os.tmpdir(), 'bench-wal-'));
+  const env = {
+    // One socket sends for every device, at rates far above a real mote's
+    INGEST_SOURCE_RATE: '0',
+    INGEST_DEVICE_RATE: '0',
+    ...scenario.env,
+    PORT: String(apiPort),
+    WAL_DIR: walDir,
+    INGEST_HOST: host,
+    INGEST_STATS_PORT: String(statsPort),
+    INGEST_MAX_INFLIGHT: String(concurrency),
+    API_ENDPOINT: `http://localhost:${apiPort}/api/sensor-events`
+  };
+  const apiURL = `http://localhost:${apiPort}`;
+  const statsURL = `http://localhost:${statsPort}/stats`;
+  const logPath = path.join(logDir, `rate${rate}-c${concurrency}.log`);
+
+  const backend = startProcess('src/app.js', env, logPath);
+  const gateway = startProcess('udp_receivers/ingest_gateway.js', env, logPath);
+  const generator = new TrafficGenerator({
+    host,
+    mix: scenario.mix,
+    devicesPerType: scenario.devicesPerType || 50,
+    format: scenario.format || 'json'
+  });
+
+  try {
+    await waitForHttp(`${apiURL}/`);
+    await waitForHttp(statsURL);
+
+    generator.start(rate);
+    await sleep((scenario.warmupSeconds ?? 5) * 1000);
+
+    // Measurement window: histograms are reset, counters diffed
+    await getJSON(`${apiURL}/api/metrics?reset=true`);
+    const gatewayBefore = sumPortCounters(await getJSON(statsURL));
+    const generatorBefore = { ...generator.stats };
+    const sampler = new ProcessSampler({ generator: process.pid, gateway: gateway.pid, backend: backend.pid });
+    sampler.start();
+    const windowStartedAt = Date.now();
+
+    await sleep(scenario.durationSeconds * 1000);
+
+    const { metrics } = await getJSON(`${apiURL}/api/metrics`);
+    const windowSeconds = (Date.now() - windowStartedAt) / 1000;
+    const gatewayDelta = diffCounters(sumPortCounters(await getJSON(statsURL)), gatewayBefore);
+    const generatorDelta = diffCounters(generator.stats, generatorBefore);
+    const resources = sampler.stop();
+    generator.stop();
+
+    const latency = {};
+    for (const stage of metrics.stages.filter(({ count }) => count > 0)) {
+      latency[stage.stage] = {
+        count: stage.count,
+        p50: stage.p50,
+        p99: stage.p99,
+        'p99.9': stage['p99.9'],
+        max: stage.maxMs
+      };
+    }
+    return {
+      rate,
+      concurrency,
+      windowSeconds: round(windowSeconds),
+      offeredPerSecond: round(generatorDelta.sent / windowSeconds),
+      acceptedPerSecond: round(metrics.throughput.accepted.total / windowSeconds),
+      committedPerSecond: round(metrics.throughput.committed.total / windowSeconds),
+      latency,
+      drops: {
+        generatorSendErrors: generatorDelta.sendErrors,
+        gatewayDropped: gatewayDelta.dropped,
+        gatewayDecodeErrors: gatewayDelta.decodeErrors,
+        gatewayRejected: gatewayDelta.rejected,
+        gatewayForwardErrors: gatewayDelta.forwardErrors,
+        // Sent in the window but neither forwarded nor dropped at the gateway (lost in UDP buffers)
+        unaccounted: Math.max(0, generatorDelta.sent - gatewayDelta.events)
+      },
+      resources
+    };
+  } finally {
+    generator.close();
+    await Promise.all([stopProcess(gateway), stopProcess(backend)]);
+    fs.rmSync(walDir, { recursive: true, force: true });
+  }
+}
+
+function describeHost() {
+  let commit = null;
+  let dirty = null;
+  try {
+    commit = execSync('git rev-parse --short HEAD', { cwd: BACKEND_DIR }).toString().trim();
+    dirty = execSync('git status --porcelain', { cwd: BACKEND_DIR }).toString().trim() !== '';
+  } catch (error) {
+    // Not a git checkout
+  }
+  return {
+    git: { commit, dirty },
+    host: {
+      node: process.version,
+      platform: `${os.platform()} ${os.release()}`,
+      cpuModel: os.cpus()[0] ? os.cpus()[0].model : null,
+      cpus: os.cpus().length,
+      memoryGB: round(os.totalmem() / 2 ** 30)
+    }
+  };
+}
+
+const formatRow = (cells) => cells.map((cell, i) => String(cell).padStart(i === 0 ? 6 : 11)).join(' ');
+
+function printStep(step) {
+  const headline = step.latency.end_to_end || step.latency.api_to_commit || {};
+  const drops = Object.values(step.drops).reduce((sum, value) => sum + value, 0);
+  console.log(formatRow([
+    step.rate, step.concurrency, step.offeredPerSecond, step.committedPerSecond,
+    headline.p50 ?? '-', headline.p99 ?? '-', headline['p99.9'] ?? '-', drops,
+    step.resources.backend.cpuPercent, step.resources.gateway.cpuPercent
+  ]));
+}
+
+async function runScenario(scenarioPath, outDir) {
+  const scenario = JSON.parse(fs.readFileSync(scenarioPath, 'utf8'));
+  const { git, host } = describeHost();
+  const startedAt = new Date().toISOString();
+  const stamp = startedAt.replace(/[:.]/g, '-');
+  const logDir = path.join(outDir, `${scenario.name}-${stamp}-logs`);
+  fs.mkdirSync(logDir, { recursive: true });
+
+  console.log(`Benchmark "${scenario.name}" at ${git.commit || 'unknown commit'}${git.dirty ? ' (dirty)' : ''}, ledger ${(scenario.env && scenario.env.FABRIC_MODE) || 'gateway'}`);
+  console.log(formatRow(['rate', 'conc', 'offered/s', 'commit/s', 'p50 ms', 'p99 ms', 'p99.9 ms', 'drops', 'api cpu%', 'gw cpu%']));
+
+  const results = [];
+  for (const rate of scenario.rates) {
+    for (const concurrency of scenario.concurrency || [256]) {
+      const step = await runStep(scenario, rate, concurrency, logDir);
+      printStep(step);
+      results.push(step);
+    }
+  }
+
+  const report = { benchmark: scenario.name, startedAt, git, host, scenario, results };
+  const outPath = path.join(outDir, `${scenario.name}-${git.commit || 'nogit'}-${stamp}.json`);
+  fs.writeFileSync(outPath, `${JSON.stringify(report, null, 2)}\n`);
+  console.log(`Results written to ${outPath}`);
+}
+
+const percentChange = (base, head) => (base ? `${round(((head - base) / base) * 100, 1)}%` : 'n/a');
+
+/**
+ * Prints the change in throughput and headline latency between two result files, step by step.
+ */
+function compare(basePath, headPath) {
+  const base = JSON.parse(fs.readFileSync(basePath, 'utf8'));
+  const head = JSON.parse(fs.readFileSync(headPath, 'utf8'));
+  console.log(`${base.git.commit} → ${head.git.commit}`);
+  console.log(formatRow(['rate', 'conc', 'commit/s', 'Δ', 'p50 ms', 'Δ', 'p99 ms', 'Δ']));
+  for (const headStep of head.results) {
+    const baseStep = base.results.find((step) => step.rate === headStep.rate && step.concurrency === headStep.concurrency);
+    if (!baseStep) {
+      continue;
+    }
+    const b = baseStep.latency.end_to_end || baseStep.latency.api_to_commit || {};
+    const h = headStep.latency.end_to_end || headStep.latency.api_to_commit || {};
+    console.log(formatRow([
+      headStep.rate, headStep.concurrency,
+      headStep.committedPerSecond, percentChange(baseStep.committedPerSecond, headStep.committedPerSecond),
+      h.p50 ?? '-', percentChange(b.p50, h.p50),
+      h.p99 ?? '-', percentChange(b.p99, h.p99)
+    ]));
+  }
+}
+
+async function main() {
+  const args = process.argv.slice(2);
+  if (args[0] === '--compare') {
+    if (args.length !== 3) {
+      throw new Error('usage: run-benchmark.js --compare base.json head.json');
+    }
+    compare(args[1], args[2]);
+    return;
+  }
+  const outIndex = args.indexOf('--out');
+  const outDir = outIndex === -1 ? DEFAULT_OUT_DIR : path.resolve(args[outIndex + 1]);
+  const scenarioPath = args.find((arg, i) => !arg.startsWith('--') && (outIndex === -1 || i !== outIndex + 1)) || DEFAULT_SCENARIO;
+  await runScenario(path.resolve(scenarioPath), outDir);
+}
+
+if (require.main === module) {
+  main().catch((error) => {
+    console.error(`Benchmark failed: ${error.message}`);
+    process.exit(1);
+  });
+}
+
+module.exports = {
+  BACKEND_DIR,
+  sleep,
+  getJSON,
+  waitForHttp,
+  startProcess,
+  stopProcess,
+  sumPortCounters,
+  diffCounters
+};
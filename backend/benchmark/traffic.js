@@ -0,0 +1,248 @@
+'use strict';
+
+// Synthetic mote traffic for the benchmark: the five device types with the
+// payloads the firmwares send (cooja-simulation/sensors/sensor-payloads.c,
+// mirrored by cooja-simulation/modules/*.js), as JSON or as binary records in
+// the sensor-codec.h format, paced to a target rate over UDP.
+
+const dgram = require('dgram');
+
+const CODEC_MAGIC = 0xB1;
+const BOOT_ID_FIELD = 14;
+const MOTE_TIME_FIELD = 15;
+
+const pad = (value, width) => String(value).padStart(width, '0');
+const randomInt = (min, max) => Math.floor(Math.random() * (max - min + 1)) + min;
+
+// Per device type: UDP port, codec codes, the eventID of a device, boot and
+// counter, and a reading generator returning the JSON event fields and the
+// binary record fields ([field id, value] pairs).
+const DEVICE_TYPES = {
+  co2_sensor: {
+    port: 8849,
+    code: 5,
+    location: 5,
+    deviceID: (num) => `sensor_${pad(num, 2)}`,
+    eventID: (num, bootID, counter) => `sensor_${pad(num, 2)}_${bootID}_${pad(counter, 3)}`,
+    build(counter) {
+      const co2Level = randomInt(400, 2000);
+      const temperature = randomInt(15, 30);
+      return {
+        eventType: 1,
+        json: {
+          eventType: 'reading',
+          location: 'Building C - Lab',
+          metadata: `co2Level:${co2Level}; temperature:${temperature}`
+        },
+        // temperature is a signed field: zigzag encoded
+        fields: [[1, co2Level, false], [2, temperature, true]]
+      };
+    }
+  },
+  light: {
+    port: 8843,
+    code: 2,
+    location: 2,
+    deviceID: (num) => `light_${pad(num, 2)}`,
+    eventID: (num, bootID, counter) => `light_${pad(num, 2)}_${bootID}_${pad(counter, 3)}`,
+    build(counter) {
+      const brightness = randomInt(50, 100);
+      const energyConsumption = randomInt(1, 10);
+      const off = counter % 2 === 0;
+      return {
+        eventType: off ? 4 : 3,
+        json: {
+          eventType: off ? 'off' : 'on',
+          location: 'Building B - Corridor',
+          metadata: `brightness:${brightness}; energyConsumption:${energyConsumption}W`
+        },
+        fields: [[1, brightness, false], [2, energyConsumption, false]]
+      };
+    }
+  },
+  printer: {
+    port: 8845,
+    code: 4,
+    location: 4,
+    deviceID: (num) => `printer_${num}`,
+    eventID: (num, bootID, counter) => `printer_${num}_${bootID}_${pad(counter, 3)}`,
+    build(counter) {
+      const pagesPrinted = randomInt(1, 20);
+      return {
+        eventType: 5,
+        json: {
+          eventType: 'completed',
+          location: 'Library',
+          metadata: `jobID:job_${pad(counter, 3)}; pagesPrinted:${pagesPrinted}; userID:student${counter}`
+        },
+        fields: [[1, counter, false], [2, pagesPrinted, false], [3, counter, false]]
+      };
+    }
+  },
+  cctv: {
+    port: 8842,
+    code: 1,
+    location: 1,
+    deviceID: (num) => `cam_${num}`,
+    eventID: (num, bootID, counter) => `cctv_${num}_${bootID}_${pad(counter, 3)}`,
+    build(counter) {
+      return {
+        eventType: 2,
+        json: {
+          eventType: 'motion_detected',
+          location: 'Parking Lot A',
+          metadata: `imageReference:img_202503141100_${pad(counter, 3)}.jpg`
+        },
+        fields: [[1, counter, false]]
+      };
+    }
+  },
+  card_reader: {
+    port: 8844,
+    code: 3,
+    location: 3,
+    deviceID: (num) => `reader_${pad(num, 2)}`,
+    eventID: (num, bootID, counter) => `card_${pad(num, 2)}_${bootID}_${pad(counter, 3)}`,
+    build(counter) {
+      const userID = randomInt(0, 999);
+      const cardID = randomInt(0, 999);
+      return {
+        eventType: 6,
+        json: {
+          eventType: 'swipe',
+          location: 'Building A - Main Entrance',
+          metadata: `userID:user${userID}; cardID:card${cardID}`
+        },
+        fields: [[1, userID, false], [2, cardID, false]]
+      };
+    }
+  }
+};
+
+const varint = (value, out) => {
+  while (value >= 0x80) {
+    out.push((value & 0x7f) | 0x80);
+    value = Math.floor(value / 128);
+  }
+  out.push(value);
+};
+
+/**
+ * Encodes one record exactly as sensor_record_begin/put_*() do.
+ */
+function encodeBinary(device, deviceNum, bootID, counter, reading, moteTime) {
+  const out = [CODEC_MAGIC, device.code, reading.eventType];
+  varint(deviceNum, out);
+  varint(device.location, out);
+  varint(counter, out);
+  for (const [field, value, signed] of [...reading.fields, [BOOT_ID_FIELD, bootID, false], [MOTE_TIME_FIELD, moteTime, false]]) {
+    out.push((field << 3) | (signed ? 1 : 0));
+    varint(signed ? (value >= 0 ? value * 2 : -value * 2 - 1) : value, out);
+  }
+  return Buffer.from(out);
+}
+
+/**
+ * Paces events of a weighted device mix to a target rate.
+ */
+class TrafficGenerator {
+  /**
+   * @param {Object} options
+   * @param {string} options.host - Gateway address.
+   * @param {Object<string, number>} options.mix - Relative weight per device type.
+   * @param {number} options.devicesPerType - Distinct device numbers per type.
+   * @param {string} options.format - 'json' or 'binary'.
+   */
+  constructor({ host, mix, devicesPerType, format }) {
+    this.host = host;
+    this.format = format;
+    this.devicesPerType = devicesPerType;
+    this.types = Object.entries(mix)
+      .filter(([, weight]) => weight > 0)
+      .map(([name, weight]) => {
+        if (!DEVICE_TYPES[name]) {
+          throw new Error(`Unknown device type "${name}" in mix`);
+        }
+        return { name, weight, device: DEVICE_TYPES[name], counters: new Array(devicesPerType).fill(0), nextDevice: 0 };
+      });
+    this.totalWeight = this.types.reduce((sum, type) => sum + type.weight, 0);
+    this.socket = dgram.createSocket('udp6');
+    this.bootedAt = Date.now();
+    // One boot id per run, as a mote draws one per boot, so runs against the
+    // same ledger do not repeat eventIDs
+    this.bootID = randomInt(0, 255);
+    this.timer = null;
+    this.stats = { sent: 0, bytes: 0, sendErrors: 0 };
+  }
+
+  _pickType() {
+    let r = Math.random() * this.totalWeight;
+    for (const type of this.types) {
+      r -= type.weight;
+      if (r < 0) {
+        return type;
+      }
+    }
+    return this.types[this.types.length - 1];
+  }
+
+  _sendOne() {
+    const type = this._pickType();
+    const device = type.nextDevice++ % this.devicesPerType;
+    const deviceNum = 1 + device;
+    const counter = ++type.counters[device];
+    const reading = type.device.build(counter);
+    const moteTime = Date.now() - this.bootedAt;
+    const message = this.format === 'binary'
+      ? encodeBinary(type.device, deviceNum, this.bootID, counter, reading, moteTime)
+      : Buffer.from(JSON.stringify({
+        eventID: type.device.eventID(deviceNum, this.bootID, counter),
+        deviceType: type.name,
+        deviceID: type.device.deviceID(deviceNum),
+        moteTime,
+        eventType: reading.json.eventType,
+        location: reading.json.location,
+        metadata: reading.json.metadata
+      }));
+    this.socket.send(message, type.device.port, this.host, (err) => {
+      if (err) {
+        this.stats.sendErrors++;
+      }
+    });
+    this.stats.sent++;
+    this.stats.bytes += message.length;
+  }
+
+  /**
+   * Sends at ratePerSecond until stop(), in 10 ms ticks carrying the fractional remainder.
+   */
+  start(ratePerSecond) {
+    const tickMs = 10;
+    let startedAt = Date.now();
+    let due = 0;
+    this.timer = setInterval(() => {
+      const now = Date.now();
+      due += ((now - startedAt) / 1000) * ratePerSecond;
+      startedAt = now;
+      for (; due >= 1; due--) {
+        this._sendOne();
+      }
+    }, tickMs);
+  }
+
+  stop() {
+    clearInterval(this.timer);
+    this.timer = null;
+  }
+
+  close() {
+    this.stop();
+    this.socket.close();
+  }
+}
+
+module.exports = {
+  DEVICE_TYPES,
+  TrafficGenerator,
+  encodeBinary
+};
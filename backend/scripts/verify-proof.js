@@ -0,0 +1,79 @@
+'use strict';
+
+// Checks the Merkle inclusion proof of an event stored in anchor ingest mode
+// (INGEST_MODE=anchor), without trusting the backend that served it: the leaf
+// is recomputed from the event itself, folded with the proof's sibling hashes,
+// and the resulting root compared with the batch root and with the anchor read
+// from the ledger. Pass --root with a root read from the ledger yourself
+// (ReadAnchor) to also rule out a forged anchor in the response.
+//
+// usage: node scripts/verify-proof.js <proof.json | http://host:port/api/anchors/proof?eventID=...>
+//        [--root <hex root>]
+//
+// Exits 0 when the event is proven included, 1 otherwise.
+
+const fs = require('fs');
+const http = require('http');
+const https = require('https');
+const { leafHash, rootFromProof } = require('../src/services/merkle');
+
+const fetchJSON = (url) => new Promise((resolve, reject) => {
+  (url.startsWith('https:') ? https : http).get(url, (res) => {
+    let body = '';
+    res.setEncoding('utf8');
+    res.on('data', (chunk) => { body += chunk; });
+    res.on('end', () => {
+      try {
+        resolve(JSON.parse(body));
+      } catch (error) {
+        reject(new Error(`${url} returned invalid JSON (HTTP ${res.statusCode})`));
+      }
+    });
+  }).on('error', reject);
+});
+
+const main = async () => {
+  const args = process.argv.slice(2);
+  const rootFlag = args.indexOf('--root');
+  const expectedRoot = rootFlag >= 0 ? args.splice(rootFlag, 2)[1] : null;
+  if (args.length !== 1 || (rootFlag >= 0 && !expectedRoot)) {
+    console.error('usage: node scripts/verify-proof.js <proof.json | proof URL> [--root <hex root>]');
+    process.exit(2);
+  }
+
+  const source = args[0];
+  const response = /^https?:/.test(source)
+    ? await fetchJSON(source)
+    : JSON.parse(fs.readFileSync(source, 'utf8'));
+  if (response.status === 'error') {
+    throw new Error(response.message);
+  }
+  // Accepts the API response as well as the bare proof object
+  const proof = response.proof || response;
+
+  const checks = [];
+  const leaf = leafHash(proof.event);
+  checks.push(['leaf hash matches the event', leaf === proof.leaf]);
+  const root = rootFromProof(leaf, proof.path);
+  checks.push(['path leads to the batch root', root === proof.batch.root]);
+  checks.push(['batch root is anchored on the ledger', Boolean(proof.anchor) && proof.anchor.root === root]);
+  if (expectedRoot) {
+    checks.push(['root matches --root', root === expectedRoot.toLowerCase()]);
+  }
+
+  console.log(`event   ${proof.event.eventID}`);
+  console.log(`leaf    ${leaf}`);
+  console.log(`root    ${root} (${proof.path.length} step(s), leaf ${proof.index} of ${proof.batch.count})`);
+  if (proof.anchor) {
+    console.log(`anchor  tx ${proof.anchor.txID} at ${proof.anchor.anchoredAt}`);
+  }
+  for (const [name, passed] of checks) {
+    console.log(`${passed ? 'ok  ' : 'FAIL'}    ${name}`);
+  }
+  process.exit(checks.every(([, passed]) => passed) ? 0 : 1);
+};
+
+main().catch((error) => {
+  console.error(`verify-proof: ${error.message}`);
+  process.exit(1);
+});
@@ -2,12 +2,128 @@
 const dotenv = require('dotenv');
 dotenv.config({ path: './config.env' });
 
-// Import FabricClient from the services folder
+const path = require('path');
+
+// Import FabricClient, the ledger write batcher and the async ingest services
 const FabricClient = require('../services/fabricClient');
+const SensorBatcher = require('../services/sensorBatcher');
+const WriteAheadLog = require('../services/writeAheadLog');
+const LedgerDrainer = require('../services/ledgerDrainer');
+const EventStore = require('../services/eventStore');
+const AnchorStore = require('../services/anchorStore');
+const Anchorer = require('../services/anchorer');
+const ArchiveWriter = require('../services/archiveWriter');
+const ArchiveReader = require('../services/archiveReader');
+const LoadShedder = require('../services/loadShedder');
+const {
+  recordStage,
+  recordAccepted,
+  getLatencyMetrics,
+  formatPrometheus,
+  resetLatencyMetrics
+} = require('../services/latencyMetrics');
 
 // Instantiate FabricClient
 const fabricClient = new FabricClient();
 
+// Events are written to the ledger in micro-batches (one CreateEvents
+// transaction per batch) instead of one transaction per event.
+const sensorBatcher = new SensorBatcher((events) => fabricClient.submitSensorBatch(events), {
+  maxEvents: Number(process.env.FABRIC_BATCH_MAX_EVENTS) || undefined,
+  maxWaitMs: Number(process.env.FABRIC_BATCH_MAX_WAIT_MS) || undefined
+});
+
+// Ingest mode: 'sync' holds each request until its event is on the ledger;
+// 'async' acknowledges once the event is durable in the local write-ahead log
+// and drains the log to the ledger in the background; 'anchor' keeps events
+// off-chain in the anchor store and only puts the Merkle root of each
+// ANCHOR_WINDOW_MS window of events on the ledger.
+const INGEST_MODE = ['async', 'anchor'].includes(process.env.INGEST_MODE) ? process.env.INGEST_MODE : 'sync';
+
+let writeAheadLog = null;
+let ledgerDrainer = null;
+if (INGEST_MODE === 'async') {
+  writeAheadLog = new WriteAheadLog({
+    dir: path.resolve(process.env.WAL_DIR || './data/wal'),
+    segmentBytes: Number(process.env.WAL_SEGMENT_BYTES) || undefined,
+    fsyncIntervalMs: Number(process.env.WAL_FSYNC_INTERVAL_MS) || undefined
+  });
+  const recovered = writeAheadLog.open();
+  ledgerDrainer = new LedgerDrainer(writeAheadLog, (events) => fabricClient.submitSensorBatch(events), {
+    batchSize: Number(process.env.WAL_DRAIN_BATCH_SIZE) || undefined,
+    maxInflight: Number(process.env.WAL_DRAIN_MAX_INFLIGHT) || undefined,
+    maxBacklog: Number(process.env.WAL_MAX_BACKLOG) || undefined,
+    maxAttempts: Number(process.env.WAL_MAX_ATTEMPTS) || undefined
+  });
+  ledgerDrainer.start(recovered);
+}
+
+let anchorStore = null;
+let anchorer = null;
+if (INGEST_MODE === 'anchor') {
+  anchorStore = new AnchorStore({
+    dir: path.resolve(process.env.ANCHOR_DIR || './data/anchor'),
+    segmentBytes: Number(process.env.ANCHOR_SEGMENT_BYTES) || undefined,
+    fsyncIntervalMs: Number(process.env.ANCHOR_FSYNC_INTERVAL_MS) || undefined
+  }).open();
+  anchorer = new Anchorer(anchorStore, (batch) => fabricClient.anchorBatch(batch), {
+    windowMs: Number(process.env.ANCHOR_WINDOW_MS) || undefined
+  });
+  anchorer.start();
+}
+
+// Past INGEST_SHED_BACKLOG events waiting for the ledger (default 5000, 0
+// turns shedding off), bulk readings are refused with 503 and only alarms
+// (CO2 at or above INGEST_CO2_ALARM_PPM, CCTV motion) and access events are
+// accepted (see loadShedder.js). Anchor mode keeps events off the ledger and
+// never sheds.
+let loadShedder = null;
+if (INGEST_MODE !== 'anchor' && process.env.INGEST_SHED_BACKLOG !== '0') {
+  loadShedder = new LoadShedder(() => (ledgerDrainer ? ledgerDrainer.backlog() : sensorBatcher.backlog()), {
+    threshold: Number(process.env.INGEST_SHED_BACKLOG) || undefined,
+    co2AlarmPpm: Number(process.env.INGEST_CO2_ALARM_PPM) || undefined
+  });
+}
+
+// Dashboard reads are served from an in-memory read model of the ledger kept
+// current by block events (see eventStore.js) instead of chaincode queries.
+// EVENT_STORE=off reads the ledger on every request. EVENT_STORE_SNAPSHOT
+// names a file the store is saved to, so a restart replays blocks from the
+// snapshot instead of reading the whole ledger (not with the mock ledger,
+// which starts empty).
+let eventStore = null;
+if (process.env.EVENT_STORE !== 'off') {
+  eventStore = new EventStore({
+    snapshotPath: process.env.EVENT_STORE_SNAPSHOT && fabricClient.mode !== 'mock'
+      ? path.resolve(process.env.EVENT_STORE_SNAPSHOT)
+      : null,
+    snapshotIntervalMs: Number(process.env.EVENT_STORE_SNAPSHOT_INTERVAL_MS) || undefined,
+    anchors: anchorStore
+  });
+  eventStore.start(fabricClient);
+}
+
+// ARCHIVE_DIR turns on the columnar archive of committed events (see
+// archiveWriter.js), which serves range and aggregate queries over months of
+// history from compressed per-device-type, per-day chunk files. Buffered
+// events are written out every ARCHIVE_FLUSH_INTERVAL_MS. With the mock
+// ledger, whose block numbers restart, the archive does not resume from its
+// checkpoint and only appends what is committed while it runs.
+let archiveWriter = null;
+let archiveReader = null;
+if (process.env.ARCHIVE_DIR) {
+  const archiveDir = path.resolve(process.env.ARCHIVE_DIR);
+  archiveWriter = new ArchiveWriter({
+    dir: archiveDir,
+    flushIntervalMs: Number(process.env.ARCHIVE_FLUSH_INTERVAL_MS) || undefined,
+    maxBufferedRows: Number(process.env.ARCHIVE_MAX_BUFFERED_ROWS) || undefined,
+    fromCheckpoint: fabricClient.mode !== 'mock',
+    anchors: anchorStore
+  }).open();
+  archiveWriter.start(fabricClient);
+  archiveReader = new ArchiveReader({ dir: archiveDir });
+}
+
 /**
  * Helper function to validate required fields.
  * Returns a string detailing the missing fields if any exist, or null if all are present.
@@ -24,6 +140,30 @@ const validateRequiredFields = (obj, requiredFields) => {
   return null;
 };
 
+/**
+ * Returns an error message unless startTime and endTime, when given, are timestamps.
+ */
+const validateTimeWindow = (query) => {
+  if ([query.startTime, query.endTime].some((time) => time !== undefined && Number.isNaN(Date.parse(time)))) {
+    return 'startTime and endTime must be ISO formatted timestamps';
+  }
+  return null;
+};
+
+/**
+ * Checks that the given query parameters, where present, are positive integers.
+ *
+ * @returns {string|null} An error message, or null if they are.
+ */
+const validatePositiveIntegers = (query, names) => {
+  const invalid = names.filter((name) => query[name] !== undefined &&
+    !(Number.isInteger(Number(query[name])) && Number(query[name]) > 0));
+  if (invalid.length > 0) {
+    return `${invalid.join(' and ')} must be ${invalid.length > 1 ? 'positive integers' : 'a positive integer'}`;
+  }
+  return null;
+};
+
 /**
  * Express controller function to handle incoming sensor event submissions.
  * It expects a POST request with a JSON body containing:
@@ -33,7 +173,15 @@ const validateRequiredFields = (obj, requiredFields) => {
  *   - metadata
  *   - location
  *
- * On success, it records the sensor data onto the blockchain via FabricClient.
+ * On success, it records the sensor data onto the blockchain via FabricClient,
+ * batched with other events received within the same short window.
+ * An optional `trace` object (stamped by the ingestion gateway) is completed
+ * with the acceptance time and feeds the latency histograms; it is not
+ * stored on the ledger. While the ledger backlog is shedding load, only
+ * alarms and access events are accepted, the rest get 503 with Retry-After.
+ * Resending an event already on the ledger answers with result status
+ * 'duplicate'; an event whose eventID the ledger holds with different
+ * content gets 409 and is not recorded.
  * On error, it returns appropriate HTTP response statuses with a clear message.
  *
  * Success response example:
@@ -64,14 +212,30 @@ const submitSensorEvent = async (req, res) => {
     });
   }
 
+  if (loadShedder && !loadShedder.admit(req.body)) {
+    res.set('Retry-After', '1');
+    return res.status(503).json({
+      status: 'error',
+      message: 'Ledger backlog is high, only alarms and access events are accepted; retry later.'
+    });
+  }
+
+  recordAccepted(req.body);
+
+  if (INGEST_MODE === 'async') {
+    return acceptSensorEvent(req, res);
+  }
+  if (INGEST_MODE === 'anchor') {
+    return storeSensorEvent(req, res);
+  }
+
   try {
     // Extract sensor data from the request body
     const sensorData = req.body;
-    console.log('Received sensor data:', sensorData);
 
-    // Submit the sensor data to the blockchain using FabricClient
-    const result = await fabricClient.submitSensorData(sensorData);
-    
+    // Queue the sensor data for the next CreateEvents batch and wait for it to commit
+    const result = await sensorBatcher.add(sensorData);
+
     // Return a clear success response with the transaction result
     return res.status(200).json({
       status: 'success',
@@ -80,13 +244,589 @@ const submitSensorEvent = async (req, res) => {
     });
   } catch (error) {
     console.error('Error recording sensor event:', error);
-    return res.status(500).json({
+    return res.status(error.rejected ? 400 : error.conflict ? 409 : 500).json({
       status: 'error',
       message: error.message || 'An error occurred while recording the sensor event.'
     });
   }
 };
 
+/**
+ * Async-mode handler: appends the validated event to the write-ahead log and
+ * answers 202 with its sequence number as soon as it is durable. Refuses new
+ * events with 503 while the ledger backlog is over its limit.
+ *
+ * Accepted response example:
+ * {
+ *   "status": "accepted",
+ *   "message": "Sensor event accepted for ledger commit.",
+ *   "sequence": 1042
+ * }
+ *
+ * @param {Object} req - Express request object.
+ * @param {Object} res - Express response object.
+ */
+const acceptSensorEvent = async (req, res) => {
+  if (ledgerDrainer.isBackpressured()) {
+    res.set('Retry-After', '1');
+    return res.status(503).json({
+      status: 'error',
+      message: 'Ledger backlog is full, retry later.'
+    });
+  }
+
+  try {
+    const sequence = await writeAheadLog.append(req.body);
+    recordStage('wal_append', Date.now() - req.body.trace.acceptedAt);
+    ledgerDrainer.enqueue({ seq: sequence, event: req.body });
+    return res.status(202).json({
+      status: 'accepted',
+      message: 'Sensor event accepted for ledger commit.',
+      sequence
+    });
+  } catch (error) {
+    console.error('Error appending sensor event to write-ahead log:', error);
+    return res.status(500).json({
+      status: 'error',
+      message: error.message || 'An error occurred while accepting the sensor event.'
+    });
+  }
+};
+
+/**
+ * Anchor-mode handler: appends the event (without its gateway trace) to the
+ * anchor store and answers 202 with its leaf hash once it is durable. The
+ * event is on the ledger, through its batch root, after the next anchoring
+ * window; GET /anchors/proof then proves it. The chaincode never sees the
+ * event, so its timestamp and device type are checked here. Resending a
+ * stored event answers 202 again; a different event reusing a stored eventID
+ * gets 409.
+ *
+ * Accepted response example:
+ * {
+ *   "status": "accepted",
+ *   "message": "Sensor event stored for anchoring.",
+ *   "hash": "<leaf hash>"
+ * }
+ *
+ * @param {Object} req - Express request object.
+ * @param {Object} res - Express response object.
+ */
+const storeSensorEvent = async (req, res) => {
+  const { trace, ...event } = req.body;
+  const validationError = validateRequiredFields(event, ['deviceType', 'timestamp']);
+  if (validationError || Number.isNaN(Date.parse(event.timestamp))) {
+    return res.status(400).json({
+      status: 'error',
+      message: validationError || `Invalid timestamp "${event.timestamp}"`
+    });
+  }
+
+  try {
+    const { hash, duplicate } = await anchorStore.append(event);
+    recordStage('anchor_append', Date.now() - trace.acceptedAt);
+    return res.status(202).json({
+      status: 'accepted',
+      message: duplicate ? 'Sensor event was already stored.' : 'Sensor event stored for anchoring.',
+      hash
+    });
+  } catch (error) {
+    console.error('Error appending sensor event to the anchor store:', error);
+    return res.status(error.conflict ? 409 : 500).json({
+      status: 'error',
+      message: error.message || 'An error occurred while storing the sensor event.'
+    });
+  }
+};
+
+// Page sizes used when streaming events out of the ledger
+const DEFAULT_STREAM_PAGE_SIZE = 200;
+const MAX_STREAM_PAGE_SIZE = 1000;
+
+/**
+ * Resolves once the response can take more data, or once the client is gone.
+ */
+const waitForDrain = (res) => new Promise((resolve) => {
+  const done = () => {
+    res.off('drain', done);
+    res.off('close', done);
+    resolve();
+  };
+  res.on('drain', done);
+  res.on('close', done);
+});
+
+/**
+ * Express controller function streaming sensor events as NDJSON (one event
+ * per line), oldest first. Events come from the event store once it has
+ * caught up with the ledger; until then they are read from the ledger one
+ * page at a time with the chaincode's bookmark pagination. Either way each
+ * page is written as soon as it is ready, so the client can render the first
+ * rows while later pages are still being read.
+ *
+ * Query parameters (all optional):
+ *   - deviceID: only events of this device
+ *   - deviceType: only events of this device type
+ *   - startTime, endTime: only events in this window (ISO timestamps, inclusive)
+ *   - pageSize: events per write, and per ledger query (default 200, max 1000)
+ *   - limit: stop after this many events (default: all of them)
+ * pageSize and limit must be positive integers.
+ *
+ * @param {Object} req - Express request object.
+ * @param {Object} res - Express response object.
+ */
+const streamSensorEvents = async (req, res) => {
+  const { deviceID, deviceType, startTime, endTime } = req.query;
+  const validationError = validatePositiveIntegers(req.query, ['pageSize', 'limit']) || validateTimeWindow(req.query);
+  if (validationError) {
+    return res.status(400).json({
+      status: 'error',
+      message: validationError
+    });
+  }
+  const pageSize = Math.min(Number(req.query.pageSize) || DEFAULT_STREAM_PAGE_SIZE, MAX_STREAM_PAGE_SIZE);
+  const limit = Number(req.query.limit) || Infinity;
+
+  let closed = false;
+  res.on('close', () => {
+    closed = true;
+  });
+  const startStream = () => {
+    if (!res.headersSent) {
+      res.status(200).set({
+        'Content-Type': 'application/x-ndjson',
+        'Cache-Control': 'no-cache'
+      });
+      res.flushHeaders();
+    }
+  };
+
+  if (eventStore && eventStore.isReady()) {
+    const records = eventStore.query({ deviceID, deviceType, startTime, endTime, limit });
+    startStream();
+    for (let i = 0; i < records.length && !closed; i += pageSize) {
+      const page = records.slice(i, i + pageSize).map((event) => `${JSON.stringify(event)}\n`).join('');
+      if (!res.write(page)) {
+        await waitForDrain(res);
+      }
+    }
+    return res.end();
+  }
+
+  const start = startTime !== undefined ? Date.parse(startTime) : -Infinity;
+  const end = endTime !== undefined ? Date.parse(endTime) : Infinity;
+  let bookmark = '';
+  let sent = 0;
+  try {
+    do {
+      const page = await fabricClient.getSensorEventsPage({ deviceID, deviceType, pageSize, bookmark });
+      bookmark = page.bookmark;
+      startStream();
+
+      // Device pages span every type, so a type filter still applies to them
+      let records = page.records.filter((event) => {
+        const time = Date.parse(event.timestamp);
+        return time >= start && time <= end && (!deviceID || !deviceType || event.deviceType === deviceType);
+      });
+      records = records.slice(0, limit - sent);
+      sent += records.length;
+      if (records.length > 0 && !res.write(records.map((event) => `${JSON.stringify(event)}\n`).join(''))) {
+        await waitForDrain(res);
+      }
+    } while (bookmark && sent < limit && !closed);
+    res.end();
+  } catch (error) {
+    console.error('Error streaming sensor events:', error);
+    if (!res.headersSent) {
+      return res.status(500).json({
+        status: 'error',
+        message: error.message || 'An error occurred while reading sensor events.'
+      });
+    }
+    // Headers are gone: abort so the client sees a truncated stream, not a short one
+    res.destroy(error);
+  }
+};
+
+// Live stream settings: keep-alive comment period, client reconnect delay, and
+// unsent bytes after which a slow client is dropped (it reconnects and is
+// sent what it missed)
+const LIVE_HEARTBEAT_MS = 15000;
+const LIVE_RETRY_MS = 2000;
+const LIVE_MAX_BUFFERED_BYTES = 8 * 1024 * 1024;
+
+/**
+ * Express controller function pushing sensor events as they are committed,
+ * as server-sent events, so dashboards follow the ledger without polling.
+ * Each block with matching changes is sent as one message with the block
+ * number as its id:
+ *   - event "events": JSON array of the events written
+ *   - event "deleted": JSON array of the eventIDs deleted
+ *   - event "reset": the events missed since Last-Event-ID cannot be
+ *     resent; the client should reload them with GET /sensor-events
+ * A reconnecting client (Last-Event-ID header) is first sent the events
+ * written since that block.
+ *
+ * Query parameters (all optional): deviceID, deviceType.
+ *
+ * @param {Object} req - Express request object.
+ * @param {Object} res - Express response object.
+ */
+const streamSensorEventUpdates = (req, res) => {
+  if (!eventStore) {
+    return res.status(503).json({
+      status: 'error',
+      message: 'Live updates need the event store (EVENT_STORE is off).'
+    });
+  }
+  const { deviceID, deviceType } = req.query;
+  const matches = (event) => (!deviceID || event.deviceID === deviceID) && (!deviceType || event.deviceType === deviceType);
+
+  res.status(200).set({
+    'Content-Type': 'text/event-stream',
+    'Cache-Control': 'no-cache',
+    'X-Accel-Buffering': 'no'
+  });
+  res.flushHeaders();
+  res.write(`retry: ${LIVE_RETRY_MS}\n\n`);
+
+  const send = (id, name, data) => {
+    res.write(`id: ${id}\nevent: ${name}\ndata: ${JSON.stringify(data)}\n\n`);
+    if (res.writableLength > LIVE_MAX_BUFFERED_BYTES) {
+      res.destroy();
+    }
+  };
+
+  const lastEventID = req.get('Last-Event-ID');
+  if (lastEventID !== undefined && /^\d+$/.test(lastEventID)) {
+    const missed = eventStore.writtenSince(Number(lastEventID), { deviceID, deviceType });
+    if (missed === null) {
+      send(eventStore.blockNumber ?? '', 'reset', {});
+    } else if (missed.length > 0) {
+      send(eventStore.blockNumber, 'events', missed);
+    }
+  }
+
+  const unsubscribe = eventStore.subscribe((blockNumber, written, deleted) => {
+    const events = written.filter(matches);
+    if (events.length > 0) {
+      send(blockNumber, 'events', events);
+    }
+    if (deleted.length > 0) {
+      send(blockNumber, 'deleted', deleted);
+    }
+  });
+  const heartbeat = setInterval(() => res.write(': keep-alive\n\n'), LIVE_HEARTBEAT_MS);
+  res.on('close', () => {
+    clearInterval(heartbeat);
+    unsubscribe();
+  });
+};
+
+/**
+ * Express controller function returning the hourly aggregates the chaincode
+ * maintains for a device's numeric readings (CO₂ level, temperature, energy
+ * consumption), without reading the individual events.
+ *
+ * Query parameters: deviceID, field, startTime, endTime (all required).
+ *
+ * @param {Object} req - Express request object.
+ * @param {Object} res - Express response object.
+ */
+const getSensorAggregates = async (req, res) => {
+  const validationError = validateRequiredFields(req.query, ['deviceID', 'field', 'startTime', 'endTime']);
+  if (validationError) {
+    return res.status(400).json({
+      status: 'error',
+      message: validationError
+    });
+  }
+
+  try {
+    const aggregates = await fabricClient.getSensorAggregates(req.query);
+    return res.status(200).json({
+      status: 'success',
+      aggregates
+    });
+  } catch (error) {
+    console.error('Error reading sensor aggregates:', error);
+    return res.status(500).json({
+      status: 'error',
+      message: error.message || 'An error occurred while reading sensor aggregates.'
+    });
+  }
+};
+
+// Most events one archive range query returns
+const DEFAULT_ARCHIVE_LIMIT = 1000;
+const MAX_ARCHIVE_LIMIT = 10000;
+
+const ARCHIVE_OFF_MESSAGE = 'The event archive is off (set ARCHIVE_DIR to enable it).';
+
+/**
+ * Express controller function returning archived events, oldest first, read
+ * from the columnar archive (see archiveReader.js) with the scan statistics.
+ *
+ * Query parameters (all optional):
+ *   - deviceType: only events of this device type
+ *   - deviceID: only events of this device
+ *   - startTime, endTime: only events in this window (ISO timestamps, inclusive)
+ *   - limit: at most this many events (default 1000, max 10000)
+ *
+ * @param {Object} req - Express request object.
+ * @param {Object} res - Express response object.
+ */
+const getArchivedEvents = (req, res) => {
+  if (!archiveReader) {
+    return res.status(404).json({
+      status: 'error',
+      message: ARCHIVE_OFF_MESSAGE
+    });
+  }
+  const validationError = validatePositiveIntegers(req.query, ['limit']) || validateTimeWindow(req.query);
+  if (validationError) {
+    return res.status(400).json({
+      status: 'error',
+      message: validationError
+    });
+  }
+  const { deviceType, deviceID, startTime, endTime } = req.query;
+  const limit = Math.min(Number(req.query.limit) || DEFAULT_ARCHIVE_LIMIT, MAX_ARCHIVE_LIMIT);
+
+  try {
+    const { events, scan } = archiveReader.range({ deviceType, deviceID, startTime, endTime, limit });
+    return res.status(200).json({
+      status: 'success',
+      events,
+      scan
+    });
+  } catch (error) {
+    console.error('Error reading the event archive:', error);
+    return res.status(500).json({
+      status: 'error',
+      message: error.message || 'An error occurred while reading the event archive.'
+    });
+  }
+};
+
+/**
+ * Express controller function returning count, sum, min, max and avg of a
+ * numeric metadata field (e.g. co2Level, temperature, brightness,
+ * pagesPrinted) over archived events, in total or per UTC hour or day.
+ *
+ * Query parameters: field (required); deviceType, deviceID, startTime,
+ * endTime and interval ('hour' or 'day') (optional).
+ *
+ * @param {Object} req - Express request object.
+ * @param {Object} res - Express response object.
+ */
+const getArchivedAggregates = (req, res) => {
+  if (!archiveReader) {
+    return res.status(404).json({
+      status: 'error',
+      message: ARCHIVE_OFF_MESSAGE
+    });
+  }
+  const validationError = validateRequiredFields(req.query, ['field']) || validateTimeWindow(req.query);
+  if (validationError) {
+    return res.status(400).json({
+      status: 'error',
+      message: validationError
+    });
+  }
+  const { field, deviceType, deviceID, startTime, endTime, interval } = req.query;
+  if (interval !== undefined && !['hour', 'day'].includes(interval)) {
+    return res.status(400).json({
+      status: 'error',
+      message: 'interval must be hour or day'
+    });
+  }
+
+  try {
+    const { aggregates, scan } = archiveReader.aggregate({ field, deviceType, deviceID, startTime, endTime, interval });
+    return res.status(200).json({
+      status: 'success',
+      aggregates,
+      scan
+    });
+  } catch (error) {
+    console.error('Error aggregating the event archive:', error);
+    return res.status(500).json({
+      status: 'error',
+      message: error.message || 'An error occurred while aggregating the event archive.'
+    });
+  }
+};
+
+/**
+ * Express controller function reporting the archive's export progress
+ * (checkpoint block, buffered events, flushes, compactions) and storage
+ * (partitions, chunks, events, bytes on disk and the compression ratio
+ * against the same events as ledger JSON).
+ *
+ * @param {Object} req - Express request object.
+ * @param {Object} res - Express response object.
+ */
+const getArchiveStatus = (req, res) => {
+  if (!archiveReader) {
+    return res.status(404).json({
+      status: 'error',
+      message: ARCHIVE_OFF_MESSAGE
+    });
+  }
+  return res.status(200).json({
+    status: 'success',
+    archive: {
+      export: archiveWriter.getStatus(),
+      storage: archiveReader.getStatus()
+    }
+  });
+};
+
+/**
+ * Express controller function returning the inclusion proof of an event
+ * stored in anchor mode: the event, its leaf hash, the sibling hashes up to
+ * its batch root, and the batch's anchor as read from the ledger (not the
+ * backend's own copy), so the proof can be checked with
+ * scripts/verify-proof.js without trusting this backend.
+ *
+ * Query parameters: eventID (required).
+ *
+ * Responds 404 for an unknown event and 409 while its batch is not anchored yet.
+ *
+ * @param {Object} req - Express request object.
+ * @param {Object} res - Express response object.
+ */
+const getEventProof = async (req, res) => {
+  const validationError = validateRequiredFields(req.query, ['eventID']);
+  if (validationError) {
+    return res.status(400).json({
+      status: 'error',
+      message: validationError
+    });
+  }
+  if (!anchorStore) {
+    return res.status(404).json({
+      status: 'error',
+      message: 'Proofs are only kept in anchor ingest mode (INGEST_MODE=anchor).'
+    });
+  }
+
+  const proof = anchorStore.proof(req.query.eventID);
+  if (!proof) {
+    return res.status(404).json({
+      status: 'error',
+      message: `The event ${req.query.eventID} is not in the anchor store`
+    });
+  }
+  if (!proof.anchor) {
+    res.set('Retry-After', String(Math.ceil(anchorer.windowMs / 1000)));
+    return res.status(409).json({
+      status: 'error',
+      message: `The event ${req.query.eventID} is not anchored yet`
+    });
+  }
+
+  try {
+    const { anchor, ...rest } = proof;
+    return res.status(200).json({
+      status: 'success',
+      proof: { ...rest, anchor: await fabricClient.readAnchor(proof.batch.root) }
+    });
+  } catch (error) {
+    console.error('Error reading batch anchor:', error);
+    return res.status(500).json({
+      status: 'error',
+      message: error.message || 'An error occurred while reading the batch anchor.'
+    });
+  }
+};
+
+/**
+ * Express controller function reporting the ingest pipeline state. In async
+ * mode this includes the last accepted sequence number and the committed
+ * high-water mark (every sequence at or below it is on the ledger); in
+ * anchor mode, the anchor store's size and the anchoring progress; in the
+ * other modes, the load shedding threshold and counters.
+ *
+ * @param {Object} req - Express request object.
+ * @param {Object} res - Express response object.
+ */
+const getIngestStatus = (req, res) => {
+  let ingest;
+  if (INGEST_MODE === 'async') {
+    ingest = { mode: INGEST_MODE, ...writeAheadLog.getStatus(), ...ledgerDrainer.getStatus() };
+  } else if (INGEST_MODE === 'anchor') {
+    ingest = { mode: INGEST_MODE, store: anchorStore.getStatus(), anchoring: anchorer.getStatus() };
+  } else {
+    ingest = { mode: INGEST_MODE, ...sensorBatcher.getStats() };
+  }
+  if (loadShedder) {
+    ingest.shedding = loadShedder.getStats();
+  }
+  return res.status(200).json({
+    status: 'success',
+    ingest
+  });
+};
+
+/**
+ * Express controller function reporting Fabric connection pool metrics:
+ * connection-setup time versus submit time, failures and reconnects, and the
+ * event store's size and last applied block.
+ *
+ * @param {Object} req - Express request object.
+ * @param {Object} res - Express response object.
+ */
+const getFabricMetrics = (req, res) => {
+  return res.status(200).json({
+    status: 'success',
+    metrics: {
+      ...fabricClient.getMetrics(),
+      batching: sensorBatcher.getStats(),
+      eventStore: eventStore ? eventStore.getStats() : null
+    }
+  });
+};
+
+/**
+ * Express controller function reporting per-stage latency histograms of the
+ * ingest pipeline (mote reading, gateway arrival and decode, API acceptance,
+ * batching, endorse, order, commit) with p50/p90/p99/p99.9, and accepted and
+ * committed throughput.
+ *
+ * Query parameters (all optional):
+ *   - format: 'prometheus' for the Prometheus text format instead of JSON
+ *   - reset: 'true' to clear the histograms after reading them, e.g. between benchmark runs
+ *
+ * @param {Object} req - Express request object.
+ * @param {Object} res - Express response object.
+ */
+const getLatencyMetricsHandler = (req, res) => {
+  const body = req.query.format === 'prometheus' ? formatPrometheus() : null;
+  const metrics = body === null ? getLatencyMetrics() : null;
+  if (req.query.reset === 'true') {
+    resetLatencyMetrics();
+  }
+  if (body !== null) {
+    return res.status(200).type('text/plain; version=0.0.4').send(body);
+  }
+  return res.status(200).json({
+    status: 'success',
+    metrics
+  });
+};
+
 module.exports = {
-  submitSensorEvent
+  submitSensorEvent,
+  streamSensorEvents,
+  streamSensorEventUpdates,
+  getSensorAggregates,
+  getEventProof,
+  getArchivedEvents,
+  getArchivedAggregates,
+  getArchiveStatus,
+  getIngestStatus,
+  getFabricMetrics,
+  getLatencyMetrics: getLatencyMetricsHandler
 };
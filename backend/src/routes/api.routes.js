@@ -10,5 +10,46 @@ const router = express.Router();
 // the submitSensorEvent method in sensorController is called.
 router.post('/sensor-events', sensorController.submitSensorEvent);
 
+// Define the HTTP GET route at '/sensor-events'
+// Streams sensor events as NDJSON from the block-event-fed event store
+// (or from the ledger, one page at a time, until the store has caught up).
+router.get('/sensor-events', sensorController.streamSensorEvents);
+
+// Define the HTTP GET route at '/sensor-events/stream'
+// Pushes newly committed sensor events as server-sent events.
+router.get('/sensor-events/stream', sensorController.streamSensorEventUpdates);
+
+// Define the HTTP GET route at '/sensor-aggregates'
+// Returns the on-chain hourly aggregates of one reading of one device.
+router.get('/sensor-aggregates', sensorController.getSensorAggregates);
+
+// Define the HTTP GET route at '/anchors/proof'
+// Returns the Merkle inclusion proof of an event stored in anchor ingest mode.
+router.get('/anchors/proof', sensorController.getEventProof);
+
+// Define the HTTP GET route at '/archive/events'
+// Returns archived events of a device type, device and time window.
+router.get('/archive/events', sensorController.getArchivedEvents);
+
+// Define the HTTP GET route at '/archive/aggregates'
+// Returns hourly, daily or total aggregates of a numeric field from the archive.
+router.get('/archive/aggregates', sensorController.getArchivedAggregates);
+
+// Define the HTTP GET route at '/archive/status'
+// Reports the archive's export checkpoint, size and compression ratio.
+router.get('/archive/status', sensorController.getArchiveStatus);
+
+// Define the HTTP GET route at '/ingest/status'
+// Reports the ingest mode, backlog and committed high-water mark.
+router.get('/ingest/status', sensorController.getIngestStatus);
+
+// Define the HTTP GET route at '/fabric/metrics'
+// Reports connection-setup versus submit timings of the Fabric gateway pool.
+router.get('/fabric/metrics', sensorController.getFabricMetrics);
+
+// Define the HTTP GET route at '/metrics'
+// Reports per-stage latency histograms from mote reading to ledger commit.
+router.get('/metrics', sensorController.getLatencyMetrics);
+
 // Export the router instance for use in the main application.
 module.exports = router;
@@ -0,0 +1,383 @@
+// Content-addressed, append-only event store of the anchor ingest mode
+// (INGEST_MODE=anchor). Full events stay in this store, off the ledger, and
+// the ledger only receives the Merkle root of each batch (see anchorer.js).
+//
+// Events are appended to segment files as NDJSON lines
+// {"hash": leaf hash, "event": {...}} and fsynced in groups, like the
+// write-ahead log. Lines are never rewritten or deleted. An event is
+// addressed by its leaf hash (merkle.js), so anyone holding it can check it
+// against an anchored root. Sealing a batch appends its root and its leaf
+// hashes in order to batches.log as {"batch": {...}}, and anchoring it appends
+// {"anchored": root, "anchor": on-chain record}. Events appended since the
+// last seal form the open batch.
+
+const fs = require('fs');
+const path = require('path');
+const { leafHash, buildLevels, merkleProof } = require('./merkle');
+
+const DEFAULT_SEGMENT_BYTES = 64 * 1024 * 1024;
+const DEFAULT_FSYNC_INTERVAL_MS = 10;
+
+const SEGMENT_PREFIX = 'events-';
+const SEGMENT_SUFFIX = '.log';
+const BATCHES_FILE = 'batches.log';
+
+const segmentName = (number) => `${SEGMENT_PREFIX}${String(number).padStart(8, '0')}${SEGMENT_SUFFIX}`;
+
+/**
+ * Writes the whole buffer to fd, looping over partial writes.
+ */
+const writeAll = (fd, buffer) => new Promise((resolve, reject) => {
+  const writeFrom = (offset) => {
+    fs.write(fd, buffer, offset, buffer.length - offset, null, (err, written) => {
+      if (err) {
+        reject(err);
+      } else if (offset + written < buffer.length) {
+        writeFrom(offset + written);
+      } else {
+        resolve();
+      }
+    });
+  };
+  writeFrom(0);
+});
+
+const fdatasync = (fd) => new Promise((resolve, reject) => {
+  fs.fdatasync(fd, (err) => (err ? reject(err) : resolve()));
+});
+
+/**
+ * Calls onLine(text, offset, length) for each complete line of a file and
+ * truncates a torn last line (crash mid-write).
+ */
+const readLines = (file, onLine) => {
+  const content = fs.readFileSync(file);
+  let offset = 0;
+  while (offset < content.length) {
+    const newline = content.indexOf(0x0a, offset);
+    if (newline === -1) {
+      break;
+    }
+    onLine(content.subarray(offset, newline).toString('utf8'), offset, newline - offset);
+    offset = newline + 1;
+  }
+  if (offset < content.length) {
+    console.warn(`Anchor store: truncating ${content.length - offset} torn bytes at the end of ${file}`);
+    fs.truncateSync(file, offset);
+  }
+  return offset;
+};
+
+class AnchorStore {
+  /**
+   * @param {Object} options
+   * @param {string} options.dir - Directory holding the segments and batches.log.
+   * @param {number} [options.segmentBytes] - Roll to a new segment past this size.
+   * @param {number} [options.fsyncIntervalMs] - Group-commit window.
+   */
+  constructor(options) {
+    this.dir = options.dir;
+    this.segmentBytes = options.segmentBytes || DEFAULT_SEGMENT_BYTES;
+    this.fsyncIntervalMs = options.fsyncIntervalMs || DEFAULT_FSYNC_INTERVAL_MS;
+
+    this.segments = [];         // { file, readFd, bytes }, oldest first; the last one is appended to
+    this.fd = null;
+    this.batchesFd = null;
+    this.byEventID = new Map(); // eventID -> leaf hash, including appends in flight
+    this.byHash = new Map();    // leaf hash -> { segment, offset, length, batch, index }
+    this.batches = new Map();   // root -> { root, count, startTime, endTime, sealedAt, leaves, anchor }
+    this.openLeaves = [];       // leaf hashes of the open batch, in append order
+    this.openRange = null;      // { start, end } event times of the open batch
+
+    this.buffered = [];
+    this.flushTimer = null;
+    this.flushing = null;
+    this.stats = { appends: 0, duplicates: 0, conflicts: 0, flushes: 0, bytesWritten: 0 };
+  }
+
+  /**
+   * Opens the store, recovering its indexes from disk.
+   */
+  open() {
+    fs.mkdirSync(this.dir, { recursive: true });
+
+    const batchesPath = path.join(this.dir, BATCHES_FILE);
+    if (fs.existsSync(batchesPath)) {
+      readLines(batchesPath, (line) => {
+        const record = JSON.parse(line);
+        if (record.batch) {
+          this._addBatch(record.batch);
+        } else if (record.anchored && this.batches.has(record.anchored)) {
+          this.batches.get(record.anchored).anchor = record.anchor;
+        }
+      });
+    }
+    this.batchesFd = fs.openSync(batchesPath, 'a');
+
+    const files = fs.readdirSync(this.dir)
+      .filter((file) => file.startsWith(SEGMENT_PREFIX) && file.endsWith(SEGMENT_SUFFIX))
+      .sort();
+    for (const file of files) {
+      const segment = { file: path.join(this.dir, file), readFd: null, bytes: 0 };
+      const index = this.segments.length;
+      segment.bytes = readLines(segment.file, (line, offset, length) => {
+        const { hash, event } = JSON.parse(line);
+        const location = this.byHash.get(hash) || { batch: null, index: null };
+        this.byHash.set(hash, { ...location, segment: index, offset, length });
+        this.byEventID.set(event.eventID, hash);
+        if (location.batch === null) {
+          this._addToOpen(hash, event);
+        }
+      });
+      segment.readFd = fs.openSync(segment.file, 'r');
+      this.segments.push(segment);
+    }
+    if (this.segments.length === 0) {
+      this._newSegment();
+    }
+    this.fd = fs.openSync(this.segments[this.segments.length - 1].file, 'a');
+    return this;
+  }
+
+  _newSegment() {
+    const file = path.join(this.dir, segmentName(this.segments.length + 1));
+    fs.closeSync(fs.openSync(file, 'a'));
+    this.segments.push({ file, readFd: fs.openSync(file, 'r'), bytes: 0 });
+  }
+
+  _addBatch(batch) {
+    this.batches.set(batch.root, { ...batch, anchor: null });
+    batch.leaves.forEach((hash, index) => {
+      this.byHash.set(hash, { ...this.byHash.get(hash), batch: batch.root, index });
+    });
+  }
+
+  _addToOpen(hash, event) {
+    const time = Date.parse(event.timestamp);
+    this.openLeaves.push(hash);
+    this.openRange = this.openRange
+      ? { start: Math.min(this.openRange.start, time), end: Math.max(this.openRange.end, time) }
+      : { start: time, end: time };
+  }
+
+  /**
+   * Appends one event. Resolves once it is fsynced; the same event (same leaf
+   * hash) already stored is not appended again, and a different event reusing
+   * a stored eventID is refused with an error flagged `conflict`.
+   *
+   * @param {Object} event - Validated sensor event, without its gateway trace.
+   * @returns {Promise<{hash: string, duplicate: boolean}>} Leaf hash of the event.
+   */
+  append(event) {
+    const hash = leafHash(event);
+    const existing = this.byEventID.get(event.eventID);
+    if (existing === hash) {
+      this.stats.duplicates++;
+      return Promise.resolve({ hash, duplicate: true });
+    }
+    if (existing) {
+      this.stats.conflicts++;
+      const error = new Error(`The event ${event.eventID} is already stored with different content`);
+      error.conflict = true;
+      return Promise.reject(error);
+    }
+    // Claimed before the write so a concurrent retry of the same event is a duplicate
+    this.byEventID.set(event.eventID, hash);
+    this.stats.appends++;
+    const line = Buffer.from(`${JSON.stringify({ hash, event })}\n`, 'utf8');
+    return new Promise((resolve, reject) => {
+      this.buffered.push({ hash, event, line, resolve, reject });
+      if (!this.flushTimer) {
+        this.flushTimer = setTimeout(() => this._flush(), this.fsyncIntervalMs);
+      }
+    });
+  }
+
+  /**
+   * Writes and fsyncs everything buffered as one group; an event joins the
+   * open batch only once it is durable.
+   */
+  async _flush() {
+    this.flushTimer = null;
+    while (this.flushing) {
+      await this.flushing.catch(() => {});
+    }
+    const group = this.buffered;
+    this.buffered = [];
+    if (group.length === 0) {
+      return;
+    }
+
+    const current = (async () => {
+      if (this.segments[this.segments.length - 1].bytes >= this.segmentBytes) {
+        fs.closeSync(this.fd);
+        this._newSegment();
+        this.fd = fs.openSync(this.segments[this.segments.length - 1].file, 'a');
+      }
+      const segmentIndex = this.segments.length - 1;
+      const segment = this.segments[segmentIndex];
+      const data = Buffer.concat(group.map(({ line }) => line));
+      await writeAll(this.fd, data);
+      await fdatasync(this.fd);
+
+      let offset = segment.bytes;
+      for (const { hash, event, line } of group) {
+        this.byHash.set(hash, { segment: segmentIndex, offset, length: line.length - 1, batch: null, index: null });
+        this._addToOpen(hash, event);
+        offset += line.length;
+      }
+      segment.bytes = offset;
+      this.stats.flushes++;
+      this.stats.bytesWritten += data.length;
+    })();
+    this.flushing = current;
+
+    try {
+      await current;
+      group.forEach(({ hash, resolve }) => resolve({ hash, duplicate: false }));
+    } catch (error) {
+      group.forEach(({ event, reject }) => {
+        this.byEventID.delete(event.eventID);
+        reject(error);
+      });
+    } finally {
+      if (this.flushing === current) {
+        this.flushing = null;
+      }
+    }
+  }
+
+  /**
+   * Closes the open batch: computes its Merkle root and records the batch
+   * durably before it is anchored.
+   *
+   * @returns {Object|null} { root, count, startTime, endTime, sealedAt }, or null if no event is waiting.
+   */
+  sealBatch() {
+    if (this.openLeaves.length === 0) {
+      return null;
+    }
+    const leaves = this.openLeaves;
+    const levels = buildLevels(leaves);
+    const batch = {
+      root: levels[levels.length - 1][0],
+      count: leaves.length,
+      startTime: new Date(this.openRange.start).toISOString(),
+      endTime: new Date(this.openRange.end).toISOString(),
+      sealedAt: new Date().toISOString(),
+      leaves
+    };
+    fs.writeSync(this.batchesFd, `${JSON.stringify({ batch })}\n`);
+    fs.fdatasyncSync(this.batchesFd);
+    this.openLeaves = [];
+    this.openRange = null;
+    this._addBatch(batch);
+    return this.describe(batch.root);
+  }
+
+  /**
+   * Records the on-chain anchor record of a sealed batch.
+   */
+  markAnchored(root, anchor) {
+    fs.writeSync(this.batchesFd, `${JSON.stringify({ anchored: root, anchor })}\n`);
+    fs.fdatasyncSync(this.batchesFd);
+    this.batches.get(root).anchor = anchor;
+  }
+
+  /**
+   * A batch without its leaf hashes.
+   */
+  describe(root) {
+    const { leaves, ...batch } = this.batches.get(root);
+    return batch;
+  }
+
+  /**
+   * Sealed batches not yet anchored, oldest first.
+   */
+  unanchoredBatches() {
+    return [...this.batches.keys()].filter((root) => !this.batches.get(root).anchor).map((root) => this.describe(root));
+  }
+
+  readEvent(hash) {
+    const location = this.byHash.get(hash);
+    const buffer = Buffer.alloc(location.length);
+    fs.readSync(this.segments[location.segment].readFd, buffer, 0, location.length, location.offset);
+    return JSON.parse(buffer.toString('utf8')).event;
+  }
+
+  /**
+   * Events of a sealed batch in batch order, or null if the batch is not in this store.
+   */
+  eventsOfBatch(root) {
+    const batch = this.batches.get(root);
+    return batch ? batch.leaves.map((hash) => this.readEvent(hash)) : null;
+  }
+
+  /**
+   * Every event of the anchored batches.
+   */
+  anchoredEvents() {
+    const events = [];
+    for (const batch of this.batches.values()) {
+      if (batch.anchor) {
+        events.push(...batch.leaves.map((hash) => this.readEvent(hash)));
+      }
+    }
+    return events;
+  }
+
+  /**
+   * Inclusion proof of an event against the root of its batch.
+   *
+   * @returns {Object|null} null for an unknown event; { event, leaf, batch: null } while its
+   *   batch is open; otherwise { event, leaf, index, path, batch, anchor }.
+   */
+  proof(eventID) {
+    const hash = this.byEventID.get(eventID);
+    const location = hash && this.byHash.get(hash);
+    if (!location) {
+      return null;
+    }
+    const event = this.readEvent(hash);
+    if (location.batch === null) {
+      return { event, leaf: hash, batch: null };
+    }
+    const { leaves, anchor, ...batch } = this.batches.get(location.batch);
+    return {
+      event,
+      leaf: hash,
+      index: location.index,
+      path: merkleProof(buildLevels(leaves), location.index),
+      batch,
+      anchor
+    };
+  }
+
+  getStatus() {
+    let anchored = 0;
+    for (const batch of this.batches.values()) {
+      anchored += batch.anchor ? 1 : 0;
+    }
+    return {
+      events: this.byHash.size,
+      openBatchEvents: this.openLeaves.length,
+      batches: this.batches.size,
+      anchoredBatches: anchored,
+      segments: this.segments.length,
+      ...this.stats
+    };
+  }
+
+  async close() {
+    clearTimeout(this.flushTimer);
+    await this._flush();
+    for (const segment of this.segments) {
+      fs.closeSync(segment.readFd);
+    }
+    fs.closeSync(this.fd);
+    fs.closeSync(this.batchesFd);
+  }
+}
+
+module.exports = AnchorStore;
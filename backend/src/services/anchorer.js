@@ -0,0 +1,105 @@
+// Periodic anchoring of the anchor store's batches on the ledger.
+// Every windowMs the open batch is sealed and its Merkle root, event count
+// and time range are submitted as one AnchorBatch transaction, so the ledger
+// takes one write per window instead of one per event. Batches are anchored
+// one at a time in seal order. A failed submit is retried with capped
+// exponential backoff; sealed batches keep queueing meanwhile, and the ones
+// left unanchored by a restart are resubmitted (AnchorBatch is idempotent).
+
+const DEFAULT_WINDOW_MS = 60000;
+const DEFAULT_RETRY_BASE_MS = 500;
+const DEFAULT_RETRY_MAX_MS = 30000;
+
+class Anchorer {
+  /**
+   * @param {AnchorStore} store - Store whose batches are sealed and anchored.
+   * @param {Function} anchorBatch - async (batch) => on-chain anchor record.
+   * @param {Object} [options]
+   * @param {number} [options.windowMs] - How often the open batch is sealed.
+   */
+  constructor(store, anchorBatch, options = {}) {
+    this.store = store;
+    this.anchorBatch = anchorBatch;
+    this.windowMs = options.windowMs || DEFAULT_WINDOW_MS;
+    this.retryBaseMs = options.retryBaseMs || DEFAULT_RETRY_BASE_MS;
+    this.retryMaxMs = options.retryMaxMs || DEFAULT_RETRY_MAX_MS;
+
+    this.queue = [];        // sealed batches waiting to be anchored, oldest first
+    this.sending = false;
+    this.retrying = false;
+    this.windowTimer = null;
+    this.stats = {
+      sealedBatches: 0,
+      anchoredBatches: 0,
+      anchoredEvents: 0,
+      failedAttempts: 0,
+      lastAnchor: null,
+      lastError: null
+    };
+  }
+
+  /**
+   * Starts sealing windows, first resubmitting batches sealed but not anchored.
+   */
+  start() {
+    this.queue.push(...this.store.unanchoredBatches());
+    if (this.queue.length > 0) {
+      console.log(`Anchorer resuming with ${this.queue.length} unanchored batch(es).`);
+    }
+    this.windowTimer = setInterval(() => this.seal(), this.windowMs);
+    this.windowTimer.unref();
+    this._pump();
+  }
+
+  /**
+   * Seals the open batch now, if it has events.
+   */
+  seal() {
+    const batch = this.store.sealBatch();
+    if (batch) {
+      this.stats.sealedBatches++;
+      this.queue.push(batch);
+      this._pump();
+    }
+    return batch;
+  }
+
+  _pump() {
+    if (!this.sending && this.queue.length > 0) {
+      this.sending = true;
+      this._send(this.queue[0], 1);
+    }
+  }
+
+  async _send(batch, attempt) {
+    try {
+      const anchor = await this.anchorBatch(batch);
+      this.store.markAnchored(batch.root, anchor);
+      this.stats.anchoredBatches++;
+      this.stats.anchoredEvents += batch.count;
+      this.stats.lastAnchor = anchor;
+      this.queue.shift();
+      this.sending = false;
+      this.retrying = false;
+      this._pump();
+    } catch (error) {
+      this.stats.failedAttempts++;
+      this.stats.lastError = error.message;
+      this.retrying = true;
+      const delay = Math.min(this.retryMaxMs, this.retryBaseMs * 2 ** (attempt - 1));
+      console.warn(`Anchoring batch ${batch.root} of ${batch.count} event(s) failed (attempt ${attempt}): ${error.message}. Retrying in ${delay} ms.`);
+      setTimeout(() => this._send(batch, attempt + 1), delay);
+    }
+  }
+
+  getStatus() {
+    return {
+      windowMs: this.windowMs,
+      queuedBatches: this.queue.length,
+      retrying: this.retrying,
+      ...this.stats
+    };
+  }
+}
+
+module.exports = Anchorer;
@@ -0,0 +1,264 @@
+// Chunk files of the time-series archive (see archiveWriter.js). A chunk holds
+// the events of one partition (device type and UTC day) written by one flush,
+// column by column, with the rows of each device stored together as one
+// series sorted by time, so every encoding sees one device's regular
+// readings in a row:
+//
+//   'SCA1' | header length (u32 LE) | header (JSON) | column blobs
+//
+// The header lists the series and every column's encoding and byte range, so
+// a query reads only the columns it needs and only the rows of the devices
+// and times it asks for, and keeps zone maps that let aggregates be answered
+// from the header alone:
+//
+//   { version, seq, rows, minTime, maxTime, firstBlock, lastBlock, rawBytes,
+//     replaces: [seq...],
+//     series: [{ deviceID, start, rows, minTime, maxTime }],
+//     columns: [{ name, encoding, offset, length,
+//                 stats: { count, sum, min, max } (numeric columns) }] }
+//
+// Columns: time (delta-of-delta, epoch ms), eventID, eventType, location and
+// one metadata.<field> column per metadata field: float when every value is
+// a number, otherwise dict or, for mostly distinct strings, prefix. The
+// device type is the partition's and the deviceID the series', neither is
+// stored per row.
+
+const fs = require('fs');
+const codecs = require('./columnCodecs');
+
+const MAGIC = Buffer.from('SCA1');
+const CHUNK_VERSION = 1;
+const PREAMBLE_BYTES = 8;
+const METADATA_PREFIX = 'metadata.';
+// String columns with more distinct values than rows / DICT_MAX_RATIO are prefix coded
+const DICT_MAX_RATIO = 4;
+
+const ENCODERS = {
+  dod: codecs.encodeTimestamps,
+  float: codecs.encodeFloats,
+  dict: codecs.encodeDictionary,
+  prefix: codecs.encodePrefixed
+};
+
+const DECODERS = {
+  dod: codecs.decodeTimestamps,
+  float: codecs.decodeFloats,
+  dict: codecs.decodeDictionary,
+  prefix: codecs.decodePrefixed
+};
+
+const numericStats = (values) => {
+  let count = 0;
+  let sum = 0;
+  let min = Infinity;
+  let max = -Infinity;
+  for (let i = 0; i < values.length; i++) {
+    const value = values[i];
+    if (value === value) { // not NaN
+      count++;
+      sum += value;
+      if (value < min) min = value;
+      if (value > max) max = value;
+    }
+  }
+  return count === 0 ? { count } : { count, sum, min, max };
+};
+
+const stringColumn = (name, values) => {
+  const distinct = new Set(values);
+  distinct.delete(null);
+  return [name, distinct.size * DICT_MAX_RATIO > values.length ? 'prefix' : 'dict', values];
+};
+
+/**
+ * Encodes rows ({ time, eventID, deviceID, eventType, location, metadata })
+ * into a chunk file image. Rows are sorted by device and time in place.
+ *
+ * @param {Array<Object>} rows
+ * @param {Object} info - seq, firstBlock, lastBlock, rawBytes and replaces of the header.
+ * @returns {Buffer}
+ */
+function encodeChunk(rows, info) {
+  rows.sort((a, b) => (a.deviceID < b.deviceID ? -1 : a.deviceID > b.deviceID ? 1 : a.time - b.time));
+
+  const series = [];
+  let minTime = Infinity;
+  let maxTime = -Infinity;
+  for (let i = 0; i < rows.length; i++) {
+    const { deviceID, time } = rows[i];
+    let current = series[series.length - 1];
+    if (!current || current.deviceID !== deviceID) {
+      current = { deviceID, start: i, rows: 0, minTime: time, maxTime: time };
+      series.push(current);
+    }
+    current.rows++;
+    current.maxTime = time;
+    minTime = Math.min(minTime, time);
+    maxTime = Math.max(maxTime, time);
+  }
+
+  const columns = [
+    ['time', 'dod', rows.map((row) => row.time)],
+    stringColumn('eventID', rows.map((row) => row.eventID)),
+    stringColumn('eventType', rows.map((row) => row.eventType)),
+    stringColumn('location', rows.map((row) => row.location))
+  ];
+  const fields = new Set();
+  for (const row of rows) {
+    for (const field of Object.keys(row.metadata)) {
+      fields.add(field);
+    }
+  }
+  for (const field of [...fields].sort()) {
+    const values = rows.map((row) => row.metadata[field]);
+    const numeric = values.every((value) => value === undefined || value === null || typeof value === 'number');
+    columns.push(numeric
+      ? [METADATA_PREFIX + field, 'float', Float64Array.from(values, (value) => (typeof value === 'number' ? value : NaN))]
+      : stringColumn(METADATA_PREFIX + field, values.map((value) => (value === undefined || value === null ? null : String(value)))));
+  }
+
+  const blobs = [];
+  const described = [];
+  let offset = 0;
+  for (const [name, encoding, values] of columns) {
+    const blob = ENCODERS[encoding](values);
+    const column = { name, encoding, offset, length: blob.length };
+    if (encoding === 'float') {
+      column.stats = numericStats(values);
+    }
+    described.push(column);
+    blobs.push(blob);
+    offset += blob.length;
+  }
+
+  const header = Buffer.from(JSON.stringify({
+    version: CHUNK_VERSION,
+    seq: info.seq,
+    rows: rows.length,
+    minTime: rows.length > 0 ? minTime : null,
+    maxTime: rows.length > 0 ? maxTime : null,
+    firstBlock: info.firstBlock,
+    lastBlock: info.lastBlock,
+    rawBytes: info.rawBytes,
+    replaces: info.replaces || [],
+    series,
+    columns: described
+  }));
+  const preamble = Buffer.alloc(PREAMBLE_BYTES);
+  MAGIC.copy(preamble, 0);
+  preamble.writeUInt32LE(header.length, 4);
+  return Buffer.concat([preamble, header, ...blobs]);
+}
+
+const readExactly = (fd, length, position) => {
+  const buffer = Buffer.allocUnsafe(length);
+  let read = 0;
+  while (read < length) {
+    const bytes = fs.readSync(fd, buffer, read, length - read, position + read);
+    if (bytes === 0) {
+      throw new Error(`unexpected end of file at byte ${position + read}`);
+    }
+    read += bytes;
+  }
+  return buffer;
+};
+
+/**
+ * Reads a chunk's header. Returns it with dataOffset (start of the column
+ * blobs), bytes (file size) and columns also indexed by name (byName).
+ */
+function readChunkHeader(file) {
+  const fd = fs.openSync(file, 'r');
+  try {
+    const bytes = fs.fstatSync(fd).size;
+    const preamble = readExactly(fd, PREAMBLE_BYTES, 0);
+    if (!preamble.subarray(0, 4).equals(MAGIC)) {
+      throw new Error(`${file} is not an archive chunk`);
+    }
+    const headerLength = preamble.readUInt32LE(4);
+    const header = JSON.parse(readExactly(fd, headerLength, PREAMBLE_BYTES).toString('utf8'));
+    if (header.version !== CHUNK_VERSION) {
+      throw new Error(`${file} has unknown chunk version ${header.version}`);
+    }
+    header.dataOffset = PREAMBLE_BYTES + headerLength;
+    header.bytes = bytes;
+    header.byName = new Map(header.columns.map((column) => [column.name, column]));
+    return header;
+  } finally {
+    fs.closeSync(fd);
+  }
+}
+
+/**
+ * Reads and decodes the named columns of a chunk (only their byte ranges).
+ * Columns the chunk lacks are left out of the result.
+ *
+ * @returns {Object} name -> Float64Array (dod, float), {dictionary, codes} (dict) or Array<string|null> (prefix).
+ */
+function readChunkColumns(file, header, names) {
+  const decoded = {};
+  const fd = fs.openSync(file, 'r');
+  try {
+    for (const name of names) {
+      const column = header.byName.get(name);
+      if (column) {
+        const blob = readExactly(fd, column.length, header.dataOffset + column.offset);
+        decoded[name] = DECODERS[column.encoding](blob, header.rows);
+      }
+    }
+  } finally {
+    fs.closeSync(fd);
+  }
+  return decoded;
+}
+
+/**
+ * Value of row i of a decoded column, null when missing.
+ */
+const valueAt = (column, i) => {
+  if (column.codes) {
+    return column.dictionary[column.codes[i]];
+  }
+  const value = column[i];
+  return value === undefined || value !== value ? null : value; // NaN is a missing float
+};
+
+/**
+ * Decodes a whole chunk back into rows, for compaction.
+ */
+function readChunkRows(file, header) {
+  const names = header.columns.map((column) => column.name);
+  const columns = readChunkColumns(file, header, names);
+  const fields = names.filter((name) => name.startsWith(METADATA_PREFIX));
+
+  const rows = [];
+  for (const { deviceID, start, rows: count } of header.series) {
+    for (let i = start; i < start + count; i++) {
+      const metadata = {};
+      for (const name of fields) {
+        const value = valueAt(columns[name], i);
+        if (value !== null) {
+          metadata[name.slice(METADATA_PREFIX.length)] = value;
+        }
+      }
+      rows.push({
+        time: columns.time[i],
+        eventID: valueAt(columns.eventID, i),
+        deviceID,
+        eventType: valueAt(columns.eventType, i),
+        location: valueAt(columns.location, i),
+        metadata
+      });
+    }
+  }
+  return rows;
+}
+
+module.exports = {
+  METADATA_PREFIX,
+  valueAt,
+  encodeChunk,
+  readChunkHeader,
+  readChunkColumns,
+  readChunkRows
+};
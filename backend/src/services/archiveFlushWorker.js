@@ -0,0 +1,126 @@
+// Worker thread used by archiveWriter.js: encodes and durably writes the
+// chunks of a flush, records the checkpoint, then compacts one past day, so
+// the backend's event loop never waits on chunk encoding or fsync.
+//
+// Each message is one flush; the reply carries the next chunk number, or
+// the error that failed the flush (chunks it wrote are removed again).
+
+const fs = require('fs');
+const path = require('path');
+const { parentPort } = require('worker_threads');
+const { encodeChunk, readChunkHeader, readChunkRows } = require('./archiveChunks');
+const { listPartitions, listChunks, chunkName, MANIFEST_FILE, MANIFEST_VERSION } = require('./archiveWriter');
+
+const writeFileDurably = (file, data) => {
+  const tmpPath = `${file}.tmp`;
+  const fd = fs.openSync(tmpPath, 'w');
+  try {
+    fs.writeSync(fd, data);
+    fs.fsyncSync(fd);
+  } finally {
+    fs.closeSync(fd);
+  }
+  fs.renameSync(tmpPath, file);
+};
+
+const writeManifest = (dir, checkpoint, nextSeq) => {
+  writeFileDurably(path.join(dir, MANIFEST_FILE), JSON.stringify({
+    version: MANIFEST_VERSION,
+    checkpoint,
+    nextSeq,
+    updatedAt: new Date().toISOString()
+  }));
+};
+
+/**
+ * Writes each partition's rows as a chunk, then the manifest.
+ *
+ * @returns {number} The next chunk number.
+ */
+function writeChunks({ dir, partitions, seq, firstBlock, lastBlock }) {
+  const written = [];
+  try {
+    for (const partition of partitions) {
+      const partitionDir = path.join(dir, partition.deviceType, partition.day);
+      fs.mkdirSync(partitionDir, { recursive: true });
+      const image = encodeChunk(partition.rows, { seq, firstBlock, lastBlock, rawBytes: partition.rawBytes });
+      const file = path.join(partitionDir, chunkName(seq));
+      writeFileDurably(file, image);
+      written.push(file);
+      seq++;
+    }
+    writeManifest(dir, lastBlock, seq);
+  } catch (error) {
+    // Chunks written so far are numbered past the manifest and would be
+    // discarded on open anyway
+    written.forEach((file) => fs.rmSync(file, { force: true }));
+    throw error;
+  }
+  return seq;
+}
+
+/**
+ * Merges the chunks of the oldest past day that has several into one.
+ *
+ * @returns {number} The next chunk number.
+ */
+function compactOne({ dir, seq, checkpoint, today }) {
+  const partition = listPartitions(dir)
+    .filter(({ day }) => day < today)
+    .sort((a, b) => (a.day < b.day ? -1 : a.day > b.day ? 1 : 0))
+    .find(({ dir: partitionDir }) => listChunks(partitionDir).length > 1);
+  if (!partition) {
+    return seq;
+  }
+
+  const chunks = listChunks(partition.dir);
+  const rows = [];
+  let rawBytes = 0;
+  let firstBlock = Infinity;
+  let lastBlock = -Infinity;
+  for (const chunk of chunks) {
+    const header = readChunkHeader(chunk.file);
+    for (const row of readChunkRows(chunk.file, header)) {
+      rows.push(row);
+    }
+    rawBytes += header.rawBytes;
+    firstBlock = Math.min(firstBlock, header.firstBlock);
+    lastBlock = Math.max(lastBlock, header.lastBlock);
+  }
+  const image = encodeChunk(rows, {
+    seq,
+    firstBlock,
+    lastBlock,
+    rawBytes,
+    replaces: chunks.map((chunk) => chunk.seq)
+  });
+  const file = path.join(partition.dir, chunkName(seq));
+  writeFileDurably(file, image);
+  try {
+    writeManifest(dir, checkpoint, seq + 1);
+  } catch (error) {
+    fs.rmSync(file, { force: true });
+    throw error;
+  }
+  for (const chunk of chunks) {
+    fs.unlinkSync(chunk.file);
+  }
+  return seq + 1;
+}
+
+parentPort.on('message', ({ id, dir, partitions, seq, firstBlock, lastBlock, today }) => {
+  try {
+    seq = writeChunks({ dir, partitions, seq, firstBlock, lastBlock });
+  } catch (error) {
+    parentPort.postMessage({ id, error: error.message });
+    return;
+  }
+  const reply = { id, nextSeq: seq, chunksWritten: partitions.length, compacted: false };
+  try {
+    reply.nextSeq = compactOne({ dir, seq, checkpoint: lastBlock, today });
+    reply.compacted = reply.nextSeq !== seq;
+  } catch (error) {
+    reply.compactionError = error.message;
+  }
+  parentPort.postMessage(reply);
+});
@@ -0,0 +1,358 @@
+// Range and aggregate queries over the columnar archive (see archiveWriter.js).
+//
+// A query lists the partitions of the requested device types whose day
+// overlaps the time window, and keeps from each chunk header the device
+// series that overlap the window (none: the chunk is skipped). From the
+// remaining chunks it reads only the byte ranges of the columns it needs,
+// decodes them into typed arrays and scans them in plain loops; a series is
+// sorted by time, so its part in the window is two binary searches.
+// Aggregates over a chunk that lies wholly in the window and in one bucket
+// are answered from the header's zone maps without reading the chunk when no
+// device is selected.
+//
+// Chunk headers are immutable and cached. Events are queryable once flushed,
+// i.e. up to flushIntervalMs after their block.
+
+const ArchiveWriter = require('./archiveWriter');
+const { METADATA_PREFIX, valueAt, readChunkHeader, readChunkColumns } = require('./archiveChunks');
+
+const HOUR_MS = 3600000;
+const DAY_MS = 86400000;
+const INTERVALS = { hour: HOUR_MS, day: DAY_MS };
+const DEFAULT_RANGE_LIMIT = 1000;
+const MAX_HEADER_CACHE = 10000;
+
+/**
+ * First position in values[low, high), sorted, whose value is >= target
+ * (upper: > target); high when there is none.
+ */
+const bound = (values, target, upper, low, high) => {
+  while (low < high) {
+    const mid = (low + high) >>> 1;
+    if (values[mid] < target || (upper && values[mid] === target)) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+};
+
+const parseTime = (value, fallback) => {
+  if (value === undefined || value === null || value === '') {
+    return fallback;
+  }
+  const time = Date.parse(value);
+  if (Number.isNaN(time)) {
+    throw new Error(`Invalid timestamp "${value}"`);
+  }
+  return time;
+};
+
+class ArchiveReader {
+  /**
+   * @param {Object} options
+   * @param {string} options.dir - Archive root directory.
+   */
+  constructor(options) {
+    this.dir = options.dir;
+    this.headers = new Map(); // chunk file -> header
+    this.stats = { queries: 0, chunksRead: 0, chunksSkipped: 0, chunksFromHeader: 0 };
+  }
+
+  /**
+   * Events matching all given criteria, oldest first.
+   *
+   * @param {Object} query
+   * @param {string} [query.deviceType] - All device types when omitted.
+   * @param {string} [query.deviceID]
+   * @param {string} [query.startTime] - ISO timestamp, inclusive.
+   * @param {string} [query.endTime] - ISO timestamp, inclusive.
+   * @param {number} [query.limit] - At most this many events (the oldest).
+   * @returns {{events: Array<Object>, scan: Object}}
+   */
+  range({ deviceType, deviceID, startTime, endTime, limit = DEFAULT_RANGE_LIMIT } = {}) {
+    const start = parseTime(startTime, -Infinity);
+    const end = parseTime(endTime, Infinity);
+    const scan = this._newScan();
+    const events = [];
+
+    // Partitions in day order, so the limit can stop the scan early
+    const byDay = new Map();
+    for (const partition of this._partitions(deviceType, start, end)) {
+      if (!byDay.has(partition.day)) {
+        byDay.set(partition.day, []);
+      }
+      byDay.get(partition.day).push(partition);
+    }
+    for (const day of [...byDay.keys()].sort()) {
+      const dayEvents = [];
+      for (const partition of byDay.get(day)) {
+        for (const chunk of this._chunks(partition, start, end, deviceID, scan)) {
+          this._collect(partition, chunk, start, end, dayEvents, scan);
+        }
+      }
+      dayEvents.sort((a, b) => a.time - b.time);
+      for (const row of dayEvents) {
+        if (events.length >= limit) {
+          break;
+        }
+        events.push(this._record(row));
+      }
+      if (events.length >= limit) {
+        break;
+      }
+    }
+    return { events, scan: this._endScan(scan) };
+  }
+
+  /**
+   * count, sum, min, max and avg of a numeric metadata field, overall or per
+   * hour or day bucket (UTC).
+   *
+   * @param {Object} query
+   * @param {string} query.field - Metadata field, e.g. co2Level or pagesPrinted.
+   * @param {string} [query.deviceType] - All device types when omitted.
+   * @param {string} [query.deviceID]
+   * @param {string} [query.startTime] - ISO timestamp, inclusive.
+   * @param {string} [query.endTime] - ISO timestamp, inclusive.
+   * @param {string} [query.interval] - 'hour' or 'day'; one total when omitted.
+   * @returns {{aggregates: Array<Object>, scan: Object}}
+   */
+  aggregate({ field, deviceType, deviceID, startTime, endTime, interval } = {}) {
+    if (!field) {
+      throw new Error('An aggregated field is required');
+    }
+    if (interval !== undefined && !INTERVALS[interval]) {
+      throw new Error(`Unknown interval "${interval}" (hour or day)`);
+    }
+    const start = parseTime(startTime, -Infinity);
+    const end = parseTime(endTime, Infinity);
+    const bucketMs = interval ? INTERVALS[interval] : Infinity;
+    const bucketOf = (time) => (bucketMs === Infinity ? 0 : Math.floor(time / bucketMs) * bucketMs);
+    const column = METADATA_PREFIX + field;
+    const scan = this._newScan();
+    const buckets = new Map(); // bucket start -> { count, sum, min, max }
+
+    const merge = (bucket, count, sum, min, max) => {
+      if (count === 0) {
+        return;
+      }
+      const totals = buckets.get(bucket);
+      if (!totals) {
+        buckets.set(bucket, { count, sum, min, max });
+      } else {
+        totals.count += count;
+        totals.sum += sum;
+        totals.min = Math.min(totals.min, min);
+        totals.max = Math.max(totals.max, max);
+      }
+    };
+
+    for (const partition of this._partitions(deviceType, start, end)) {
+      for (const chunk of this._chunks(partition, start, end, deviceID, scan)) {
+        const description = chunk.header.byName.get(column);
+        if (!description || description.encoding !== 'float') {
+          continue;
+        }
+        const { header } = chunk;
+        if (!deviceID && header.minTime >= start && header.maxTime <= end
+          && bucketOf(header.minTime) === bucketOf(header.maxTime)) {
+          const { count, sum, min, max } = description.stats;
+          merge(bucketOf(header.minTime), count, sum, min, max);
+          scan.chunksFromHeader++;
+          continue;
+        }
+
+        const names = ['time', column];
+        const columns = readChunkColumns(chunk.file, header, names);
+        scan.chunksRead++;
+        scan.bytesRead += names.reduce((bytes, name) => bytes + header.byName.get(name).length, 0);
+        const times = columns.time;
+        const values = columns[column];
+
+        for (const series of chunk.series) {
+          const from = bound(times, start, false, series.start, series.start + series.rows);
+          const to = bound(times, end, true, from, series.start + series.rows);
+          scan.rowsScanned += to - from;
+          // The series is sorted by time: each bucket is a run of it
+          let i = from;
+          while (i < to) {
+            const bucket = bucketOf(times[i]);
+            const bucketEnd = bucketMs === Infinity ? to : bound(times, bucket + bucketMs, false, i, to);
+            let count = 0;
+            let sum = 0;
+            let min = Infinity;
+            let max = -Infinity;
+            for (; i < bucketEnd; i++) {
+              const value = values[i];
+              if (value === value) { // not NaN
+                count++;
+                sum += value;
+                if (value < min) min = value;
+                if (value > max) max = value;
+              }
+            }
+            merge(bucket, count, sum, min, max);
+          }
+        }
+      }
+    }
+
+    const aggregates = [...buckets.keys()].sort((a, b) => a - b).map((bucket) => {
+      const { count, sum, min, max } = buckets.get(bucket);
+      return {
+        ...(bucketMs !== Infinity && { bucket: new Date(bucket).toISOString() }),
+        count,
+        sum,
+        min,
+        max,
+        avg: sum / count
+      };
+    });
+    return { aggregates, scan: this._endScan(scan) };
+  }
+
+  /**
+   * Size of the archive: events, chunks, bytes on disk and the size of the
+   * same events as ledger JSON.
+   */
+  getStatus() {
+    const status = { dir: this.dir, partitions: 0, chunks: 0, rows: 0, rawBytes: 0, encodedBytes: 0, firstDay: null, lastDay: null };
+    const live = new Set();
+    for (const partition of ArchiveWriter.listPartitions(this.dir)) {
+      status.partitions++;
+      status.firstDay = status.firstDay === null || partition.day < status.firstDay ? partition.day : status.firstDay;
+      status.lastDay = status.lastDay === null || partition.day > status.lastDay ? partition.day : status.lastDay;
+      for (const { file } of ArchiveWriter.listChunks(partition.dir)) {
+        const header = this._header(file);
+        if (!header) {
+          continue;
+        }
+        live.add(file);
+        status.chunks++;
+        status.rows += header.rows;
+        status.rawBytes += header.rawBytes;
+        status.encodedBytes += header.bytes;
+      }
+    }
+    // Forget chunks compacted away
+    for (const file of this.headers.keys()) {
+      if (!live.has(file)) {
+        this.headers.delete(file);
+      }
+    }
+    status.compressionRatio = status.encodedBytes > 0 ? Number((status.rawBytes / status.encodedBytes).toFixed(1)) : null;
+    return { ...status, ...this.stats };
+  }
+
+  _newScan() {
+    this.stats.queries++;
+    return { startedAt: process.hrtime.bigint(), partitions: 0, chunksRead: 0, chunksSkipped: 0, chunksFromHeader: 0, rowsScanned: 0, bytesRead: 0 };
+  }
+
+  _endScan(scan) {
+    const { startedAt, ...counters } = scan;
+    this.stats.chunksRead += scan.chunksRead;
+    this.stats.chunksSkipped += scan.chunksSkipped;
+    this.stats.chunksFromHeader += scan.chunksFromHeader;
+    return { ...counters, ms: Number(process.hrtime.bigint() - startedAt) / 1e6 };
+  }
+
+  /**
+   * Partitions of the device type (all when omitted) whose day overlaps [start, end].
+   */
+  _partitions(deviceType, start, end) {
+    const firstDay = start === -Infinity ? '' : new Date(start).toISOString().slice(0, 10);
+    const lastDay = end === Infinity ? '9999-12-31' : new Date(end).toISOString().slice(0, 10);
+    return ArchiveWriter.listPartitions(this.dir).filter((partition) =>
+      (!deviceType || partition.deviceType === deviceType) && partition.day >= firstDay && partition.day <= lastDay);
+  }
+
+  /**
+   * Chunks of a partition that may hold rows of the window and device, with
+   * the series that do.
+   */
+  _chunks(partition, start, end, deviceID, scan) {
+    scan.partitions++;
+    const chunks = [];
+    for (const { file } of ArchiveWriter.listChunks(partition.dir)) {
+      const header = this._header(file);
+      if (!header || header.rows === 0) {
+        continue;
+      }
+      const series = header.maxTime < start || header.minTime > end ? [] : header.series.filter((candidate) =>
+        (!deviceID || candidate.deviceID === deviceID) && candidate.maxTime >= start && candidate.minTime <= end);
+      if (series.length === 0) {
+        scan.chunksSkipped++;
+        continue;
+      }
+      chunks.push({ file, header, series });
+    }
+    return chunks;
+  }
+
+  _header(file) {
+    let header = this.headers.get(file);
+    if (!header) {
+      try {
+        header = readChunkHeader(file);
+      } catch (error) {
+        // Compacted away since the directory was listed
+        if (error.code === 'ENOENT') {
+          return null;
+        }
+        throw error;
+      }
+      if (this.headers.size >= MAX_HEADER_CACHE) {
+        this.headers.delete(this.headers.keys().next().value);
+      }
+      this.headers.set(file, header);
+    }
+    return header;
+  }
+
+  /**
+   * Appends the rows of the chunk's selected series in [start, end] to out as
+   * { time, i, series, columns, deviceType }, made into records by _record.
+   */
+  _collect(partition, chunk, start, end, out, scan) {
+    const { header, file } = chunk;
+    const columns = readChunkColumns(file, header, header.columns.map((column) => column.name));
+    scan.chunksRead++;
+    scan.bytesRead += header.bytes - header.dataOffset;
+    const times = columns.time;
+
+    for (const series of chunk.series) {
+      const from = bound(times, start, false, series.start, series.start + series.rows);
+      const to = bound(times, end, true, from, series.start + series.rows);
+      scan.rowsScanned += to - from;
+      for (let i = from; i < to; i++) {
+        out.push({ time: times[i], i, series, columns, deviceType: partition.deviceType });
+      }
+    }
+  }
+
+  _record({ time, i, series, columns, deviceType }) {
+    const metadata = {};
+    for (const name of Object.keys(columns)) {
+      if (name.startsWith(METADATA_PREFIX)) {
+        const value = valueAt(columns[name], i);
+        if (value !== null) {
+          metadata[name.slice(METADATA_PREFIX.length)] = value;
+        }
+      }
+    }
+    return {
+      eventID: valueAt(columns.eventID, i),
+      deviceType,
+      deviceID: series.deviceID,
+      timestamp: new Date(time).toISOString(),
+      eventType: valueAt(columns.eventType, i),
+      location: valueAt(columns.location, i),
+      metadata
+    };
+  }
+}
+
+module.exports = ArchiveReader;
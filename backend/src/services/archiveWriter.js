@@ -0,0 +1,431 @@
+// Compressed columnar archive of committed sensor events, for range and
+// aggregate queries over months of history (see archiveReader.js) that the
+// ledger and the in-memory event store are not built for.
+//
+// The writer follows committed blocks like the event store and buffers the
+// written events per partition, one directory per device type and UTC day:
+//
+//   <dir>/<deviceType>/<YYYY-MM-DD>/chunk-<seq>.col
+//
+// Every flushIntervalMs (or once maxBufferedRows are buffered) each partition
+// with buffered events is written as an immutable chunk file (format and
+// encodings in archiveChunks.js and columnCodecs.js), then archive.json
+// records the last block archived and the next chunk number. On open, chunks
+// numbered past archive.json are from a flush that did not complete and are
+// deleted, and blocks are replayed from the one after the checkpoint, so
+// every event is archived once.
+//
+// Past days are compacted into a single chunk, one partition per flush: the
+// merged chunk lists the chunks it replaces, which are then deleted (again on
+// open, after a crash in between).
+//
+// Flushes and compactions run on a worker thread (archiveFlushWorker.js):
+// the buffered events are handed over and the buffer starts afresh, so blocks
+// keep being applied while chunks are encoded and synced. A failed flush
+// puts its events back in front of those buffered meanwhile.
+//
+// The archive is a history of committed writes: deletions are not applied,
+// and metadata is stored as typed fields, like the chaincode stores it
+// (firmware strings such as "energyConsumption:5W" are split and numbers kept
+// without their unit). Timestamps are stored as epoch milliseconds and read
+// back as ISO 8601 UTC.
+
+const fs = require('fs');
+const path = require('path');
+const { Worker } = require('worker_threads');
+const { readChunkHeader } = require('./archiveChunks');
+
+const DEFAULT_FLUSH_INTERVAL_MS = 60000;
+const DEFAULT_MAX_BUFFERED_ROWS = 100000;
+const RETRY_MS = 5000;
+const MANIFEST_VERSION = 1;
+const MANIFEST_FILE = 'archive.json';
+const CHUNK_PATTERN = /^chunk-(\d+)\.col$/;
+const DAY_PATTERN = /^\d{4}-\d{2}-\d{2}$/;
+const NUMBER_WITH_UNIT = /^(-?\d+(?:\.\d+)?(?:e[+-]?\d+)?)\s*[A-Za-z%°]*$/i;
+
+const chunkName = (seq) => `chunk-${String(seq).padStart(10, '0')}.col`;
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+/**
+ * Typed metadata fields of a record: the chaincode's object as is, the
+ * firmware "key:value; key:value" string split, numeric values as numbers.
+ */
+const typedMetadata = (metadata) => {
+  if (metadata && typeof metadata === 'object') {
+    return metadata;
+  }
+  const typed = {};
+  for (const pair of String(metadata ?? '').split(';')) {
+    const separator = pair.indexOf(':');
+    if (separator === -1) {
+      continue;
+    }
+    const value = pair.slice(separator + 1).trim();
+    const number = NUMBER_WITH_UNIT.exec(value);
+    typed[pair.slice(0, separator).trim()] = number ? Number(number[1]) : value;
+  }
+  return typed;
+};
+
+/**
+ * Lists the chunks of a partition directory, oldest first.
+ */
+const listChunks = (partitionDir) => {
+  let files;
+  try {
+    files = fs.readdirSync(partitionDir);
+  } catch (error) {
+    if (error.code === 'ENOENT') {
+      return [];
+    }
+    throw error;
+  }
+  return files
+    .map((file) => CHUNK_PATTERN.exec(file))
+    .filter(Boolean)
+    .map((match) => ({ seq: Number(match[1]), file: path.join(partitionDir, match[0]) }))
+    .sort((a, b) => a.seq - b.seq);
+};
+
+/**
+ * Lists the partitions of an archive as { deviceType, day, dir }, by device
+ * type then day.
+ */
+const listPartitions = (dir) => {
+  const partitions = [];
+  const entries = (parent) => {
+    try {
+      return fs.readdirSync(parent, { withFileTypes: true }).filter((entry) => entry.isDirectory()).map((entry) => entry.name).sort();
+    } catch (error) {
+      if (error.code === 'ENOENT') {
+        return [];
+      }
+      throw error;
+    }
+  };
+  for (const deviceType of entries(dir)) {
+    for (const day of entries(path.join(dir, deviceType))) {
+      if (DAY_PATTERN.test(day)) {
+        partitions.push({ deviceType, day, dir: path.join(dir, deviceType, day) });
+      }
+    }
+  }
+  return partitions;
+};
+
+class ArchiveWriter {
+  /**
+   * @param {Object} options
+   * @param {string} options.dir - Archive root directory.
+   * @param {number} [options.flushIntervalMs] - How often buffered events are written out.
+   * @param {number} [options.maxBufferedRows] - Flush early once this many events are buffered.
+   * @param {boolean} [options.fromCheckpoint] - Resume from the archived block on start (false
+   *   for a ledger whose block numbers restart, like the mock ledger).
+   * @param {AnchorStore} [options.anchors] - Off-chain events of anchored batches (INGEST_MODE=anchor).
+   */
+  constructor(options) {
+    this.dir = options.dir;
+    this.flushIntervalMs = options.flushIntervalMs || DEFAULT_FLUSH_INTERVAL_MS;
+    this.maxBufferedRows = options.maxBufferedRows || DEFAULT_MAX_BUFFERED_ROWS;
+    this.fromCheckpoint = options.fromCheckpoint !== false;
+    this.anchors = options.anchors || null;
+
+    this.checkpoint = null;       // last block archived
+    this.nextSeq = 0;             // number of the next chunk file
+    this.partitions = new Map();  // "<deviceType>/<day>" -> { deviceType, day, rows, rawBytes }
+    this.bufferedRows = 0;
+    this.firstBlock = null;       // first and last block of the buffered events
+    this.lastBlock = null;
+    this.flushTimer = null;
+    this.flushing = null;         // the flush in progress
+    this.worker = null;
+    this.jobs = new Map();        // flush id -> { resolve, reject }
+    this.nextJobID = 0;
+    this.stopListening = null;
+    this.stats = {
+      blocks: 0,
+      archived: 0,
+      skipped: 0,
+      flushes: 0,
+      chunksWritten: 0,
+      compactions: 0,
+      lastFlushAt: null,
+      lastFlushMs: null
+    };
+  }
+
+  /**
+   * Opens the archive, discarding what an interrupted flush or compaction left behind.
+   */
+  open() {
+    fs.mkdirSync(this.dir, { recursive: true });
+    const manifestPath = path.join(this.dir, MANIFEST_FILE);
+    if (fs.existsSync(manifestPath)) {
+      const manifest = JSON.parse(fs.readFileSync(manifestPath, 'utf8'));
+      if (manifest.version !== MANIFEST_VERSION) {
+        throw new Error(`${manifestPath} has unknown version ${manifest.version}`);
+      }
+      this.checkpoint = manifest.checkpoint;
+      this.nextSeq = manifest.nextSeq;
+    }
+
+    for (const partition of listPartitions(this.dir)) {
+      fs.readdirSync(partition.dir)
+        .filter((file) => file.endsWith('.tmp'))
+        .forEach((file) => fs.unlinkSync(path.join(partition.dir, file)));
+      const chunks = listChunks(partition.dir);
+      const replaced = new Set();
+      for (const chunk of chunks) {
+        if (chunk.seq >= this.nextSeq) {
+          console.warn(`Archive: removing ${chunk.file}, written by an interrupted flush`);
+          fs.unlinkSync(chunk.file);
+          chunk.removed = true;
+        } else {
+          readChunkHeader(chunk.file).replaces.forEach((seq) => replaced.add(seq));
+        }
+      }
+      for (const chunk of chunks) {
+        if (!chunk.removed && replaced.has(chunk.seq)) {
+          fs.unlinkSync(chunk.file);
+        }
+      }
+    }
+    return this;
+  }
+
+  /**
+   * Follows committed blocks from the checkpoint, retrying until the ledger
+   * can be reached, and starts the flush timer.
+   *
+   * @param {FabricClient} fabricClient
+   */
+  async start(fabricClient) {
+    const resumeFrom = this.fromCheckpoint ? this.checkpoint : null;
+    for (;;) {
+      try {
+        this.stopListening = await fabricClient.listenSensorEventChanges(
+          (blockNumber, changes) => this.applyBlock(blockNumber, changes),
+          { startBlock: resumeFrom === null ? 0 : resumeFrom + 1 });
+        break;
+      } catch (error) {
+        console.error(`Archive could not listen to the ledger (${error.message}); retrying in ${RETRY_MS / 1000}s.`);
+        await sleep(RETRY_MS);
+      }
+    }
+    this.flushTimer = setInterval(() => this.flush(), this.flushIntervalMs);
+    this.flushTimer.unref();
+    console.log(`Archive following blocks${resumeFrom !== null ? ` after block ${resumeFrom}` : ''} into ${this.dir}.`);
+  }
+
+  /**
+   * Buffers the events written by one committed block.
+   *
+   * @param {number} blockNumber
+   * @param {Array<{deleted: string[], written: Array<Object>}|{anchored: Object}>} changes
+   */
+  applyBlock(blockNumber, changes) {
+    // Replayed by the peer after a restart: already archived
+    if (this.fromCheckpoint && this.checkpoint !== null && blockNumber <= this.checkpoint) {
+      return;
+    }
+    for (const change of changes) {
+      let { written = [] } = change;
+      if (change.anchored) {
+        // Batches anchored by another backend are unknown here and skipped
+        written = (this.anchors && this.anchors.eventsOfBatch(change.anchored.root)) || [];
+      }
+      for (const record of written) {
+        this._buffer(record);
+      }
+    }
+    if (this.firstBlock === null) {
+      this.firstBlock = blockNumber;
+    }
+    this.lastBlock = blockNumber;
+    this.stats.blocks++;
+    if (this.bufferedRows >= this.maxBufferedRows) {
+      this.flush();
+    }
+  }
+
+  /**
+   * Writes each partition's buffered events as a chunk, records the
+   * checkpoint, then compacts one past day, on the flush worker. A flush
+   * already in progress is not doubled: its promise is returned.
+   *
+   * @returns {Promise<void>} Settles once the flush is done; never rejects.
+   */
+  flush() {
+    if (!this.flushing && this.lastBlock !== null) {
+      this.flushing = this._flush().finally(() => {
+        this.flushing = null;
+      });
+    }
+    return this.flushing || Promise.resolve();
+  }
+
+  /**
+   * Flushes, stops following blocks and stops the flush worker.
+   */
+  async close() {
+    clearInterval(this.flushTimer);
+    if (this.stopListening) {
+      this.stopListening();
+      this.stopListening = null;
+    }
+    await this.flushing;
+    await this.flush();
+    if (this.worker) {
+      await this.worker.terminate();
+    }
+  }
+
+  getStatus() {
+    return {
+      dir: this.dir,
+      checkpoint: this.checkpoint,
+      bufferedRows: this.bufferedRows,
+      bufferedPartitions: this.partitions.size,
+      flushIntervalMs: this.flushIntervalMs,
+      ...this.stats
+    };
+  }
+
+  _buffer(record) {
+    const time = Date.parse(record.timestamp);
+    if (Number.isNaN(time) || !record.deviceType) {
+      this.stats.skipped++;
+      return;
+    }
+    const day = new Date(time).toISOString().slice(0, 10);
+    const key = `${record.deviceType}/${day}`;
+    let partition = this.partitions.get(key);
+    if (!partition) {
+      partition = { deviceType: record.deviceType, day, rows: [], rawBytes: 0 };
+      this.partitions.set(key, partition);
+    }
+    partition.rows.push({
+      time,
+      eventID: String(record.eventID),
+      deviceID: String(record.deviceID),
+      eventType: record.eventType ?? null,
+      location: record.location ?? null,
+      metadata: typedMetadata(record.metadata)
+    });
+    partition.rawBytes += Buffer.byteLength(JSON.stringify(record));
+    this.bufferedRows++;
+    this.stats.archived++;
+  }
+
+  async _flush() {
+    const startedAt = Date.now();
+    const { partitions, bufferedRows, firstBlock, lastBlock } = this;
+    this.partitions = new Map();
+    this.bufferedRows = 0;
+    this.firstBlock = null;
+    this.lastBlock = null;
+
+    let result;
+    try {
+      result = await this._runJob({
+        dir: this.dir,
+        partitions: [...partitions.values()],
+        seq: this.nextSeq,
+        firstBlock,
+        lastBlock,
+        today: new Date().toISOString().slice(0, 10)
+      });
+    } catch (error) {
+      // The events go back in the buffer for the next flush
+      console.error(`Archive flush to ${this.dir} failed:`, error.message);
+      this._rebuffer(partitions, bufferedRows, firstBlock, lastBlock);
+      return;
+    }
+    this.nextSeq = result.nextSeq;
+    this.checkpoint = lastBlock;
+    this.stats.chunksWritten += result.chunksWritten;
+    this.stats.flushes++;
+    this.stats.lastFlushAt = new Date().toISOString();
+    this.stats.lastFlushMs = Date.now() - startedAt;
+    if (result.compacted) {
+      this.stats.compactions++;
+    }
+    if (result.compactionError) {
+      console.error(`Archive compaction in ${this.dir} failed:`, result.compactionError);
+    }
+  }
+
+  /**
+   * Puts the events of a failed flush back in front of those buffered since.
+   */
+  _rebuffer(partitions, bufferedRows, firstBlock, lastBlock) {
+    for (const [key, partition] of partitions) {
+      const newer = this.partitions.get(key);
+      if (newer) {
+        partition.rows.push(...newer.rows);
+        partition.rawBytes += newer.rawBytes;
+      }
+    }
+    for (const [key, partition] of this.partitions) {
+      if (!partitions.has(key)) {
+        partitions.set(key, partition);
+      }
+    }
+    this.partitions = partitions;
+    this.bufferedRows += bufferedRows;
+    this.firstBlock = firstBlock;
+    if (this.lastBlock === null) {
+      this.lastBlock = lastBlock;
+    }
+  }
+
+  /**
+   * Hands a flush to the worker, started on first use and again after it exits.
+   */
+  _runJob(job) {
+    if (!this.worker) {
+      this._startWorker();
+    }
+    const id = this.nextJobID++;
+    return new Promise((resolve, reject) => {
+      this.jobs.set(id, { resolve, reject });
+      this.worker.postMessage({ id, ...job });
+    });
+  }
+
+  _startWorker() {
+    const worker = new Worker(path.join(__dirname, 'archiveFlushWorker.js'));
+    // Does not keep the process alive, like the flush timer
+    worker.unref();
+    worker.on('message', ({ id, error, ...result }) => {
+      const job = this.jobs.get(id);
+      this.jobs.delete(id);
+      if (error) {
+        job.reject(new Error(error));
+      } else {
+        job.resolve(result);
+      }
+    });
+    worker.on('error', (error) => {
+      console.error(`Archive flush worker failed: ${error.message}`);
+    });
+    worker.on('exit', () => {
+      this.worker = null;
+      for (const job of this.jobs.values()) {
+        job.reject(new Error('flush worker exited'));
+      }
+      this.jobs.clear();
+    });
+    this.worker = worker;
+  }
+}
+
+ArchiveWriter.listPartitions = listPartitions;
+ArchiveWriter.listChunks = listChunks;
+ArchiveWriter.chunkName = chunkName;
+ArchiveWriter.MANIFEST_FILE = MANIFEST_FILE;
+ArchiveWriter.MANIFEST_VERSION = MANIFEST_VERSION;
+
+module.exports = ArchiveWriter;
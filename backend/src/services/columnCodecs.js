@@ -0,0 +1,536 @@
+// Column encodings of the time-series archive (see archiveWriter.js).
+//
+//   timestamps  delta-of-delta of epoch ms, with Gorilla's variable-length
+//               buckets: a regular reporting interval costs one bit per row
+//   float64     Gorilla XOR: each value is XORed with the previous one and
+//               only the meaningful bits of the XOR are written, so repeated
+//               or slowly changing readings take a few bits
+//   dict        distinct strings once, then each row's code bit-packed at
+//               the width of the largest code (no bits at all when every
+//               row has the same value; code 0 is a missing value)
+//   prefix      for unique, mostly sequential strings such as event IDs:
+//               the difference from the previous value's trailing number
+//               when only that changed ("sensor_041" after "sensor_040"),
+//               otherwise the length of the prefix shared with it and the rest
+//
+// Every encoder returns a Buffer and every decoder takes the Buffer and the
+// row count. Decoders fill typed arrays so scans run over flat memory.
+
+const TEXT_ENCODER = new TextEncoder();
+const TEXT_DECODER = new TextDecoder();
+
+// Views of one float64 as two uint32 halves (little-endian: [lo, hi])
+const FLOAT = new Float64Array(1);
+const HALVES = new Uint32Array(FLOAT.buffer);
+
+class BitWriter {
+  constructor(capacity = 1024) {
+    this.bytes = new Uint8Array(capacity);
+    this.bitLength = 0;
+  }
+
+  /**
+   * Appends the low n bits of value (n <= 32), most significant first.
+   */
+  write(value, n) {
+    if (n === 0) {
+      return;
+    }
+    this._reserve(n);
+    let remaining = n;
+    while (remaining > 0) {
+      const byteIndex = this.bitLength >>> 3;
+      const free = 8 - (this.bitLength & 7);
+      const take = Math.min(free, remaining);
+      const bits = (value >>> (remaining - take)) & ((1 << take) - 1);
+      this.bytes[byteIndex] |= bits << (free - take);
+      this.bitLength += take;
+      remaining -= take;
+    }
+  }
+
+  writeBit(bit) {
+    this.write(bit, 1);
+  }
+
+  toBuffer() {
+    return Buffer.from(this.bytes.buffer, this.bytes.byteOffset, (this.bitLength + 7) >>> 3);
+  }
+
+  _reserve(n) {
+    const needed = (this.bitLength + n + 7) >>> 3;
+    if (needed > this.bytes.length) {
+      const grown = new Uint8Array(Math.max(needed, this.bytes.length * 2));
+      grown.set(this.bytes);
+      this.bytes = grown;
+    }
+  }
+}
+
+class BitReader {
+  constructor(buffer) {
+    this.bytes = buffer;
+    this.position = 0;
+  }
+
+  /**
+   * Reads n bits (n <= 32) as an unsigned number.
+   */
+  read(n) {
+    let value = 0;
+    let remaining = n;
+    while (remaining > 0) {
+      const byte = this.bytes[this.position >>> 3];
+      const available = 8 - (this.position & 7);
+      const take = Math.min(available, remaining);
+      const bits = (byte >>> (available - take)) & ((1 << take) - 1);
+      value = value * (1 << take) + bits;
+      this.position += take;
+      remaining -= take;
+    }
+    return value;
+  }
+
+  readBit() {
+    const bit = (this.bytes[this.position >>> 3] >>> (7 - (this.position & 7))) & 1;
+    this.position++;
+    return bit;
+  }
+}
+
+const zigzag = (n) => (n >= 0 ? n * 2 : -n * 2 - 1);
+const unzigzag = (n) => (n % 2 === 0 ? n / 2 : -(n + 1) / 2);
+
+// Delta-of-delta buckets: [control bits, control length, value bits]
+const DOD_BUCKETS = [
+  [0b10, 2, 7],
+  [0b110, 3, 9],
+  [0b1110, 4, 12]
+];
+
+/**
+ * Timestamps (epoch ms, any order but cheapest sorted) as delta-of-delta.
+ * The first value takes 48 bits and the first delta 32 (zigzag); rows of a
+ * partition fall within one day, so every delta fits.
+ */
+function encodeTimestamps(times) {
+  const writer = new BitWriter(Math.max(16, times.length >>> 1));
+  if (times.length === 0) {
+    return writer.toBuffer();
+  }
+  writer.write(Math.floor(times[0] / 2 ** 24), 24);
+  writer.write(times[0] % 2 ** 24, 24);
+  if (times.length === 1) {
+    return writer.toBuffer();
+  }
+  let delta = times[1] - times[0];
+  writer.write(zigzag(delta), 32);
+  for (let i = 2; i < times.length; i++) {
+    const next = times[i] - times[i - 1];
+    const dod = next - delta;
+    delta = next;
+    if (dod === 0) {
+      writer.writeBit(0);
+      continue;
+    }
+    const encoded = zigzag(dod);
+    const bucket = DOD_BUCKETS.find(([, , bits]) => encoded < 2 ** bits);
+    if (bucket) {
+      writer.write(bucket[0], bucket[1]);
+      writer.write(encoded, bucket[2]);
+    } else {
+      writer.write(0b1111, 4);
+      writer.write(encoded, 32);
+    }
+  }
+  return writer.toBuffer();
+}
+
+function decodeTimestamps(buffer, rows) {
+  const times = new Float64Array(rows);
+  if (rows === 0) {
+    return times;
+  }
+  const reader = new BitReader(buffer);
+  times[0] = reader.read(24) * 2 ** 24 + reader.read(24);
+  if (rows === 1) {
+    return times;
+  }
+  let delta = unzigzag(reader.read(32));
+  times[1] = times[0] + delta;
+  for (let i = 2; i < rows; i++) {
+    if (reader.readBit() === 1) {
+      let bits;
+      if (reader.readBit() === 0) {
+        bits = 7;
+      } else if (reader.readBit() === 0) {
+        bits = 9;
+      } else if (reader.readBit() === 0) {
+        bits = 12;
+      } else {
+        bits = 32;
+      }
+      delta += unzigzag(reader.read(bits));
+    }
+    times[i] = times[i - 1] + delta;
+  }
+  return times;
+}
+
+const leadingZeros = (hi, lo) => (hi !== 0 ? Math.clz32(hi) : 32 + Math.clz32(lo));
+const trailingZeros = (hi, lo) => {
+  if (lo !== 0) {
+    return 31 - Math.clz32(lo & -lo);
+  }
+  return 32 + (31 - Math.clz32(hi & -hi));
+};
+
+/**
+ * Writes bits [trailing, 64 - leading) of the 64-bit value hi:lo.
+ */
+function writeMeaningful(writer, hi, lo, leading, trailing) {
+  const length = 64 - leading - trailing;
+  let shiftedHi;
+  let shiftedLo;
+  if (trailing >= 32) {
+    shiftedHi = 0;
+    shiftedLo = hi >>> (trailing - 32);
+  } else if (trailing === 0) {
+    shiftedHi = hi;
+    shiftedLo = lo;
+  } else {
+    shiftedHi = hi >>> trailing;
+    shiftedLo = ((lo >>> trailing) | (hi << (32 - trailing))) >>> 0;
+  }
+  if (length > 32) {
+    writer.write(shiftedHi, length - 32);
+    writer.write(shiftedLo, 32);
+  } else {
+    writer.write(shiftedLo, length);
+  }
+}
+
+/**
+ * Float64 values with Gorilla XOR compression. NaN stands for a missing value.
+ */
+function encodeFloats(values) {
+  const writer = new BitWriter(Math.max(16, values.length));
+  if (values.length === 0) {
+    return writer.toBuffer();
+  }
+  FLOAT[0] = values[0];
+  let prevHi = HALVES[1];
+  let prevLo = HALVES[0];
+  writer.write(prevHi, 32);
+  writer.write(prevLo, 32);
+  let prevLeading = -1;
+  let prevTrailing = 0;
+
+  for (let i = 1; i < values.length; i++) {
+    FLOAT[0] = values[i];
+    const hi = HALVES[1];
+    const lo = HALVES[0];
+    const xorHi = (hi ^ prevHi) >>> 0;
+    const xorLo = (lo ^ prevLo) >>> 0;
+    prevHi = hi;
+    prevLo = lo;
+
+    if (xorHi === 0 && xorLo === 0) {
+      writer.writeBit(0);
+      continue;
+    }
+    writer.writeBit(1);
+    // Leading zeros are capped at 31 to fit 5 bits
+    const leading = Math.min(leadingZeros(xorHi, xorLo), 31);
+    const trailing = trailingZeros(xorHi, xorLo);
+    if (prevLeading !== -1 && leading >= prevLeading && trailing >= prevTrailing) {
+      writer.writeBit(0);
+      writeMeaningful(writer, xorHi, xorLo, prevLeading, prevTrailing);
+    } else {
+      writer.writeBit(1);
+      writer.write(leading, 5);
+      // A length of 64 is written as 0
+      writer.write((64 - leading - trailing) & 63, 6);
+      writeMeaningful(writer, xorHi, xorLo, leading, trailing);
+      prevLeading = leading;
+      prevTrailing = trailing;
+    }
+  }
+  return writer.toBuffer();
+}
+
+function decodeFloats(buffer, rows) {
+  const values = new Float64Array(rows);
+  if (rows === 0) {
+    return values;
+  }
+  const reader = new BitReader(buffer);
+  let hi = reader.read(32);
+  let lo = reader.read(32);
+  HALVES[1] = hi;
+  HALVES[0] = lo;
+  values[0] = FLOAT[0];
+  let leading = 0;
+  let trailing = 0;
+
+  for (let i = 1; i < rows; i++) {
+    if (reader.readBit() === 1) {
+      if (reader.readBit() === 1) {
+        leading = reader.read(5);
+        const length = reader.read(6) || 64;
+        trailing = 64 - leading - length;
+      }
+      const length = 64 - leading - trailing;
+      let xorHi;
+      let xorLo;
+      if (length > 32) {
+        const high = reader.read(length - 32);
+        const low = reader.read(32);
+        // Shift high:low left by trailing
+        if (trailing === 0) {
+          xorHi = high;
+          xorLo = low;
+        } else {
+          xorHi = ((high << trailing) | (low >>> (32 - trailing))) >>> 0;
+          xorLo = (low << trailing) >>> 0;
+        }
+      } else {
+        const low = reader.read(length);
+        if (trailing >= 32) {
+          xorHi = (low << (trailing - 32)) >>> 0;
+          xorLo = 0;
+        } else if (trailing === 0) {
+          xorHi = 0;
+          xorLo = low;
+        } else {
+          xorHi = low >>> (32 - trailing);
+          xorLo = (low << trailing) >>> 0;
+        }
+      }
+      hi = (hi ^ xorHi) >>> 0;
+      lo = (lo ^ xorLo) >>> 0;
+    }
+    HALVES[1] = hi;
+    HALVES[0] = lo;
+    values[i] = FLOAT[0];
+  }
+  return values;
+}
+
+class ByteWriter {
+  constructor() {
+    this.chunks = [];
+    this.current = Buffer.allocUnsafe(4096);
+    this.offset = 0;
+  }
+
+  varint(n) {
+    this._reserve(8);
+    let value = n;
+    while (value >= 0x80) {
+      this.current[this.offset++] = (value % 0x80) | 0x80;
+      value = Math.floor(value / 0x80);
+    }
+    this.current[this.offset++] = value;
+  }
+
+  bytes(data) {
+    this._reserve(data.length);
+    this.current.set(data, this.offset);
+    this.offset += data.length;
+  }
+
+  toBuffer() {
+    this.chunks.push(this.current.subarray(0, this.offset));
+    return Buffer.concat(this.chunks);
+  }
+
+  _reserve(n) {
+    if (this.offset + n > this.current.length) {
+      this.chunks.push(this.current.subarray(0, this.offset));
+      this.current = Buffer.allocUnsafe(Math.max(4096, n));
+      this.offset = 0;
+    }
+  }
+}
+
+class ByteReader {
+  constructor(buffer) {
+    this.buffer = buffer;
+    this.offset = 0;
+  }
+
+  varint() {
+    let value = 0;
+    let scale = 1;
+    for (;;) {
+      const byte = this.buffer[this.offset++];
+      value += (byte & 0x7f) * scale;
+      if (byte < 0x80) {
+        return value;
+      }
+      scale *= 0x80;
+    }
+  }
+
+  string(length) {
+    const text = TEXT_DECODER.decode(this.buffer.subarray(this.offset, this.offset + length));
+    this.offset += length;
+    return text;
+  }
+}
+
+/**
+ * Strings (null or undefined for missing) as a dictionary and one code per row.
+ */
+function encodeDictionary(values) {
+  const codes = new Map();
+  const dictionary = [];
+  const rowCodes = new Uint32Array(values.length);
+  let maxCode = 0;
+  let constant = true;
+  for (let i = 0; i < values.length; i++) {
+    const value = values[i];
+    let code = 0;
+    if (value !== null && value !== undefined) {
+      code = codes.get(value);
+      if (code === undefined) {
+        dictionary.push(value);
+        code = dictionary.length;
+        codes.set(value, code);
+      }
+    }
+    rowCodes[i] = code;
+    maxCode = Math.max(maxCode, code);
+    constant = constant && code === rowCodes[0];
+  }
+
+  const writer = new ByteWriter();
+  writer.varint(dictionary.length);
+  for (const entry of dictionary) {
+    const bytes = TEXT_ENCODER.encode(entry);
+    writer.varint(bytes.length);
+    writer.bytes(bytes);
+  }
+  if (constant) {
+    writer.varint(0);
+    writer.varint(values.length > 0 ? rowCodes[0] : 0);
+    return writer.toBuffer();
+  }
+  const width = 32 - Math.clz32(maxCode);
+  writer.varint(width);
+  const packed = new BitWriter(Math.ceil((values.length * width) / 8));
+  for (const code of rowCodes) {
+    packed.write(code, width);
+  }
+  writer.bytes(packed.toBuffer());
+  return writer.toBuffer();
+}
+
+/**
+ * @returns {{dictionary: Array<string|null>, codes: Uint32Array}} dictionary[0] is null.
+ */
+function decodeDictionary(buffer, rows) {
+  const reader = new ByteReader(buffer);
+  const size = reader.varint();
+  const dictionary = [null];
+  for (let i = 0; i < size; i++) {
+    dictionary.push(reader.string(reader.varint()));
+  }
+  const codes = new Uint32Array(rows);
+  const width = reader.varint();
+  if (width === 0) {
+    codes.fill(reader.varint());
+    return { dictionary, codes };
+  }
+  const packed = new BitReader(buffer.subarray(reader.offset));
+  for (let i = 0; i < rows; i++) {
+    codes[i] = packed.read(width);
+  }
+  return { dictionary, codes };
+}
+
+// A prefix-coded row starts with a tag: tag % 3 is the kind of row and
+// Math.floor(tag / 3) its argument
+const PREFIX_NULL = 0;      // missing value
+const PREFIX_SHARED = 1;    // argument: shared prefix length; then length and bytes of the rest
+const PREFIX_NUMBER = 2;    // argument: zigzag difference of the trailing number
+const TRAILING_NUMBER = /^(.*?)(\d{1,15})$/s;
+
+/**
+ * Strings (null or undefined for missing) coded against the previous row.
+ */
+function encodePrefixed(values) {
+  const writer = new ByteWriter();
+  let previous = '';
+  let previousNumber = null;
+  for (const value of values) {
+    if (value === null || value === undefined) {
+      writer.varint(PREFIX_NULL);
+      continue;
+    }
+    const number = TRAILING_NUMBER.exec(value);
+    if (number && previousNumber && number[1] === previousNumber[1] && number[2].length === previousNumber[2].length) {
+      writer.varint(PREFIX_NUMBER + 3 * zigzag(Number(number[2]) - Number(previousNumber[2])));
+    } else {
+      const limit = Math.min(previous.length, value.length);
+      let shared = 0;
+      while (shared < limit && previous.charCodeAt(shared) === value.charCodeAt(shared)) {
+        shared++;
+      }
+      const rest = TEXT_ENCODER.encode(value.slice(shared));
+      writer.varint(PREFIX_SHARED + 3 * shared);
+      writer.varint(rest.length);
+      writer.bytes(rest);
+    }
+    previous = value;
+    previousNumber = number;
+  }
+  return writer.toBuffer();
+}
+
+/**
+ * @returns {Array<string|null>}
+ */
+function decodePrefixed(buffer, rows) {
+  const reader = new ByteReader(buffer);
+  const values = new Array(rows);
+  let previous = '';
+  let stem = '';
+  let digits = 0;
+  let number = 0;
+  for (let i = 0; i < rows; i++) {
+    const tag = reader.varint();
+    const kind = tag % 3;
+    const argument = (tag - kind) / 3;
+    if (kind === PREFIX_NULL) {
+      values[i] = null;
+      continue;
+    }
+    if (kind === PREFIX_NUMBER) {
+      number += unzigzag(argument);
+      previous = stem + String(number).padStart(digits, '0');
+    } else {
+      previous = previous.slice(0, argument) + reader.string(reader.varint());
+      const match = TRAILING_NUMBER.exec(previous);
+      if (match) {
+        stem = match[1];
+        digits = match[2].length;
+        number = Number(match[2]);
+      }
+    }
+    values[i] = previous;
+  }
+  return values;
+}
+
+module.exports = {
+  encodeTimestamps,
+  decodeTimestamps,
+  encodeFloats,
+  decodeFloats,
+  encodeDictionary,
+  decodeDictionary,
+  encodePrefixed,
+  decodePrefixed
+};
@@ -0,0 +1,427 @@
+// In-memory read model of the ledger's sensor events, serving the dashboard
+// reads (GET /sensor-events) without querying the peers.
+//
+// The store follows committed blocks (FabricClient.listenSensorEventChanges)
+// and applies the chaincode's SensorEventsChanged events, so it is as fresh as
+// the last block and a dashboard refresh costs a lookup instead of chaincode
+// range scans. Events are indexed by device type, device ID and time: each
+// index keeps its events sorted by timestamp, so a time window is two binary
+// searches.
+//
+// On first start the store is filled by paging through the ledger once while
+// already listening for blocks. With a snapshot file it instead restores the
+// events and the block they are current to, and replays blocks from there;
+// replaying a block already applied is harmless, since every change is an
+// upsert or a delete by eventID.
+//
+// Subscribers are told of every block as it is applied (the live stream of
+// GET /sensor-events/stream). Events written by blocks this process applied
+// remember their block, so a subscriber that lost its connection can be sent
+// what it missed, unless events were deleted meanwhile: deletions are not
+// kept, so such a subscriber is told to reload instead.
+//
+// In the anchor ingest mode events are kept off-chain in the anchor store and
+// the ledger only carries batch roots; an EventsAnchored event then brings the
+// events of that batch into the store, read back from the anchor store.
+
+const fs = require('fs');
+const path = require('path');
+
+const DEFAULT_SNAPSHOT_INTERVAL_MS = 60000;
+const BACKFILL_PAGE_SIZE = 1000;
+const RETRY_MS = 5000;
+const SNAPSHOT_VERSION = 1;
+const SNAPSHOT_CHUNK = 1000;
+
+/**
+ * First position in a time-sorted index whose time is >= time (upper: > time).
+ */
+const bound = (index, time, upper) => {
+  let low = 0;
+  let high = index.length;
+  while (low < high) {
+    const mid = (low + high) >>> 1;
+    if (index[mid].time < time || (upper && index[mid].time === time)) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+};
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+class EventStore {
+  /**
+   * @param {Object} [options]
+   * @param {string} [options.snapshotPath] - NDJSON snapshot file; none when omitted.
+   * @param {number} [options.snapshotIntervalMs] - How often a changed store is written to the snapshot.
+   * @param {AnchorStore} [options.anchors] - Off-chain events of anchored batches (INGEST_MODE=anchor).
+   */
+  constructor(options = {}) {
+    this.snapshotPath = options.snapshotPath || null;
+    this.anchors = options.anchors || null;
+    this.snapshotIntervalMs = options.snapshotIntervalMs || DEFAULT_SNAPSHOT_INTERVAL_MS;
+
+    this.byID = new Map();      // eventID -> { time, block, record }
+    this.all = [];              // entries sorted by time
+    this.byType = new Map();    // deviceType -> entries sorted by time
+    this.byDevice = new Map();  // deviceID -> entries sorted by time
+
+    this.ready = false;
+    this.blockNumber = null;    // last block applied
+    this.liveSince = null;      // first block applied by this process
+    this.lastDeleteBlock = null; // last block applied that deleted events
+    this.subscribers = new Set();
+    this.backfillDeleted = null;
+    this.dirty = false;
+    this.writingSnapshot = false;
+    this.snapshotTimer = null;
+    this.stopListening = null;
+    this.stats = {
+      blocks: 0,
+      written: 0,
+      deleted: 0,
+      rejected: 0,
+      queries: 0,
+      lastBlockAt: null,
+      snapshotAt: null,
+      snapshotBlock: null
+    };
+  }
+
+  /**
+   * Fills the store and keeps it current, retrying until the ledger can be
+   * reached. Reads should go to the ledger until isReady().
+   *
+   * @param {FabricClient} fabricClient
+   */
+  async start(fabricClient) {
+    for (;;) {
+      try {
+        const restored = this.snapshotPath !== null && this._loadSnapshot();
+        this.backfillDeleted = restored ? null : new Set();
+        this.stopListening = await fabricClient.listenSensorEventChanges(
+          (blockNumber, changes) => this.applyBlock(blockNumber, changes),
+          restored ? { startBlock: this.blockNumber } : {});
+        if (!restored) {
+          await this._backfill(fabricClient);
+        }
+        break;
+      } catch (error) {
+        console.error(`Event store could not sync with the ledger (${error.message}); retrying in ${RETRY_MS / 1000}s.`);
+        if (this.stopListening) {
+          this.stopListening();
+          this.stopListening = null;
+        }
+        this._clear();
+        await sleep(RETRY_MS);
+      }
+    }
+    this.backfillDeleted = null;
+    this.ready = true;
+    if (this.snapshotPath !== null) {
+      this.snapshotTimer = setInterval(() => this._writeSnapshot(), this.snapshotIntervalMs);
+      this.snapshotTimer.unref();
+    }
+    console.log(`Event store ready with ${this.byID.size} events${this.blockNumber !== null ? ` at block ${this.blockNumber}` : ''}.`);
+  }
+
+  isReady() {
+    return this.ready;
+  }
+
+  /**
+   * Applies the change events of one committed block.
+   *
+   * @param {number} blockNumber
+   * @param {Array<{deleted: string[], written: Array<Object>}|{anchored: Object}>} changes
+   */
+  applyBlock(blockNumber, changes) {
+    const allWritten = [];
+    const allDeleted = [];
+    for (const change of changes) {
+      const { deleted = [] } = change;
+      let { written = [] } = change;
+      if (change.anchored) {
+        // Batches anchored by another backend are unknown here and skipped
+        written = (this.anchors && this.anchors.eventsOfBatch(change.anchored.root)) || [];
+      }
+      for (const eventID of deleted) {
+        this._remove(eventID);
+        allDeleted.push(eventID);
+        if (this.backfillDeleted) {
+          this.backfillDeleted.add(eventID);
+        }
+        this.stats.deleted++;
+      }
+      for (const record of written) {
+        if (this._put(record, blockNumber)) {
+          allWritten.push(record);
+          this.stats.written++;
+        }
+      }
+    }
+    if (allDeleted.length > 0) {
+      this.lastDeleteBlock = blockNumber;
+    }
+    if (this.liveSince === null) {
+      this.liveSince = blockNumber;
+    }
+    this.blockNumber = blockNumber;
+    this.dirty = true;
+    this.stats.blocks++;
+    this.stats.lastBlockAt = new Date().toISOString();
+    for (const subscriber of this.subscribers) {
+      subscriber(blockNumber, allWritten, allDeleted);
+    }
+  }
+
+  /**
+   * Calls subscriber(blockNumber, written, deleted) after each block is
+   * applied, written being the stored records and deleted their eventIDs.
+   *
+   * @returns {Function} Unsubscribes.
+   */
+  subscribe(subscriber) {
+    this.subscribers.add(subscriber);
+    return () => this.subscribers.delete(subscriber);
+  }
+
+  /**
+   * Events written after the given block that match the query, oldest first,
+   * or null when the store cannot tell: the block predates this process or
+   * is unknown to it, or events were deleted after it (deletions are not
+   * kept, so they cannot be replayed).
+   *
+   * @param {number} blockNumber
+   * @param {Object} [query] - deviceID and deviceType, as for query().
+   * @returns {Array<Object>|null}
+   */
+  writtenSince(blockNumber, query = {}) {
+    // A block ahead of the store's is from another ledger (e.g. a restarted mock)
+    if (this.liveSince === null || blockNumber + 1 < this.liveSince || blockNumber > this.blockNumber) {
+      return null;
+    }
+    if (this.lastDeleteBlock !== null && this.lastDeleteBlock > blockNumber) {
+      return null;
+    }
+    return this.query(query).filter((record) => this.byID.get(record.eventID).block > blockNumber);
+  }
+
+  /**
+   * Events matching all given criteria, oldest first.
+   *
+   * @param {Object} [query]
+   * @param {string} [query.deviceID]
+   * @param {string} [query.deviceType]
+   * @param {string} [query.startTime] - ISO timestamp, inclusive.
+   * @param {string} [query.endTime] - ISO timestamp, inclusive.
+   * @param {number} [query.limit] - At most this many events (the oldest).
+   * @returns {Array<Object>} Stored records; callers must not modify them.
+   */
+  query({ deviceID, deviceType, startTime, endTime, limit = Infinity } = {}) {
+    this.stats.queries++;
+    let index;
+    if (deviceID) {
+      index = this.byDevice.get(deviceID) || [];
+    } else if (deviceType) {
+      index = this.byType.get(deviceType) || [];
+    } else {
+      index = this.all;
+    }
+    const from = startTime ? bound(index, Date.parse(startTime), false) : 0;
+    const to = endTime ? bound(index, Date.parse(endTime), true) : index.length;
+
+    const records = [];
+    for (let i = from; i < to && records.length < limit; i++) {
+      // Device indexes span every type
+      if (!deviceID || !deviceType || index[i].record.deviceType === deviceType) {
+        records.push(index[i].record);
+      }
+    }
+    return records;
+  }
+
+  getStats() {
+    return {
+      ready: this.ready,
+      events: this.byID.size,
+      deviceTypes: this.byType.size,
+      devices: this.byDevice.size,
+      blockNumber: this.blockNumber,
+      snapshot: this.snapshotPath,
+      ...this.stats
+    };
+  }
+
+  /**
+   * Reads every event of the ledger, then every anchored off-chain event, into
+   * the store. Events changed by blocks received meanwhile are newer than the
+   * page that carries them, so they win.
+   */
+  async _backfill(fabricClient) {
+    let bookmark = '';
+    do {
+      const page = await fabricClient.getSensorEventsPage({ pageSize: BACKFILL_PAGE_SIZE, bookmark });
+      for (const record of page.records) {
+        if (!this.byID.has(record.eventID) && !this.backfillDeleted.has(record.eventID)) {
+          this._put(record);
+        }
+      }
+      bookmark = page.bookmark;
+    } while (bookmark);
+    if (this.anchors) {
+      for (const record of this.anchors.anchoredEvents()) {
+        if (!this.byID.has(record.eventID)) {
+          this._put(record);
+        }
+      }
+    }
+  }
+
+  /**
+   * Stores a record, replacing the one with its eventID. Records whose
+   * timestamp does not parse are refused: the indexes are sorted by time.
+   *
+   * @returns {boolean} false if the record was refused.
+   */
+  _put(record, block = null) {
+    const time = Date.parse(record.timestamp);
+    if (Number.isNaN(time)) {
+      console.warn(`Event store skipped event ${record.eventID}: invalid timestamp "${record.timestamp}".`);
+      this.stats.rejected++;
+      return false;
+    }
+    this._remove(record.eventID);
+    const entry = { time, block, record };
+    this.byID.set(record.eventID, entry);
+    this._insert(this.all, entry);
+    this._insert(this._index(this.byType, record.deviceType), entry);
+    this._insert(this._index(this.byDevice, record.deviceID), entry);
+    return true;
+  }
+
+  _remove(eventID) {
+    const entry = this.byID.get(eventID);
+    if (!entry) {
+      return;
+    }
+    this.byID.delete(eventID);
+    this._delete(this.all, entry);
+    this._delete(this.byType.get(entry.record.deviceType), entry);
+    this._delete(this.byDevice.get(entry.record.deviceID), entry);
+  }
+
+  _index(indexes, key) {
+    let index = indexes.get(key);
+    if (!index) {
+      index = [];
+      indexes.set(key, index);
+    }
+    return index;
+  }
+
+  _insert(index, entry) {
+    // Events mostly arrive in time order: append without searching
+    if (index.length === 0 || index[index.length - 1].time <= entry.time) {
+      index.push(entry);
+    } else {
+      index.splice(bound(index, entry.time, true), 0, entry);
+    }
+  }
+
+  _delete(index, entry) {
+    for (let i = bound(index, entry.time, false); i < index.length && index[i].time === entry.time; i++) {
+      if (index[i] === entry) {
+        index.splice(i, 1);
+        return;
+      }
+    }
+  }
+
+  _clear() {
+    this.byID.clear();
+    this.all = [];
+    this.byType.clear();
+    this.byDevice.clear();
+    this.blockNumber = null;
+    this.liveSince = null;
+    this.lastDeleteBlock = null;
+  }
+
+  /**
+   * Restores the store from the snapshot file. Returns false when there is
+   * no usable snapshot.
+   */
+  _loadSnapshot() {
+    let lines;
+    try {
+      lines = fs.readFileSync(this.snapshotPath, 'utf8').split('\n');
+    } catch (error) {
+      if (error.code !== 'ENOENT') {
+        console.warn(`Event store snapshot ${this.snapshotPath} unreadable (${error.message}); reading the ledger.`);
+      }
+      return false;
+    }
+    try {
+      const header = JSON.parse(lines[0]);
+      if (header.version !== SNAPSHOT_VERSION || !Number.isInteger(header.blockNumber)) {
+        throw new Error('unknown snapshot format');
+      }
+      for (let i = 1; i < lines.length; i++) {
+        if (lines[i] !== '') {
+          this._put(JSON.parse(lines[i]));
+        }
+      }
+      this.blockNumber = header.blockNumber;
+    } catch (error) {
+      console.warn(`Event store snapshot ${this.snapshotPath} is corrupt (${error.message}); reading the ledger.`);
+      this._clear();
+      return false;
+    }
+    console.log(`Event store restored ${this.byID.size} events at block ${this.blockNumber} from ${this.snapshotPath}.`);
+    return true;
+  }
+
+  /**
+   * Writes the events and the block they are current to. Blocks applied while
+   * the file is written may or may not be in it; the recorded block is the
+   * one before them, so they are replayed on restore either way.
+   */
+  async _writeSnapshot() {
+    if (!this.dirty || this.blockNumber === null || this.writingSnapshot) {
+      return;
+    }
+    this.writingSnapshot = true;
+    this.dirty = false;
+    const blockNumber = this.blockNumber;
+    const entries = this.all.slice();
+    const tmpPath = `${this.snapshotPath}.tmp`;
+    try {
+      await fs.promises.mkdir(path.dirname(this.snapshotPath), { recursive: true });
+      const file = await fs.promises.open(tmpPath, 'w');
+      try {
+        await file.write(`${JSON.stringify({ version: SNAPSHOT_VERSION, blockNumber, events: entries.length })}\n`);
+        for (let i = 0; i < entries.length; i += SNAPSHOT_CHUNK) {
+          const chunk = entries.slice(i, i + SNAPSHOT_CHUNK).map((entry) => `${JSON.stringify(entry.record)}\n`);
+          await file.write(chunk.join(''));
+        }
+        await file.sync();
+      } finally {
+        await file.close();
+      }
+      await fs.promises.rename(tmpPath, this.snapshotPath);
+      this.stats.snapshotAt = new Date().toISOString();
+      this.stats.snapshotBlock = blockNumber;
+    } catch (error) {
+      console.error(`Event store snapshot to ${this.snapshotPath} failed:`, error.message);
+      this.dirty = true;
+    } finally {
+      this.writingSnapshot = false;
+    }
+  }
+}
+
+module.exports = EventStore;
@@ -1,10 +1,70 @@
 // Import dependencies from the Hyperledger Fabric Node.js SDK and Node.js modules
-const { Gateway, Wallets } = require('fabric-network');
+const { Gateway, Wallets, DefaultEventHandlerStrategies } = require('fabric-network');
 const path = require('path');
 const fs = require('fs');
+const { recordStage } = require('./latencyMetrics');
+const MockLedger = require('./mockLedger');
+
+// Pool defaults (overridable through config.env)
+const DEFAULT_POOL_SIZE = 2;
+const DEFAULT_HEALTH_INTERVAL_MS = 30000;
+
+// Chaincode event set by every sensor chaincode transaction that writes or deletes events
+const CHANGE_EVENT = 'SensorEventsChanged';
+// Chaincode event set when a batch root is anchored (INGEST_MODE=anchor)
+const ANCHOR_EVENT = 'EventsAnchored';
+
+/**
+ * Running totals for one timed operation (connection setup or submit).
+ */
+const newTiming = () => ({ count: 0, totalMs: 0, maxMs: 0, lastMs: 0 });
+
+const recordTiming = (timing, elapsedMs) => {
+  timing.count++;
+  timing.totalMs += elapsedMs;
+  timing.lastMs = elapsedMs;
+  timing.maxMs = Math.max(timing.maxMs, elapsedMs);
+};
+
+const summarizeTiming = (timing) => ({
+  ...timing,
+  avgMs: timing.count > 0 ? timing.totalMs / timing.count : 0
+});
+
+/**
+ * Commit event handler factory that wraps the default strategy to time the
+ * phases of one submit. fabric-network starts listening once endorsement is
+ * complete and waits for events once the orderer has accepted the
+ * transaction, so the three hooks split the submit into endorse, order and
+ * commit.
+ */
+const timedEventHandler = (startedAt, strategy) => (transactionId, network) => {
+  const handler = strategy(transactionId, network);
+  let endorsedAt;
+  let orderedAt;
+  return {
+    startListening: async () => {
+      endorsedAt = Date.now();
+      recordStage('endorse', endorsedAt - startedAt);
+      await handler.startListening();
+    },
+    waitForEvents: async () => {
+      orderedAt = Date.now();
+      recordStage('order', orderedAt - endorsedAt);
+      await handler.waitForEvents();
+      recordStage('commit', Date.now() - orderedAt);
+    },
+    cancelListening: () => handler.cancelListening()
+  };
+};
+
+// Gateway traces travel with events through the backend but are not stored on the ledger
+const withoutTrace = ({ trace, ...event }) => event;
 
 class FabricClient {
   constructor() {
+    // FABRIC_MODE=mock replaces the network with an in-process ledger (see mockLedger.js)
+    this.mode = process.env.FABRIC_MODE === 'mock' ? 'mock' : 'gateway';
     try {
       // Define the network connection profile path
       const connectionProfilePath = path.resolve(
@@ -13,13 +73,45 @@ class FabricClient {
       );
 
       // Load the network connection profile
-      this.connectionProfile = JSON.parse(fs.readFileSync(connectionProfilePath, 'utf8'));
+      this.connectionProfile = this.mode === 'mock' ? null : JSON.parse(fs.readFileSync(connectionProfilePath, 'utf8'));
 
       // Define other class properties clearly
       this.walletPath = path.resolve(__dirname, '/home/ibrahimh/iot-blockchain-system/hyperledger/ac-uk/wallet');
       this.channelName = 'mychannel';
       this.chaincodeName = 'sensor_chaincode';
       this.identity = 'Admin@napier.ac.uk';
+
+      // Connection pool settings
+      this.poolSize = Number(process.env.FABRIC_POOL_SIZE) || DEFAULT_POOL_SIZE;
+      this.healthIntervalMs = Number(process.env.FABRIC_HEALTH_INTERVAL_MS) || DEFAULT_HEALTH_INTERVAL_MS;
+
+      this.wallet = null;
+      this.pool = [];
+      this.nextEntry = 0;
+      this.initPromise = null;
+      this.healthTimer = null;
+      this.listenerGateways = new Set();
+
+      this.mockLedger = null;
+      this.eventHandlerStrategy = DefaultEventHandlerStrategies.MSPID_SCOPE_ALLFORTX;
+      if (this.mode === 'mock') {
+        this.mockLedger = new MockLedger({
+          endorseMs: process.env.FABRIC_MOCK_ENDORSE_MS !== undefined ? Number(process.env.FABRIC_MOCK_ENDORSE_MS) : undefined,
+          orderMs: process.env.FABRIC_MOCK_ORDER_MS !== undefined ? Number(process.env.FABRIC_MOCK_ORDER_MS) : undefined,
+          commitMs: process.env.FABRIC_MOCK_COMMIT_MS !== undefined ? Number(process.env.FABRIC_MOCK_COMMIT_MS) : undefined
+        });
+        this.eventHandlerStrategy = this.mockLedger.eventHandlerStrategy;
+      }
+
+      this.metrics = {
+        connect: newTiming(),
+        submit: newTiming(),
+        evaluate: newTiming(),
+        submitFailures: 0,
+        evaluateFailures: 0,
+        reconnects: 0,
+        healthCheckFailures: 0
+      };
     } catch (error) {
       console.error('Error initializing FabricClient:', error);
       throw error;
@@ -27,47 +119,394 @@ class FabricClient {
   }
 
   /**
-   * Submits sensor data to the blockchain network.
-   *
-   * @param {Object} sensorData - The sensor data JSON object to send.
+   * Loads the wallet and identity once and opens the pool of gateways.
+   * Safe to call repeatedly; concurrent callers share the same initialization.
    */
-  async submitSensorData(sensorData) {
-    const gateway = new Gateway();
-    try {
+  init() {
+    if (!this.initPromise) {
+      this.initPromise = this._init().catch((error) => {
+        // Allow a later call to retry from scratch
+        this.initPromise = null;
+        throw error;
+      });
+    }
+    return this.initPromise;
+  }
+
+  async _init() {
+    if (this.mode !== 'mock') {
       // Load wallet from the file system
-      const wallet = await Wallets.newFileSystemWallet(this.walletPath);
+      this.wallet = await Wallets.newFileSystemWallet(this.walletPath);
       // Check if the admin identity exists in wallet
-      const identity = await wallet.get(this.identity);
+      const identity = await this.wallet.get(this.identity);
       if (!identity) {
         throw new Error(`An identity for the user ${this.identity} does not exist in the wallet.`);
       }
+    }
 
-      // Connect to the gateway using the connection profile,
-      // wallet and identity along with gateway discovery settings.
-      await gateway.connect(this.connectionProfile, {
-        wallet,
-        identity: this.identity,
-        discovery: { enabled: true, asLocalhost: true }
+    this.pool = Array.from({ length: this.poolSize }, (_, index) => ({
+      index,
+      gateway: null,
+      network: null,
+      contract: null,
+      healthy: false,
+      connecting: null
+    }));
+    // Wait for every connection, so that none is left open behind a failure
+    const results = await Promise.allSettled(this.pool.map((entry) => this._connect(entry)));
+    const failure = results.find(({ status }) => status === 'rejected');
+    if (failure) {
+      this.pool.forEach((entry) => {
+        if (entry.gateway) {
+          entry.gateway.disconnect();
+        }
       });
+      this.pool = [];
+      throw failure.reason;
+    }
 
-      // Get the network channel (mychannel) and contract (sensor_chaincode)
-      const network = await gateway.getNetwork(this.channelName);
-      const contract = network.getContract(this.chaincodeName);
+    this.healthTimer = setInterval(() => this._checkHealth(), this.healthIntervalMs);
+    this.healthTimer.unref();
+    console.log(`FabricClient connected a pool of ${this.poolSize} ${this.mode === 'mock' ? 'mock ledger contract' : 'gateway'}(s).`);
+  }
 
-      // Submit the transaction 'CreateSensorEvent' with sensorData as a JSON string
-      console.log('Submitting transaction CreateSensorEvent with sensorData:', sensorData);
-      const result = await contract.submitTransaction('CreateSensorEvent', JSON.stringify(sensorData));
-      
-      console.log('Transaction has been submitted successfully. Result:', result.toString());
+  /**
+   * (Re)connects one pool entry, timing the full connection setup.
+   */
+  _connect(entry) {
+    if (entry.connecting) {
+      return entry.connecting;
+    }
+    entry.connecting = (async () => {
+      if (entry.gateway) {
+        entry.gateway.disconnect();
+        entry.gateway = null;
+        this.metrics.reconnects++;
+      }
+      entry.healthy = false;
+
+      const startedAt = process.hrtime.bigint();
+      if (this.mode === 'mock') {
+        entry.contract = this.mockLedger.getContract();
+        entry.healthy = true;
+        recordTiming(this.metrics.connect, Number(process.hrtime.bigint() - startedAt) / 1e6);
+        return;
+      }
+      const gateway = new Gateway();
+      let network;
+      try {
+        // Connect to the gateway using the connection profile,
+        // wallet and identity along with gateway discovery settings.
+        await gateway.connect(this.connectionProfile, {
+          wallet: this.wallet,
+          identity: this.identity,
+          discovery: { enabled: true, asLocalhost: true }
+        });
+
+        // Get the network channel (mychannel) and contract (sensor_chaincode)
+        network = await gateway.getNetwork(this.channelName);
+      } catch (error) {
+        gateway.disconnect();
+        throw error;
+      }
+      entry.gateway = gateway;
+      entry.network = network;
+      entry.contract = network.getContract(this.chaincodeName);
+      entry.healthy = true;
+      recordTiming(this.metrics.connect, Number(process.hrtime.bigint() - startedAt) / 1e6);
+    })().finally(() => {
+      entry.connecting = null;
+    });
+    return entry.connecting;
+  }
+
+  /**
+   * Returns the next healthy pool entry (round-robin), reconnecting one if
+   * none is currently usable.
+   */
+  async _acquire() {
+    await this.init();
+    for (let i = 0; i < this.pool.length; i++) {
+      const entry = this.pool[this.nextEntry];
+      this.nextEntry = (this.nextEntry + 1) % this.pool.length;
+      if (entry.healthy) {
+        return entry;
+      }
+    }
+    const entry = this.pool[this.nextEntry];
+    await this._connect(entry);
+    return entry;
+  }
+
+  /**
+   * Checks that a pool entry can still reach at least one peer of the
+   * channel. Only the gRPC connections are probed: no proposal is endorsed
+   * and no chaincode runs. The mock ledger has nothing to reach.
+   */
+  async _probe(entry) {
+    if (!entry.network) {
+      return;
+    }
+    const peers = entry.network.getChannel().getEndorsers();
+    const reachable = await Promise.all(peers.map((peer) => peer.checkConnection()));
+    if (!reachable.includes(true)) {
+      throw new Error(`no peer of ${this.channelName} is reachable`);
+    }
+  }
+
+  /**
+   * Verifies a pool entry and reconnects it on failure.
+   */
+  async _verify(entry) {
+    try {
+      if (!entry.healthy) {
+        throw new Error('gateway marked unhealthy');
+      }
+      await this._probe(entry);
+    } catch (error) {
+      this.metrics.healthCheckFailures++;
+      console.warn(`Fabric gateway ${entry.index} failed health check (${error.message}); reconnecting.`);
+      try {
+        await this._connect(entry);
+      } catch (connectError) {
+        console.error(`Fabric gateway ${entry.index} reconnect failed:`, connectError.message);
+      }
+    }
+  }
+
+  _checkHealth() {
+    this.pool.forEach((entry) => {
+      if (!entry.connecting) {
+        this._verify(entry);
+      }
+    });
+  }
+
+  /**
+   * Submits a transaction on a pooled contract, timing the submit and its
+   * endorse/order/commit phases, and scheduling a health check of the entry
+   * if it fails.
+   */
+  async _submit(transactionName, ...args) {
+    const entry = await this._acquire();
+    const startedAt = process.hrtime.bigint();
+    try {
+      const transaction = entry.contract.createTransaction(transactionName);
+      transaction.setEventHandler(timedEventHandler(Date.now(), this.eventHandlerStrategy));
+      const result = await transaction.submit(...args);
+      recordTiming(this.metrics.submit, Number(process.hrtime.bigint() - startedAt) / 1e6);
       return result.toString();
+    } catch (error) {
+      this.metrics.submitFailures++;
+      // Chaincode errors leave the gateway healthy; the check tells them apart
+      this._verify(entry);
+      throw error;
+    }
+  }
+
+  /**
+   * Evaluates a read-only transaction on a pooled contract (query, no ordering).
+   */
+  async _evaluate(transactionName, ...args) {
+    const entry = await this._acquire();
+    const startedAt = process.hrtime.bigint();
+    try {
+      const result = await entry.contract.evaluateTransaction(transactionName, ...args);
+      recordTiming(this.metrics.evaluate, Number(process.hrtime.bigint() - startedAt) / 1e6);
+      return result.toString();
+    } catch (error) {
+      this.metrics.evaluateFailures++;
+      this._verify(entry);
+      throw error;
+    }
+  }
+
+  /**
+   * Submits sensor data to the blockchain network.
+   *
+   * @param {Object} sensorData - The sensor data JSON object to send.
+   */
+  async submitSensorData(sensorData) {
+    try {
+      // Submit the transaction 'CreateSensorEvent' with sensorData as a JSON string
+      const result = await this._submit('CreateSensorEvent', JSON.stringify(withoutTrace(sensorData)));
+      console.log('Transaction has been submitted successfully. Result:', result);
+      return result;
     } catch (error) {
       console.error('Error in submitSensorData:', error);
       throw error;
-    } finally {
-      // Disconnect from the gateway gracefully
-      gateway.disconnect();
     }
   }
+
+  /**
+   * Submits a batch of sensor events as one CreateEvents transaction.
+   *
+   * @param {Array<Object>} events - Sensor event JSON objects.
+   * @returns {Promise<{created: string[], skipped: string[], conflicts: Array<{eventID: string, error: string}>,
+   *   rejected: Array<{eventID: string, error: string}>}>} eventIDs written, already stored
+   *   identically (retries), taken by a different event, and rejected by chaincode validation.
+   */
+  async submitSensorBatch(events) {
+    try {
+      const result = await this._submit('CreateEvents', JSON.stringify(events.map(withoutTrace)));
+      return JSON.parse(result);
+    } catch (error) {
+      console.error(`Error in submitSensorBatch (${events.length} events):`, error);
+      throw error;
+    }
+  }
+
+  /**
+   * Anchors the Merkle root of a batch of off-chain events (AnchorBatch).
+   * Idempotent: re-anchoring a root returns the anchor already on the ledger.
+   *
+   * @param {{root: string, count: number, startTime: string, endTime: string}} batch
+   * @returns {Promise<Object>} The anchor record: root, count, time range, txID, anchoredAt.
+   */
+  async anchorBatch({ root, count, startTime, endTime }) {
+    const result = await this._submit('AnchorBatch', JSON.stringify({ root, count, startTime, endTime }));
+    return JSON.parse(result);
+  }
+
+  /**
+   * Reads the anchor of a batch root from the ledger.
+   *
+   * @param {string} root - Merkle root of the batch.
+   * @returns {Promise<Object>} The anchor record; rejects if the root is not anchored.
+   */
+  async readAnchor(root) {
+    const result = await this._evaluate('ReadAnchor', root);
+    return JSON.parse(result);
+  }
+
+  /**
+   * Reads one page of sensor events from the ledger.
+   *
+   * @param {Object} [options]
+   * @param {string} [options.deviceID] - Restrict the page to one device.
+   * @param {string} [options.deviceType] - Restrict the page to one device type (ignored with deviceID).
+   * @param {number} [options.pageSize] - Events per page.
+   * @param {string} [options.bookmark] - Bookmark returned with the previous page.
+   * @returns {Promise<{records: Array<Object>, fetchedRecordsCount: number, bookmark: string}>}
+   *   bookmark is empty once the last page has been read.
+   */
+  async getSensorEventsPage({ deviceID, deviceType, pageSize = 100, bookmark = '' } = {}) {
+    let result;
+    if (deviceID) {
+      result = await this._evaluate('GetEventsByDevicePage', deviceID, String(pageSize), bookmark);
+    } else if (deviceType) {
+      result = await this._evaluate('GetEventsByTypePage', deviceType, String(pageSize), bookmark);
+    } else {
+      result = await this._evaluate('GetEventsPage', String(pageSize), bookmark);
+    }
+    return JSON.parse(result);
+  }
+
+  /**
+   * Reads the on-chain hourly aggregates of one metadata field of a device.
+   *
+   * @param {Object} query
+   * @param {string} query.deviceID - Device to summarize.
+   * @param {string} query.field - Aggregated metadata field (e.g. co2Level, energyConsumption).
+   * @param {string} query.startTime - ISO timestamp, inclusive.
+   * @param {string} query.endTime - ISO timestamp, inclusive.
+   * @returns {Promise<Array<Object>>} One entry per non-empty hour: count, sum, min, max, mean, stddev.
+   */
+  async getSensorAggregates({ deviceID, field, startTime, endTime }) {
+    const result = await this._evaluate('GetAggregates', deviceID, field, startTime, endTime);
+    return JSON.parse(result);
+  }
+
+  /**
+   * Follows committed blocks and hands onBlock the sensor chaincode's change
+   * events of each, from valid transactions only. Listens on a gateway of its
+   * own so pool reconnects do not interrupt the block stream.
+   *
+   * @param {Function} onBlock - (blockNumber, changes) with changes an array of
+   *   { deleted: string[], written: Array<Object> } or, for an anchored batch,
+   *   { anchored: Object } with the anchor record; possibly empty.
+   * @param {Object} [options]
+   * @param {number} [options.startBlock] - Replay from this block; from the next block when omitted.
+   * @returns {Promise<Function>} Stops listening.
+   */
+  async listenSensorEventChanges(onBlock, { startBlock } = {}) {
+    const listener = (blockEvent) => {
+      const changes = [];
+      for (const transactionEvent of blockEvent.getTransactionEvents()) {
+        if (!transactionEvent.isValid) {
+          continue;
+        }
+        for (const contractEvent of transactionEvent.getContractEvents()) {
+          if (contractEvent.chaincodeId !== this.chaincodeName) {
+            continue;
+          }
+          if (contractEvent.eventName === CHANGE_EVENT) {
+            changes.push(JSON.parse(contractEvent.payload.toString()));
+          } else if (contractEvent.eventName === ANCHOR_EVENT) {
+            changes.push({ anchored: JSON.parse(contractEvent.payload.toString()) });
+          }
+        }
+      }
+      onBlock(Number(blockEvent.blockNumber.toString()), changes);
+    };
+
+    await this.init();
+    if (this.mode === 'mock') {
+      this.mockLedger.addBlockListener(listener);
+      return () => this.mockLedger.removeBlockListener(listener);
+    }
+    const gateway = new Gateway();
+    await gateway.connect(this.connectionProfile, {
+      wallet: this.wallet,
+      identity: this.identity,
+      discovery: { enabled: true, asLocalhost: true }
+    });
+    const network = await gateway.getNetwork(this.channelName);
+    // Full blocks: filtered blocks do not carry chaincode event payloads
+    await network.addBlockListener(listener, { type: 'full', ...(startBlock !== undefined && { startBlock }) });
+    this.listenerGateways.add(gateway);
+    return () => {
+      network.removeBlockListener(listener);
+      gateway.disconnect();
+      this.listenerGateways.delete(gateway);
+    };
+  }
+
+  /**
+   * Connection-setup versus submit timings, to compare pooled and
+   * per-request connection costs.
+   */
+  getMetrics() {
+    return {
+      mode: this.mode,
+      ...(this.mockLedger && { mockLedger: this.mockLedger.getStats() }),
+      poolSize: this.pool.length,
+      healthyGateways: this.pool.filter((entry) => entry.healthy).length,
+      connect: summarizeTiming(this.metrics.connect),
+      submit: summarizeTiming(this.metrics.submit),
+      evaluate: summarizeTiming(this.metrics.evaluate),
+      submitFailures: this.metrics.submitFailures,
+      evaluateFailures: this.metrics.evaluateFailures,
+      reconnects: this.metrics.reconnects,
+      healthCheckFailures: this.metrics.healthCheckFailures
+    };
+  }
+
+  /**
+   * Disconnects every pooled gateway and the block listener's.
+   */
+  close() {
+    clearInterval(this.healthTimer);
+    this.listenerGateways.forEach((gateway) => gateway.disconnect());
+    this.listenerGateways.clear();
+    this.pool.forEach((entry) => {
+      if (entry.gateway) {
+        entry.gateway.disconnect();
+      }
+      entry.healthy = false;
+    });
+    this.initPromise = null;
+  }
 }
 
 module.exports = FabricClient;
@@ -0,0 +1,274 @@
+// Per-stage latency histograms and throughput meters for the ingest pipeline.
+//
+// Events reach the backend with a `trace` object stamped by the ingestion
+// gateway (mote send estimate, arrival, decode); the backend adds its own
+// stages up to the ledger commit. Each stage is recorded into an HDR-style
+// histogram: log-linear buckets with a fixed relative error (under 1%), so
+// memory is constant and percentiles stay accurate from microseconds to
+// minutes.
+
+// Stages in pipeline order. Not every stage applies to every event: gateway
+// stages need a gateway trace, wal_append only exists in async ingest mode and
+// anchor_append in anchor ingest mode.
+const STAGES = {
+  mote_to_gateway: 'Mote reading to gateway arrival (mote batching and radio)',
+  gateway_decode: 'Gateway arrival to decoded (worker queue and decode)',
+  gateway_to_api: 'Decoded to accepted by the API (forwarding and HTTP)',
+  wal_append: 'Accepted to durable in the write-ahead log',
+  anchor_append: 'Accepted to durable in the anchor store',
+  batch_wait: 'Queued for the ledger to included in a submitted batch',
+  endorse: 'Transaction proposal to endorsements collected',
+  order: 'Endorsed to accepted by the orderer',
+  commit: 'Accepted by the orderer to committed on the peers',
+  api_to_commit: 'Accepted by the API to committed on the ledger',
+  end_to_end: 'Mote reading to committed on the ledger'
+};
+
+const PERCENTILES = [50, 90, 99, 99.9];
+
+// Values are recorded in microseconds. Below 2^SUB_BUCKET_BITS every value has
+// its own bucket; above, each power of two is split into 2^(SUB_BUCKET_BITS-1)
+// buckets, i.e. 7 significant bits.
+const SUB_BUCKET_BITS = 7;
+const SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+const HALF_SUB_BUCKETS = SUB_BUCKETS >> 1;
+const MAX_VALUE_US = 0xffffffff;
+const BUCKET_COUNT = SUB_BUCKETS + (32 - SUB_BUCKET_BITS) * HALF_SUB_BUCKETS;
+
+const bucketIndex = (value) => {
+  if (value < SUB_BUCKETS) {
+    return value;
+  }
+  const shift = 31 - Math.clz32(value) - (SUB_BUCKET_BITS - 1);
+  return SUB_BUCKETS + (shift - 1) * HALF_SUB_BUCKETS + ((value >>> shift) - HALF_SUB_BUCKETS);
+};
+
+// Largest value that falls in the bucket, as HdrHistogram reports percentiles
+const bucketHighestValue = (index) => {
+  if (index < SUB_BUCKETS) {
+    return index;
+  }
+  const shift = Math.floor((index - SUB_BUCKETS) / HALF_SUB_BUCKETS) + 1;
+  const mantissa = ((index - SUB_BUCKETS) % HALF_SUB_BUCKETS) + HALF_SUB_BUCKETS;
+  return (mantissa + 1) * 2 ** shift - 1;
+};
+
+class LatencyHistogram {
+  constructor() {
+    this.counts = new Float64Array(BUCKET_COUNT);
+    this.reset();
+  }
+
+  /**
+   * Records one latency. Negative values (clock skew between hosts) count as
+   * 0; non-numeric values (e.g. a malformed client trace) are ignored.
+   *
+   * @param {number} ms - Latency in milliseconds.
+   */
+  record(ms) {
+    if (!Number.isFinite(ms)) {
+      return;
+    }
+    const us = Math.min(MAX_VALUE_US, Math.max(0, Math.round(ms * 1000)));
+    this.counts[bucketIndex(us)]++;
+    this.count++;
+    this.sumUs += us;
+    this.minUs = Math.min(this.minUs, us);
+    this.maxUs = Math.max(this.maxUs, us);
+  }
+
+  /**
+   * Latency in ms at or below which the given percentage of values fall.
+   */
+  percentile(p) {
+    if (this.count === 0) {
+      return null;
+    }
+    const rank = Math.max(1, Math.ceil((p / 100) * this.count));
+    let seen = 0;
+    for (let i = 0; i < BUCKET_COUNT; i++) {
+      seen += this.counts[i];
+      if (seen >= rank) {
+        return Math.min(bucketHighestValue(i), this.maxUs) / 1000;
+      }
+    }
+    return this.maxUs / 1000;
+  }
+
+  summary() {
+    const summary = {
+      count: this.count,
+      minMs: this.count > 0 ? this.minUs / 1000 : null,
+      meanMs: this.count > 0 ? this.sumUs / this.count / 1000 : null,
+      maxMs: this.count > 0 ? this.maxUs / 1000 : null
+    };
+    for (const p of PERCENTILES) {
+      summary[`p${p}`] = this.percentile(p);
+    }
+    return summary;
+  }
+
+  reset() {
+    this.counts.fill(0);
+    this.count = 0;
+    this.sumUs = 0;
+    this.minUs = Infinity;
+    this.maxUs = 0;
+  }
+}
+
+// Throughput over a sliding window of one-second slots
+const RATE_WINDOW_SECONDS = 60;
+
+class RateMeter {
+  constructor() {
+    this.slots = new Float64Array(RATE_WINDOW_SECONDS);
+    this.slotSecond = new Float64Array(RATE_WINDOW_SECONDS).fill(-1);
+    this.total = 0;
+    this.startedAt = Date.now();
+  }
+
+  mark(n = 1, now = Date.now()) {
+    const second = Math.floor(now / 1000);
+    const slot = second % RATE_WINDOW_SECONDS;
+    if (this.slotSecond[slot] !== second) {
+      this.slotSecond[slot] = second;
+      this.slots[slot] = 0;
+    }
+    this.slots[slot] += n;
+    this.total += n;
+  }
+
+  /**
+   * Events per second over the last RATE_WINDOW_SECONDS (or since start, if shorter).
+   */
+  rate(now = Date.now()) {
+    const second = Math.floor(now / 1000);
+    let sum = 0;
+    for (let i = 0; i < RATE_WINDOW_SECONDS; i++) {
+      if (second - this.slotSecond[i] < RATE_WINDOW_SECONDS) {
+        sum += this.slots[i];
+      }
+    }
+    const elapsed = Math.min(RATE_WINDOW_SECONDS, Math.max(1, (now - this.startedAt) / 1000));
+    return sum / elapsed;
+  }
+
+  reset() {
+    this.slots.fill(0);
+    this.slotSecond.fill(-1);
+    this.total = 0;
+    this.startedAt = Date.now();
+  }
+}
+
+const histograms = Object.fromEntries(Object.keys(STAGES).map((stage) => [stage, new LatencyHistogram()]));
+const throughput = {
+  accepted: new RateMeter(),
+  committed: new RateMeter()
+};
+
+/**
+ * Records one stage latency in ms. Unknown stages are a programming error.
+ */
+const recordStage = (stage, ms) => {
+  histograms[stage].record(ms);
+};
+
+/**
+ * Stamps an event's trace with its API acceptance and records the gateway
+ * stages it carries. Events posted directly (no gateway) get a trace too, so
+ * the backend stages are measured for every event.
+ *
+ * @param {Object} event - Sensor event as posted; its `trace` is created or completed.
+ * @param {number} [acceptedAt] - Acceptance time, ms since the epoch.
+ */
+const recordAccepted = (event, acceptedAt = Date.now()) => {
+  const trace = event.trace && typeof event.trace === 'object' ? event.trace : {};
+  if (trace.sentAt !== undefined && trace.receivedAt !== undefined) {
+    recordStage('mote_to_gateway', trace.receivedAt - trace.sentAt);
+  }
+  if (trace.receivedAt !== undefined && trace.decodedAt !== undefined) {
+    recordStage('gateway_decode', trace.decodedAt - trace.receivedAt);
+  }
+  if (trace.decodedAt !== undefined) {
+    recordStage('gateway_to_api', acceptedAt - trace.decodedAt);
+  }
+  trace.acceptedAt = acceptedAt;
+  event.trace = trace;
+  throughput.accepted.mark();
+};
+
+/**
+ * Records the commit of events carrying traces stamped by recordAccepted.
+ */
+const recordCommitted = (events, committedAt = Date.now()) => {
+  for (const { trace } of events) {
+    if (!trace) {
+      continue;
+    }
+    recordStage('api_to_commit', committedAt - trace.acceptedAt);
+    if (trace.sentAt !== undefined) {
+      recordStage('end_to_end', committedAt - trace.sentAt);
+    }
+  }
+  throughput.committed.mark(events.length, committedAt);
+};
+
+/**
+ * Snapshot of every stage histogram and the throughput meters.
+ */
+const getLatencyMetrics = () => ({
+  stages: Object.entries(STAGES).map(([stage, description]) => ({
+    stage,
+    description,
+    ...histograms[stage].summary()
+  })),
+  throughput: Object.fromEntries(Object.entries(throughput).map(([name, meter]) => [name, {
+    total: meter.total,
+    perSecond: meter.rate(),
+    windowSeconds: RATE_WINDOW_SECONDS
+  }]))
+});
+
+/**
+ * Same snapshot in the Prometheus text exposition format (summaries in seconds).
+ */
+const formatPrometheus = () => {
+  const lines = [
+    '# HELP sensor_stage_latency_seconds Ingest pipeline latency per stage.',
+    '# TYPE sensor_stage_latency_seconds summary'
+  ];
+  for (const stage of Object.keys(STAGES)) {
+    const histogram = histograms[stage];
+    for (const p of PERCENTILES) {
+      const value = histogram.percentile(p);
+      lines.push(`sensor_stage_latency_seconds{stage="${stage}",quantile="${Number((p / 100).toFixed(4))}"} ${value === null ? 'NaN' : value / 1000}`);
+    }
+    lines.push(`sensor_stage_latency_seconds_sum{stage="${stage}"} ${histogram.sumUs / 1e6}`);
+    lines.push(`sensor_stage_latency_seconds_count{stage="${stage}"} ${histogram.count}`);
+  }
+  lines.push('# HELP sensor_events_total Events accepted by the API and committed to the ledger.');
+  lines.push('# TYPE sensor_events_total counter');
+  for (const [name, meter] of Object.entries(throughput)) {
+    lines.push(`sensor_events_total{state="${name}"} ${meter.total}`);
+  }
+  return `${lines.join('\n')}\n`;
+};
+
+const resetLatencyMetrics = () => {
+  Object.values(histograms).forEach((histogram) => histogram.reset());
+  Object.values(throughput).forEach((meter) => meter.reset());
+};
+
+module.exports = {
+  STAGES,
+  LatencyHistogram,
+  RateMeter,
+  recordStage,
+  recordAccepted,
+  recordCommitted,
+  getLatencyMetrics,
+  formatPrometheus,
+  resetLatencyMetrics
+};
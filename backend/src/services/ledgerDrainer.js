@@ -0,0 +1,182 @@
+// Background drain of write-ahead log records to the ledger.
+// Records are submitted in CreateEvents batches with a bounded number of
+// batches in flight. Failed batches are retried with capped exponential
+// backoff; while a batch waits to be retried no new batches start, so a slow
+// or unavailable ledger shows up as a growing backlog that the API turns into
+// 503 responses once it passes maxBacklog.
+
+const fs = require('fs');
+const path = require('path');
+const { recordStage, recordCommitted } = require('./latencyMetrics');
+
+const DEFAULT_BATCH_SIZE = 100;
+const DEFAULT_MAX_INFLIGHT = 4;
+const DEFAULT_MAX_BACKLOG = 100000;
+const DEFAULT_RETRY_BASE_MS = 500;
+const DEFAULT_RETRY_MAX_MS = 30000;
+
+class LedgerDrainer {
+  /**
+   * @param {WriteAheadLog} wal - Log whose high-water mark is advanced on commit.
+   * @param {Function} submitBatch - async (events) => result of CreateEvents ({ created, skipped, conflicts, rejected }).
+   * @param {Object} [options]
+   * @param {number} [options.batchSize] - Events per CreateEvents transaction.
+   * @param {number} [options.maxInflight] - Batches submitted concurrently.
+   * @param {number} [options.maxBacklog] - Backlog at which new events are refused.
+   * @param {number} [options.maxAttempts] - Attempts before a batch is dead-lettered (0 = retry forever).
+   * @param {string} [options.deadLetterPath] - NDJSON file receiving dead-lettered records.
+   */
+  constructor(wal, submitBatch, options = {}) {
+    this.wal = wal;
+    this.submitBatch = submitBatch;
+    this.batchSize = options.batchSize || DEFAULT_BATCH_SIZE;
+    this.maxInflight = options.maxInflight || DEFAULT_MAX_INFLIGHT;
+    this.maxBacklog = options.maxBacklog || DEFAULT_MAX_BACKLOG;
+    this.maxAttempts = options.maxAttempts || 0;
+    this.retryBaseMs = options.retryBaseMs || DEFAULT_RETRY_BASE_MS;
+    this.retryMaxMs = options.retryMaxMs || DEFAULT_RETRY_MAX_MS;
+    this.deadLetterPath = options.deadLetterPath || path.join(wal.dir, 'dead-letter.ndjson');
+
+    this.queue = [];        // records waiting for a batch, in seq order
+    this.outstanding = [];  // batches submitted or awaiting retry, in seq order
+    this.inflightEvents = 0;
+    this.retryPending = 0;
+
+    this.stats = {
+      committedEvents: 0,
+      committedBatches: 0,
+      skippedEvents: 0,
+      rejectedEvents: 0,
+      conflictingEvents: 0,
+      failedAttempts: 0,
+      deadLettered: 0,
+      lastError: null
+    };
+  }
+
+  /**
+   * Starts draining, beginning with the records recovered from the log.
+   */
+  start(recovered = []) {
+    const queuedAt = Date.now();
+    this.queue.push(...recovered.map((record) => ({ ...record, queuedAt })));
+    if (recovered.length > 0) {
+      console.log(`Ledger drainer resuming with ${recovered.length} uncommitted event(s).`);
+    }
+    this._pump();
+  }
+
+  /**
+   * Queues a durable record for submission.
+   */
+  enqueue(record) {
+    this.queue.push({ ...record, queuedAt: Date.now() });
+    this._pump();
+  }
+
+  backlog() {
+    return this.queue.length + this.inflightEvents;
+  }
+
+  isBackpressured() {
+    return this.backlog() >= this.maxBacklog;
+  }
+
+  _pump() {
+    while (this.retryPending === 0 &&
+           this.outstanding.length < this.maxInflight &&
+           this.queue.length > 0) {
+      const records = this.queue.splice(0, this.batchSize);
+      const submittedAt = Date.now();
+      records.forEach(({ queuedAt }) => recordStage('batch_wait', submittedAt - queuedAt));
+      const batch = { records, attempts: 0, done: false };
+      this.outstanding.push(batch);
+      this.inflightEvents += records.length;
+      this._send(batch);
+    }
+  }
+
+  async _send(batch) {
+    batch.attempts++;
+    try {
+      const events = batch.records.map(({ event }) => event);
+      const { created = [], skipped = [], conflicts = [], rejected = [] } = await this.submitBatch(events);
+      const createdIDs = new Set(created);
+      recordCommitted(events.filter(({ eventID }) => createdIDs.has(eventID)));
+      this.stats.committedEvents += createdIDs.size;
+      this.stats.committedBatches++;
+      // Already stored byte for byte, e.g. records replayed after a crash
+      this.stats.skippedEvents += skipped.length;
+      // Events failing chaincode validation will never succeed; count them and move on
+      this.stats.rejectedEvents += rejected.length;
+      // Another event holds the eventID; keep these for inspection rather than drop them
+      this.stats.conflictingEvents += conflicts.length;
+      if (conflicts.length > 0) {
+        const errors = new Map(conflicts.map(({ eventID, error }) => [eventID, error]));
+        this._writeDeadLetters(batch.records.filter(({ event }) => errors.has(event.eventID)),
+          ({ event }) => errors.get(event.eventID));
+        console.warn(`Dead-lettered ${conflicts.length} event(s) whose eventID holds a different event on the ledger.`);
+      }
+      this._complete(batch);
+    } catch (error) {
+      this.stats.failedAttempts++;
+      this.stats.lastError = error.message;
+      if (this.maxAttempts > 0 && batch.attempts >= this.maxAttempts) {
+        this._deadLetter(batch, error);
+        this._complete(batch);
+        return;
+      }
+      const delay = Math.min(this.retryMaxMs, this.retryBaseMs * 2 ** (batch.attempts - 1));
+      console.warn(`Ledger batch of ${batch.records.length} failed (attempt ${batch.attempts}): ${error.message}. Retrying in ${delay} ms.`);
+      this.retryPending++;
+      setTimeout(() => {
+        this.retryPending--;
+        this._send(batch);
+      }, delay);
+    }
+  }
+
+  /**
+   * Marks a batch finished and advances the committed high-water mark over
+   * every leading finished batch, so out-of-order completions are safe.
+   */
+  _complete(batch) {
+    batch.done = true;
+    this.inflightEvents -= batch.records.length;
+    while (this.outstanding.length > 0 && this.outstanding[0].done) {
+      const finished = this.outstanding.shift();
+      this.wal.markCommitted(finished.records[finished.records.length - 1].seq);
+    }
+    this._pump();
+  }
+
+  _deadLetter(batch, error) {
+    this._writeDeadLetters(batch.records, () => error.message);
+    this.stats.deadLettered += batch.records.length;
+    console.error(`Dead-lettered ${batch.records.length} event(s) after ${batch.attempts} attempts.`);
+  }
+
+  /**
+   * Appends records to the dead-letter file, each with the error returned by errorOf(record).
+   */
+  _writeDeadLetters(records, errorOf) {
+    const failedAt = new Date().toISOString();
+    const lines = records
+      .map((record) => JSON.stringify({ ...record, error: errorOf(record), failedAt }))
+      .join('\n');
+    fs.appendFileSync(this.deadLetterPath, `${lines}\n`);
+  }
+
+  getStatus() {
+    return {
+      backlog: this.backlog(),
+      queued: this.queue.length,
+      inflightBatches: this.outstanding.length,
+      retrying: this.retryPending > 0,
+      backpressured: this.isBackpressured(),
+      ...this.stats
+    };
+  }
+}
+
+module.exports = LedgerDrainer;
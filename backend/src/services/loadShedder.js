@@ -0,0 +1,66 @@
+// Load shedding for the ingest API.
+// While the ledger backlog (events accepted but not yet committed) is at or
+// above the threshold, only urgent events (alarms and access events) are let
+// through; bulk readings are refused so what ledger capacity is left goes to
+// the others. Events are classed here from their own content, with the
+// classifier of the ingestion gateway (udp_receivers/admission.js): the
+// priority the gateway stamps on the trace is a client-supplied field and is
+// not trusted. Urgent events are still subject to the ingest mode's own hard
+// limit.
+
+const { classifyEvent } = require('../../udp_receivers/admission');
+
+const DEFAULT_THRESHOLD = 5000;
+const URGENT_PRIORITIES = new Set(['alarm', 'access']);
+
+class LoadShedder {
+  /**
+   * @param {Function} backlog - () => events accepted but not yet on the ledger.
+   * @param {Object} [options]
+   * @param {number} [options.threshold] - Backlog at which bulk events are refused.
+   * @param {number} [options.co2AlarmPpm] - CO2 level that makes a reading an alarm.
+   */
+  constructor(backlog, options = {}) {
+    this.backlog = backlog;
+    this.threshold = options.threshold || DEFAULT_THRESHOLD;
+    this.co2AlarmPpm = options.co2AlarmPpm;
+
+    this.stats = {
+      shedEvents: 0,
+      urgentWhileShedding: 0,
+      lastShedAt: null
+    };
+  }
+
+  isShedding() {
+    return this.backlog() >= this.threshold;
+  }
+
+  /**
+   * @param {Object} event - Validated sensor event.
+   * @returns {boolean} false if the event is to be refused.
+   */
+  admit(event) {
+    if (!this.isShedding()) {
+      return true;
+    }
+    if (URGENT_PRIORITIES.has(classifyEvent(event, this.co2AlarmPpm))) {
+      this.stats.urgentWhileShedding++;
+      return true;
+    }
+    this.stats.shedEvents++;
+    this.stats.lastShedAt = new Date().toISOString();
+    return false;
+  }
+
+  getStats() {
+    return {
+      threshold: this.threshold,
+      backlog: this.backlog(),
+      shedding: this.isShedding(),
+      ...this.stats
+    };
+  }
+}
+
+module.exports = LoadShedder;
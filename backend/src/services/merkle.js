@@ -0,0 +1,110 @@
+// Merkle trees over sensor events, for the anchor ingest mode: the ledger
+// holds only the root of each batch, and an inclusion proof shows that one
+// event belongs to an anchored batch.
+//
+//   leaf = SHA-256(0x00 || canonical JSON of the event)
+//   node = SHA-256(0x01 || left || right)
+//
+// Canonical JSON is JSON.stringify with object keys sorted at every level.
+// Leaves are paired left to right level by level; an odd node at the end of
+// a level is carried up unchanged. The 0x00/0x01 prefixes keep a leaf from
+// ever passing for an inner node. Hashes are lowercase hex.
+
+const crypto = require('crypto');
+
+const LEAF_PREFIX = Buffer.from([0]);
+const NODE_PREFIX = Buffer.from([1]);
+
+/**
+ * JSON with the keys of every object sorted, so equal events always hash equally.
+ */
+function canonicalJSON(value) {
+  if (Array.isArray(value)) {
+    return `[${value.map(canonicalJSON).join(',')}]`;
+  }
+  if (value !== null && typeof value === 'object') {
+    const keys = Object.keys(value).filter((key) => value[key] !== undefined).sort();
+    return `{${keys.map((key) => `${JSON.stringify(key)}:${canonicalJSON(value[key])}`).join(',')}}`;
+  }
+  return JSON.stringify(value);
+}
+
+function leafHash(event) {
+  return crypto.createHash('sha256').update(LEAF_PREFIX).update(canonicalJSON(event)).digest('hex');
+}
+
+function nodeHash(left, right) {
+  return crypto.createHash('sha256')
+    .update(NODE_PREFIX)
+    .update(Buffer.from(left, 'hex'))
+    .update(Buffer.from(right, 'hex'))
+    .digest('hex');
+}
+
+/**
+ * Every level of the tree, leaves first and root last.
+ *
+ * @param {string[]} leaves - Leaf hashes, in batch order (at least one).
+ * @returns {string[][]}
+ */
+function buildLevels(leaves) {
+  const levels = [leaves];
+  while (levels[levels.length - 1].length > 1) {
+    const level = levels[levels.length - 1];
+    const next = [];
+    for (let i = 0; i < level.length; i += 2) {
+      next.push(i + 1 < level.length ? nodeHash(level[i], level[i + 1]) : level[i]);
+    }
+    levels.push(next);
+  }
+  return levels;
+}
+
+function merkleRoot(leaves) {
+  const levels = buildLevels(leaves);
+  return levels[levels.length - 1][0];
+}
+
+/**
+ * Inclusion proof of one leaf: the sibling hashes from the leaf up to the
+ * root, each with the side it is on. Levels where the node is carried up
+ * have no step.
+ *
+ * @param {string[][]} levels - From buildLevels().
+ * @param {number} index - Position of the leaf in the batch.
+ * @returns {Array<{side: 'left'|'right', hash: string}>}
+ */
+function merkleProof(levels, index) {
+  const path = [];
+  let position = index;
+  for (let depth = 0; depth < levels.length - 1; depth++) {
+    const level = levels[depth];
+    if (position % 2 === 1) {
+      path.push({ side: 'left', hash: level[position - 1] });
+    } else if (position + 1 < level.length) {
+      path.push({ side: 'right', hash: level[position + 1] });
+    }
+    position = Math.floor(position / 2);
+  }
+  return path;
+}
+
+/**
+ * Recomputes the root from a leaf and its proof.
+ *
+ * @param {string} leaf - Leaf hash of the event.
+ * @param {Array<{side: 'left'|'right', hash: string}>} path - From merkleProof().
+ * @returns {string} The root the proof leads to.
+ */
+function rootFromProof(leaf, path) {
+  return path.reduce((hash, step) => (step.side === 'left' ? nodeHash(step.hash, hash) : nodeHash(hash, step.hash)), leaf);
+}
+
+module.exports = {
+  canonicalJSON,
+  leafHash,
+  buildLevels,
+  merkleRoot,
+  merkleProof,
+  rootFromProof
+};
@@ -0,0 +1,285 @@
+// In-process stand-in for the Fabric network (FABRIC_MODE=mock), so the
+// backend and benchmarks run on one offline machine.
+//
+// Contracts handed out by the mock follow the subset of the fabric-network
+// Contract API used by FabricClient (createTransaction / setEventHandler /
+// submit, submitTransaction, evaluateTransaction) and mimic Fabric's
+// execute-order-validate flow: a submit is "endorsed" against committed state
+// after endorseMs, "ordered" after orderMs and its writes become visible
+// commitMs later. Only the sensor chaincode transactions the backend calls are
+// implemented, with the same results as the real contract for valid input.
+// Every commit is delivered to block listeners as a one-transaction block
+// carrying the chaincode's SensorEventsChanged or EventsAnchored event, like a
+// full block event of fabric-network.
+
+const crypto = require('crypto');
+const { canonicalJSON } = require('./merkle');
+// The chaincode's own parser, so the mock accepts and stores the same timestamps
+const { parseTimestamp } = require('../../../hyperledger/chaincodes/sensor-chaincode/lib/eventIndex');
+
+const DEFAULT_ENDORSE_MS = 20;
+const DEFAULT_ORDER_MS = 10;
+const DEFAULT_COMMIT_MS = 500;
+
+const CHAINCODE_NAME = 'sensor_chaincode';
+const CHANGE_EVENT = 'SensorEventsChanged';
+const ANCHOR_EVENT = 'EventsAnchored';
+
+const REQUIRED_FIELDS = ['eventID', 'deviceType', 'deviceID', 'timestamp', 'eventType', 'location', 'metadata'];
+const DEVICE_TYPES = ['cctv', 'light', 'card_reader', 'printer', 'co2_sensor'];
+
+const sleep = (ms) => (ms > 0 ? new Promise((resolve) => setTimeout(resolve, ms)) : Promise.resolve());
+
+/**
+ * Mirrors the chaincode's validation of one event; returns an error message or null.
+ */
+const validateEvent = (event) => {
+  const missing = REQUIRED_FIELDS.filter((field) => event[field] === undefined || event[field] === null);
+  if (missing.length > 0) {
+    return `Missing required fields: ${missing.join(', ')}`;
+  }
+  if (!DEVICE_TYPES.includes(event.deviceType)) {
+    return `Unknown device type "${event.deviceType}"`;
+  }
+  if (Number.isNaN(parseTimestamp(event.timestamp))) {
+    return `Invalid timestamp "${event.timestamp}"`;
+  }
+  return null;
+};
+
+class MockLedger {
+  /**
+   * @param {Object} [options]
+   * @param {number} [options.endorseMs] - Delay before a proposal is endorsed.
+   * @param {number} [options.orderMs] - Delay before the orderer accepts an endorsed transaction.
+   * @param {number} [options.commitMs] - Delay from ordering to commit on the peers.
+   */
+  constructor(options = {}) {
+    this.endorseMs = options.endorseMs ?? DEFAULT_ENDORSE_MS;
+    this.orderMs = options.orderMs ?? DEFAULT_ORDER_MS;
+    this.commitMs = options.commitMs ?? DEFAULT_COMMIT_MS;
+
+    this.events = new Map();    // committed events by eventID, in commit order
+    this.anchors = new Map();   // committed batch anchors by root
+    this.pendingCommits = new Map();
+    this.blockListeners = new Set();
+    this.blockHeight = 0;
+    this.stats = { submitted: 0, committed: 0, evaluated: 0 };
+  }
+
+  /**
+   * Commit event handler strategy matching the mock's contracts: resolves
+   * once the transaction's writes are committed.
+   */
+  get eventHandlerStrategy() {
+    return (transactionId) => ({
+      startListening: async () => {},
+      waitForEvents: () => this.pendingCommits.get(transactionId) || Promise.resolve(),
+      cancelListening: () => {}
+    });
+  }
+
+  getContract() {
+    const ledger = this;
+    return {
+      createTransaction(name) {
+        let strategy = ledger.eventHandlerStrategy;
+        return {
+          setEventHandler(factory) {
+            strategy = factory;
+            return this;
+          },
+          submit: (...args) => ledger._submit(name, args, strategy)
+        };
+      },
+      submitTransaction(name, ...args) {
+        return ledger._submit(name, args, ledger.eventHandlerStrategy);
+      },
+      async evaluateTransaction(name, ...args) {
+        ledger.stats.evaluated++;
+        const { result } = ledger._execute(name, args);
+        return Buffer.from(JSON.stringify(result));
+      }
+    };
+  }
+
+  async _submit(name, args, strategy) {
+    this.stats.submitted++;
+    const transactionId = crypto.randomBytes(32).toString('hex');
+    await sleep(this.endorseMs);
+    const { result, writes, anchor } = this._execute(name, args, transactionId);
+
+    const handler = strategy(transactionId, null);
+    await handler.startListening();
+    await sleep(this.orderMs);
+    this.pendingCommits.set(transactionId, sleep(this.commitMs).then(() => {
+      // An event committed by another transaction since endorsement is kept
+      // (Fabric would invalidate the later transaction on its MVCC check)
+      const written = [];
+      for (const event of writes) {
+        if (!this.events.has(event.eventID)) {
+          this.events.set(event.eventID, event);
+          this.stats.committed++;
+          written.push(event);
+        }
+      }
+      const contractEvents = [];
+      if (written.length > 0) {
+        contractEvents.push({ eventName: CHANGE_EVENT, payload: { deleted: [], written } });
+      }
+      if (anchor && !this.anchors.has(anchor.root)) {
+        this.anchors.set(anchor.root, anchor);
+        contractEvents.push({ eventName: ANCHOR_EVENT, payload: anchor });
+      }
+      this.pendingCommits.delete(transactionId);
+      this._emitBlock(transactionId, contractEvents);
+    }));
+    await handler.waitForEvents();
+    return Buffer.from(JSON.stringify(result));
+  }
+
+  /**
+   * Registers a listener called with every block committed from now on.
+   */
+  addBlockListener(listener) {
+    this.blockListeners.add(listener);
+    return listener;
+  }
+
+  removeBlockListener(listener) {
+    this.blockListeners.delete(listener);
+  }
+
+  _emitBlock(transactionId, events) {
+    const blockNumber = this.blockHeight++;
+    const contractEvents = events.map(({ eventName, payload }) => ({
+      chaincodeId: CHAINCODE_NAME,
+      eventName,
+      payload: Buffer.from(JSON.stringify(payload))
+    }));
+    const blockEvent = {
+      blockNumber,
+      getTransactionEvents: () => [{ transactionId, isValid: true, getContractEvents: () => contractEvents }]
+    };
+    for (const listener of this.blockListeners) {
+      listener(blockEvent);
+    }
+  }
+
+  /**
+   * Runs one transaction against committed state. Returns its result and the
+   * events (or batch anchor) it would write.
+   */
+  _execute(name, args, transactionId = null) {
+    switch (name) {
+      case 'CreateEvents': {
+        const events = JSON.parse(args[0]);
+        const result = { created: [], skipped: [], conflicts: [], rejected: [] };
+        const writes = [];
+        const seen = new Map();
+        for (const event of events) {
+          const error = validateEvent(event);
+          const stored = seen.get(event.eventID) || this.events.get(event.eventID);
+          if (error) {
+            result.rejected.push({ eventID: event.eventID ?? null, error });
+          } else if (stored && canonicalJSON(stored) === canonicalJSON(event)) {
+            result.skipped.push(event.eventID);
+          } else if (stored) {
+            result.conflicts.push({ eventID: event.eventID, error: `The event ${event.eventID} already exists with different content` });
+          } else {
+            seen.set(event.eventID, event);
+            writes.push(event);
+            result.created.push(event.eventID);
+          }
+        }
+        return { result, writes };
+      }
+      case 'CreateSensorEvent': {
+        const event = JSON.parse(args[0]);
+        const error = validateEvent(event) || (this.events.has(event.eventID) ? `The event ${event.eventID} already exists` : null);
+        if (error) {
+          throw new Error(error);
+        }
+        return { result: event, writes: [event] };
+      }
+      case 'EventExists':
+        return { result: this.events.has(args[0]), writes: [] };
+      case 'ReadEvent':
+        if (!this.events.has(args[0])) {
+          throw new Error(`The event ${args[0]} does not exist`);
+        }
+        return { result: this.events.get(args[0]), writes: [] };
+      case 'GetEventsPage':
+        return { result: this._page(() => true, args[0], args[1]), writes: [] };
+      case 'GetEventsByTypePage':
+        return { result: this._page((event) => event.deviceType === args[0], args[1], args[2]), writes: [] };
+      case 'GetEventsByDevicePage':
+        return { result: this._page((event) => event.deviceID === args[0], args[1], args[2]), writes: [] };
+      case 'AnchorBatch': {
+        const batch = JSON.parse(args[0]);
+        if (!/^[0-9a-f]{64}$/.test(batch.root) || !Number.isInteger(batch.count) || batch.count < 1) {
+          throw new Error('Invalid batch');
+        }
+        const start = parseTimestamp(batch.startTime);
+        const end = parseTimestamp(batch.endTime);
+        if (Number.isNaN(start) || Number.isNaN(end)) {
+          throw new Error('startTime and endTime must be ISO formatted timestamps');
+        }
+        if (end < start) {
+          throw new Error('endTime must not be earlier than startTime');
+        }
+        if (this.anchors.has(batch.root)) {
+          return { result: this.anchors.get(batch.root), writes: [] };
+        }
+        const anchor = {
+          anchoredAt: new Date().toISOString(),
+          count: batch.count,
+          docType: 'eventAnchor',
+          endTime: new Date(end).toISOString(),
+          root: batch.root,
+          startTime: new Date(start).toISOString(),
+          txID: transactionId
+        };
+        return { result: anchor, writes: [], anchor };
+      }
+      case 'ReadAnchor':
+        if (!this.anchors.has(args[0])) {
+          throw new Error(`No batch with root ${args[0]} is anchored`);
+        }
+        return { result: this.anchors.get(args[0]), writes: [] };
+      case 'GetAggregates':
+        return { result: [], writes: [] };
+      default:
+        throw new Error(`Transaction ${name} is not supported by the mock ledger`);
+    }
+  }
+
+  /**
+   * Bookmark pagination over committed events; the bookmark is the commit-order offset.
+   */
+  _page(matches, pageSize, bookmark) {
+    const size = Number(pageSize) || 100;
+    const all = [...this.events.values()].filter(matches);
+    const start = Number(bookmark) || 0;
+    const records = all.slice(start, start + size);
+    return {
+      records,
+      fetchedRecordsCount: records.length,
+      bookmark: start + size < all.length ? String(start + size) : ''
+    };
+  }
+
+  getStats() {
+    return {
+      ...this.stats,
+      pendingCommits: this.pendingCommits.size,
+      blockHeight: this.blockHeight,
+      anchors: this.anchors.size,
+      endorseMs: this.endorseMs,
+      orderMs: this.orderMs,
+      commitMs: this.commitMs
+    };
+  }
+}
+
+module.exports = MockLedger;
@@ -0,0 +1,126 @@
+// Micro-batcher for ledger writes.
+// Gathers sensor events for up to maxWaitMs or maxEvents, whichever comes
+// first, and submits them as one CreateEvents transaction. Each caller gets a
+// promise that settles with the outcome of its own event.
+
+const { recordStage, recordCommitted } = require('./latencyMetrics');
+
+const DEFAULT_MAX_EVENTS = 50;
+const DEFAULT_MAX_WAIT_MS = 100;
+
+class SensorBatcher {
+  /**
+   * @param {Function} submitBatch - async (events) => { created: [], skipped: [], conflicts: [], rejected: [] }
+   * @param {Object} [options]
+   * @param {number} [options.maxEvents] - Flush once this many events are queued.
+   * @param {number} [options.maxWaitMs] - Flush this long after the first queued event.
+   */
+  constructor(submitBatch, options = {}) {
+    this.submitBatch = submitBatch;
+    this.maxEvents = options.maxEvents || DEFAULT_MAX_EVENTS;
+    this.maxWaitMs = options.maxWaitMs || DEFAULT_MAX_WAIT_MS;
+
+    this.pending = [];
+    this.timer = null;
+    this.inflightEvents = 0;
+
+    this.stats = {
+      batches: 0,
+      events: 0,
+      rejectedEvents: 0,
+      conflictingEvents: 0,
+      failedBatches: 0
+    };
+  }
+
+  /**
+   * Queues one event for the next batch.
+   *
+   * @param {Object} sensorData - Validated sensor event.
+   * @returns {Promise<{eventID: string, status: string}>} Settles when its batch commits.
+   */
+  add(sensorData) {
+    return new Promise((resolve, reject) => {
+      this.pending.push({ sensorData, queuedAt: Date.now(), resolve, reject });
+      if (this.pending.length >= this.maxEvents) {
+        this.flush();
+      } else if (!this.timer) {
+        this.timer = setTimeout(() => this.flush(), this.maxWaitMs);
+      }
+    });
+  }
+
+  /**
+   * Submits everything queued so far as one batch. Batches are not
+   * serialized: a new one may start while earlier ones are still in flight.
+   */
+  async flush() {
+    clearTimeout(this.timer);
+    this.timer = null;
+    if (this.pending.length === 0) {
+      return;
+    }
+
+    const batch = this.pending;
+    this.pending = [];
+    this.stats.batches++;
+    this.stats.events += batch.length;
+    this.inflightEvents += batch.length;
+    const submittedAt = Date.now();
+    batch.forEach(({ queuedAt }) => recordStage('batch_wait', submittedAt - queuedAt));
+
+    try {
+      const { created = [], skipped = [], conflicts = [], rejected = [] } = await this.submitBatch(batch.map(({ sensorData }) => sensorData));
+      const createdIDs = new Set(created);
+      recordCommitted(batch.filter(({ sensorData }) => createdIDs.has(sensorData.eventID)).map(({ sensorData }) => sensorData));
+      const skippedIDs = new Set(skipped);
+      const rejections = new Map(rejected.map(({ eventID, error }) => [eventID, error]));
+      const conflicting = new Map(conflicts.map(({ eventID, error }) => [eventID, error]));
+      this.stats.rejectedEvents += rejections.size;
+      this.stats.conflictingEvents += conflicting.size;
+      for (const { sensorData, resolve, reject } of batch) {
+        if (createdIDs.has(sensorData.eventID)) {
+          resolve({ eventID: sensorData.eventID, status: 'created' });
+        } else if (skippedIDs.has(sensorData.eventID)) {
+          // Stored byte for byte already: a retry
+          resolve({ eventID: sensorData.eventID, status: 'duplicate' });
+        } else if (conflicting.has(sensorData.eventID)) {
+          // Another event holds the eventID; flagged so the API can answer 409
+          const error = new Error(conflicting.get(sensorData.eventID));
+          error.conflict = true;
+          reject(error);
+        } else if (rejections.has(sensorData.eventID)) {
+          // Failed chaincode validation; flagged so the API can answer 400
+          const error = new Error(rejections.get(sensorData.eventID));
+          error.rejected = true;
+          reject(error);
+        } else {
+          reject(new Error(`Event ${sensorData.eventID} missing from batch result`));
+        }
+      }
+    } catch (error) {
+      this.stats.failedBatches++;
+      batch.forEach(({ reject }) => reject(error));
+    } finally {
+      this.inflightEvents -= batch.length;
+    }
+  }
+
+  /**
+   * Events queued or in a batch that has not settled yet.
+   */
+  backlog() {
+    return this.pending.length + this.inflightEvents;
+  }
+
+  getStats() {
+    return {
+      ...this.stats,
+      queued: this.pending.length,
+      inflight: this.inflightEvents,
+      avgBatchSize: this.stats.batches > 0 ? this.stats.events / this.stats.batches : 0
+    };
+  }
+}
+
+module.exports = SensorBatcher;
@@ -0,0 +1,343 @@
+// Append-only write-ahead log for accepted sensor events.
+// Events are appended as NDJSON lines ({"seq":N,"event":{...}}) to segmented
+// files and fsynced in groups: every append waiting in the same flush window
+// shares one write + fdatasync. A checkpoint file records the committed
+// high-water mark (every seq <= it is on the ledger); segments entirely below
+// it are deleted.
+
+const fs = require('fs');
+const path = require('path');
+
+const DEFAULT_SEGMENT_BYTES = 16 * 1024 * 1024;
+const DEFAULT_FSYNC_INTERVAL_MS = 10;
+const DEFAULT_CHECKPOINT_INTERVAL_MS = 1000;
+
+const SEGMENT_PREFIX = 'segment-';
+const SEGMENT_SUFFIX = '.log';
+const CHECKPOINT_FILE = 'checkpoint.json';
+
+const segmentName = (firstSeq) => `${SEGMENT_PREFIX}${String(firstSeq).padStart(16, '0')}${SEGMENT_SUFFIX}`;
+
+/**
+ * Writes the whole buffer to fd, looping over partial writes.
+ */
+const writeAll = (fd, buffer) => new Promise((resolve, reject) => {
+  const writeFrom = (offset) => {
+    fs.write(fd, buffer, offset, buffer.length - offset, null, (err, written) => {
+      if (err) {
+        reject(err);
+      } else if (offset + written < buffer.length) {
+        writeFrom(offset + written);
+      } else {
+        resolve();
+      }
+    });
+  };
+  writeFrom(0);
+});
+
+const fdatasync = (fd) => new Promise((resolve, reject) => {
+  fs.fdatasync(fd, (err) => (err ? reject(err) : resolve()));
+});
+
+const ftruncate = (fd, length) => new Promise((resolve, reject) => {
+  fs.ftruncate(fd, length, (err) => (err ? reject(err) : resolve()));
+});
+
+/**
+ * Parses one NDJSON line of a segment, or returns null if it is not a record.
+ */
+const parseRecord = (line) => {
+  try {
+    const record = JSON.parse(line.toString('utf8'));
+    return record && Number.isInteger(record.seq) ? record : null;
+  } catch (err) {
+    return null;
+  }
+};
+
+/**
+ * fsyncs a directory, so the entries of files just created in it survive a crash.
+ */
+const fsyncDir = (dir) => new Promise((resolve, reject) => {
+  fs.open(dir, 'r', (openErr, fd) => {
+    if (openErr) {
+      reject(openErr);
+      return;
+    }
+    fs.fsync(fd, (syncErr) => {
+      fs.close(fd, () => (syncErr ? reject(syncErr) : resolve()));
+    });
+  });
+});
+
+class WriteAheadLog {
+  /**
+   * @param {Object} options
+   * @param {string} options.dir - Directory holding the segments and checkpoint.
+   * @param {number} [options.segmentBytes] - Roll to a new segment past this size.
+   * @param {number} [options.fsyncIntervalMs] - Group-commit window.
+   * @param {number} [options.checkpointIntervalMs] - How often the high-water mark is persisted.
+   */
+  constructor(options) {
+    this.dir = options.dir;
+    this.segmentBytes = options.segmentBytes || DEFAULT_SEGMENT_BYTES;
+    this.fsyncIntervalMs = options.fsyncIntervalMs || DEFAULT_FSYNC_INTERVAL_MS;
+    this.checkpointIntervalMs = options.checkpointIntervalMs || DEFAULT_CHECKPOINT_INTERVAL_MS;
+
+    this.segments = [];   // { firstSeq, lastSeq, file, bytes }, oldest first
+    this.fd = null;
+    // Set while the directory entry of the newest segment may not be durable yet
+    this.dirDirty = false;
+    this.nextSeq = 1;
+    this.committedSeq = 0;
+    this.checkpointedSeq = 0;
+
+    this.buffered = [];   // { line, resolve, reject } waiting for the next flush
+    this.flushTimer = null;
+    this.flushing = null;
+    this.checkpointTimer = null;
+
+    this.stats = { appends: 0, flushes: 0, failedFlushes: 0, dirSyncs: 0, bytesWritten: 0, corruptRecords: 0 };
+  }
+
+  /**
+   * Opens the log, recovering its state from disk.
+   *
+   * @returns {Array<{seq: number, event: Object}>} Records not yet committed, oldest first.
+   */
+  open() {
+    fs.mkdirSync(this.dir, { recursive: true });
+
+    const checkpointPath = path.join(this.dir, CHECKPOINT_FILE);
+    if (fs.existsSync(checkpointPath)) {
+      this.committedSeq = JSON.parse(fs.readFileSync(checkpointPath, 'utf8')).committedSeq || 0;
+    }
+    this.checkpointedSeq = this.committedSeq;
+    this.nextSeq = this.committedSeq + 1;
+
+    const pending = [];
+    const files = fs.readdirSync(this.dir)
+      .filter((file) => file.startsWith(SEGMENT_PREFIX) && file.endsWith(SEGMENT_SUFFIX))
+      .sort();
+    for (const file of files) {
+      const segment = this._recoverSegment(path.join(this.dir, file), pending);
+      if (segment) {
+        this.segments.push(segment);
+        this.nextSeq = Math.max(this.nextSeq, segment.lastSeq + 1);
+      }
+    }
+
+    this._openSegmentForAppend();
+    this._removeCommittedSegments();
+    this.checkpointTimer = setInterval(() => this._writeCheckpoint(), this.checkpointIntervalMs);
+    this.checkpointTimer.unref();
+    return pending;
+  }
+
+  /**
+   * Reads one segment back, collecting uncommitted records. A torn final line
+   * (crash mid-write) is truncated away; a corrupt line followed by others is
+   * skipped and counted, so the acknowledged records after it are kept.
+   */
+  _recoverSegment(file, pending) {
+    const content = fs.readFileSync(file);
+    let offset = 0;
+    let firstSeq = null;
+    let lastSeq = null;
+    while (offset < content.length) {
+      const newline = content.indexOf(0x0a, offset);
+      if (newline === -1) {
+        break;
+      }
+      const record = parseRecord(content.subarray(offset, newline));
+      if (!record) {
+        if (newline === content.length - 1) {
+          break;
+        }
+        console.warn(`WAL: skipping a corrupt record at byte ${offset} of ${file}`);
+        this.stats.corruptRecords++;
+        offset = newline + 1;
+        continue;
+      }
+      firstSeq = firstSeq === null ? record.seq : firstSeq;
+      lastSeq = record.seq;
+      if (record.seq > this.committedSeq) {
+        pending.push(record);
+      }
+      offset = newline + 1;
+    }
+    if (offset < content.length) {
+      console.warn(`WAL: truncating ${content.length - offset} torn bytes at the end of ${file}`);
+      fs.truncateSync(file, offset);
+    }
+    if (firstSeq === null) {
+      fs.unlinkSync(file);
+      return null;
+    }
+    return { firstSeq, lastSeq, file, bytes: offset };
+  }
+
+  _openSegmentForAppend() {
+    if (this.fd !== null) {
+      fs.closeSync(this.fd);
+    }
+    const file = path.join(this.dir, segmentName(this.nextSeq));
+    this.fd = fs.openSync(file, 'a');
+    this.dirDirty = true;
+    this.segments.push({ firstSeq: this.nextSeq, lastSeq: null, file, bytes: 0 });
+  }
+
+  /**
+   * Appends one event. Resolves with its sequence number once it is fsynced.
+   *
+   * @param {Object} event - Validated sensor event.
+   * @returns {Promise<number>} Sequence number assigned to the event.
+   */
+  append(event) {
+    const seq = this.nextSeq++;
+    const line = `${JSON.stringify({ seq, event })}\n`;
+    this.stats.appends++;
+    return new Promise((resolve, reject) => {
+      this.buffered.push({ seq, line, resolve, reject });
+      if (!this.flushTimer) {
+        this.flushTimer = setTimeout(() => this._flush(), this.fsyncIntervalMs);
+      }
+    });
+  }
+
+  /**
+   * Writes and fsyncs everything buffered as one group. Groups are flushed
+   * one at a time so segment order always matches sequence order.
+   */
+  async _flush() {
+    this.flushTimer = null;
+    while (this.flushing) {
+      await this.flushing.catch(() => {});
+    }
+    const group = this.buffered;
+    this.buffered = [];
+    if (group.length === 0) {
+      return;
+    }
+
+    const current = (async () => {
+      let segment = this.segments[this.segments.length - 1];
+      if (segment.bytes >= this.segmentBytes) {
+        this._openSegmentForAppend();
+        segment = this.segments[this.segments.length - 1];
+      }
+      const data = Buffer.from(group.map(({ line }) => line).join(''), 'utf8');
+      try {
+        await writeAll(this.fd, data);
+        await fdatasync(this.fd);
+        // A new segment's records are only durable once its directory entry is
+        if (this.dirDirty) {
+          this.dirDirty = false;
+          await fsyncDir(this.dir).catch((error) => {
+            this.dirDirty = true;
+            throw error;
+          });
+          this.stats.dirSyncs++;
+        }
+      } catch (error) {
+        this.stats.failedFlushes++;
+        await this._discardFailedWrite(segment);
+        throw error;
+      }
+
+      if (segment.lastSeq === null) {
+        segment.firstSeq = group[0].seq;
+      }
+      segment.lastSeq = group[group.length - 1].seq;
+      segment.bytes += data.length;
+      this.stats.flushes++;
+      this.stats.bytesWritten += data.length;
+    })();
+    this.flushing = current;
+
+    try {
+      await current;
+      group.forEach(({ seq, resolve }) => resolve(seq));
+    } catch (error) {
+      group.forEach(({ reject }) => reject(error));
+    } finally {
+      if (this.flushing === current) {
+        this.flushing = null;
+      }
+    }
+  }
+
+  /**
+   * Cuts the segment back to its last flushed byte after a failed flush, so
+   * the records of the next group do not follow a partial line (or records
+   * whose appends were rejected). If that fails too, the next group goes to a
+   * new segment and recovery truncates this one's torn tail.
+   */
+  async _discardFailedWrite(segment) {
+    try {
+      await ftruncate(this.fd, segment.bytes);
+    } catch (error) {
+      console.warn(`WAL: could not truncate ${segment.file} after a failed flush (${error.message}); rolling to a new segment`);
+      this._openSegmentForAppend();
+    }
+  }
+
+  /**
+   * Advances the committed high-water mark. Persisted on the next checkpoint.
+   */
+  markCommitted(seq) {
+    if (seq > this.committedSeq) {
+      this.committedSeq = seq;
+    }
+  }
+
+  _writeCheckpoint() {
+    if (this.committedSeq === this.checkpointedSeq) {
+      return;
+    }
+    const checkpointPath = path.join(this.dir, CHECKPOINT_FILE);
+    const tmpPath = `${checkpointPath}.tmp`;
+    fs.writeFileSync(tmpPath, JSON.stringify({ committedSeq: this.committedSeq, updatedAt: new Date().toISOString() }));
+    fs.renameSync(tmpPath, checkpointPath);
+    this.checkpointedSeq = this.committedSeq;
+    this._removeCommittedSegments();
+  }
+
+  /**
+   * Deletes closed segments whose records are all committed, or that hold
+   * none (left behind by a failed flush).
+   */
+  _removeCommittedSegments() {
+    while (this.segments.length > 1) {
+      const oldest = this.segments[0];
+      if (oldest.lastSeq !== null && oldest.lastSeq > this.checkpointedSeq) {
+        break;
+      }
+      fs.unlinkSync(oldest.file);
+      this.segments.shift();
+    }
+  }
+
+  getStatus() {
+    return {
+      lastAppendedSeq: this.nextSeq - 1,
+      committedSeq: this.committedSeq,
+      segments: this.segments.length,
+      ...this.stats
+    };
+  }
+
+  async close() {
+    clearTimeout(this.flushTimer);
+    clearInterval(this.checkpointTimer);
+    await this._flush();
+    this._writeCheckpoint();
+    if (this.fd !== null) {
+      fs.closeSync(this.fd);
+      this.fd = null;
+    }
+  }
+}
+
+module.exports = WriteAheadLog;
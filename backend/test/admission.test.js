@@ -0,0 +1,107 @@
+'use strict';
+
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const { TokenBuckets, PriorityQueue, classifyEvent } = require('../udp_receivers/admission');
+const LoadShedder = require('../src/services/loadShedder');
+
+test('token buckets allow a burst, then refill at the rate', () => {
+  const buckets = new TokenBuckets({ rate: 2, burst: 3 });
+  assert.deepEqual([1, 2, 3, 4].map(() => buckets.take('a', 0)), [true, true, true, false]);
+  assert.equal(buckets.take('a', 400), false);
+  assert.equal(buckets.take('a', 500), true);
+  assert.equal(buckets.take('a', 10000, 3), true);
+  assert.equal(buckets.take('a', 10000), false);
+  assert.deepEqual(buckets.getStats(), { rate: 2, burst: 3, newKeyRate: 100, tracked: 1, admitted: 5, limited: 3, overflowed: 0 });
+});
+
+test('a rate of 0 disables the limit', () => {
+  const buckets = new TokenBuckets({ rate: 0 });
+  for (let i = 0; i < 100; i++) {
+    assert.equal(buckets.take('a', 0), true);
+  }
+  assert.equal(buckets.buckets.size, 0);
+});
+
+test('keys past maxKeys or newKeyRate share the overflow bucket', () => {
+  const buckets = new TokenBuckets({ rate: 1, burst: 1, maxKeys: 2, newKeyRate: 0 });
+  assert.equal(buckets.take('a', 0), true);
+  assert.equal(buckets.take('b', 0), true);
+  assert.equal(buckets.take('c', 0), true);
+  assert.equal(buckets.take('d', 0), false);
+  assert.equal(buckets.getStats().overflowed, 2);
+
+  const slow = new TokenBuckets({ rate: 1, newKeyRate: 0.1 });
+  assert.equal(slow.take('a', 0), true);
+  assert.equal(slow.take('b', 0), true);
+  assert.equal(slow.take('c', 0), false);
+  assert.equal(slow.buckets.has('b'), false);
+  assert.equal(slow.buckets.size, 2);
+});
+
+test('sweep forgets idle buckets only', () => {
+  const buckets = new TokenBuckets({ rate: 1, idleMs: 1000 });
+  buckets.take('old', 0);
+  buckets.take('recent', 900);
+  buckets.sweep(1000);
+  assert.deepEqual([...buckets.buckets.keys()], ['recent']);
+});
+
+test('events are classed from their content', () => {
+  assert.equal(classifyEvent({ deviceType: 'cctv', eventType: 'motion_detected' }), 'alarm');
+  assert.equal(classifyEvent({ deviceType: 'cctv', eventType: 'reading' }), 'bulk');
+  assert.equal(classifyEvent({ deviceType: 'card_reader', eventType: 'swipe' }), 'access');
+  assert.equal(classifyEvent({ deviceType: 'co2_sensor', fields: { co2Level: 1000 } }), 'alarm');
+  assert.equal(classifyEvent({ deviceType: 'co2_sensor', metadata: 'co2Level:999; temperature:20' }), 'bulk');
+  assert.equal(classifyEvent({ deviceType: 'co2_sensor', metadata: 'co2Level:1500.5; temperature:20' }), 'alarm');
+  assert.equal(classifyEvent({ deviceType: 'co2_sensor', metadata: 'co2Level:800' }, 700), 'alarm');
+  assert.equal(classifyEvent({ deviceType: 'co2_sensor', metadata: 'temperature:20' }), 'bulk');
+  assert.equal(classifyEvent({ deviceType: 'printer', trace: { priority: 'alarm' } }), 'bulk');
+});
+
+test('the priority queue serves higher classes first, FIFO within a class', () => {
+  const queue = new PriorityQueue(10);
+  queue.push('bulk', 'b1');
+  queue.push('access', 'c1');
+  queue.push('bulk', 'b2');
+  queue.push('alarm', 'a1');
+  queue.push('access', 'c2');
+  const order = [];
+  while (queue.length > 0) {
+    order.push(queue.shift());
+  }
+  assert.deepEqual(order, ['a1', 'c1', 'c2', 'b1', 'b2']);
+  assert.equal(queue.shift(), undefined);
+});
+
+test('a full priority queue evicts the newest lowest item or refuses', () => {
+  const queue = new PriorityQueue(2);
+  assert.equal(queue.push('bulk', 'b1'), null);
+  assert.equal(queue.push('bulk', 'b2'), null);
+  assert.equal(queue.push('bulk', 'b3'), 'b3');
+  assert.equal(queue.push('alarm', 'a1'), 'b2');
+  assert.equal(queue.push('access', 'c1'), 'b1');
+  assert.equal(queue.push('access', 'c2'), 'c2');
+  assert.equal(queue.push('alarm', 'a2'), 'c1');
+  assert.equal(queue.length, 2);
+  const stats = queue.getStats();
+  assert.deepEqual(stats.bulk, { waiting: 0, queued: 2, evicted: 2, refused: 1 });
+  assert.deepEqual(stats.access, { waiting: 0, queued: 1, evicted: 1, refused: 1 });
+  assert.deepEqual(queue.drain('alarm'), ['a1', 'a2']);
+  assert.equal(queue.length, 0);
+});
+
+test('the load shedder refuses bulk events over the threshold, whatever their trace claims', () => {
+  let backlog = 0;
+  const shedder = new LoadShedder(() => backlog, { threshold: 10, co2AlarmPpm: 1200 });
+  const bulk = { deviceType: 'printer', trace: { priority: 'alarm' } };
+  assert.equal(shedder.admit(bulk), true);
+  backlog = 10;
+  assert.equal(shedder.admit(bulk), false);
+  assert.equal(shedder.admit({ deviceType: 'co2_sensor', metadata: 'co2Level:1100' }), false);
+  assert.equal(shedder.admit({ deviceType: 'co2_sensor', metadata: 'co2Level:1200' }), true);
+  assert.equal(shedder.admit({ deviceType: 'card_reader' }), true);
+  assert.deepEqual(shedder.getStats(), {
+    threshold: 10, backlog: 10, shedding: true, shedEvents: 2, urgentWhileShedding: 2, lastShedAt: shedder.stats.lastShedAt
+  });
+});
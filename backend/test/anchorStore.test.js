@@ -0,0 +1,46 @@
+'use strict';
+
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const AnchorStore = require('../src/services/anchorStore');
+const { leafHash } = require('../src/services/merkle');
+
+const event = (co2Level) => ({
+  eventID: 'sensor_03_7_001',
+  deviceType: 'co2_sensor',
+  deviceID: 'sensor_03',
+  timestamp: '2025-03-14T20:10:00Z',
+  eventType: 'reading',
+  location: 'Building C - Lab',
+  metadata: `co2Level:${co2Level}; temperature:21`
+});
+
+test('the same event is a duplicate, another one under its eventID a conflict', async (t) => {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'anchor-store-test-'));
+  t.after(() => fs.rmSync(dir, { recursive: true, force: true }));
+  const store = new AnchorStore({ dir, fsyncIntervalMs: 1 });
+  store.open();
+
+  const first = await store.append(event(700));
+  assert.deepEqual(first, { hash: leafHash(event(700)), duplicate: false });
+  // Resent, with its keys in another order
+  const { metadata, ...rest } = event(700);
+  assert.deepEqual(await store.append({ metadata, ...rest }), { hash: first.hash, duplicate: true });
+  await assert.rejects(store.append(event(900)), (error) => error.conflict === true &&
+    /sensor_03_7_001 is already stored with different content/.test(error.message));
+  await store.close();
+
+  // The eventIDs are recovered with their hashes
+  const reopened = new AnchorStore({ dir, fsyncIntervalMs: 1 });
+  reopened.open();
+  t.after(() => reopened.close());
+  assert.deepEqual(await reopened.append(event(700)), { hash: first.hash, duplicate: true });
+  await assert.rejects(reopened.append(event(900)), { message: /different content/ });
+  const status = reopened.getStatus();
+  assert.equal(status.events, 1);
+  assert.equal(status.duplicates, 1);
+  assert.equal(status.conflicts, 1);
+});
@@ -0,0 +1,77 @@
+'use strict';
+
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { encodeChunk, readChunkHeader, readChunkColumns, readChunkRows, valueAt } = require('../src/services/archiveChunks');
+
+const DAY = Date.parse('2025-03-14T00:00:00Z');
+
+const row = (deviceID, minute, metadata) => ({
+  time: DAY + minute * 60000,
+  eventID: `${deviceID}_${minute}`,
+  deviceID,
+  eventType: 'reading',
+  location: minute % 2 === 0 ? 'Library' : null,
+  metadata
+});
+
+const writeChunk = (t, rows, info) => {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'chunk-test-'));
+  t.after(() => fs.rmSync(dir, { recursive: true, force: true }));
+  const file = path.join(dir, 'chunk-0000000001.col');
+  fs.writeFileSync(file, encodeChunk(rows, info));
+  return file;
+};
+
+test('a chunk reads back the rows it was written with, grouped by device and time', (t) => {
+  const rows = [
+    row('sensor_02', 5, { co2Level: 410, temperature: 21.5 }),
+    row('sensor_01', 3, { co2Level: 1200, temperature: -2 }),
+    row('sensor_02', 1, { co2Level: 400 }),
+    row('sensor_01', 0, { co2Level: 405, temperature: 20, note: 'recalibrated' })
+  ];
+  const expected = [rows[3], rows[1], rows[2], rows[0]].map((r) => ({ ...r, metadata: { ...r.metadata } }));
+  const file = writeChunk(t, rows.slice(), { seq: 1, firstBlock: 7, lastBlock: 9, rawBytes: 1000, replaces: [] });
+
+  const header = readChunkHeader(file);
+  assert.equal(header.rows, 4);
+  assert.equal(header.minTime, DAY);
+  assert.equal(header.maxTime, DAY + 5 * 60000);
+  assert.deepEqual([header.seq, header.firstBlock, header.lastBlock, header.rawBytes], [1, 7, 9, 1000]);
+  assert.deepEqual(header.series.map(({ deviceID, start, rows: count }) => [deviceID, start, count]),
+    [['sensor_01', 0, 2], ['sensor_02', 2, 2]]);
+  assert.deepEqual(readChunkRows(file, header), expected);
+});
+
+test('numeric columns carry zone map stats and string fields stay strings', (t) => {
+  const rows = [
+    row('light_01', 0, { brightness: 80, mode: 'auto' }),
+    row('light_01', 1, { brightness: 20, mode: 'manual' }),
+    ...Array.from({ length: 10 }, (_, i) => row('light_01', i + 2, { mode: 'auto' }))
+  ];
+  const header = readChunkHeader(writeChunk(t, rows, { seq: 1, firstBlock: 0, lastBlock: 0, rawBytes: 0 }));
+  const brightness = header.columns.find((column) => column.name === 'metadata.brightness');
+  assert.equal(brightness.encoding, 'float');
+  assert.deepEqual(brightness.stats, { count: 2, sum: 100, min: 20, max: 80 });
+  assert.equal(header.columns.find((column) => column.name === 'metadata.mode').encoding, 'dict');
+});
+
+test('only the requested columns are read', (t) => {
+  const rows = Array.from({ length: 50 }, (_, i) => row('printer_1', i, { pagesPrinted: i }));
+  const file = writeChunk(t, rows, { seq: 1, firstBlock: 0, lastBlock: 0, rawBytes: 0 });
+  const header = readChunkHeader(file);
+  const columns = readChunkColumns(file, header, ['metadata.pagesPrinted', 'missing']);
+  assert.deepEqual(Object.keys(columns), ['metadata.pagesPrinted']);
+  assert.equal(valueAt(columns['metadata.pagesPrinted'], 49), 49);
+});
+
+test('a file that is not a chunk is refused', (t) => {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'chunk-test-'));
+  t.after(() => fs.rmSync(dir, { recursive: true, force: true }));
+  const file = path.join(dir, 'chunk-0000000001.col');
+  fs.writeFileSync(file, 'not a chunk file');
+  assert.throws(() => readChunkHeader(file));
+});
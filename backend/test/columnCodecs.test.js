@@ -0,0 +1,47 @@
+'use strict';
+
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const codecs = require('../src/services/columnCodecs');
+
+const DAY = Date.parse('2025-03-14T00:00:00Z');
+
+const roundTrip = (encode, decode, values) => decode(encode(values), values.length);
+
+test('timestamps round-trip sorted, jittered and unsorted', () => {
+  const regular = Array.from({ length: 1440 }, (_, i) => DAY + i * 60000);
+  const jittered = regular.map((time, i) => time + ((i * 7919) % 250));
+  const unsorted = [DAY + 5000, DAY, DAY + 86399999, DAY + 1, DAY + 1];
+  for (const times of [regular, jittered, unsorted, [DAY], []]) {
+    assert.deepEqual(Array.from(roundTrip(codecs.encodeTimestamps, codecs.decodeTimestamps, times)), times);
+  }
+});
+
+test('regular timestamps cost about a bit per row', () => {
+  const times = Array.from({ length: 1440 }, (_, i) => DAY + i * 60000);
+  assert.ok(codecs.encodeTimestamps(times).length < 1440 / 8 + 16);
+});
+
+test('floats round-trip exactly, NaN included', () => {
+  const values = [400, 400, 401.5, -3, 0, -0, 1e-300, 1.7976931348623157e308, NaN, 412.25, 412.25, Number.MIN_VALUE];
+  const decoded = roundTrip(codecs.encodeFloats, codecs.decodeFloats, Float64Array.from(values));
+  assert.equal(decoded.length, values.length);
+  values.forEach((value, i) => assert.ok(Object.is(decoded[i], value), `value ${i}: ${decoded[i]} !== ${value}`));
+});
+
+test('repeated floats compress', () => {
+  const values = Float64Array.from({ length: 1000 }, (_, i) => 400 + (i % 3));
+  assert.ok(codecs.encodeFloats(values).length < values.length * 2);
+});
+
+test('dictionary strings round-trip with missing values', () => {
+  const values = ['reading', null, 'reading', 'motion_detected', undefined, 'Library', 'reading', ''];
+  const { dictionary, codes } = roundTrip(codecs.encodeDictionary, codecs.decodeDictionary, values);
+  assert.equal(dictionary[0], null);
+  assert.deepEqual(Array.from(codes, (code) => dictionary[code]), values.map((value) => value ?? null));
+});
+
+test('prefix-coded strings round-trip with missing and multibyte values', () => {
+  const values = ['sensor_001', 'sensor_002', 'sensor_0021', null, 'sensor_010', 'Gebäude_β', 'Gebäude_γ', '', undefined, 'x'];
+  assert.deepEqual(roundTrip(codecs.encodePrefixed, codecs.decodePrefixed, values), values.map((value) => value ?? null));
+});
@@ -0,0 +1,42 @@
+'use strict';
+
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const LedgerDrainer = require('../src/services/ledgerDrainer');
+
+test('only created events count as committed', async (t) => {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'drainer-test-'));
+  t.after(() => fs.rmSync(dir, { recursive: true, force: true }));
+  const wal = { dir, committedSeq: 0, markCommitted(seq) { this.committedSeq = seq; } };
+  let settle;
+  const settled = new Promise((resolve) => { settle = resolve; });
+  const drainer = new LedgerDrainer(wal, async (events) => {
+    setImmediate(settle);
+    assert.deepEqual(events.map(({ eventID }) => eventID), ['a', 'b', 'c', 'd']);
+    return {
+      created: ['a'],
+      skipped: ['b'],
+      conflicts: [{ eventID: 'c', error: 'The event c already exists with different content' }],
+      rejected: [{ eventID: 'd', error: 'Invalid timestamp "yesterday"' }]
+    };
+  });
+
+  drainer.start(['a', 'b', 'c', 'd'].map((eventID, i) => ({ seq: i + 1, event: { eventID } })));
+  await settled;
+
+  const status = drainer.getStatus();
+  assert.equal(status.committedEvents, 1);
+  assert.equal(status.skippedEvents, 1);
+  assert.equal(status.conflictingEvents, 1);
+  assert.equal(status.rejectedEvents, 1);
+  assert.equal(status.deadLettered, 0);
+  assert.equal(status.backlog, 0);
+  assert.equal(wal.committedSeq, 4);
+
+  const deadLetters = fs.readFileSync(path.join(dir, 'dead-letter.ndjson'), 'utf8').trim().split('\n').map(JSON.parse);
+  assert.deepEqual(deadLetters.map(({ seq, error }) => [seq, error]),
+    [[3, 'The event c already exists with different content']]);
+});
@@ -0,0 +1,48 @@
+'use strict';
+
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const crypto = require('crypto');
+const { canonicalJSON, leafHash, buildLevels, merkleRoot, merkleProof, rootFromProof } = require('../src/services/merkle');
+
+const sha256 = (...parts) => crypto.createHash('sha256').update(Buffer.concat(parts)).digest('hex');
+const event = (i) => ({ eventID: `sensor_${i}`, deviceID: 'sensor_01', metadata: { co2Level: 400 + i } });
+
+test('canonical JSON sorts keys at every level and drops undefined', () => {
+  assert.equal(canonicalJSON({ b: 1, a: { d: [2, { f: 1, e: null }], c: undefined } }),
+    '{"a":{"d":[2,{"e":null,"f":1}]},"b":1}');
+  assert.equal(leafHash({ a: 1, b: 2 }), leafHash({ b: 2, a: 1 }));
+});
+
+test('leaves and nodes are hashed with distinct prefixes', () => {
+  const leaves = [event(1), event(2)].map(leafHash);
+  assert.equal(leaves[0], sha256(Buffer.from([0]), Buffer.from(canonicalJSON(event(1)))));
+  assert.equal(merkleRoot(leaves), sha256(Buffer.from([1]), Buffer.from(leaves[0], 'hex'), Buffer.from(leaves[1], 'hex')));
+});
+
+test('a single leaf is its own root', () => {
+  const leaf = leafHash(event(1));
+  assert.equal(merkleRoot([leaf]), leaf);
+  assert.deepEqual(merkleProof(buildLevels([leaf]), 0), []);
+});
+
+test('every leaf proves against the root, odd levels included', () => {
+  for (const size of [2, 3, 5, 7, 8, 13]) {
+    const leaves = Array.from({ length: size }, (_, i) => leafHash(event(i)));
+    const levels = buildLevels(leaves);
+    const root = levels[levels.length - 1][0];
+    leaves.forEach((leaf, i) => {
+      assert.equal(rootFromProof(leaf, merkleProof(levels, i)), root, `leaf ${i} of ${size}`);
+    });
+  }
+});
+
+test('a proof does not hold for another event or a tampered path', () => {
+  const leaves = Array.from({ length: 5 }, (_, i) => leafHash(event(i)));
+  const levels = buildLevels(leaves);
+  const root = merkleRoot(leaves);
+  const proof = merkleProof(levels, 2);
+  assert.notEqual(rootFromProof(leafHash(event(9)), proof), root);
+  assert.notEqual(rootFromProof(leaves[2], proof.map((step) => ({ ...step, side: step.side === 'left' ? 'right' : 'left' }))), root);
+  assert.notEqual(rootFromProof(leaves[2], proof.slice(1)), root);
+});
@@ -0,0 +1,43 @@
+'use strict';
+
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const MoteClocks = require('../udp_receivers/mote_clock');
+
+// Whole ms; the offset relaxes by 1 ms per 10 s (DRIFT_PPM)
+const sentAt = (clocks, ...args) => Math.round(clocks.toWallClock('sensor_01', ...args));
+
+test('the fastest datagram defines the offset', () => {
+  const clocks = new MoteClocks();
+  assert.equal(sentAt(clocks, 10000, 1000500, 7), 1000500);
+  // Crossed faster: the offset moves down
+  assert.equal(sentAt(clocks, 20000, 1010200, 7), 1010200);
+  // Queued for about 300 ms on the way
+  assert.equal(sentAt(clocks, 30000, 1020500, 7), 1020201);
+});
+
+test('reordered datagrams of the same boot do not reset the offset', () => {
+  const clocks = new MoteClocks();
+  sentAt(clocks, 30000, 1030000, 7);
+  // Sent before the last one, delayed 2 s in the mesh
+  assert.equal(sentAt(clocks, 29000, 1031000, 7), 1029000);
+  assert.equal(sentAt(clocks, 31000, 1031000, 7), 1031000);
+});
+
+test('a new boot id resets the offset, and stragglers keep the old one', () => {
+  const clocks = new MoteClocks();
+  sentAt(clocks, 600000, 2000000, 7);
+  // Rebooted: the clock starts over, 500 ms after boot
+  assert.equal(sentAt(clocks, 500, 2010000, 8), 2010000);
+  assert.equal(sentAt(clocks, 1500, 2011200, 8), 2011000);
+  // Sent by the previous boot, arriving late
+  assert.equal(sentAt(clocks, 605000, 2011500, 7), 2005000);
+  assert.equal(sentAt(clocks, 2500, 2012000, 8), 2012000);
+});
+
+test('without a boot id only a large backwards jump is a reboot', () => {
+  const clocks = new MoteClocks();
+  sentAt(clocks, 600000, 2000000);
+  assert.equal(sentAt(clocks, 590000, 2000500), 1990000);
+  assert.equal(sentAt(clocks, 500, 2010000), 2010000);
+});
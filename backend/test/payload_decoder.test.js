@@ -0,0 +1,82 @@
+'use strict';
+
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const { decodeBinary, decodeDatagram, decodePayload, peekDeviceIDs } = require('../udp_receivers/payload_decoder');
+
+const receivedAt = new Date('2025-03-14T20:00:00Z');
+
+// co2_sensor, reading, device 3, Building C - Lab, counter 300,
+// co2Level 1200, temperature -3 (zigzag), boot id 183, mote clock 1000 ms
+const CO2_RECORD = Buffer.from([
+  0xb1, 5, 1, 3, 5, 0xac, 0x02,
+  0x08, 0xb0, 0x09,
+  0x11, 0x05,
+  0x70, 0xb7, 0x01,
+  0x78, 0xe8, 0x07
+]);
+
+const batch = (...records) => Buffer.concat([
+  Buffer.from([0xb2, records.length]),
+  ...records.map((record) => Buffer.concat([Buffer.from([record.length]), record]))
+]);
+
+test('decodes a binary record into the API event', () => {
+  assert.deepEqual(decodeBinary(CO2_RECORD, receivedAt), {
+    eventID: 'sensor_03_183_300',
+    deviceType: 'co2_sensor',
+    deviceID: 'sensor_03',
+    timestamp: '2025-03-14T20:00:00.000Z',
+    eventType: 'reading',
+    location: 'Building C - Lab',
+    metadata: 'co2Level:1200; temperature:-3',
+    fields: { co2Level: 1200, temperature: -3 },
+    trace: { moteTime: 1000 }
+  });
+});
+
+test('eventIDs tell devices and boots apart', () => {
+  const record = (deviceNum, bootID) => Buffer.from([0xb1, 1, 2, deviceNum, 1, 7, 0x70, bootID]);
+  assert.equal(decodeBinary(record(1, 5)).eventID, 'cctv_1_5_007');
+  assert.equal(decodeBinary(record(2, 5)).eventID, 'cctv_2_5_007');
+  assert.equal(decodeBinary(record(1, 6)).eventID, 'cctv_1_6_007');
+  // Motes that send no boot id
+  assert.equal(decodeBinary(Buffer.from([0xb1, 1, 2, 1, 1, 7])).eventID, 'cctv_1_007');
+});
+
+test('rejects unknown codes and truncated varints', () => {
+  assert.throws(() => decodeBinary(Buffer.from([0xb1, 9, 1, 0, 0, 0])), /device type code 9/);
+  assert.throws(() => decodeBinary(Buffer.from([0xb1, 5, 9, 0, 0, 0])), /event type code 9/);
+  assert.throws(() => decodeBinary(Buffer.from([0xb1, 5, 1, 3, 5, 0xac])), /Truncated/);
+  assert.throws(() => decodeBinary(Buffer.from([0xb1, 5, 1, 3, 5, 1, 0x0a, 1])), /wire type 2/);
+});
+
+test('decodes JSON payloads, moving moteTime to the trace', () => {
+  const event = decodePayload(Buffer.from('{"eventID":"cctv_001","deviceID":"cam_1","moteTime":42}'), receivedAt);
+  assert.deepEqual(event, {
+    eventID: 'cctv_001',
+    deviceID: 'cam_1',
+    timestamp: '2025-03-14T20:00:00.000Z',
+    trace: { moteTime: 42 }
+  });
+});
+
+test('unpacks batches of binary and JSON records', () => {
+  const json = Buffer.from('{"eventID":"card_001","deviceID":"reader_01","timestamp":"2025-01-01T00:00:00Z"}');
+  const events = decodeDatagram(batch(CO2_RECORD, json), receivedAt);
+  assert.deepEqual(events.map((event) => event.eventID), ['sensor_03_183_300', 'card_001']);
+  assert.equal(events[1].timestamp, '2025-01-01T00:00:00Z');
+});
+
+test('rejects batches that overrun the datagram', () => {
+  const full = batch(CO2_RECORD);
+  assert.throws(() => decodeDatagram(full.subarray(0, full.length - 1)), /overruns/);
+  assert.throws(() => decodeDatagram(Buffer.from([0xb2, 2, 2, 0x7b, 0x7d])), /truncated after 1 of 2/);
+});
+
+test('peeks device IDs without decoding', () => {
+  const json = Buffer.from('{"eventID":"x", "deviceID" : "light_07"}');
+  const escaped = Buffer.from('{"deviceID":"a\\"b"}');
+  assert.deepEqual(peekDeviceIDs(batch(CO2_RECORD, json, escaped)), ['sensor_03', 'light_07', null]);
+  assert.deepEqual(peekDeviceIDs(Buffer.from([0xb1, 9, 1, 3])), [null]);
+});
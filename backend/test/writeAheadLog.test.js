@@ -0,0 +1,87 @@
+'use strict';
+
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const WriteAheadLog = require('../src/services/writeAheadLog');
+
+const tempDir = (t) => {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'wal-test-'));
+  t.after(() => fs.rmSync(dir, { recursive: true, force: true }));
+  return dir;
+};
+
+const line = (seq) => `${JSON.stringify({ seq, event: { eventID: `sensor_01_1_${seq}` } })}\n`;
+
+const segmentFiles = (dir) => fs.readdirSync(dir).filter((file) => file.startsWith('segment-')).sort();
+
+/**
+ * Replaces fs[name] until the returned function is called.
+ */
+const stub = (t, name, replacement) => {
+  const original = fs[name];
+  fs[name] = replacement(original);
+  const restore = () => { fs[name] = original; };
+  t.after(restore);
+  return restore;
+};
+
+test('recovery skips a corrupt middle record and truncates a torn final line', async (t) => {
+  const dir = tempDir(t);
+  const file = path.join(dir, 'segment-0000000000000001.log');
+  const kept = line(1) + line(2) + '{"seq":3,"eve\n' + line(4);
+  fs.writeFileSync(file, `${kept}{"seq":5,"event":{"eventI`);
+  fs.writeFileSync(path.join(dir, 'checkpoint.json'), JSON.stringify({ committedSeq: 1 }));
+
+  const wal = new WriteAheadLog({ dir });
+  const pending = wal.open();
+  t.after(() => wal.close());
+  assert.deepEqual(pending.map(({ seq }) => seq), [2, 4]);
+  assert.equal(fs.readFileSync(file, 'utf8'), kept);
+  assert.equal(wal.getStatus().corruptRecords, 1);
+  assert.equal(wal.getStatus().lastAppendedSeq, 4);
+});
+
+test('a failed flush is cut off before the next group is written', async (t) => {
+  const dir = tempDir(t);
+  const wal = new WriteAheadLog({ dir, fsyncIntervalMs: 1 });
+  wal.open();
+
+  const restore = stub(t, 'fdatasync', () => (fd, callback) => callback(new Error('EIO')));
+  await assert.rejects(wal.append({ eventID: 'lost' }), /EIO/);
+  restore();
+  assert.equal(await wal.append({ eventID: 'kept' }), 2);
+  await wal.close();
+
+  const reopened = new WriteAheadLog({ dir });
+  const pending = reopened.open();
+  await reopened.close();
+  assert.deepEqual(pending.map(({ seq, event }) => [seq, event.eventID]), [[2, 'kept']]);
+  assert.equal(reopened.getStatus().corruptRecords, 0);
+});
+
+test('a failed flush that cannot be cut off rolls to a new segment', async (t) => {
+  const dir = tempDir(t);
+  const wal = new WriteAheadLog({ dir, fsyncIntervalMs: 1 });
+  wal.open();
+
+  // Half the group reaches the file, then the disk fails
+  const restoreWrite = stub(t, 'write', (write) => (fd, buffer, offset, length, position, callback) =>
+    write(fd, buffer, offset, Math.floor(length / 2), position, () => callback(new Error('EIO'))));
+  const restoreTruncate = stub(t, 'ftruncate', () => (fd, length, callback) => callback(new Error('EIO')));
+  await assert.rejects(wal.append({ eventID: 'lost' }), /EIO/);
+  restoreWrite();
+  restoreTruncate();
+  assert.equal(await wal.append({ eventID: 'kept' }), 2);
+  assert.equal(segmentFiles(dir).length, 2);
+  await wal.close();
+
+  const reopened = new WriteAheadLog({ dir });
+  const pending = reopened.open();
+  await reopened.close();
+  assert.deepEqual(pending.map(({ seq, event }) => [seq, event.eventID]), [[2, 'kept']]);
+  // The torn segment held no record and is gone
+  assert.equal(segmentFiles(dir).includes('segment-0000000000000001.log'), false);
+});
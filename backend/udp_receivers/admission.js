@@ -0,0 +1,214 @@
+'use strict';
+
+// Admission control for the ingestion gateway (see ingest_gateway.js).
+// Token buckets, per source address and per device, turn a flood into drops
+// before anything is decoded; the forward queue then decides which of the
+// admitted events get the limited HTTP slots to the backend: alarms first,
+// access events next, bulk readings last, and bulk readings are the ones
+// evicted once the queue is full.
+
+// Event classes, highest priority first
+const PRIORITIES = ['alarm', 'access', 'bulk'];
+
+// Keys beyond maxKeys, or first seen faster than newKeyRate, share one
+// bucket: spoofed sources and made-up devices cannot grow the map, nor each
+// get a bucket of their own
+const OVERFLOW_KEY = '\0overflow';
+const DEFAULT_MAX_KEYS = 10000;
+const DEFAULT_NEW_KEY_RATE = 100;
+// Buckets untouched this long are forgotten (cf. IDLE_SOURCE_MS in link_tracker.js)
+const DEFAULT_IDLE_MS = 10 * 60 * 1000;
+// Matches CO2_ALARM_PPM in cooja-simulation/sensors/co2sensor.c
+const DEFAULT_CO2_ALARM_PPM = 1000;
+
+const CO2_LEVEL = /co2Level:\s*(-?\d+(?:\.\d+)?)/;
+
+class TokenBuckets {
+  /**
+   * @param {Object} options
+   * @param {number} options.rate - Tokens added per second; 0 disables the limit.
+   * @param {number} [options.burst] - Bucket size (default: one second of rate).
+   * @param {number} [options.maxKeys] - Buckets kept before new keys share the overflow bucket.
+   * @param {number} [options.newKeyRate] - Keys per second given a bucket of their own, with
+   *   a burst of ten seconds' worth; 0 gives every key one.
+   * @param {number} [options.idleMs] - Buckets unused this long are dropped by sweep().
+   */
+  constructor({ rate, burst, maxKeys = DEFAULT_MAX_KEYS, newKeyRate = DEFAULT_NEW_KEY_RATE, idleMs = DEFAULT_IDLE_MS }) {
+    this.rate = rate;
+    this.burst = burst || rate;
+    this.maxKeys = maxKeys;
+    this.newKeyRate = newKeyRate;
+    this.newKeyBurst = newKeyRate * 10;
+    this.idleMs = idleMs;
+    this.buckets = new Map();
+    this.newKeys = { tokens: this.newKeyBurst, updatedAt: 0 };
+    this.stats = { admitted: 0, limited: 0, overflowed: 0 };
+  }
+
+  get enabled() {
+    return this.rate > 0;
+  }
+
+  /**
+   * Takes `cost` tokens from the bucket of `key`.
+   *
+   * @returns {boolean} false if the bucket holds fewer tokens than that.
+   */
+  take(key, now, cost = 1) {
+    if (!this.enabled) {
+      return true;
+    }
+    let bucket = this.buckets.get(key);
+    if (!bucket) {
+      if (this.buckets.size >= this.maxKeys || !this._admitNewKey(now)) {
+        this.stats.overflowed++;
+        key = OVERFLOW_KEY;
+        bucket = this.buckets.get(key);
+      }
+      if (!bucket) {
+        bucket = { tokens: this.burst, updatedAt: now };
+        this.buckets.set(key, bucket);
+      }
+    }
+    bucket.tokens = Math.min(this.burst, bucket.tokens + ((now - bucket.updatedAt) / 1000) * this.rate);
+    bucket.updatedAt = now;
+    if (bucket.tokens < cost) {
+      this.stats.limited++;
+      return false;
+    }
+    bucket.tokens -= cost;
+    this.stats.admitted++;
+    return true;
+  }
+
+  _admitNewKey(now) {
+    if (!(this.newKeyRate > 0)) {
+      return true;
+    }
+    const { newKeys } = this;
+    newKeys.tokens = Math.min(this.newKeyBurst, newKeys.tokens + ((now - newKeys.updatedAt) / 1000) * this.newKeyRate);
+    newKeys.updatedAt = now;
+    if (newKeys.tokens < 1) {
+      return false;
+    }
+    newKeys.tokens--;
+    return true;
+  }
+
+  /**
+   * Forgets buckets unused for idleMs. Keys seen recently keep their bucket,
+   * so a flood of new keys does not push known devices into the overflow one.
+   */
+  sweep(now) {
+    for (const [key, bucket] of this.buckets) {
+      if (now - bucket.updatedAt >= this.idleMs) {
+        this.buckets.delete(key);
+      }
+    }
+  }
+
+  getStats() {
+    return { rate: this.rate, burst: this.burst, newKeyRate: this.newKeyRate, tracked: this.buckets.size, ...this.stats };
+  }
+}
+
+/**
+ * Class of a decoded event: 'alarm' for CO2 readings at or above the alarm
+ * level and CCTV motion, 'access' for card reader events, 'bulk' otherwise.
+ * The firmwares already flush their batches early for the same events
+ * (sensor-batch.h).
+ */
+function classifyEvent(event, co2AlarmPpm = DEFAULT_CO2_ALARM_PPM) {
+  switch (event.deviceType) {
+    case 'cctv':
+      return event.eventType === 'motion_detected' ? 'alarm' : 'bulk';
+    case 'card_reader':
+      return 'access';
+    case 'co2_sensor': {
+      let level = event.fields ? event.fields.co2Level : undefined;
+      if (level === undefined && typeof event.metadata === 'string') {
+        const match = CO2_LEVEL.exec(event.metadata);
+        level = match ? Number(match[1]) : undefined;
+      }
+      return level >= co2AlarmPpm ? 'alarm' : 'bulk';
+    }
+    default:
+      return 'bulk';
+  }
+}
+
+/**
+ * Bounded queue of items tagged with a class of PRIORITIES, first in first
+ * out within a class. When full, an item of a higher class evicts the newest
+ * item of the lowest class queued; an item of the lowest class is refused.
+ */
+class PriorityQueue {
+  constructor(capacity) {
+    this.capacity = capacity;
+    this.queues = new Map(PRIORITIES.map((priority) => [priority, []]));
+    this.length = 0;
+    this.stats = Object.fromEntries(PRIORITIES.map((priority) => [priority, { queued: 0, evicted: 0, refused: 0 }]));
+  }
+
+  /**
+   * @returns {Object|null} The item that did not fit (the new one or an
+   *   evicted one), or null if nothing was lost.
+   */
+  push(priority, item) {
+    let lost = null;
+    if (this.length >= this.capacity) {
+      const rank = PRIORITIES.indexOf(priority);
+      const lowest = PRIORITIES.findLastIndex((candidate) => this.queues.get(candidate).length > 0);
+      if (lowest <= rank) {
+        this.stats[priority].refused++;
+        return item;
+      }
+      lost = this.queues.get(PRIORITIES[lowest]).pop();
+      this.stats[PRIORITIES[lowest]].evicted++;
+      this.length--;
+    }
+    this.queues.get(priority).push(item);
+    this.stats[priority].queued++;
+    this.length++;
+    return lost;
+  }
+
+  /**
+   * Removes and returns the oldest item of the highest class, or undefined.
+   */
+  shift() {
+    for (const queue of this.queues.values()) {
+      if (queue.length > 0) {
+        this.length--;
+        return queue.shift();
+      }
+    }
+    return undefined;
+  }
+
+  /**
+   * Removes every queued item of a class, e.g. when it is being shed.
+   */
+  drain(priority) {
+    const items = this.queues.get(priority);
+    this.queues.set(priority, []);
+    this.length -= items.length;
+    return items;
+  }
+
+  getStats() {
+    const stats = { capacity: this.capacity, length: this.length };
+    for (const [priority, queue] of this.queues) {
+      stats[priority] = { waiting: queue.length, ...this.stats[priority] };
+    }
+    return stats;
+  }
+}
+
+module.exports = {
+  PRIORITIES,
+  DEFAULT_CO2_ALARM_PPM,
+  TokenBuckets,
+  PriorityQueue,
+  classifyEvent
+};
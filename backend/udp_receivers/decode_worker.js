@@ -0,0 +1,26 @@
+'use strict';
+
+// Worker thread used by ingest_gateway.js: decodes datagrams off the main
+// event loop so socket reads and forwarding are never blocked by parsing.
+
+const { parentPort } = require('worker_threads');
+const { decodeDatagram } = require('./payload_decoder');
+
+parentPort.on('message', ({ id, port, deviceType, payload, receivedAt, source }) => {
+  try {
+    const events = decodeDatagram(Buffer.from(payload), new Date(receivedAt));
+    // Per-device-type check: each port only accepts its own device type
+    const accepted = events.filter((event) => event.deviceType === deviceType);
+    parentPort.postMessage({
+      id,
+      port,
+      source,
+      receivedAt,
+      decodedAt: Date.now(),
+      events: accepted,
+      rejected: events.length - accepted.length
+    });
+  } catch (decodeError) {
+    parentPort.postMessage({ id, port, error: decodeError.message });
+  }
+});
@@ -0,0 +1,25 @@
+'use strict';
+
+// Event deduplication store shared by several ingestion gateways (see
+// dedup_store.js). Run one per deployment and point every gateway at it with
+// INGEST_DEDUP_URL=http://<host>:8870.
+
+const { DedupStore, createDedupServer, DEFAULT_TTL_MS } = require('./dedup_store');
+
+const PORT = Number(process.env.DEDUP_PORT || 8870);
+const HOST = process.env.DEDUP_HOST || '::';
+const TTL_MS = Number(process.env.DEDUP_TTL_MS || DEFAULT_TTL_MS);
+
+const store = new DedupStore({ ttlMs: TTL_MS });
+const server = createDedupServer(store);
+
+server.listen(PORT, HOST, () => {
+  console.log(`[Dedup] Store listening on [${HOST}]:${PORT}, keys kept ${TTL_MS / 1000}s`);
+});
+
+function shutdown(signal) {
+  console.log(`[Dedup] Received ${signal}. Shutting down store...`);
+  server.close(() => process.exit(0));
+}
+process.on('SIGINT', () => shutdown('SIGINT'));
+process.on('SIGTERM', () => shutdown('SIGTERM'));
@@ -0,0 +1,192 @@
+'use strict';
+
+// Event deduplication shared by ingestion gateways.
+// Motes can report to several sinks (sensor-sink.h), and each sink has its own
+// gateway, so one event may reach more than one gateway: when a mote changes
+// sinks, or when a gateway restarts and loses its link state. Every gateway
+// claims the (device, sequence) key of each event before forwarding it and
+// only the first claim wins, so the ledger never sees an event twice.
+//
+// DedupStore keeps the keys in process, for a single gateway or as the store
+// served by dedup_server.js; RemoteDedupStore is the client the gateways use
+// to share one. Keys are remembered for at least ttlMs (at most twice that).
+
+const http = require('http');
+
+const DEFAULT_TTL_MS = 10 * 60 * 1000;
+const REMOTE_TIMEOUT_MS = 1000;
+
+/**
+ * Key of an event: device, event counter and, since the counter restarts
+ * when a mote reboots, the mote clock of the reading.
+ */
+function dedupKey(event) {
+  const moteTime = event.trace && event.trace.moteTime !== undefined ? event.trace.moteTime : '';
+  return `${event.deviceID}/${event.eventID}/${moteTime}`;
+}
+
+class DedupStore {
+  constructor({ ttlMs = DEFAULT_TTL_MS } = {}) {
+    this.ttlMs = ttlMs;
+    // Two generations: keys move to previous after ttlMs and are dropped after 2 * ttlMs
+    this.current = new Set();
+    this.previous = new Set();
+    this.rotatedAt = Date.now();
+    this.counters = { claims: 0, duplicates: 0 };
+  }
+
+  /**
+   * Claims keys, first come first served.
+   *
+   * @param {string[]} keys
+   * @returns {boolean[]} For each key, true if this was its first claim.
+   */
+  claimNow(keys, now = Date.now()) {
+    if (now - this.rotatedAt >= this.ttlMs) {
+      this.previous = now - this.rotatedAt >= 2 * this.ttlMs ? new Set() : this.current;
+      this.current = new Set();
+      this.rotatedAt = now;
+    }
+    return keys.map((key) => {
+      this.counters.claims++;
+      if (this.current.has(key) || this.previous.has(key)) {
+        this.counters.duplicates++;
+        return false;
+      }
+      this.current.add(key);
+      return true;
+    });
+  }
+
+  /**
+   * Same as claimNow(), with the interface of RemoteDedupStore.
+   *
+   * @returns {Promise<boolean[]>}
+   */
+  claim(keys) {
+    return Promise.resolve(this.claimNow(keys));
+  }
+
+  getStats() {
+    return { store: 'local', keys: this.current.size + this.previous.size, ...this.counters };
+  }
+}
+
+/**
+ * Client of a store served by dedup_server.js. Claims made in the same event
+ * loop turn go out as one request. If the store cannot be reached the events
+ * are let through (and counted): the ledger still rejects duplicate event IDs,
+ * at the cost of a transaction.
+ */
+class RemoteDedupStore {
+  constructor(url) {
+    this.url = new URL('/claim', url);
+    this.agent = new http.Agent({ keepAlive: true, maxSockets: 4 });
+    this.queue = [];
+    this.counters = { claims: 0, duplicates: 0, requests: 0, errors: 0 };
+  }
+
+  /**
+   * @param {string[]} keys
+   * @returns {Promise<boolean[]>} For each key, true if this gateway claimed it first.
+   */
+  claim(keys) {
+    return new Promise((resolve) => {
+      if (this.queue.length === 0) {
+        setImmediate(() => this.flush());
+      }
+      this.queue.push({ keys, resolve });
+    });
+  }
+
+  flush() {
+    const batch = this.queue;
+    this.queue = [];
+    const keys = batch.flatMap((claim) => claim.keys);
+    const settle = (claimed) => {
+      let pos = 0;
+      for (const claim of batch) {
+        claim.resolve(claimed.slice(pos, pos + claim.keys.length));
+        pos += claim.keys.length;
+      }
+      this.counters.claims += keys.length;
+      this.counters.duplicates += claimed.filter((first) => !first).length;
+    };
+    const failOpen = () => {
+      this.counters.errors++;
+      settle(keys.map(() => true));
+    };
+
+    this.counters.requests++;
+    const body = JSON.stringify({ keys });
+    const req = http.request(this.url, {
+      method: 'POST',
+      agent: this.agent,
+      timeout: REMOTE_TIMEOUT_MS,
+      headers: { 'Content-Type': 'application/json', 'Content-Length': Buffer.byteLength(body) }
+    }, (res) => {
+      let response = '';
+      res.setEncoding('utf8');
+      res.on('data', (chunk) => { response += chunk; });
+      res.on('end', () => {
+        let claimed;
+        try {
+          claimed = JSON.parse(response).claimed;
+        } catch (parseError) {
+          claimed = null;
+        }
+        if (res.statusCode !== 200 || !Array.isArray(claimed) || claimed.length !== keys.length) {
+          failOpen();
+          return;
+        }
+        settle(claimed);
+      });
+    });
+    req.on('timeout', () => req.destroy(new Error('timeout')));
+    req.on('error', failOpen);
+    req.end(body);
+  }
+
+  getStats() {
+    return { store: this.url.origin, ...this.counters };
+  }
+}
+
+/**
+ * HTTP front of a DedupStore: POST /claim {"keys": [...]} answers
+ * {"claimed": [...]}, GET /stats the store counters.
+ */
+function createDedupServer(store) {
+  return http.createServer((req, res) => {
+    const send = (statusCode, body) => {
+      res.writeHead(statusCode, { 'Content-Type': 'application/json' });
+      res.end(JSON.stringify(body));
+    };
+    if (req.method === 'POST' && req.url === '/claim') {
+      let body = '';
+      req.setEncoding('utf8');
+      req.on('data', (chunk) => { body += chunk; });
+      req.on('end', () => {
+        let keys;
+        try {
+          keys = JSON.parse(body).keys;
+        } catch (parseError) {
+          keys = null;
+        }
+        if (!Array.isArray(keys) || !keys.every((key) => typeof key === 'string')) {
+          send(400, { status: 'error', message: 'Expected {"keys": [string, ...]}' });
+          return;
+        }
+        send(200, { claimed: store.claimNow(keys) });
+      });
+      return;
+    }
+    if (req.method === 'GET' && req.url === '/stats') {
+      send(200, store.getStats());
+      return;
+    }
+    send(404, { status: 'error', message: 'Not found' });
+  });
+}
+
+module.exports = { DedupStore, RemoteDedupStore, createDedupServer, dedupKey, DEFAULT_TTL_MS };
@@ -0,0 +1,566 @@
+'use strict';
+
+// Single ingestion gateway for all sensor types.
+// Replaces the former per-device receivers (one process per UDP port): one
+// process binds every sensor port, hands datagrams to a pool of decode worker
+// threads and forwards the decoded events to the backend API. Per-port
+// packet/byte/drop counters are served as JSON on the stats port.
+// Every forwarded event carries a `trace` of its arrival and decode times and,
+// when the mote sent its clock, its estimated send time (see mote_clock.js);
+// the backend turns these into per-stage latency histograms.
+// Sequenced datagrams (sensor-link.h) are unwrapped here: gaps are NACKed
+// back to the mote, duplicates dropped, and loss is measured per source
+// (see link_tracker.js). The last source address of every device is kept so
+// reporting config can be pushed to it (POST /devices/<deviceID>/report-config).
+// GET /devices lists every device with that address and its mote-to-gateway
+// latency, which the multi-hop scaling scenarios join with their hop counts.
+// Motes may report to several sinks: one gateway can bind several addresses
+// (INGEST_HOST=aaaa::1,bbbb::1), several gateways can run side by side, and
+// events are deduplicated by (device, sequence) before forwarding, in process
+// or through a store shared by all gateways (INGEST_DEDUP_URL, see
+// dedup_store.js).
+// Admission control (admission.js) keeps a flood from reaching the ledger:
+// datagrams over the token bucket of their source address, or of a device
+// they carry from that address, are dropped before anything is decoded (a
+// device's bucket is per source, so replayed or spoofed copies of its
+// datagrams sent from elsewhere cannot use up its tokens); once every POST
+// slot is taken, events wait in a bounded queue that serves alarms, then
+// access events, then bulk readings; and while the backend sheds load (HTTP
+// 503 with Retry-After) bulk readings are shed here rather than posted.
+
+const dgram = require('dgram');
+const http = require('http');
+const os = require('os');
+const path = require('path');
+const { Worker } = require('worker_threads');
+const MoteClocks = require('./mote_clock');
+const LinkTracker = require('./link_tracker');
+const { encodeReportConfig } = require('./report_config');
+const { DedupStore, RemoteDedupStore, dedupKey } = require('./dedup_store');
+const { peekDeviceIDs } = require('./payload_decoder');
+const { TokenBuckets, PriorityQueue, classifyEvent, DEFAULT_CO2_ALARM_PPM } = require('./admission');
+
+// Configuration
+// Sink addresses this gateway receives on (SENSOR_SINKS in the firmwares)
+const HOSTS_IPV6 = (process.env.INGEST_HOST || 'aaaa::1').split(',').map((host) => host.trim());
+const DEDUP_URL = process.env.INGEST_DEDUP_URL;
+const API_ENDPOINT = new URL(process.env.API_ENDPOINT || 'http://localhost:5000/api/sensor-events');
+const STATS_PORT = Number(process.env.INGEST_STATS_PORT || 8850);
+const WORKER_COUNT = Number(process.env.INGEST_WORKERS || Math.max(1, os.cpus().length - 1));
+const MAX_PENDING_DECODES = Number(process.env.INGEST_MAX_PENDING || 1024);
+const MAX_INFLIGHT_POSTS = Number(process.env.INGEST_MAX_INFLIGHT || 256);
+// A POST the API has not answered by then is abandoned and its slot freed
+const POST_TIMEOUT_MS = Number(process.env.INGEST_POST_TIMEOUT_MS || 10000);
+const LOG_INTERVAL_MS = Number(process.env.INGEST_LOG_INTERVAL_MS || 10000);
+const DEBUG = process.env.INGEST_DEBUG === '1';
+// Admission control: datagrams per second per source address and events per
+// second per device and source (0 turns a limit off), buckets kept and new
+// sources or devices per second given their own before the rest share one,
+// forward queue size and the CO2 level that makes a reading an alarm
+const SOURCE_RATE = Number(process.env.INGEST_SOURCE_RATE ?? 20);
+const SOURCE_BURST = Number(process.env.INGEST_SOURCE_BURST || 64);
+const DEVICE_RATE = Number(process.env.INGEST_DEVICE_RATE ?? 10);
+const DEVICE_BURST = Number(process.env.INGEST_DEVICE_BURST || 20);
+const MAX_TRACKED = Number(process.env.INGEST_MAX_TRACKED || 10000);
+const NEW_KEY_RATE = Number(process.env.INGEST_NEW_KEY_RATE ?? 100);
+const QUEUE_SIZE = Number(process.env.INGEST_QUEUE_SIZE || 4096);
+const CO2_ALARM_PPM = Number(process.env.INGEST_CO2_ALARM_PPM || DEFAULT_CO2_ALARM_PPM);
+const BUCKET_SWEEP_MS = 10000;
+
+// UDP port assigned to each device type (matches UDP_PORT_CENTRAL in the firmwares)
+const SENSOR_PORTS = [
+  { port: 8842, label: 'CCTV', deviceType: 'cctv' },
+  { port: 8843, label: 'Smart Light', deviceType: 'light' },
+  { port: 8844, label: 'Card Reader', deviceType: 'card_reader' },
+  { port: 8845, label: 'Printer', deviceType: 'printer' },
+  { port: 8849, label: 'CO₂ Sensor', deviceType: 'co2_sensor' }
+];
+
+const newCounters = () => ({
+  packets: 0,
+  bytes: 0,
+  events: 0,
+  decodeErrors: 0,
+  rejected: 0,
+  sourceLimited: 0,
+  deviceLimited: 0,
+  dropped: 0,
+  shed: 0,
+  duplicates: 0,
+  duplicateEvents: 0,
+  dedupErrors: 0,
+  forwarded: 0,
+  forwardErrors: 0
+});
+
+const stats = new Map(SENSOR_PORTS.map(({ port }) => [port, newCounters()]));
+const startedAt = Date.now();
+const moteClocks = new MoteClocks();
+const linkTracker = new LinkTracker();
+const dedupStore = DEDUP_URL ? new RemoteDedupStore(DEDUP_URL) : new DedupStore();
+// deviceID -> { sensorPort, local, address, port } of its latest datagram
+const deviceSources = new Map();
+// deviceID -> { events, sumMs, maxMs } of its mote-to-gateway latency
+const deviceLatency = new Map();
+const sourceBuckets = new TokenBuckets({ rate: SOURCE_RATE, burst: SOURCE_BURST, maxKeys: MAX_TRACKED, newKeyRate: NEW_KEY_RATE });
+const deviceBuckets = new TokenBuckets({ rate: DEVICE_RATE, burst: DEVICE_BURST, maxKeys: MAX_TRACKED, newKeyRate: NEW_KEY_RATE });
+const forwardQueue = new PriorityQueue(QUEUE_SIZE);
+// Until then the backend is shedding load and bulk readings are not posted
+let shedUntil = 0;
+
+/**
+ * Stamps an event with its gateway trace, including its admission class
+ * (priority), and, when the mote sent its clock, replaces the timestamp with
+ * the estimated time of the reading. boot is the link header's boot id, which
+ * tells the clock estimate about reboots.
+ */
+function traceEvent(event, receivedAt, decodedAt, boot) {
+  const trace = { ...event.trace, receivedAt, decodedAt, priority: classifyEvent(event, CO2_ALARM_PPM) };
+  if (trace.moteTime !== undefined) {
+    trace.sentAt = moteClocks.toWallClock(event.deviceID, trace.moteTime, receivedAt, boot);
+    event.timestamp = new Date(trace.sentAt).toISOString();
+    recordLatency(event.deviceID, receivedAt - trace.sentAt);
+  }
+  event.trace = trace;
+}
+
+function recordLatency(deviceID, ms) {
+  let latency = deviceLatency.get(deviceID);
+  if (!latency) {
+    latency = { events: 0, sumMs: 0, maxMs: 0 };
+    deviceLatency.set(deviceID, latency);
+  }
+  latency.events++;
+  latency.sumMs += ms;
+  latency.maxMs = Math.max(latency.maxMs, ms);
+}
+
+/**
+ * Every device seen, with the address it last sent from and its
+ * mote-to-gateway latency. Latencies are relative to the fastest datagram of
+ * the device (see mote_clock.js), so they measure queueing and retransmission
+ * delay on top of the best path, not the absolute path delay.
+ */
+function getDevices() {
+  return [...deviceSources].map(([deviceID, source]) => {
+    const latency = deviceLatency.get(deviceID);
+    return {
+      deviceID,
+      ...source,
+      latencyEvents: latency ? latency.events : 0,
+      meanLatencyMs: latency ? Math.round(latency.sumMs / latency.events) : null,
+      maxLatencyMs: latency ? latency.maxMs : null
+    };
+  });
+}
+
+// Keep-alive agent so forwarding reuses a few TCP connections to the API
+const httpAgent = new http.Agent({ keepAlive: true, maxSockets: MAX_INFLIGHT_POSTS });
+let inflightPosts = 0;
+
+/**
+ * Forwards one decoded event to the backend API, at once if a POST slot is
+ * free, otherwise through the forward queue. Events the full queue cannot
+ * take, and bulk readings while the backend sheds load, are dropped and
+ * counted rather than queued without bound.
+ */
+function forwardEvent(port, event) {
+  if (event.trace.priority === 'bulk' && Date.now() < shedUntil) {
+    stats.get(port).shed++;
+    return;
+  }
+  if (inflightPosts < MAX_INFLIGHT_POSTS) {
+    postEvent(port, event);
+    return;
+  }
+  const lost = forwardQueue.push(event.trace.priority, { port, event });
+  if (lost) {
+    stats.get(lost.port).dropped++;
+  }
+}
+
+/**
+ * Posts queued events, highest class first, while POST slots are free.
+ */
+function pumpForwardQueue() {
+  while (inflightPosts < MAX_INFLIGHT_POSTS && forwardQueue.length > 0) {
+    const { port, event } = forwardQueue.shift();
+    if (event.trace.priority === 'bulk' && Date.now() < shedUntil) {
+      stats.get(port).shed++;
+    } else {
+      postEvent(port, event);
+    }
+  }
+}
+
+/**
+ * Starts shedding bulk readings for the Retry-After period of a 503 answer,
+ * including those already queued.
+ */
+function startShedding(retryAfter) {
+  shedUntil = Math.max(shedUntil, Date.now() + (Number(retryAfter) || 1) * 1000);
+  for (const { port } of forwardQueue.drain('bulk')) {
+    stats.get(port).shed++;
+  }
+}
+
+/**
+ * POST one decoded event to the backend API. Its slot is given back when
+ * the request closes, however it ended: answered, failed, timed out, or
+ * with the response cut short.
+ */
+function postEvent(port, event) {
+  const counters = stats.get(port);
+  let settled = false;
+  const settle = (counter) => {
+    if (!settled) {
+      settled = true;
+      counters[counter]++;
+    }
+  };
+  inflightPosts++;
+
+  const body = JSON.stringify(event);
+  const req = http.request(API_ENDPOINT, {
+    method: 'POST',
+    agent: httpAgent,
+    headers: {
+      'Content-Type': 'application/json',
+      'Content-Length': Buffer.byteLength(body)
+    }
+  }, (res) => {
+    res.resume();
+    res.on('end', () => {
+      if (res.statusCode >= 200 && res.statusCode < 300) {
+        settle('forwarded');
+      } else if (res.statusCode === 503) {
+        settle('shed');
+        startShedding(res.headers['retry-after']);
+      } else {
+        settle('forwardErrors');
+        if (DEBUG) {
+          console.error(`[Ingest] API rejected ${event.eventID} with HTTP ${res.statusCode}`);
+        }
+      }
+    });
+  });
+  req.setTimeout(POST_TIMEOUT_MS, () => {
+    req.destroy(new Error(`no answer within ${POST_TIMEOUT_MS} ms`));
+  });
+  req.on('error', (httpError) => {
+    settle('forwardErrors');
+    if (DEBUG) {
+      console.error(`[Ingest] Error forwarding ${event.eventID}:`, httpError.message);
+    }
+  });
+  req.on('close', () => {
+    // Closed without an answer or an error, e.g. the response was aborted
+    settle('forwardErrors');
+    inflightPosts--;
+    pumpForwardQueue();
+  });
+  req.end(body);
+}
+
+// Decode worker pool, fed round-robin. A worker that dies is replaced after
+// WORKER_RESTART_MS; the datagrams it had not answered are counted as lost.
+const WORKER_RESTART_MS = 1000;
+const workers = [];
+let nextWorker = 0;
+let pendingDecodes = 0;
+let nextJobId = 0;
+let stopping = false;
+const workerStats = { restarts: 0, lostDecodes: 0 };
+
+/**
+ * Forwards the events of one decoded datagram that no gateway forwarded yet.
+ */
+function onDecoded({ port, source, receivedAt, decodedAt, events, rejected, error }) {
+  const counters = stats.get(port);
+  if (error) {
+    counters.decodeErrors++;
+    if (DEBUG) {
+      console.error(`[Ingest] Error decoding datagram on port ${port}:`, error);
+    }
+    return;
+  }
+  counters.rejected += rejected;
+  counters.events += events.length;
+  for (const event of events) {
+    deviceSources.set(event.deviceID, { sensorPort: port, ...source });
+    traceEvent(event, receivedAt, decodedAt, source.boot);
+  }
+  dedupStore.claim(events.map(dedupKey)).then((claimed) => {
+    events.forEach((event, i) => {
+      if (!claimed[i]) {
+        counters.duplicateEvents++;
+        return;
+      }
+      if (DEBUG) {
+        console.log(`[Ingest] ${event.deviceType} ${event.eventID} ${event.eventType}`);
+      }
+      forwardEvent(port, event);
+    });
+  }).catch((dedupError) => {
+    counters.dedupErrors++;
+    console.error(`[Ingest] Dropped ${events.length} event(s) on port ${port}: ${dedupError.message}`);
+  });
+}
+
+/**
+ * Starts a decode worker and keeps track of the datagrams it was handed.
+ */
+function startWorker() {
+  const worker = new Worker(path.join(__dirname, 'decode_worker.js'));
+  worker.pending = 0;
+  worker.on('message', (result) => {
+    pendingDecodes--;
+    worker.pending--;
+    onDecoded(result);
+  });
+  worker.on('error', (err) => {
+    console.error(`[Ingest] Decode worker ${worker.threadId} failed: ${err.message}`);
+  });
+  worker.on('exit', () => {
+    workers.splice(workers.indexOf(worker), 1);
+    pendingDecodes -= worker.pending;
+    workerStats.lostDecodes += worker.pending;
+    if (!stopping) {
+      workerStats.restarts++;
+      setTimeout(() => workers.push(startWorker()), WORKER_RESTART_MS).unref();
+    }
+  });
+  return worker;
+}
+
+for (let i = 0; i < WORKER_COUNT; i++) {
+  workers.push(startWorker());
+}
+
+/**
+ * Takes tokens from the bucket of every device a datagram carries, one per
+ * event, keyed by device and source address. Records whose device cannot be
+ * read without decoding share one bucket per source.
+ *
+ * @returns {boolean} false if a device is over its rate.
+ */
+function admitDevices(message, address, now) {
+  const costs = new Map();
+  for (const deviceID of peekDeviceIDs(message)) {
+    const key = `${address}|${deviceID === null ? '?' : deviceID}`;
+    costs.set(key, (costs.get(key) || 0) + 1);
+  }
+  for (const [key, cost] of costs) {
+    if (!deviceBuckets.take(key, now, cost)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Hand one datagram to the next decode worker, after admission control and
+ * after stripping and checking its link header if the mote sent one.
+ */
+function dispatch(sensor, host, udpSocket, message, rinfo) {
+  const counters = stats.get(sensor.port);
+  const receivedAt = Date.now();
+  counters.packets++;
+  counters.bytes += message.length;
+
+  // Whole source first, so a flood costs no more than a counter update
+  if (!sourceBuckets.take(rinfo.address, receivedAt)) {
+    counters.sourceLimited++;
+    return;
+  }
+
+  let boot;
+  if (message.length > LinkTracker.HEADER_LEN && message[0] === LinkTracker.LINK_MAGIC) {
+    boot = message[1];
+    if (!linkTracker.accept(udpSocket, rinfo, boot, message.readUInt16BE(2), receivedAt, host)) {
+      counters.duplicates++;
+      return;
+    }
+    message = message.subarray(LinkTracker.HEADER_LEN);
+  }
+
+  if (deviceBuckets.enabled && !admitDevices(message, rinfo.address, receivedAt)) {
+    counters.deviceLimited++;
+    return;
+  }
+
+  if (pendingDecodes >= MAX_PENDING_DECODES || workers.length === 0) {
+    counters.dropped++;
+    return;
+  }
+  pendingDecodes++;
+
+  // Copy into a standalone ArrayBuffer so it can be transferred, not cloned
+  const payload = new Uint8Array(message).buffer;
+  nextWorker = (nextWorker + 1) % workers.length;
+  const worker = workers[nextWorker];
+  worker.pending++;
+  worker.postMessage({
+    id: nextJobId++,
+    port: sensor.port,
+    deviceType: sensor.deviceType,
+    payload,
+    receivedAt,
+    source: { local: host, address: rinfo.address, port: rinfo.port, ...(boot !== undefined && { boot }) }
+  }, [payload]);
+}
+
+// One socket per sink address and sensor port, keyed "[address]:port"
+const socketsByLocal = new Map();
+const sockets = HOSTS_IPV6.flatMap((host) => SENSOR_PORTS.map((sensor) => {
+  const udpSocket = dgram.createSocket('udp6');
+
+  udpSocket.on('message', (message, rinfo) => dispatch(sensor, host, udpSocket, message, rinfo));
+
+  udpSocket.on('listening', () => {
+    const address = udpSocket.address();
+    console.log(`[${sensor.label} UDP Receiver] Listening on [${address.address}]:${address.port}`);
+  });
+
+  udpSocket.on('error', (err) => {
+    console.error(`[${sensor.label} UDP Receiver] Socket error: ${err.message}`);
+    udpSocket.close();
+  });
+
+  udpSocket.bind(sensor.port, host);
+  socketsByLocal.set(`[${host}]:${sensor.port}`, udpSocket);
+  return udpSocket;
+}));
+
+/**
+ * Snapshot of the per-port counters.
+ */
+function getStats() {
+  const ports = {};
+  for (const sensor of SENSOR_PORTS) {
+    ports[sensor.port] = { deviceType: sensor.deviceType, ...stats.get(sensor.port) };
+  }
+  return {
+    uptimeSeconds: Math.round((Date.now() - startedAt) / 1000),
+    workers: workers.length,
+    workerRestarts: workerStats.restarts,
+    lostDecodes: workerStats.lostDecodes,
+    pendingDecodes,
+    inflightPosts,
+    admission: {
+      sources: sourceBuckets.getStats(),
+      devices: deviceBuckets.getStats(),
+      queue: forwardQueue.getStats(),
+      sheddingForMs: Math.max(0, shedUntil - Date.now())
+    },
+    tracedDevices: moteClocks.size,
+    knownDevices: deviceSources.size,
+    links: linkTracker.getStats(),
+    dedup: dedupStore.getStats(),
+    ports
+  };
+}
+
+/**
+ * Sends a reporting config downlink to the address a device last sent from,
+ * through the socket it sent to: the mote only listens to its sensor port, and
+ * its cb_receive_udp drops datagrams whose source is not one of its sinks.
+ *
+ * @returns {Buffer|null} The datagram sent, or null if the device is unknown.
+ */
+function sendReportConfig(deviceID, config) {
+  const source = deviceSources.get(deviceID);
+  if (!source) {
+    return null;
+  }
+  const message = encodeReportConfig(config);
+  socketsByLocal.get(`[${source.local}]:${source.sensorPort}`).send(message, source.port, source.address);
+  return message;
+}
+
+const linkTimer = setInterval(() => linkTracker.tick(Date.now()), LinkTracker.NACK_INTERVAL_MS);
+linkTimer.unref();
+
+const bucketTimer = setInterval(() => {
+  const now = Date.now();
+  sourceBuckets.sweep(now);
+  deviceBuckets.sweep(now);
+}, BUCKET_SWEEP_MS);
+bucketTimer.unref();
+
+const REPORT_CONFIG_PATH = /^\/devices\/([^/]+)\/report-config$/;
+
+const sendJSON = (res, statusCode, body) => {
+  res.writeHead(statusCode, { 'Content-Type': 'application/json' });
+  res.end(JSON.stringify(body));
+};
+
+// Stats and device control endpoint
+const statsServer = http.createServer((req, res) => {
+  const configMatch = req.method === 'POST' && REPORT_CONFIG_PATH.exec(req.url);
+  if (configMatch) {
+    let body = '';
+    req.setEncoding('utf8');
+    req.on('data', (chunk) => { body += chunk; });
+    req.on('end', () => {
+      const deviceID = decodeURIComponent(configMatch[1]);
+      let message;
+      try {
+        message = sendReportConfig(deviceID, JSON.parse(body || '{}'));
+      } catch (error) {
+        sendJSON(res, 400, { status: 'error', message: error.message });
+        return;
+      }
+      if (!message) {
+        sendJSON(res, 404, { status: 'error', message: `No datagram seen from ${deviceID}` });
+        return;
+      }
+      // UDP: delivery is best effort, the device's next reports show whether it applied
+      sendJSON(res, 202, { status: 'success', deviceID, bytes: message.length, source: deviceSources.get(deviceID) });
+    });
+    return;
+  }
+  if (req.method === 'GET' && req.url === '/stats') {
+    res.writeHead(200, { 'Content-Type': 'application/json' });
+    res.end(JSON.stringify(getStats()));
+    return;
+  }
+  if (req.method === 'GET' && req.url === '/links') {
+    res.writeHead(200, { 'Content-Type': 'application/json' });
+    res.end(JSON.stringify(linkTracker.getStats(true)));
+    return;
+  }
+  if (req.method === 'GET' && req.url === '/devices') {
+    sendJSON(res, 200, getDevices());
+    return;
+  }
+  res.writeHead(404, { 'Content-Type': 'application/json' });
+  res.end(JSON.stringify({ status: 'error', message: 'Not found' }));
+});
+statsServer.listen(STATS_PORT, () => {
+  console.log(`[Ingest] Stats available on http://localhost:${STATS_PORT}/stats`);
+});
+
+// Periodic one-line summary in place of per-packet logging
+const summaryTimer = setInterval(() => {
+  const line = SENSOR_PORTS.map(({ port, deviceType }) => {
+    const c = stats.get(port);
+    return `${deviceType}: ${c.packets} pkts/${c.events} evts/${c.sourceLimited + c.deviceLimited} limited/${c.dropped} drop/${c.shed} shed`;
+  }).join(', ');
+  const links = linkTracker.getStats();
+  const dedup = dedupStore.getStats();
+  console.log(`[Ingest] ${line}; link loss ${(links.lossRate * 100).toFixed(2)}% ` +
+    `(${(links.rawLossRate * 100).toFixed(2)}% before ${links.recovered} retransmits); ` +
+    `${dedup.duplicates} duplicate events`);
+}, LOG_INTERVAL_MS);
+summaryTimer.unref();
+
+function shutdown(signal) {
+  console.log(`[Ingest] Received ${signal}. Shutting down gateway...`);
+  sockets.forEach((udpSocket) => udpSocket.close());
+  statsServer.close();
+  stopping = true;
+  Promise.all(workers.map((worker) => worker.terminate())).then(() => process.exit(0));
+}
+process.on('SIGINT', () => shutdown('SIGINT'));
+process.on('SIGTERM', () => shutdown('SIGTERM'));
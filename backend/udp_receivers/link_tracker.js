@@ -0,0 +1,209 @@
+'use strict';
+
+// Gateway side of the mote link layer (cooja-simulation/sensors/sensor-link.h).
+// Motes prefix each datagram with a boot id and a 16-bit sequence number. Per
+// source address the tracker remembers the highest sequence seen and the gaps
+// below it; every new gap is NACKed at once on the socket the datagram came
+// in on, outstanding gaps are NACKed again on each tick, and a gap is given up
+// as lost after MAX_NACKS attempts or once it falls WINDOW sequence numbers
+// behind (the NACK bitmap cannot reach it any more). Retransmissions fill the
+// gaps; anything else seen before is a duplicate and must not be forwarded.
+
+const NACK_MAGIC = 0xA1;
+const WINDOW = 32;
+const MAX_NACKS = 3;
+const NACK_INTERVAL_MS = 1000;
+const IDLE_SOURCE_MS = 10 * 60 * 1000;
+
+const seqDiff = (a, b) => (a - b) & 0xffff;
+
+const newLinkCounters = () => ({
+  received: 0,
+  duplicates: 0,
+  recovered: 0,
+  lost: 0,
+  nacks: 0
+});
+
+class LinkTracker {
+  constructor() {
+    this.sources = new Map();
+    this.totals = newLinkCounters();
+  }
+
+  /**
+   * Records one sequenced datagram.
+   *
+   * @param {dgram.Socket} socket - Socket it arrived on; NACKs go back through it.
+   * @param {Object} rinfo - Sender address and port.
+   * @param {number} boot - Boot id of the mote.
+   * @param {number} seq - Sequence number.
+   * @param {number} now - Arrival time, ms since the epoch.
+   * @param {string} [sink] - Local address it was sent to. A mote numbers the
+   *   datagrams of each of its sinks separately (sensor-link.h).
+   * @returns {boolean} false if the datagram was already received.
+   */
+  accept(socket, rinfo, boot, seq, now, sink = '') {
+    const key = `${sink}|[${rinfo.address}]:${rinfo.port}`;
+    let source = this.sources.get(key);
+    if (!source) {
+      source = { key, socket, sink, address: rinfo.address, port: rinfo.port, counters: newLinkCounters() };
+      this._restart(source, boot, (seq - 1) & 0xffff);
+      this.sources.set(key, source);
+    } else if (source.boot !== boot) {
+      // Rebooted: what was still missing cannot be recovered, and sequence
+      // numbers the new boot sent before this one are gaps like any other
+      this._lose(source, source.missing.size);
+      this._restart(source, boot, seq < WINDOW ? 0xffff : seq - 1);
+    }
+    source.lastSeenAt = now;
+
+    const ahead = seqDiff(seq, source.highest);
+    if (ahead === 0) {
+      this._count(source, 'duplicates', 1);
+      return false;
+    }
+    if (ahead < 0x8000) {
+      // Gaps beyond the NACK window are lost outright
+      this._lose(source, Math.max(0, ahead - 1 - WINDOW));
+      for (let gap = Math.min(ahead - 1, WINDOW); gap > 0; gap--) {
+        source.missing.set((seq - gap) & 0xffff, { since: now, nacks: 0, lastNackAt: 0 });
+      }
+      source.highest = seq;
+      this._count(source, 'received', 1);
+      this._expire(source);
+      if (ahead > 1) {
+        this._nack(source, now);
+      }
+      return true;
+    }
+    if (source.missing.delete(seq)) {
+      this._count(source, 'received', 1);
+      this._count(source, 'recovered', 1);
+      return true;
+    }
+    this._count(source, 'duplicates', 1);
+    return false;
+  }
+
+  /**
+   * Re-NACKs outstanding gaps, gives up on exhausted ones and forgets idle
+   * sources. Call about once per NACK_INTERVAL_MS.
+   */
+  tick(now) {
+    for (const source of this.sources.values()) {
+      if (now - source.lastSeenAt > IDLE_SOURCE_MS) {
+        this._lose(source, source.missing.size);
+        this.sources.delete(source.key);
+        continue;
+      }
+      let due = false;
+      for (const [seq, gap] of source.missing) {
+        if (now - gap.lastNackAt < NACK_INTERVAL_MS) {
+          continue;
+        }
+        if (gap.nacks >= MAX_NACKS) {
+          source.missing.delete(seq);
+          this._lose(source, 1);
+        } else {
+          due = true;
+        }
+      }
+      if (due) {
+        this._nack(source, now);
+      }
+    }
+  }
+
+  _restart(source, boot, highest) {
+    source.boot = boot;
+    source.highest = highest;
+    source.missing = new Map();
+  }
+
+  // Gaps the NACK bitmap can no longer express are lost
+  _expire(source) {
+    for (const seq of source.missing.keys()) {
+      if (seqDiff(source.highest, seq) > WINDOW) {
+        source.missing.delete(seq);
+        this._lose(source, 1);
+      }
+    }
+  }
+
+  _lose(source, count) {
+    this._count(source, 'lost', count);
+  }
+
+  _count(source, counter, count) {
+    source.counters[counter] += count;
+    this.totals[counter] += count;
+  }
+
+  /**
+   * Sends one NACK covering every outstanding gap of a source.
+   */
+  _nack(source, now) {
+    if (source.missing.size === 0) {
+      return;
+    }
+    // Cumulative ack: the sequence number just before the oldest gap
+    let oldest = null;
+    for (const seq of source.missing.keys()) {
+      if (oldest === null || seqDiff(source.highest, seq) > seqDiff(source.highest, oldest)) {
+        oldest = seq;
+      }
+    }
+    const ack = (oldest - 1) & 0xffff;
+    let bitmap = 0;
+    for (const [seq, gap] of source.missing) {
+      const bit = seqDiff(seq, ack) - 1;
+      if (bit < WINDOW) {
+        bitmap |= 1 << bit;
+        gap.nacks++;
+        gap.lastNackAt = now;
+      }
+    }
+
+    const message = Buffer.alloc(8);
+    message[0] = NACK_MAGIC;
+    message[1] = source.boot;
+    message.writeUInt16BE(ack, 2);
+    message.writeUInt32BE(bitmap >>> 0, 4);
+    source.socket.send(message, source.port, source.address);
+    this._count(source, 'nacks', 1);
+  }
+
+  /**
+   * Totals with the measured loss rate (lost / (received + lost)), before and
+   * after recovery, and optionally the per-source breakdown.
+   */
+  getStats(withSources = false) {
+    const { received, recovered, lost } = this.totals;
+    const rate = (missed) => (received + lost > 0 ? missed / (received + lost) : 0);
+    const summary = {
+      sources: this.sources.size,
+      ...this.totals,
+      outstanding: [...this.sources.values()].reduce((sum, source) => sum + source.missing.size, 0),
+      lossRate: rate(lost),
+      rawLossRate: rate(lost + recovered)
+    };
+    if (withSources) {
+      summary.bySource = [...this.sources.values()].map((source) => ({
+        source: `[${source.address}]:${source.port}`,
+        sink: source.sink,
+        boot: source.boot,
+        highest: source.highest,
+        outstanding: source.missing.size,
+        ...source.counters
+      }));
+    }
+    return summary;
+  }
+}
+
+LinkTracker.LINK_MAGIC = 0xB3;
+LinkTracker.HEADER_LEN = 4;
+LinkTracker.NACK_INTERVAL_MS = NACK_INTERVAL_MS;
+
+module.exports = LinkTracker;
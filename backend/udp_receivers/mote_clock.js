@@ -0,0 +1,63 @@
+'use strict';
+
+// Maps mote clocks (ms since boot, sent in every event) to wall-clock time.
+// Motes are not synchronized, so each device's offset is estimated as the
+// smallest (arrival - moteTime) seen so far: the event that crossed fastest
+// defines "no delay", and every other event's mote-to-gateway latency is
+// measured against it. That excludes the fixed radio and routing delay but
+// captures what varies, batching and queueing on the mote and in the mesh.
+// The offset is relaxed by DRIFT_PPM over time so crystal drift does not pin
+// it to an old minimum.
+//
+// The offset is reset when the mote reboots, told by a new boot id in the
+// link header. Datagrams reordered in the mesh carry an older moteTime of the
+// same boot and only feed the minimum; stragglers of the previous boot keep
+// that boot's offset. Motes sending without a link header have no boot id, so
+// for them only a clock running backwards by more than MAX_REORDER_MS counts
+// as a reboot.
+
+const DRIFT_PPM = 100;
+const MAX_REORDER_MS = 60 * 1000;
+
+class MoteClocks {
+  constructor() {
+    this.devices = new Map();
+  }
+
+  /**
+   * Estimates the wall-clock time at which a device's mote clock read moteTime.
+   *
+   * @param {string} deviceID - Device the event came from.
+   * @param {number} moteTime - Mote clock in ms since boot.
+   * @param {number} receivedAt - Arrival time at the gateway, ms since the epoch.
+   * @param {number} [boot] - Boot id from the datagram's link header, if it had one.
+   * @returns {number} Estimated send time, ms since the epoch (never after receivedAt).
+   */
+  toWallClock(deviceID, moteTime, receivedAt, boot) {
+    const sample = receivedAt - moteTime;
+    let state = this.devices.get(deviceID);
+    if (state && boot !== undefined && state.previous && boot === state.previous.boot && boot !== state.boot) {
+      return Math.min(moteTime + state.previous.offset, receivedAt);
+    }
+    const rebooted = state && (boot !== undefined
+      ? boot !== state.boot
+      : state.lastMoteTime - moteTime > MAX_REORDER_MS);
+    if (!state || rebooted) {
+      const previous = state ? { boot: state.boot, offset: state.offset } : null;
+      state = { boot, offset: sample, lastMoteTime: moteTime, lastReceivedAt: receivedAt, previous };
+      this.devices.set(deviceID, state);
+    } else {
+      const relaxed = state.offset + (receivedAt - state.lastReceivedAt) * DRIFT_PPM / 1e6;
+      state.offset = Math.min(relaxed, sample);
+      state.lastMoteTime = Math.max(state.lastMoteTime, moteTime);
+      state.lastReceivedAt = receivedAt;
+    }
+    return moteTime + state.offset;
+  }
+
+  get size() {
+    return this.devices.size;
+  }
+}
+
+module.exports = MoteClocks;
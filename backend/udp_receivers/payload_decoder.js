@@ -0,0 +1,290 @@
+'use strict';
+
+// Decoder for the sensor payloads sent by the mote firmwares.
+// Motes built with SENSOR_PAYLOAD_BINARY=1 send the compact record described in
+// cooja-simulation/sensors/sensor-codec.h; all others send the legacy JSON
+// string. Both are turned into the same event object for the backend API.
+// Records may arrive batched (sensor-batch.h), several to a datagram.
+
+const CODEC_MAGIC = 0xB1;
+const BATCH_MAGIC = 0xB2;
+
+// Field ids shared by every device type: the link boot id, part of the
+// eventID, and the mote clock (ms since boot) at build time
+const BOOT_ID_FIELD = 14;
+const MOTE_TIME_FIELD = 15;
+
+const WIRE_UVARINT = 0;
+const WIRE_SVARINT = 1;
+
+const EVENT_TYPES = {
+  1: 'reading',
+  2: 'motion_detected',
+  3: 'on',
+  4: 'off',
+  5: 'completed',
+  6: 'swipe'
+};
+
+const LOCATIONS = {
+  1: 'Parking Lot A',
+  2: 'Building B - Corridor',
+  3: 'Building A - Main Entrance',
+  4: 'Library',
+  5: 'Building C - Lab'
+};
+
+const pad = (value, width) => String(value).padStart(width, '0');
+
+// "<device>_<boot id>_<counter>" (cf. sensor-payloads.h); records of motes
+// that predate the boot id give "<device>_<counter>"
+const eventSuffix = (device, bootID, counter) =>
+  `${device}_${bootID === undefined ? '' : `${bootID}_`}${pad(counter, 3)}`;
+
+// Per device type: how to rebuild the string identifiers and the metadata
+// string from the numeric header and typed fields (keyed by field id).
+const DEVICE_TYPES = {
+  1: {
+    deviceType: 'cctv',
+    deviceID: (num) => `cam_${num}`,
+    eventID: (num, bootID, counter) => `cctv_${eventSuffix(num, bootID, counter)}`,
+    fields: { 1: 'imageReference' },
+    metadata: (f) => `imageReference:img_202503141100_${pad(f.imageReference, 3)}.jpg`
+  },
+  2: {
+    deviceType: 'light',
+    deviceID: (num) => `light_${pad(num, 2)}`,
+    eventID: (num, bootID, counter) => `light_${eventSuffix(pad(num, 2), bootID, counter)}`,
+    fields: { 1: 'brightness', 2: 'energyConsumption' },
+    metadata: (f) => `brightness:${f.brightness}; energyConsumption:${f.energyConsumption}W`
+  },
+  3: {
+    deviceType: 'card_reader',
+    deviceID: (num) => `reader_${pad(num, 2)}`,
+    eventID: (num, bootID, counter) => `card_${eventSuffix(pad(num, 2), bootID, counter)}`,
+    fields: { 1: 'userID', 2: 'cardID' },
+    metadata: (f) => `userID:user${f.userID}; cardID:card${f.cardID}`
+  },
+  4: {
+    deviceType: 'printer',
+    deviceID: (num) => `printer_${num}`,
+    eventID: (num, bootID, counter) => `printer_${eventSuffix(num, bootID, counter)}`,
+    fields: { 1: 'jobID', 2: 'pagesPrinted', 3: 'userID' },
+    metadata: (f) => `jobID:job_${pad(f.jobID, 3)}; pagesPrinted:${f.pagesPrinted}; userID:student${f.userID}`
+  },
+  5: {
+    deviceType: 'co2_sensor',
+    deviceID: (num) => `sensor_${pad(num, 2)}`,
+    eventID: (num, bootID, counter) => `sensor_${eventSuffix(pad(num, 2), bootID, counter)}`,
+    fields: { 1: 'co2Level', 2: 'temperature' },
+    metadata: (f) => `co2Level:${f.co2Level}; temperature:${f.temperature}`
+  }
+};
+
+/**
+ * Read an unsigned LEB128 varint starting at cursor.pos.
+ */
+function readVarint(buf, cursor) {
+  let value = 0;
+  let shift = 0;
+  while (cursor.pos < buf.length) {
+    const byte = buf[cursor.pos++];
+    value += (byte & 0x7f) * 2 ** shift;
+    if ((byte & 0x80) === 0) {
+      return value;
+    }
+    shift += 7;
+    if (shift > 28) {
+      break;
+    }
+  }
+  throw new Error('Truncated or oversized varint in binary sensor record');
+}
+
+/**
+ * Decode one binary sensor record into the event object the API expects.
+ *
+ * @param {Buffer} buf - Raw record starting with CODEC_MAGIC.
+ * @param {Date} [receivedAt] - Arrival time, used as the event timestamp.
+ * @returns {Object} Sensor event with an extra `fields` object of typed values,
+ *   and `trace.moteTime` when the mote sent its clock.
+ */
+function decodeBinary(buf, receivedAt = new Date()) {
+  if (buf.length < 3 || buf[0] !== CODEC_MAGIC) {
+    throw new Error('Not a binary sensor record');
+  }
+  const device = DEVICE_TYPES[buf[1]];
+  if (!device) {
+    throw new Error(`Unknown device type code ${buf[1]}`);
+  }
+  const eventType = EVENT_TYPES[buf[2]];
+  if (!eventType) {
+    throw new Error(`Unknown event type code ${buf[2]}`);
+  }
+
+  const cursor = { pos: 3 };
+  const deviceNum = readVarint(buf, cursor);
+  const locationCode = readVarint(buf, cursor);
+  const counter = readVarint(buf, cursor);
+
+  const fields = {};
+  let moteTime;
+  let bootID;
+  while (cursor.pos < buf.length) {
+    const key = buf[cursor.pos++];
+    const wire = key & 0x07;
+    const raw = readVarint(buf, cursor);
+    let value;
+    if (wire === WIRE_UVARINT) {
+      value = raw;
+    } else if (wire === WIRE_SVARINT) {
+      value = raw % 2 === 0 ? raw / 2 : -(raw + 1) / 2;
+    } else {
+      throw new Error(`Unknown wire type ${wire}`);
+    }
+    const name = device.fields[key >> 3];
+    if (key >> 3 === MOTE_TIME_FIELD) {
+      moteTime = value;
+    } else if (key >> 3 === BOOT_ID_FIELD) {
+      bootID = value;
+    } else if (name) {
+      fields[name] = value;
+    }
+  }
+
+  return {
+    eventID: device.eventID(deviceNum, bootID, counter),
+    deviceType: device.deviceType,
+    deviceID: device.deviceID(deviceNum),
+    timestamp: receivedAt.toISOString(),
+    eventType,
+    location: LOCATIONS[locationCode] || `location_${locationCode}`,
+    metadata: device.metadata(fields),
+    fields,
+    ...(moteTime !== undefined && { trace: { moteTime } })
+  };
+}
+
+/**
+ * Decode a UDP payload from a mote, whichever format it was sent in.
+ *
+ * @param {Buffer} message - The datagram payload.
+ * @param {Date} [receivedAt] - Arrival time of the datagram.
+ * @returns {Object} Parsed sensor event. JSON events without a timestamp get the
+ *   arrival time, and a `moteTime` key moves to `trace.moteTime` as for binary records.
+ */
+function decodePayload(message, receivedAt = new Date()) {
+  if (message.length > 0 && message[0] === CODEC_MAGIC) {
+    return decodeBinary(message, receivedAt);
+  }
+  const { moteTime, ...event } = JSON.parse(message.toString());
+  if (event.timestamp === undefined) {
+    event.timestamp = receivedAt.toISOString();
+  }
+  if (moteTime !== undefined) {
+    event.trace = { moteTime };
+  }
+  return event;
+}
+
+/**
+ * Decode a datagram into the individual events it carries.
+ * Batch frames are unpacked record by record; anything else is a single event.
+ *
+ * @param {Buffer} message - The datagram payload.
+ * @param {Date} [receivedAt] - Arrival time of the datagram.
+ * @returns {Array<Object>} Parsed sensor events, in the order they were queued.
+ */
+function decodeDatagram(message, receivedAt = new Date()) {
+  if (message.length === 0 || message[0] !== BATCH_MAGIC) {
+    return [decodePayload(message, receivedAt)];
+  }
+  if (message.length < 2) {
+    throw new Error('Truncated batch header');
+  }
+
+  const count = message[1];
+  const events = [];
+  let pos = 2;
+  for (let i = 0; i < count; i++) {
+    if (pos >= message.length) {
+      throw new Error(`Batch truncated after ${i} of ${count} records`);
+    }
+    const len = message[pos++];
+    if (pos + len > message.length) {
+      throw new Error(`Batch record ${i} overruns the datagram`);
+    }
+    events.push(decodePayload(message.subarray(pos, pos + len), receivedAt));
+    pos += len;
+  }
+  return events;
+}
+
+const DEVICE_ID_KEY = Buffer.from('"deviceID"');
+
+/**
+ * Device ID of one payload, read without decoding it: from the numeric
+ * header of a binary record, or from the raw bytes of a JSON one.
+ *
+ * @returns {string|null} null if it cannot be found cheaply.
+ */
+function peekDeviceID(payload) {
+  if (payload.length > 3 && payload[0] === CODEC_MAGIC) {
+    const device = DEVICE_TYPES[payload[1]];
+    if (!device) {
+      return null;
+    }
+    try {
+      return device.deviceID(readVarint(payload, { pos: 3 }));
+    } catch (varintError) {
+      return null;
+    }
+  }
+  const key = payload.indexOf(DEVICE_ID_KEY);
+  if (key === -1) {
+    return null;
+  }
+  let pos = key + DEVICE_ID_KEY.length;
+  while (pos < payload.length && (payload[pos] === 0x20 || payload[pos] === 0x3a)) { // spaces and ':'
+    pos++;
+  }
+  if (payload[pos] !== 0x22) { // not a string value
+    return null;
+  }
+  const end = payload.indexOf(0x22, pos + 1);
+  const escape = payload.indexOf(0x5c, pos + 1); // '\'
+  // Escaped values are left to the decoder
+  if (end === -1 || (escape !== -1 && escape < end)) {
+    return null;
+  }
+  return payload.toString('utf8', pos + 1, end);
+}
+
+/**
+ * Device IDs of the events a datagram carries, one per record, without
+ * decoding it, so the gateway can rate-limit devices before any parsing.
+ * A record whose ID cannot be read this way gives null.
+ *
+ * @param {Buffer} message - The datagram payload.
+ * @returns {Array<string|null>}
+ */
+function peekDeviceIDs(message) {
+  if (message.length === 0 || message[0] !== BATCH_MAGIC) {
+    return [peekDeviceID(message)];
+  }
+  const ids = [];
+  let pos = 2;
+  for (let i = 0; i < message[1] && pos < message.length; i++) {
+    const len = message[pos++];
+    ids.push(peekDeviceID(message.subarray(pos, pos + len)));
+    pos += len;
+  }
+  return ids;
+}
+
+module.exports = {
+  decodeDatagram,
+  peekDeviceIDs,
+  decodePayload,
+  decodeBinary
+};
@@ -0,0 +1,77 @@
+'use strict';
+
+// Encoder for the reporting config downlink of the mote firmwares
+// (cooja-simulation/sensors/sensor-report.h): magic 0xA2 followed by
+// (parameter id, 16-bit big-endian value) pairs. Only the parameters given
+// are sent; the mote keeps its current value for the others.
+
+const CONFIG_MAGIC = 0xA2;
+const PARAM_SAMPLE_MS = 0x01;
+const PARAM_BACKOFF_MAX = 0x02;
+const PARAM_HEARTBEAT = 0x03;
+const PARAM_DEADBAND = 0x10;
+const PARAM_ALARM = 0x20;
+const ALARM_OFF = 0x7fff;
+const MAX_CHANNELS = 4;
+
+const checkRange = (name, value, min, max) => {
+  if (!Number.isInteger(value) || value < min || value > max) {
+    throw new Error(`${name} must be an integer between ${min} and ${max}`);
+  }
+  return value;
+};
+
+/**
+ * Encodes a reporting config.
+ *
+ * @param {Object} config
+ * @param {number} [config.sampleMs] - Base sample interval.
+ * @param {number} [config.backoffMaxSeconds] - Longest sample interval while stable (0: no backoff).
+ * @param {number} [config.heartbeatSeconds] - Longest time without a report (0: none).
+ * @param {Array<number|undefined>} [config.deadband] - Per channel; undefined entries are left unchanged.
+ * @param {Array<number|null|undefined>} [config.alarm] - Per channel; null disables the alarm.
+ * @returns {Buffer} The downlink datagram.
+ * @throws {Error} If a value is out of range or nothing is set.
+ */
+function encodeReportConfig({ sampleMs, backoffMaxSeconds, heartbeatSeconds, deadband = [], alarm = [] }) {
+  const params = [];
+  if (sampleMs !== undefined) {
+    params.push([PARAM_SAMPLE_MS, checkRange('sampleMs', sampleMs, 1, 0xffff)]);
+  }
+  if (backoffMaxSeconds !== undefined) {
+    params.push([PARAM_BACKOFF_MAX, checkRange('backoffMaxSeconds', backoffMaxSeconds, 0, 0xffff)]);
+  }
+  if (heartbeatSeconds !== undefined) {
+    params.push([PARAM_HEARTBEAT, checkRange('heartbeatSeconds', heartbeatSeconds, 0, 0xffff)]);
+  }
+  if (deadband.length > MAX_CHANNELS || alarm.length > MAX_CHANNELS) {
+    throw new Error(`At most ${MAX_CHANNELS} channels`);
+  }
+  deadband.forEach((value, ch) => {
+    if (value !== undefined && value !== null) {
+      params.push([PARAM_DEADBAND + ch, checkRange(`deadband[${ch}]`, value, 0, 0xffff)]);
+    }
+  });
+  alarm.forEach((value, ch) => {
+    if (value === null) {
+      params.push([PARAM_ALARM + ch, ALARM_OFF]);
+    } else if (value !== undefined) {
+      params.push([PARAM_ALARM + ch, checkRange(`alarm[${ch}]`, value, -0x8000, ALARM_OFF - 1) & 0xffff]);
+    }
+  });
+  if (params.length === 0) {
+    throw new Error('No reporting parameter given');
+  }
+
+  const message = Buffer.alloc(1 + params.length * 3);
+  message[0] = CONFIG_MAGIC;
+  params.forEach(([param, value], i) => {
+    message[1 + i * 3] = param;
+    message.writeUInt16BE(value, 2 + i * 3);
+  });
+  return message;
+}
+
+module.exports = {
+  encodeReportConfig
+};
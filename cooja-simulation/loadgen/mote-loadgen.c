@@ -0,0 +1,596 @@
+/*
+ * Host load generator for the sensor pipeline.
+ *
+ * Runs thousands of motes in one process. Every mote builds its events with
+ * the firmwares' own payload builders (sensor-payloads.c) and encoder
+ * (sensor-codec.c), queues them through the same batching code
+ * (sensor-batch.c) and sends the resulting datagrams from its own UDP socket
+ * to the sensor ports of the ingestion gateway, so the backend sees exactly
+ * what real motes would send, at rates the emulated Z1 motes cannot reach.
+ * Datagrams go through each mote's sensor-link.c sequencing, and NACKs from
+ * the gateway are answered with retransmissions like on a real mote; -l drops
+ * a share of outgoing datagrams to exercise that recovery path. With several
+ * gateways (-H a,b,...) every mote sends to them in turn, with one sequence
+ * space per gateway, like a firmware built with SENSOR_SINK_ROUND_ROBIN.
+ *
+ * usage: mote-loadgen [-n motes] [-t types] [-i interval_ms] [-b]
+ *                     [-H host[,host...]] [-f first_device] [-d seconds] [-l loss%]
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include "sys/ctimer.h"
+#include "sensor-batch.h"
+#include "sensor-link.h"
+#include "sensor-payloads.h"
+
+#define PAYLOAD_SIZE 256
+
+struct mote;
+
+struct device_type {
+  const char *name;
+  uint16_t port;          /* UDP_PORT_CENTRAL of the firmware */
+  uint8_t urgent;         /* events flush the batch immediately */
+  int (*build)(struct mote *m);
+};
+
+struct mote {
+  struct sensor_batch batch;   /* first member: timers on it point at the mote */
+  struct sensor_link link;
+  struct ctimer report_timer;
+  const struct device_type *type;
+  uint16_t device_num;
+  uint32_t counter;
+  uint8_t next_gateway;        /* round robin over the gateways */
+  int sock;
+  uint8_t payload[PAYLOAD_SIZE];
+};
+
+static struct {
+  uint64_t events;
+  uint64_t datagrams;
+  uint64_t bytes;
+  uint64_t send_errors;
+  uint64_t build_errors;
+  uint64_t dropped;       /* simulated radio loss (-l) */
+  uint64_t nacks;
+  uint64_t retransmits;
+} stats;
+
+/* Gateway addresses (-H), without port: each mote type sends to its own */
+static struct {
+  struct sockaddr_storage addr;
+  socklen_t len;
+} gateways[SENSOR_LINK_DESTS];
+static unsigned int gateway_count;
+
+static uint8_t binary;
+static double loss_rate;
+static clock_time_t report_interval = 2000;
+static volatile sig_atomic_t running = 1;
+
+/*---------------------------------------------------------------------------*/
+/* Payloads: readings drawn from the same ranges as the firmwares */
+
+static int
+build_co2(struct mote *m)
+{
+  return sensor_payload_co2(m->payload, PAYLOAD_SIZE, binary, m->device_num,
+                            m->link.boot_id, m->counter++, rand() % 1601 + 400, rand() % 16 + 15);
+}
+
+static int
+build_light(struct mote *m)
+{
+  return sensor_payload_light(m->payload, PAYLOAD_SIZE, binary, m->device_num,
+                              m->link.boot_id, m->counter++, rand() % 51 + 50, rand() % 10 + 1);
+}
+
+static int
+build_printer(struct mote *m)
+{
+  return sensor_payload_printer(m->payload, PAYLOAD_SIZE, binary, m->device_num,
+                                m->link.boot_id, m->counter++, rand() % 20 + 1);
+}
+
+static int
+build_cctv(struct mote *m)
+{
+  return sensor_payload_cctv(m->payload, PAYLOAD_SIZE, binary, m->device_num,
+                             m->link.boot_id, m->counter++);
+}
+
+static int
+build_card(struct mote *m)
+{
+  return sensor_payload_card(m->payload, PAYLOAD_SIZE, binary, m->device_num,
+                             m->link.boot_id, m->counter++, rand() % 1000, rand() % 1000);
+}
+
+static const struct device_type device_types[] = {
+  { "co2",     8849, 0, build_co2 },
+  { "light",   8843, 0, build_light },
+  { "printer", 8845, 0, build_printer },
+  { "cctv",    8842, 1, build_cctv },
+  { "card",    8844, 1, build_card },
+};
+#define DEVICE_TYPE_COUNT (sizeof(device_types) / sizeof(device_types[0]))
+
+/*---------------------------------------------------------------------------*/
+/* Clock and ctimer shim: one min-heap of timers ordered by expiry */
+
+static struct ctimer **heap;
+static unsigned int heap_len;
+static unsigned int heap_cap;
+
+clock_time_t
+clock_time(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (clock_time_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void
+heap_place(struct ctimer *c, unsigned int i)
+{
+  heap[i] = c;
+  c->slot = i + 1;
+}
+
+static void
+heap_sift_up(unsigned int i)
+{
+  struct ctimer *c = heap[i];
+  while(i > 0 && heap[(i - 1) / 2]->expires > c->expires) {
+    heap_place(heap[(i - 1) / 2], i);
+    i = (i - 1) / 2;
+  }
+  heap_place(c, i);
+}
+
+static void
+heap_sift_down(unsigned int i)
+{
+  struct ctimer *c = heap[i];
+  for(;;) {
+    unsigned int child = 2 * i + 1;
+    if(child >= heap_len) {
+      break;
+    }
+    if(child + 1 < heap_len && heap[child + 1]->expires < heap[child]->expires) {
+      child++;
+    }
+    if(heap[child]->expires >= c->expires) {
+      break;
+    }
+    heap_place(heap[child], i);
+    i = child;
+  }
+  heap_place(c, i);
+}
+
+static void
+heap_push(struct ctimer *c)
+{
+  if(heap_len == heap_cap) {
+    heap_cap = heap_cap ? heap_cap * 2 : 1024;
+    heap = realloc(heap, heap_cap * sizeof(*heap));
+    if(heap == NULL) {
+      perror("realloc");
+      exit(1);
+    }
+  }
+  heap[heap_len++] = c;
+  heap_sift_up(heap_len - 1);
+}
+
+static void
+heap_remove(struct ctimer *c)
+{
+  unsigned int i = c->slot - 1;
+  struct ctimer *last = heap[--heap_len];
+  c->slot = 0;
+  if(last != c) {
+    heap_place(last, i);
+    heap_sift_up(i);
+    heap_sift_down(last->slot - 1);
+  }
+}
+
+void
+ctimer_set(struct ctimer *c, clock_time_t t, void (*f)(void *), void *ptr)
+{
+  ctimer_stop(c);
+  c->expires = clock_time() + t;
+  c->interval = t;
+  c->f = f;
+  c->ptr = ptr;
+  heap_push(c);
+}
+
+void
+ctimer_reset(struct ctimer *c)
+{
+  /* Like Contiki: restart from the previous expiry so the period does not drift */
+  ctimer_stop(c);
+  c->expires += c->interval;
+  heap_push(c);
+}
+
+void
+ctimer_stop(struct ctimer *c)
+{
+  if(c->slot != 0) {
+    heap_remove(c);
+  }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void
+send_frame(struct sensor_link *link, uint8_t dest, const uint8_t *data, uint16_t len)
+{
+  struct mote *m = (struct mote *)((char *)link - offsetof(struct mote, link));
+  struct sockaddr_storage to = gateways[dest].addr;
+
+  if(loss_rate > 0 && rand() < loss_rate * RAND_MAX) {
+    stats.dropped++;
+    return;
+  }
+  if(to.ss_family == AF_INET6) {
+    ((struct sockaddr_in6 *)&to)->sin6_port = htons(m->type->port);
+  } else {
+    ((struct sockaddr_in *)&to)->sin_port = htons(m->type->port);
+  }
+  if(sendto(m->sock, data, len, 0, (struct sockaddr *)&to, gateways[dest].len) < 0) {
+    stats.send_errors++;
+    return;
+  }
+  stats.datagrams++;
+  stats.bytes += len;
+}
+
+/*
+ * Mote whose batch may send next. sensor_batch_send_t carries no context,
+ * so whatever may flush a batch (a timer, or the final flush) sets it first.
+ */
+static struct mote *sending;
+
+static void
+send_datagram(const uint8_t *data, uint16_t len)
+{
+  struct mote *m = sending;
+  uint8_t dest = m->next_gateway;
+
+  m->next_gateway = (m->next_gateway + 1) % gateway_count;
+  sensor_link_send(&m->link, dest, data, len);
+}
+
+/* Index of the gateway a datagram came from (any port), or -1 */
+static int
+gateway_index(const struct sockaddr_storage *from)
+{
+  unsigned int i;
+
+  for(i = 0; i < gateway_count; i++) {
+    if(from->ss_family != gateways[i].addr.ss_family) {
+      continue;
+    }
+    if(from->ss_family == AF_INET6 ?
+       memcmp(&((const struct sockaddr_in6 *)from)->sin6_addr,
+              &((const struct sockaddr_in6 *)&gateways[i].addr)->sin6_addr,
+              sizeof(struct in6_addr)) == 0 :
+       ((const struct sockaddr_in *)from)->sin_addr.s_addr ==
+       ((const struct sockaddr_in *)&gateways[i].addr)->sin_addr.s_addr) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/* Drains the downlink of one mote: NACKs are answered, anything else ignored */
+static void
+receive(struct mote *m)
+{
+  uint8_t buf[64];
+  struct sockaddr_storage from;
+  socklen_t from_len = sizeof(from);
+  ssize_t len;
+  int dest;
+
+  while((len = recvfrom(m->sock, buf, sizeof(buf), 0,
+                        (struct sockaddr *)&from, &from_len)) > 0) {
+    uint16_t retransmits = m->link.retransmits;
+    from_len = sizeof(from);
+    if((dest = gateway_index(&from)) < 0) {
+      continue;
+    }
+    if(sensor_link_input(&m->link, dest, buf, len)) {
+      stats.nacks++;
+      stats.retransmits += (uint16_t)(m->link.retransmits - retransmits);
+    }
+  }
+}
+
+static void
+report(void *ptr)
+{
+  struct mote *m = ptr;
+  int len = m->type->build(m);
+
+  ctimer_reset(&m->report_timer);
+  if(len < 0) {
+    stats.build_errors++;
+    return;
+  }
+  stats.events++;
+  sensor_batch_add(&m->batch, m->payload, len, m->type->urgent);
+}
+
+/* Resolves the comma separated -H list into gateways[] */
+static void
+resolve_gateways(char *hosts)
+{
+  struct addrinfo hints, *res;
+  char *host;
+  int err;
+
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_DGRAM;
+  for(host = strtok(hosts, ","); host != NULL; host = strtok(NULL, ",")) {
+    if(gateway_count == SENSOR_LINK_DESTS) {
+      fprintf(stderr, "at most %u gateways\n", SENSOR_LINK_DESTS);
+      exit(1);
+    }
+    if((err = getaddrinfo(host, NULL, &hints, &res)) != 0) {
+      fprintf(stderr, "%s: %s\n", host, gai_strerror(err));
+      exit(1);
+    }
+    if(gateway_count > 0 && res->ai_family != gateways[0].addr.ss_family) {
+      fprintf(stderr, "%s: all gateways must be IPv6 or all IPv4\n", host);
+      exit(1);
+    }
+    memcpy(&gateways[gateway_count].addr, res->ai_addr, res->ai_addrlen);
+    gateways[gateway_count].len = res->ai_addrlen;
+    gateway_count++;
+    freeaddrinfo(res);
+  }
+}
+
+static int
+open_socket(void)
+{
+  int sock = socket(gateways[0].addr.ss_family, SOCK_DGRAM, 0);
+
+  if(sock < 0) {
+    fprintf(stderr, "socket: %s\n", strerror(errno));
+    exit(1);
+  }
+  /* A full socket buffer is counted as a send error, never blocks the loop */
+  fcntl(sock, F_SETFL, O_NONBLOCK);
+  return sock;
+}
+
+static void
+raise_fd_limit(unsigned int needed)
+{
+  struct rlimit rl;
+
+  if(getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < needed) {
+    rl.rlim_cur = needed < rl.rlim_max ? needed : rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+    if(rl.rlim_cur < needed) {
+      fprintf(stderr, "need %u file descriptors but the limit is %lu; raise it with ulimit -n\n",
+              needed, (unsigned long)rl.rlim_cur);
+      exit(1);
+    }
+  }
+}
+
+static void
+on_signal(int sig)
+{
+  (void)sig;
+  running = 0;
+}
+
+static void
+usage(const char *prog)
+{
+  fprintf(stderr,
+          "usage: %s [-n motes] [-t types] [-i interval_ms] [-b] [-H host[,host...]] [-f first_device] [-d seconds] [-l loss%%]\n"
+          "  -n  motes per device type (default 100)\n"
+          "  -t  comma separated types: co2,light,printer,cctv,card (default all)\n"
+          "  -i  report interval of every mote in ms (default 2000)\n"
+          "  -b  send binary records instead of JSON\n"
+          "  -H  gateway addresses, sent to in turn (default aaaa::1)\n"
+          "  -f  device number of the first mote of each type (default 1000)\n"
+          "  -d  stop after this many seconds (default: run until interrupted)\n"
+          "  -l  drop this percentage of outgoing datagrams (default 0)\n",
+          prog);
+  exit(2);
+}
+
+int
+main(int argc, char *argv[])
+{
+  char default_host[] = "aaaa::1";
+  char *hosts = default_host;
+  char *types = NULL;
+  unsigned int per_type = 100, first_device = 1000, duration = 0;
+  uint8_t enabled[DEVICE_TYPE_COUNT];
+  unsigned int type_count = 0, mote_count, i, j;
+  struct mote *motes;
+  clock_time_t start, next_report;
+  uint64_t last_events = 0, last_datagrams = 0, last_bytes = 0;
+  struct epoll_event ready[256];
+  int epfd, opt;
+
+  while((opt = getopt(argc, argv, "n:t:i:bH:f:d:l:")) != -1) {
+    switch(opt) {
+    case 'n': per_type = strtoul(optarg, NULL, 10); break;
+    case 't': types = optarg; break;
+    case 'i': report_interval = strtoull(optarg, NULL, 10); break;
+    case 'b': binary = 1; break;
+    case 'H': hosts = optarg; break;
+    case 'f': first_device = strtoul(optarg, NULL, 10); break;
+    case 'd': duration = strtoul(optarg, NULL, 10); break;
+    case 'l': loss_rate = strtod(optarg, NULL) / 100; break;
+    default: usage(argv[0]);
+    }
+  }
+  if(per_type == 0 || report_interval == 0 || first_device + per_type > 0xffff ||
+     loss_rate < 0 || loss_rate >= 1) {
+    usage(argv[0]);
+  }
+
+  for(i = 0; i < DEVICE_TYPE_COUNT; i++) {
+    enabled[i] = types == NULL;
+  }
+  if(types != NULL) {
+    char *name;
+    for(name = strtok(types, ","); name != NULL; name = strtok(NULL, ",")) {
+      for(i = 0; i < DEVICE_TYPE_COUNT && strcmp(name, device_types[i].name) != 0; i++);
+      if(i == DEVICE_TYPE_COUNT) {
+        fprintf(stderr, "unknown device type %s\n", name);
+        usage(argv[0]);
+      }
+      enabled[i] = 1;
+    }
+  }
+  for(i = 0; i < DEVICE_TYPE_COUNT; i++) {
+    type_count += enabled[i];
+  }
+
+  resolve_gateways(hosts);
+  if(gateway_count == 0) {
+    usage(argv[0]);
+  }
+
+  mote_count = per_type * type_count;
+  raise_fd_limit(mote_count + 16);
+  motes = calloc(mote_count, sizeof(*motes));
+  if(motes == NULL) {
+    perror("calloc");
+    return 1;
+  }
+
+  epfd = epoll_create1(0);
+  if(epfd < 0) {
+    perror("epoll_create1");
+    return 1;
+  }
+
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+  srand(time(NULL));
+
+  /* Start every mote at a random offset within one interval */
+  start = clock_time();
+  for(i = 0, j = 0; i < DEVICE_TYPE_COUNT; i++) {
+    unsigned int n;
+    if(!enabled[i]) {
+      continue;
+    }
+    for(n = 0; n < per_type; n++, j++) {
+      struct mote *m = &motes[j];
+      struct epoll_event ev;
+      m->type = &device_types[i];
+      m->device_num = first_device + n;
+      m->counter = 1;
+      m->sock = open_socket();
+      ev.events = EPOLLIN;
+      ev.data.ptr = m;
+      epoll_ctl(epfd, EPOLL_CTL_ADD, m->sock, &ev);
+      sensor_batch_init(&m->batch, send_datagram);
+      sensor_link_init(&m->link, send_frame, (uint8_t)rand());
+      ctimer_set(&m->report_timer, rand() % report_interval, report, m);
+      m->report_timer.interval = report_interval;
+    }
+  }
+  printf("%u motes (%u per type), one report every %llu ms each, %s payloads to %u gateway(s), %.1f%% loss\n",
+         mote_count, per_type, (unsigned long long)report_interval,
+         binary ? "binary" : "JSON", gateway_count, loss_rate * 100);
+
+  next_report = start + 1000;
+  while(running) {
+    clock_time_t now = clock_time();
+    int wait_ms, n;
+
+    while(heap_len > 0 && heap[0]->expires <= now) {
+      struct ctimer *c = heap[0];
+      heap_remove(c);
+      /* Report and batch timers both point at the mote (the batch is its first member) */
+      sending = c->ptr;
+      c->f(c->ptr);
+    }
+
+    if(now >= next_report) {
+      printf("%6llus  %8llu events/s  %8llu datagrams/s  %10llu B/s  send errors %llu  dropped %llu  retransmits %llu\n",
+             (unsigned long long)((now - start) / 1000),
+             (unsigned long long)(stats.events - last_events),
+             (unsigned long long)(stats.datagrams - last_datagrams),
+             (unsigned long long)(stats.bytes - last_bytes),
+             (unsigned long long)stats.send_errors,
+             (unsigned long long)stats.dropped,
+             (unsigned long long)stats.retransmits);
+      fflush(stdout);
+      last_events = stats.events;
+      last_datagrams = stats.datagrams;
+      last_bytes = stats.bytes;
+      next_report += 1000;
+      if(duration > 0 && now - start >= (clock_time_t)duration * 1000) {
+        break;
+      }
+    }
+
+    /* Sleep until the next timer, waking early for NACKs from the gateway */
+    now = clock_time();
+    wait_ms = 1;
+    if(heap_len > 0 && heap[0]->expires > now + 1) {
+      clock_time_t delay = heap[0]->expires - now;
+      if(delay > next_report - now) {
+        delay = next_report - now;
+      }
+      wait_ms = (int)delay;
+    }
+    n = epoll_wait(epfd, ready, sizeof(ready) / sizeof(ready[0]), wait_ms);
+    for(j = 0; (int)j < n; j++) {
+      receive(ready[j].data.ptr);
+    }
+  }
+
+  /* Send what is still queued so the totals match what left the motes */
+  for(i = 0; i < mote_count; i++) {
+    sending = &motes[i];
+    sensor_batch_flush(&motes[i].batch);
+    close(motes[i].sock);
+  }
+  printf("total: %llu events in %llu datagrams (%llu bytes), %llu send errors, %llu build errors\n",
+         (unsigned long long)stats.events, (unsigned long long)stats.datagrams,
+         (unsigned long long)stats.bytes, (unsigned long long)stats.send_errors,
+         (unsigned long long)stats.build_errors);
+  printf("link: %llu datagrams dropped, %llu NACKs, %llu retransmitted\n",
+         (unsigned long long)stats.dropped, (unsigned long long)stats.nacks,
+         (unsigned long long)stats.retransmits);
+  close(epfd);
+  free(motes);
+  free(heap);
+  return 0;
+}
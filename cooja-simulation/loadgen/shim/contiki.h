@@ -0,0 +1,18 @@
+#ifndef LOADGEN_CONTIKI_H_
+#define LOADGEN_CONTIKI_H_
+
+/*
+ * Minimal stand-in for contiki.h so the firmware's sensor-*.c modules build
+ * on the host. Clock ticks are milliseconds.
+ */
+
+#include <stdint.h>
+
+typedef uint64_t clock_time_t;
+
+#define CLOCK_SECOND 1000
+
+/* Monotonic milliseconds, provided by mote-loadgen.c */
+clock_time_t clock_time(void);
+
+#endif /* LOADGEN_CONTIKI_H_ */
@@ -0,0 +1,24 @@
+#ifndef LOADGEN_CTIMER_H_
+#define LOADGEN_CTIMER_H_
+
+/*
+ * Callback timers for the host load generator, API-compatible with the parts
+ * of Contiki's ctimer used by sensor-batch.c. Timers live in one min-heap
+ * driven by the load generator's event loop.
+ */
+
+#include "contiki.h"
+
+struct ctimer {
+  clock_time_t expires;
+  clock_time_t interval;
+  void (*f)(void *);
+  void *ptr;
+  unsigned int slot;   /* heap position + 1, 0 when not scheduled */
+};
+
+void ctimer_set(struct ctimer *c, clock_time_t t, void (*f)(void *), void *ptr);
+void ctimer_reset(struct ctimer *c);
+void ctimer_stop(struct ctimer *c);
+
+#endif /* LOADGEN_CTIMER_H_ */
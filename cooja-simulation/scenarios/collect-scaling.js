@@ -0,0 +1,141 @@
+'use strict';
+
+// Joins the per-mote report of a scaling scenario (scaling-stats.js) with
+// what the ingestion gateway measured for the same motes: delivery ratio
+// from the link sequence numbers (GET /links) and mote-to-gateway latency
+// (GET /devices). Prints one row per hop count and writes the per-mote join
+// as JSON, so runs of growing size show where the single sink saturates.
+//
+// usage: node collect-scaling.js <scenario>-motes.csv [gateway stats URL] [out.json]
+//   e.g. node collect-scaling.js grid-200-motes.csv http://localhost:8850 grid-200.json
+
+const fs = require('fs');
+const http = require('http');
+
+function getJSON(url) {
+  return new Promise((resolve, reject) => {
+    http.get(url, (res) => {
+      let body = '';
+      res.setEncoding('utf8');
+      res.on('data', (chunk) => { body += chunk; });
+      res.on('end', () => {
+        try {
+          resolve(JSON.parse(body));
+        } catch (error) {
+          reject(new Error(`${url}: ${error.message}`));
+        }
+      });
+    }).on('error', reject);
+  });
+}
+
+/**
+ * Full eight-group form of an IPv6 address, so the mote's own formatting
+ * and Node's compare equal.
+ */
+function expandIPv6(address) {
+  const [head, tail] = address.toLowerCase().split('::');
+  const left = head ? head.split(':') : [];
+  const right = tail !== undefined && tail ? tail.split(':') : [];
+  const zeros = tail !== undefined ? Array(8 - left.length - right.length).fill('0') : [];
+  return [...left, ...zeros, ...right].map((group) => group.replace(/^0+(?=.)/, '')).join(':');
+}
+
+function readMotes(path) {
+  const [header, ...lines] = fs.readFileSync(path, 'utf8').trim().split('\n');
+  const names = header.split(',');
+  return lines.map((line) => {
+    const values = line.split(',');
+    return Object.fromEntries(names.map((name, i) => [name, values[i]]));
+  });
+}
+
+const ratio = (part, whole) => (whole > 0 ? part / whole : null);
+const percent = (value) => (value === null ? 'n/a' : `${(value * 100).toFixed(2)}%`);
+
+async function main() {
+  const [motesPath, gateway = 'http://localhost:8850', outPath] = process.argv.slice(2);
+  if (!motesPath) {
+    console.error('usage: node collect-scaling.js <scenario>-motes.csv [gateway stats URL] [out.json]');
+    process.exit(2);
+  }
+  const motes = readMotes(motesPath);
+  const [links, devices] = await Promise.all([getJSON(`${gateway}/links`), getJSON(`${gateway}/devices`)]);
+
+  const linksByAddress = new Map();
+  for (const source of links.bySource || []) {
+    const address = expandIPv6(source.source.replace(/^\[(.*)\]:\d+$/, '$1'));
+    // A mote may show up under several boots or ports; add them up
+    const total = linksByAddress.get(address) || { received: 0, recovered: 0, lost: 0 };
+    total.received += source.received;
+    total.recovered += source.recovered;
+    total.lost += source.lost;
+    linksByAddress.set(address, total);
+  }
+  const devicesByAddress = new Map(devices.map((device) => [expandIPv6(device.address), device]));
+
+  const joined = motes.map((mote) => {
+    const address = mote.address && mote.address !== '-' ? expandIPv6(mote.address) : null;
+    const link = address ? linksByAddress.get(address) : undefined;
+    const device = address ? devicesByAddress.get(address) : undefined;
+    return {
+      ...mote,
+      hops: mote.hops === '' ? null : Number(mote.hops),
+      received: link ? link.received : 0,
+      recovered: link ? link.recovered : 0,
+      lost: link ? link.lost : 0,
+      deviceID: device ? device.deviceID : null,
+      meanLatencyMs: device ? device.meanLatencyMs : null,
+      maxLatencyMs: device ? device.maxLatencyMs : null,
+      latencyEvents: device ? device.latencyEvents : 0
+    };
+  });
+
+  const byHops = new Map();
+  for (const mote of joined) {
+    const key = mote.hops === null ? 'none' : mote.hops;
+    const row = byHops.get(key) || {
+      motes: 0, silent: 0, received: 0, recovered: 0, lost: 0,
+      latencySum: 0, latencyEvents: 0, maxLatencyMs: 0, forwarded: 0, drops: 0
+    };
+    row.motes++;
+    row.silent += mote.received === 0 ? 1 : 0;
+    row.received += mote.received;
+    row.recovered += mote.recovered;
+    row.lost += mote.lost;
+    row.latencySum += (mote.meanLatencyMs || 0) * mote.latencyEvents;
+    row.latencyEvents += mote.latencyEvents;
+    row.maxLatencyMs = Math.max(row.maxLatencyMs, mote.maxLatencyMs || 0);
+    row.forwarded += Number(mote.forwarded);
+    row.drops += Number(mote.drops);
+    byHops.set(key, row);
+  }
+
+  const columns = ['hops', 'motes', 'silent', 'delivered', 'raw', 'mean_ms', 'max_ms', 'forwarded', 'drops'];
+  console.log(columns.map((name) => name.padStart(11)).join(''));
+  const keys = [...byHops.keys()].sort((a, b) => (a === 'none') - (b === 'none') || a - b);
+  for (const key of keys) {
+    const row = byHops.get(key);
+    const sent = row.received + row.lost;
+    console.log([
+      key, row.motes, row.silent,
+      percent(ratio(row.received, sent)),
+      percent(ratio(row.received - row.recovered, sent)),
+      row.latencyEvents ? Math.round(row.latencySum / row.latencyEvents) : 'n/a',
+      row.latencyEvents ? row.maxLatencyMs : 'n/a',
+      row.forwarded, row.drops
+    ].map((cell) => String(cell).padStart(11)).join(''));
+  }
+  console.log(`gateway: ${links.received} received, ${links.recovered} recovered, ` +
+    `${links.lost} lost (${percent(links.lossRate)} loss)`);
+
+  if (outPath) {
+    fs.writeFileSync(outPath, JSON.stringify({ links, motes: joined }, null, 2));
+    console.log(`Per-mote results written to ${outPath}`);
+  }
+}
+
+main().catch((error) => {
+  console.error(error.message);
+  process.exit(1);
+});
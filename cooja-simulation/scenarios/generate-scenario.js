@@ -0,0 +1,351 @@
+'use strict';
+
+// Generates multi-hop Cooja scenarios for scaling tests: RPL border routers
+// (the sinks, each bridged to a gateway host by tunslip6) and any
+// number of sensor motes laid out as a grid, a corridor or at random, with a
+// chosen mix of device types and UDGM loss. The collection script
+// (scaling-stats.js) is embedded with the run length of the scenario.
+//
+// usage: node generate-scenario.js [--layout grid|corridor|random] [--motes 100]
+//          [--mix co2=40,light=30,printer=10,cctv=10,card=10] [--spacing 35]
+//          [--range 50] [--tx 1.0] [--rx 0.8] [--sink corner|center] [--sinks 1]
+//          [--format bin|json] [--minutes 20] [--seed 1] [--out <name>.csc]
+
+const fs = require('fs');
+const path = require('path');
+
+const FIRMWARES = {
+  co2: 'co2sensor',
+  light: 'lights',
+  printer: 'printers',
+  cctv: 'cameras',
+  card: 'cardreader'
+};
+
+const DEFAULTS = {
+  layout: 'grid',
+  motes: 100,
+  mix: 'co2=40,light=30,printer=10,cctv=10,card=10',
+  spacing: 35,
+  range: 50,
+  tx: 1.0,
+  rx: 0.8,
+  sink: 'corner',
+  sinks: 1,
+  format: 'bin',
+  minutes: 20,
+  seed: 1,
+  out: null
+};
+
+// Corridor: two rows of motes this far apart (m)
+const CORRIDOR_WIDTH = 10;
+// Not counted in the report: RPL needs a few minutes to build the DODAG
+const WARMUP_MINUTES = 3;
+const BORDER_ROUTER_FIRMWARE = '[CONTIKI_DIR]/examples/ipv6/rpl-border-router/border-router.z1';
+
+const Z1_INTERFACES = [
+  'org.contikios.cooja.interfaces.Position',
+  'org.contikios.cooja.interfaces.RimeAddress',
+  'org.contikios.cooja.interfaces.IPAddress',
+  'org.contikios.cooja.interfaces.Mote2MoteRelations',
+  'org.contikios.cooja.interfaces.MoteAttributes',
+  'org.contikios.cooja.mspmote.interfaces.MspClock',
+  'org.contikios.cooja.mspmote.interfaces.MspMoteID',
+  'org.contikios.cooja.mspmote.interfaces.MspButton',
+  'org.contikios.cooja.mspmote.interfaces.Msp802154Radio',
+  'org.contikios.cooja.mspmote.interfaces.MspDefaultSerial',
+  'org.contikios.cooja.mspmote.interfaces.MspLED',
+  'org.contikios.cooja.mspmote.interfaces.MspDebugOutput'
+];
+
+function parseArgs(argv) {
+  const options = { ...DEFAULTS };
+  for (let i = 0; i < argv.length; i += 2) {
+    const name = argv[i].replace(/^--/, '');
+    if (!(name in DEFAULTS) || argv[i + 1] === undefined) {
+      throw new Error(`unknown or incomplete option ${argv[i]}`);
+    }
+    options[name] = typeof DEFAULTS[name] === 'number' ? Number(argv[i + 1]) : argv[i + 1];
+  }
+  if (!['grid', 'corridor', 'random'].includes(options.layout)) {
+    throw new Error(`unknown layout ${options.layout}`);
+  }
+  if (!Number.isInteger(options.motes) || options.motes < 1) {
+    throw new Error('--motes must be a positive integer');
+  }
+  if (!Number.isInteger(options.sinks) || options.sinks < 1 || options.sinks > 4) {
+    throw new Error('--sinks must be 1 to 4 (SENSOR_LINK_DESTS)');
+  }
+  if (!(options.rx > 0 && options.rx <= 1 && options.tx > 0 && options.tx <= 1)) {
+    throw new Error('--tx and --rx are success ratios in (0, 1]');
+  }
+  return options;
+}
+
+// Small seeded PRNG (mulberry32) so a scenario is reproducible from its options
+function random(seed) {
+  let state = seed >>> 0;
+  return () => {
+    state = (state + 0x6D2B79F5) >>> 0;
+    let t = state;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+/**
+ * Device types for count motes in the given proportions (largest remainder),
+ * shuffled so every type is spread over the whole area.
+ */
+function assignTypes(mix, count, rand) {
+  const shares = mix.split(',').map((entry) => {
+    const [type, weight] = entry.split('=');
+    if (!FIRMWARES[type] || !(Number(weight) >= 0)) {
+      throw new Error(`bad mix entry ${entry} (types: ${Object.keys(FIRMWARES).join(', ')})`);
+    }
+    return { type, weight: Number(weight) };
+  });
+  const total = shares.reduce((sum, share) => sum + share.weight, 0);
+  if (total <= 0) {
+    throw new Error('mix weights must not all be zero');
+  }
+  for (const share of shares) {
+    share.exact = (share.weight / total) * count;
+    share.count = Math.floor(share.exact);
+  }
+  let missing = count - shares.reduce((sum, share) => sum + share.count, 0);
+  for (const share of [...shares].sort((a, b) => (b.exact - b.count) - (a.exact - a.count))) {
+    if (missing-- <= 0) {
+      break;
+    }
+    share.count++;
+  }
+  const types = shares.flatMap((share) => Array(share.count).fill(share.type));
+  for (let i = types.length - 1; i > 0; i--) {
+    const j = Math.floor(rand() * (i + 1));
+    [types[i], types[j]] = [types[j], types[i]];
+  }
+  return types;
+}
+
+/**
+ * Positions of the sinks and of the motes, sinks first: the first one at the
+ * corner or center, every other one as far as possible from those before.
+ */
+function layOut(options, rand) {
+  const points = layOutFirstSink({ ...options, motes: options.motes + options.sinks - 1 }, rand);
+  for (let k = 1; k < options.sinks; k++) {
+    let best = k;
+    let bestDistance = -1;
+    for (let i = k; i < points.length; i++) {
+      const distance = Math.min(...points.slice(0, k).map((p) => Math.hypot(p.x - points[i].x, p.y - points[i].y)));
+      if (distance > bestDistance) {
+        best = i;
+        bestDistance = distance;
+      }
+    }
+    [points[k], points[best]] = [points[best], points[k]];
+  }
+  return points;
+}
+
+function layOutFirstSink(options, rand) {
+  const { layout, motes, spacing } = options;
+  const points = [];
+  if (layout === 'grid') {
+    const columns = Math.ceil(Math.sqrt(motes + 1));
+    for (let i = 0; i <= motes; i++) {
+      points.push({ x: (i % columns) * spacing, y: Math.floor(i / columns) * spacing });
+    }
+  } else if (layout === 'corridor') {
+    for (let i = 0; i <= motes; i++) {
+      points.push({ x: Math.floor(i / 2) * spacing, y: (i % 2) * CORRIDOR_WIDTH });
+    }
+  } else {
+    // Same density as the grid of this spacing
+    const side = spacing * Math.sqrt(motes + 1);
+    points.push({ x: 0, y: 0 });
+    for (let i = 0; i < motes; i++) {
+      points.push({ x: rand() * side, y: rand() * side });
+    }
+    if (options.sink === 'center') {
+      points[0] = { x: side / 2, y: side / 2 };
+    }
+    return points;
+  }
+  if (options.sink === 'center') {
+    // Swap the point nearest the centroid into the sink slot
+    const cx = points.reduce((sum, p) => sum + p.x, 0) / points.length;
+    const cy = points.reduce((sum, p) => sum + p.y, 0) / points.length;
+    let best = 0;
+    points.forEach((p, i) => {
+      if (Math.hypot(p.x - cx, p.y - cy) < Math.hypot(points[best].x - cx, points[best].y - cy)) {
+        best = i;
+      }
+    });
+    [points[0], points[best]] = [points[best], points[0]];
+  }
+  return points;
+}
+
+/**
+ * Fewest radio hops from the nearest of the first sinks points to every
+ * point within range, or -1 for points none can reach. RPL picks parents by
+ * link quality, so real paths are at least this long.
+ */
+function minimumHops(points, sinks, range) {
+  const hops = points.map((p, i) => (i < sinks ? 0 : -1));
+  const queue = [...Array(sinks).keys()];
+  while (queue.length > 0) {
+    const from = queue.shift();
+    points.forEach((p, i) => {
+      if (hops[i] < 0 && Math.hypot(p.x - points[from].x, p.y - points[from].y) <= range) {
+        hops[i] = hops[from] + 1;
+        queue.push(i);
+      }
+    });
+  }
+  return hops;
+}
+
+const escapeXML = (text) => text.replace(/&/g, '&amp;').replace(/</g, '&lt;').replace(/>/g, '&gt;');
+
+function moteTypeXML(identifier, description, firmware) {
+  return [
+    '    <motetype>',
+    '      org.contikios.cooja.mspmote.Z1MoteType',
+    `      <identifier>${identifier}</identifier>`,
+    `      <description>${description}</description>`,
+    `      <firmware EXPORT="copy">${firmware}</firmware>`,
+    ...Z1_INTERFACES.map((name) => `      <moteinterface>${name}</moteinterface>`),
+    '    </motetype>'
+  ].join('\n');
+}
+
+function moteXML(id, point, typeIdentifier) {
+  return [
+    '    <mote>',
+    '      <breakpoints />',
+    '      <interface_config>',
+    '        org.contikios.cooja.interfaces.Position',
+    `        <x>${point.x.toFixed(1)}</x>`,
+    `        <y>${point.y.toFixed(1)}</y>`,
+    '        <z>0.0</z>',
+    '      </interface_config>',
+    '      <interface_config>',
+    '        org.contikios.cooja.mspmote.interfaces.MspClock',
+    '        <deviation>1.0</deviation>',
+    '      </interface_config>',
+    '      <interface_config>',
+    '        org.contikios.cooja.mspmote.interfaces.MspMoteID',
+    `        <id>${id}</id>`,
+    '      </interface_config>',
+    `      <motetype_identifier>${typeIdentifier}</motetype_identifier>`,
+    '    </mote>'
+  ].join('\n');
+}
+
+function pluginXML(plugin, moteArg, config, width, height, x, y) {
+  return [
+    '  <plugin>',
+    `    ${plugin}`,
+    ...(moteArg !== null ? [`    <mote_arg>${moteArg}</mote_arg>`] : []),
+    ...(config ? ['    <plugin_config>', config, '    </plugin_config>'] : []),
+    `    <width>${width}</width>`,
+    '    <z>0</z>',
+    `    <height>${height}</height>`,
+    `    <location_x>${x}</location_x>`,
+    `    <location_y>${y}</location_y>`,
+    '  </plugin>'
+  ].join('\n');
+}
+
+/**
+ * scaling-stats.js with the run length and report file of this scenario.
+ */
+function collectionScript(options, reportFile) {
+  const durationMs = options.minutes * 60 * 1000;
+  return fs.readFileSync(path.join(__dirname, 'scaling-stats.js'), 'utf8')
+    .replace(/^TIMEOUT\(\d+/m, `TIMEOUT(${durationMs + 60000}`)
+    .replace(/^var DURATION_MS = .*$/m, `var DURATION_MS = ${durationMs};`)
+    .replace(/^var WARMUP_US = .*$/m, `var WARMUP_US = ${WARMUP_MINUTES * 60} * 1000000;`)
+    .replace(/^var REPORT_FILE = .*$/m, `var REPORT_FILE = "${reportFile}";`);
+}
+
+function generate(options) {
+  const rand = random(options.seed);
+  const types = assignTypes(options.mix, options.motes, rand);
+  const points = layOut(options, rand);
+  const suffix = options.format === 'bin' ? '-bin' : '';
+  const name = path.basename(options.out ||
+    `${options.layout}-${options.motes}${options.sinks > 1 ? `-${options.sinks}sinks` : ''}.csc`, '.csc');
+  const usedTypes = Object.keys(FIRMWARES).filter((type) => types.includes(type));
+
+  const sections = [
+    '<?xml version="1.0" encoding="UTF-8"?>',
+    '<simconf>',
+    ...['mrm', 'mspsim', 'avrora', 'serial_socket', 'collect-view', 'powertracker']
+      .map((project) => `  <project EXPORT="discard">[APPS_DIR]/${project}</project>`),
+    '  <simulation>',
+    `    <title>Scaling ${options.layout} ${options.motes} motes, ${options.sinks} sink(s) ` +
+      `(${options.mix}, rx ${options.rx})</title>`,
+    `    <randomseed>${options.seed}</randomseed>`,
+    '    <motedelay_us>1000000</motedelay_us>',
+    '    <radiomedium>',
+    '      org.contikios.cooja.radiomediums.UDGM',
+    `      <transmitting_range>${options.range.toFixed(1)}</transmitting_range>`,
+    `      <interference_range>${(options.range * 2).toFixed(1)}</interference_range>`,
+    `      <success_ratio_tx>${options.tx}</success_ratio_tx>`,
+    `      <success_ratio_rx>${options.rx}</success_ratio_rx>`,
+    '    </radiomedium>',
+    '    <events>',
+    '      <logoutput>40000</logoutput>',
+    '    </events>',
+    moteTypeXML('br', 'rpl-border-router', BORDER_ROUTER_FIRMWARE),
+    ...usedTypes.map((type) =>
+      moteTypeXML(type, FIRMWARES[type] + suffix, `[CONFIG_DIR]/../sensors/${FIRMWARES[type]}${suffix}.z1`)),
+    ...points.slice(0, options.sinks).map((point, k) => moteXML(k + 1, point, 'br')),
+    ...types.map((type, i) => moteXML(options.sinks + i + 1, points[options.sinks + i], type)),
+    '  </simulation>',
+    // tunslip6 attaches to each border router's serial port
+    ...points.slice(0, options.sinks).map((point, k) =>
+      pluginXML('org.contikios.cooja.serialsocket.SerialSocketServer', k,
+        `      <port>${60001 + k}</port>\n      <bound>true</bound>`, 362, 116, 0, k * 120)),
+    pluginXML('org.contikios.cooja.plugins.ScriptRunner', null,
+      `      <script>${escapeXML(collectionScript(options, `${name}-motes.csv`))}</script>\n      <active>true</active>`,
+      600, 700, 0, options.sinks * 120),
+    pluginXML('org.contikios.cooja.plugins.LogListener', null,
+      '      <filter>NET 1</filter>\n      <formatted_time />', 900, 300, 600, 0),
+    '</simconf>',
+    ''
+  ];
+  return { xml: sections.join('\n'), name, points, types };
+}
+
+function main() {
+  let options;
+  try {
+    options = parseArgs(process.argv.slice(2));
+  } catch (error) {
+    console.error(error.message);
+    console.error('usage: node generate-scenario.js [--layout grid|corridor|random] [--motes N] ' +
+      '[--mix co2=40,light=30,...] [--spacing m] [--range m] [--tx ratio] [--rx ratio] ' +
+      '[--sink corner|center] [--sinks N] [--format bin|json] [--minutes N] [--seed N] [--out file.csc]');
+    process.exit(2);
+  }
+  const { xml, name, points, types } = generate(options);
+  const file = path.join(__dirname, `${name}.csc`);
+  fs.writeFileSync(file, xml);
+
+  const hops = minimumHops(points, options.sinks, options.range);
+  const unreachable = hops.filter((h) => h < 0).length;
+  const counts = types.reduce((acc, type) => ({ ...acc, [type]: (acc[type] || 0) + 1 }), {});
+  console.log(`Wrote ${file}`);
+  console.log(`  ${options.motes} motes + ${options.sinks} border router(s), ${Object.entries(counts).map(([t, n]) => `${n} ${t}`).join(', ')}`);
+  console.log(`  at least ${Math.max(...hops)} hops to the farthest mote` +
+    (unreachable ? `; ${unreachable} motes out of range of every neighbour` : ''));
+}
+
+main();
@@ -0,0 +1,131 @@
+/*
+ * Cooja ScriptRunner script for the scenarios written by generate-scenario.js
+ * (which embeds it with the run length of each scenario): per-mote routing
+ * and forwarding report of the sensor firmwares built with `make SCALE=1`.
+ *
+ * Collects the NET lines every mote prints (see sensor-netstat.h). At
+ * DURATION_MS of simulated time it follows the preferred-parent chain of
+ * every mote to the border router to get its hop count and writes
+ * REPORT_FILE with one row per mote: hops, RPL rank, IP packets sent,
+ * forwarded and dropped after warm-up, and the fewest free queue buffers
+ * seen. The per-hop totals are logged. Delivery ratio and latency are
+ * measured on the gateway side and joined by collect-scaling.js.
+ */
+
+/* Safety net only: the report is written at DURATION_MS */
+TIMEOUT(1260000, writeReport());
+
+var DURATION_MS = 20 * 60 * 1000;
+var WARMUP_US = 180 * 1000000;
+var REPORT_FILE = "scaling-motes.csv";
+
+/* Longer parent chains than this are routing loops */
+var MAX_HOPS = 64;
+
+/* A real-time link to the gateway: Cooja must not run ahead of tunslip6 */
+sim.setSpeedLimit(1.0);
+
+var motes = {};
+
+function parse(line) {
+  var fields = {};
+  var parts = line.split(" ");
+  for (var i = 2; i < parts.length; i++) {
+    var kv = parts[i].split("=");
+    fields[kv[0]] = kv[1];
+  }
+  return fields;
+}
+
+/* Hops from a mote to the border router, or -1 without a route or in a loop */
+function hopsOf(m, byIid) {
+  var hops = 0;
+  while (hops <= MAX_HOPS) {
+    if (m.last.parent === "-") {
+      return -1;
+    }
+    hops++;
+    var parent = byIid[m.last.parent];
+    if (!parent) {
+      /* Not a sensor mote: the border router */
+      return hops;
+    }
+    m = parent;
+  }
+  return -1;
+}
+
+/* uIP statistics are 16-bit counters */
+function counter(m, key) {
+  var base = m.first !== null ? Number(m.first[key]) : 0;
+  return (Number(m.last[key]) - base + 65536) % 65536;
+}
+
+function writeReport() {
+  var byIid = {};
+  for (var id in motes) {
+    if (motes[id].last !== null && motes[id].last.id !== "-") {
+      byIid[motes[id].last.id] = motes[id];
+    }
+  }
+
+  var header = "mote,firmware,device,address,hops,rank,sent,forwarded,drops,queue_free_min";
+  var out = new java.io.PrintWriter(new java.io.FileWriter(REPORT_FILE));
+  out.println(header);
+  var perHop = {};
+  for (var id in motes) {
+    var m = motes[id];
+    if (m.last === null) {
+      log.log("mote " + id + " (" + m.type + "): no NET line after warm-up\n");
+      continue;
+    }
+    var hops = hopsOf(m, byIid);
+    var sent = counter(m, "sent");
+    var forwarded = counter(m, "fwd");
+    var drops = counter(m, "drop");
+    out.println([id, m.type, m.last.dev, m.last.addr, hops >= 0 ? hops : "",
+                 m.last.rank, sent, forwarded, drops, m.qfreeMin].join(","));
+
+    var h = perHop[hops] || (perHop[hops] = { motes: 0, sent: 0, forwarded: 0, drops: 0, qfreeMin: 999 });
+    h.motes++;
+    h.sent += sent;
+    h.forwarded += forwarded;
+    h.drops += drops;
+    h.qfreeMin = Math.min(h.qfreeMin, m.qfreeMin);
+  }
+  out.close();
+
+  log.log("hops,motes,sent,forwarded,drops,queue_free_min\n");
+  for (var hops in perHop) {
+    var h = perHop[hops];
+    log.log([hops < 0 ? "no route" : hops, h.motes, h.sent, h.forwarded, h.drops, h.qfreeMin].join(",") + "\n");
+  }
+  log.log("Mote report written to " +
+          new java.io.File(REPORT_FILE).getAbsolutePath() + "\n");
+  log.testOK();
+}
+
+GENERATE_MSG(DURATION_MS, "report");
+
+while (true) {
+  YIELD();
+  var line = String(msg);
+  if (line === "report") {
+    writeReport();
+  }
+  if (line.indexOf("NET 1 ") !== 0) {
+    continue;
+  }
+  if (!motes[id]) {
+    motes[id] = { type: String(mote.getType().getDescription()), first: null, last: null, qfreeMin: 999 };
+  }
+  if (time < WARMUP_US) {
+    continue;
+  }
+  var fields = parse(line);
+  if (motes[id].first === null && motes[id].last !== null) {
+    motes[id].first = motes[id].last;
+  }
+  motes[id].last = fields;
+  motes[id].qfreeMin = Math.min(motes[id].qfreeMin, Number(fields.qfree));
+}
@@ -8,19 +8,31 @@
 #include "dev/serial-line.h"
 #include "net/ipv6/uip-ds6.h"
 #include "sys/etimer.h"
+#include "lib/random.h"
 #include "simple-udp.h"
 #include "net/ip/uip-debug.h"
+#include "sensor-codec.h"
+#include "sensor-batch.h"
+#include "sensor-config.h"
+#include "sensor-payloads.h"
+#include "sensor-format.h"
+#include "sensor-link.h"
+#include "sensor-netstat.h"
+#include "sensor-profile.h"
+#include "sensor-sink.h"
 
 #define UDP_PORT_CENTRAL 8844
 #define UDP_PORT_OUT 5555
-#define CLOCK_REPORT CLOCK_SECOND*2
 static struct simple_udp_connection broadcast_connection;
-static uip_ipaddr_t server_addr;
-static uint16_t central_addr[] = {0xaaaa, 0, 0, 0, 0, 0, 0, 0x1};
+static struct sensor_batch batch;
+static struct sensor_config config;
+static struct sensor_link uplink;
+static struct sensor_sink sinks;
 
 void connect_udp_server();
+static void send_datagram(const uint8_t *data, uint16_t len);
+static void send_frame(struct sensor_link *l, uint8_t dest, const uint8_t *data, uint16_t len);
 void uip_debug_ipaddr_print(const uip_ipaddr_t *addr);
-int ipaddr_sprintf(char *buf, uint8_t buf_len, const uip_ipaddr_t *addr);
 int sicslowpan_get_last_rssi();
 
 PROCESS(init_system_proc, "Init system process");
@@ -29,21 +41,21 @@ AUTOSTART_PROCESSES(&init_system_proc);
 PROCESS_THREAD(init_system_proc, ev, data) {
     PROCESS_BEGIN();
     static struct etimer periodic_timer;
-    uint8_t buff_udp[256];
-    uint8_t device_address[30],
-            device_id[17];
+    uint8_t buff_udp[SENSOR_PAYLOAD_MAX];
+    char device_address[32];
     static int event_counter = 1;
+    int payload_len;
 
     /* Build an identifier from the node address */
-    sprintf((char *)device_id, "%02X%02X%02X%02X%02X%02X%02X%02X",
-            linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1],
-            linkaddr_node_addr.u8[2], linkaddr_node_addr.u8[3],
-            linkaddr_node_addr.u8[4], linkaddr_node_addr.u8[5],
-            linkaddr_node_addr.u8[6], linkaddr_node_addr.u8[7]);
-    sprintf((char *)device_address, "[%c%c%c%c]-Device-%s", 
-            device_id[12], device_id[13], device_id[14], device_id[15], device_id);
+    sensor_format_device_address(device_address, sizeof(device_address),
+                                 linkaddr_node_addr.u8, LINKADDR_SIZE);
     connect_udp_server();
-    etimer_set(&periodic_timer, CLOCK_REPORT);
+    sensor_batch_init(&batch, send_datagram);
+    sensor_link_init(&uplink, send_frame, (uint8_t)random_rand());
+    sensor_config_init(&config, 1);
+    SENSOR_PROFILE_INIT(config.device_num);
+    SENSOR_NETSTAT_INIT(config.device_num);
+    etimer_set(&periodic_timer, config.report_interval);
     printf("Device initialized - %s\n", device_address);
 
     while (1) {
@@ -52,21 +64,19 @@ PROCESS_THREAD(init_system_proc, ev, data) {
         if (etimer_expired(&periodic_timer)) {
             etimer_reset(&periodic_timer);
 
-            /* Prepare a dynamic JSON payload to mimic a card reader */
-            sprintf((char *)buff_udp,
-                "{"
-                "\"eventID\":\"card_%03d\","
-                "\"deviceType\":\"card_reader\","
-                "\"deviceID\":\"reader_01\","
-                "\"timestamp\":\"2025-03-14T10:15:30Z\","
-                "\"eventType\":\"swipe\","
-                "\"location\":\"Building A - Main Entrance\","
-                "\"metadata\":\"userID:user%d; cardID:card%d\""
-                "}",
-                event_counter++, rand() % 1000, rand() % 1000);
+            SENSOR_PROFILE_BUILD_BEGIN();
+            payload_len = sensor_payload_card(buff_udp, sizeof(buff_udp), SENSOR_PAYLOAD_BINARY,
+                                              config.device_num, uplink.boot_id, event_counter++,
+                                              rand() % 1000, rand() % 1000);
+            SENSOR_PROFILE_BUILD_END(payload_len);
+            if (payload_len < 0) {
+                printf("Card swipe event does not fit in %u bytes, skipped\n", (unsigned)sizeof(buff_udp));
+                continue;
+            }
 
+            /* Swipes are access events: flush the batch right away */
             printf("Sending card swipe event to UDP Server at border router...\n");
-            simple_udp_sendto(&broadcast_connection, buff_udp, strlen((const char *)buff_udp), &server_addr);
+            sensor_batch_add(&batch, buff_udp, payload_len, 1);
         }
     }
     PROCESS_END();
@@ -79,20 +89,42 @@ void cb_receive_udp(struct simple_udp_connection *c,
                     uint16_t receiver_port,
                     const uint8_t *data,
                     uint16_t datalen) {
+    int sink = sensor_sink_lookup(&sinks, sender_addr);
+
+    if (sink < 0) {
+        return;
+    }
+    if (sensor_link_input(&uplink, sink, data, datalen)) {
+        return;
+    }
     printf("########## UDP #########\n");
-    printf("Received from UDP Server: %s\n", data);
+    printf("Received %u bytes from UDP Server\n", datalen);
+}
+
+static void send_datagram(const uint8_t *data, uint16_t len) {
+    sensor_link_send(&uplink, sensor_sink_select(&sinks), data, len);
+}
+
+static void send_frame(struct sensor_link *l, uint8_t dest, const uint8_t *data, uint16_t len) {
+    SENSOR_PROFILE_SEND_BEGIN();
+    simple_udp_sendto(&broadcast_connection, data, len, sensor_sink_addr(&sinks, dest));
+    SENSOR_PROFILE_SEND_END(len);
 }
 
 void connect_udp_server() {
-    uip_ip6addr(&server_addr,
-                central_addr[0],
-                central_addr[1],
-                central_addr[2],
-                central_addr[3],
-                central_addr[4],
-                central_addr[5],
-                central_addr[6],
-                central_addr[7]);
-    
-    simple_udp_register(&broadcast_connection, UDP_PORT_OUT, NULL, UDP_PORT_CENTRAL, cb_receive_udp);
+    uint8_t i;
+
+    sensor_sink_init(&sinks);
+    for (i = 0; i < sinks.count; i++) {
+        printf("IPv6 UDP server: ");
+        uip_debug_ipaddr_print(sensor_sink_addr(&sinks, i));
+        printf("\n");
+    }
+
+    /* No remote address, as any of the sinks may send; cb_receive_udp drops other senders */
+    simple_udp_register(&broadcast_connection,
+                        UDP_PORT_OUT,
+                        NULL,
+                        UDP_PORT_CENTRAL,
+                        cb_receive_udp);
 }
\ No newline at end of file
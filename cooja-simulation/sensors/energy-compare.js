@@ -0,0 +1,49 @@
+'use strict';
+
+// Compares two energy-report.csv files written by energy-report.js (e.g.
+// before and after a firmware change), firmware by firmware.
+//
+// usage: node energy-compare.js base.csv head.csv
+
+const fs = require('fs');
+
+const COLUMNS = ['air_bytes_per_event', 'radio_on_pct', 'avg_current_ma', 'mj_per_event', 'battery_days'];
+
+function readReport(path) {
+  const [header, ...lines] = fs.readFileSync(path, 'utf8').trim().split('\n');
+  const names = header.split(',');
+  const byFirmware = new Map();
+  for (const line of lines) {
+    const values = line.split(',');
+    const row = Object.fromEntries(names.map((name, i) => [name, values[i]]));
+    byFirmware.set(row.firmware, row);
+  }
+  return byFirmware;
+}
+
+function main() {
+  const [basePath, headPath] = process.argv.slice(2);
+  if (!basePath || !headPath) {
+    console.error('usage: node energy-compare.js base.csv head.csv');
+    process.exit(2);
+  }
+  const base = readReport(basePath);
+  const head = readReport(headPath);
+
+  console.log(['firmware', ...COLUMNS].map((name) => name.padStart(22)).join(''));
+  for (const [firmware, headRow] of head) {
+    const baseRow = base.get(firmware);
+    if (!baseRow) {
+      continue;
+    }
+    const cells = COLUMNS.map((column) => {
+      const b = Number(baseRow[column]);
+      const h = Number(headRow[column]);
+      const change = b ? `${(((h - b) / b) * 100).toFixed(1)}%` : 'n/a';
+      return `${h} (${change})`.padStart(22);
+    });
+    console.log(firmware.padStart(22) + cells.join(''));
+  }
+}
+
+main();
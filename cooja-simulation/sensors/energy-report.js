@@ -0,0 +1,114 @@
+/*
+ * Cooja ScriptRunner script for profile.csc: per-mote energy report of the
+ * sensor firmwares built with `make PROFILE=1`.
+ *
+ * Collects the PROF lines every mote prints (see sensor-profile.h), and after
+ * DURATION_MS of simulated time writes energy-report.csv with, per mote, the
+ * difference between its first line after warm-up and its last one:
+ * events and bytes, build and send time per event, CPU and radio duty cycle,
+ * average current, energy per event and the battery life it implies.
+ *
+ * Headless: java -jar cooja.jar -nogui=profile.csc
+ */
+
+/* Safety net only: the report is written at DURATION_MS */
+TIMEOUT(1860000, writeReport());
+
+var DURATION_MS = 30 * 60 * 1000;
+var WARMUP_US = 60 * 1000000;
+var REPORT_FILE = "energy-report.csv";
+
+/* Supply current per Energest state in mA, Z1 at 3 V: MSP430F2617 active at
+   8 MHz and in LPM3, CC2420 transmitting at 0 dBm and listening */
+var CURRENT_MA = { cpu: 4.0, lpm: 0.0005, tx: 17.4, rx: 18.8 };
+var VOLTAGE = 3.0;
+var BATTERY_MAH = 2500;
+
+var motes = {};
+
+function parse(line) {
+  var fields = {};
+  var parts = line.split(" ");
+  for (var i = 2; i < parts.length; i++) {
+    var kv = parts[i].split("=");
+    fields[kv[0]] = Number(kv[1]);
+  }
+  return fields;
+}
+
+function round(value, digits) {
+  var scale = Math.pow(10, digits);
+  return Math.round(value * scale) / scale;
+}
+
+function row(id, m) {
+  var d = {};
+  for (var key in m.last) {
+    d[key] = m.last[key] - m.first[key];
+  }
+  var hz = m.last.hz;
+  var ticks = d.cpu + d.lpm;
+  var seconds = ticks / hz;
+  var events = Math.max(d.ev, 1);
+  var avgMA = (d.cpu * CURRENT_MA.cpu + d.lpm * CURRENT_MA.lpm +
+               d.tx * CURRENT_MA.tx + d.rx * CURRENT_MA.rx) / ticks;
+  var buildUs = d.build / events * 1e6 / hz;
+  return [
+    id, m.type, round(seconds, 1), d.ev, d.dg,
+    round(d.pb / events, 1), round(d.tb / events, 1),
+    round(buildUs, 1), m.last.fcpu > 0 ? Math.round(buildUs * m.last.fcpu / 1e6) : "",
+    round(d.send / Math.max(d.dg, 1) * 1e6 / hz, 1),
+    round(100 * d.cpu / ticks, 3), round(100 * (d.tx + d.rx) / ticks, 3),
+    round(100 * d.tx / ticks, 3), round(100 * d.rx / ticks, 3),
+    round(avgMA, 4), round(avgMA * VOLTAGE * seconds / events, 3),
+    round(BATTERY_MAH / avgMA / 24, 1)
+  ].join(",");
+}
+
+function writeReport() {
+  var header = "mote,firmware,seconds,events,datagrams,payload_bytes_per_event," +
+               "air_bytes_per_event,build_us_per_event,build_cycles_per_event," +
+               "send_us_per_datagram,cpu_pct,radio_on_pct,tx_pct,rx_pct," +
+               "avg_current_ma,mj_per_event,battery_days";
+  var out = new java.io.PrintWriter(new java.io.FileWriter(REPORT_FILE));
+  out.println(header);
+  log.log(header + "\n");
+  for (var id in motes) {
+    var m = motes[id];
+    if (m.first === null || m.last === null) {
+      log.log("mote " + id + " (" + m.type + "): not enough PROF lines after warm-up\n");
+      continue;
+    }
+    var csv = row(id, m);
+    out.println(csv);
+    log.log(csv + "\n");
+  }
+  out.close();
+  log.log("Energy report written to " +
+          new java.io.File(REPORT_FILE).getAbsolutePath() + "\n");
+  log.testOK();
+}
+
+GENERATE_MSG(DURATION_MS, "report");
+
+while (true) {
+  YIELD();
+  var line = String(msg);
+  if (line === "report") {
+    writeReport();
+  }
+  if (line.indexOf("PROF 1 ") !== 0) {
+    continue;
+  }
+  if (!motes[id]) {
+    motes[id] = { type: String(mote.getType().getDescription()), first: null, last: null };
+  }
+  if (time < WARMUP_US) {
+    continue;
+  }
+  if (motes[id].first === null) {
+    motes[id].first = parse(line);
+  } else {
+    motes[id].last = parse(line);
+  }
+}
@@ -8,20 +8,38 @@
 #include "dev/serial-line.h"
 #include "net/ipv6/uip-ds6.h"
 #include "sys/etimer.h"
+#include "lib/random.h"
 #include "simple-udp.h"
 #include "net/ip/uip-debug.h"
+#include "sensor-codec.h"
+#include "sensor-batch.h"
+#include "sensor-config.h"
+#include "sensor-payloads.h"
+#include "sensor-format.h"
+#include "sensor-link.h"
+#include "sensor-netstat.h"
+#include "sensor-profile.h"
+#include "sensor-report.h"
+#include "sensor-sink.h"
 
 #define UDP_PORT_CENTRAL 8843
 #define UDP_PORT_OUT 5555
-#define CLOCK_REPORT CLOCK_SECOND * 2
+
+/* Reporting policy defaults; all can be changed over the config downlink */
+#define BRIGHTNESS_DEADBAND 10
+#define ENERGY_DEADBAND_W 2
 
 static struct simple_udp_connection broadcast_connection;
-static uip_ipaddr_t server_addr;
-static uint16_t central_addr[] = { 0xaaaa, 0, 0, 0, 0, 0, 0, 0x1 };
+static struct sensor_batch batch;
+static struct sensor_config config;
+static struct sensor_link uplink;
+static struct sensor_sink sinks;
+static struct sensor_report reporting;
 
 void connect_udp_server();
+static void send_datagram(const uint8_t *data, uint16_t len);
+static void send_frame(struct sensor_link *l, uint8_t dest, const uint8_t *data, uint16_t len);
 void uip_debug_ipaddr_print(const uip_ipaddr_t *addr);
-int ipaddr_sprintf(char *buf, uint8_t buf_len, const uip_ipaddr_t *addr);
 int sicslowpan_get_last_rssi();
 
 PROCESS(init_system_proc, "Init system process");
@@ -31,68 +49,64 @@ PROCESS_THREAD(init_system_proc, ev, data)
 {
   PROCESS_BEGIN();
   static struct etimer periodic_timer;
-  uint8_t buff_udp[256], device_address[30], device_id[17];
+  uint8_t buff_udp[SENSOR_PAYLOAD_MAX];
+  char device_address[32];
   static int event_counter = 1;
-  int brightness;
+  static int brightness = 75;
   int energyConsumption;
-  char eventType[4]; // "on" or "off"
-
-  sprintf((char *)device_id, "%02X%02X%02X%02X%02X%02X%02X%02X",
-          linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1],
-          linkaddr_node_addr.u8[2], linkaddr_node_addr.u8[3],
-          linkaddr_node_addr.u8[4], linkaddr_node_addr.u8[5],
-          linkaddr_node_addr.u8[6], linkaddr_node_addr.u8[7]);
-  sprintf((char *)device_address, "[%c%c%c%c]-Device-%s",
-          device_id[12], device_id[13], device_id[14], device_id[15],
-          device_id);
+  int16_t sample[2];
+  uint8_t reason;
+  int payload_len;
+
+  sensor_format_device_address(device_address, sizeof(device_address),
+                               linkaddr_node_addr.u8, LINKADDR_SIZE);
   
   connect_udp_server();
-  etimer_set(&periodic_timer, CLOCK_REPORT);
+  sensor_batch_init(&batch, send_datagram);
+  sensor_link_init(&uplink, send_frame, (uint8_t)random_rand());
+  sensor_config_init(&config, 5);
+  SENSOR_PROFILE_INIT(config.device_num);
+  SENSOR_NETSTAT_INIT(config.device_num);
+  sensor_report_init(&reporting, 2, config.report_interval);
+  reporting.deadband[0] = BRIGHTNESS_DEADBAND;
+  reporting.deadband[1] = ENERGY_DEADBAND_W;
+  etimer_set(&periodic_timer, reporting.interval);
   printf("Device initialized - %s\n", device_address);
 
   while (1) {
     PROCESS_YIELD();
 
-    if (etimer_expired(&periodic_timer)) {
-      etimer_reset(&periodic_timer);
-
-      /* Generate dynamic values for brightness (50-100) and energy consumption (1-10 Watts) */
-      brightness = rand() % 51 + 50;
-      energyConsumption = rand() % 10 + 1;
-      
-      /* Alternate event type between "on" and "off" */
-      if (event_counter % 2 == 0) {
-        strcpy(eventType, "off");
-      } else {
-        strcpy(eventType, "on");
+    if (ev == PROCESS_EVENT_POLL) {
+      /* Reporting reconfigured: sample again on the new schedule */
+      etimer_set(&periodic_timer, reporting.interval);
+    } else if (etimer_expired(&periodic_timer)) {
+      /* Brightness drifts within 50-100; energy consumption (1-10 Watts) follows it */
+      brightness += rand() % 7 - 3;
+      brightness = brightness < 50 ? 50 : brightness > 100 ? 100 : brightness;
+      energyConsumption = brightness / 10 - 4 + rand() % 2;
+
+      sample[0] = brightness;
+      sample[1] = energyConsumption;
+      reason = sensor_report_sample(&reporting, sample, clock_time());
+      etimer_set(&periodic_timer, reporting.interval);
+      if (reason == SENSOR_REPORT_NONE) {
+        continue;
+      }
+
+      SENSOR_PROFILE_BUILD_BEGIN();
+      payload_len = sensor_payload_light(buff_udp, sizeof(buff_udp), SENSOR_PAYLOAD_BINARY,
+                                         config.device_num, uplink.boot_id, event_counter,
+                                         brightness, energyConsumption);
+      SENSOR_PROFILE_BUILD_END(payload_len);
+      if (payload_len < 0) {
+        printf("Smart light event does not fit in %u bytes, skipped\n", (unsigned)sizeof(buff_udp));
+        continue;
       }
-      
-      /* Build the dynamic JSON payload for the smart light event.
-       * Fixed device parameters are used; dynamic values are inserted for eventID,
-       * eventType, brightness, and energyConsumption.
-       */
-      sprintf((char *)buff_udp,
-              "{"
-                "\"eventID\": \"light_%03d\","
-                "\"deviceType\": \"light\","
-                "\"deviceID\": \"light_05\","
-                "\"timestamp\": \"2025-03-14T18:45:00Z\","
-                "\"eventType\": \"%s\","
-                "\"location\": \"Building B - Corridor\","
-                "\"metadata\": \"brightness:%d; energyConsumption:%dW\""
-              "}",
-              event_counter,
-              eventType,
-              brightness,
-              energyConsumption);
 
       event_counter++;
 
-      printf("Sending smart light event data to UDP Server at border router...\n");
-      simple_udp_sendto(&broadcast_connection,
-                        buff_udp,
-                        strlen((const char *)buff_udp),
-                        &server_addr);
+      printf("Queueing smart light event data for UDP Server at border router...\n");
+      sensor_batch_add(&batch, buff_udp, payload_len, 0);
     }
   }
   PROCESS_END();
@@ -106,50 +120,50 @@ void cb_receive_udp(struct simple_udp_connection *c,
                     const uint8_t *data,
                     uint16_t datalen)
 {
+  int sink = sensor_sink_lookup(&sinks, sender_addr);
+
+  /* The socket takes datagrams from any address: only the sinks may NACK or reconfigure */
+  if (sink < 0) {
+    return;
+  }
+  if (sensor_link_input(&uplink, sink, data, datalen)) {
+    return;
+  }
+  if (sensor_report_input(&reporting, data, datalen)) {
+    process_poll(&init_system_proc);
+    return;
+  }
   printf("########## UDP #########\n");
-  printf("\nReceived from UDP Server: %s\n", data);
+  printf("\nReceived %u bytes from UDP Server\n", datalen);
 }
 
-void connect_udp_server()
+static void send_datagram(const uint8_t *data, uint16_t len)
 {
-  uip_ip6addr(&server_addr,
-              central_addr[0],
-              central_addr[1],
-              central_addr[2],
-              central_addr[3],
-              central_addr[4],
-              central_addr[5],
-              central_addr[6],
-              central_addr[7]);
-  printf("IPv6 UDP server: ");
-  uip_debug_ipaddr_print(&server_addr);
+  sensor_link_send(&uplink, sensor_sink_select(&sinks), data, len);
+}
 
-  simple_udp_register(&broadcast_connection,
-                        UDP_PORT_OUT,
-                        &server_addr,
-                        UDP_PORT_CENTRAL,
-                        cb_receive_udp);
+static void send_frame(struct sensor_link *l, uint8_t dest, const uint8_t *data, uint16_t len)
+{
+  SENSOR_PROFILE_SEND_BEGIN();
+  simple_udp_sendto(&broadcast_connection, data, len, sensor_sink_addr(&sinks, dest));
+  SENSOR_PROFILE_SEND_END(len);
 }
 
-int ipaddr_sprintf(char *buf, uint8_t buf_len, const uip_ipaddr_t *addr)
+void connect_udp_server()
 {
-  uint16_t a;
-  uint8_t len = 0;
-  int i, f;
-  for (i = 0, f = 0; i < sizeof(uip_ipaddr_t); i += 2) {
-    a = (addr->u8[i] << 8) + addr->u8[i + 1];
-    if (a == 0 && f >= 0) {
-      if (f++ == 0) {
-        len += snprintf(&buf[len], buf_len - len, "::");
-      }
-    } else {
-      if (f > 0) {
-        f = -1;
-      } else if (i > 0) {
-        len += snprintf(&buf[len], buf_len - len, ":");
-      }
-      len += snprintf(&buf[len], buf_len - len, "%x", a);
-    }
+  uint8_t i;
+
+  sensor_sink_init(&sinks);
+  for (i = 0; i < sinks.count; i++) {
+    printf("IPv6 UDP server: ");
+    uip_debug_ipaddr_print(sensor_sink_addr(&sinks, i));
+    printf("\n");
   }
-  return len;
-}
\ No newline at end of file
+
+  /* No remote address, as any of the sinks may send; cb_receive_udp drops other senders */
+  simple_udp_register(&broadcast_connection,
+                      UDP_PORT_OUT,
+                      NULL,
+                      UDP_PORT_CENTRAL,
+                      cb_receive_udp);
+}
@@ -8,20 +8,32 @@
 #include "dev/serial-line.h"
 #include "net/ipv6/uip-ds6.h"
 #include "sys/etimer.h"
+#include "lib/random.h"
 #include "simple-udp.h"
 #include "net/ip/uip-debug.h"
+#include "sensor-codec.h"
+#include "sensor-batch.h"
+#include "sensor-config.h"
+#include "sensor-payloads.h"
+#include "sensor-format.h"
+#include "sensor-link.h"
+#include "sensor-netstat.h"
+#include "sensor-profile.h"
+#include "sensor-sink.h"
 
 #define UDP_PORT_CENTRAL 8845
 #define UDP_PORT_OUT 5555
-#define CLOCK_REPORT CLOCK_SECOND * 2
 
 static struct simple_udp_connection broadcast_connection;
-static uip_ipaddr_t server_addr;
-static uint16_t central_addr[] = { 0xaaaa, 0, 0, 0, 0, 0, 0, 0x1 };
+static struct sensor_batch batch;
+static struct sensor_config config;
+static struct sensor_link uplink;
+static struct sensor_sink sinks;
 
 void connect_udp_server();
+static void send_datagram(const uint8_t *data, uint16_t len);
+static void send_frame(struct sensor_link *l, uint8_t dest, const uint8_t *data, uint16_t len);
 void uip_debug_ipaddr_print(const uip_ipaddr_t *addr);
-int ipaddr_sprintf(char *buf, uint8_t buf_len, const uip_ipaddr_t *addr);
 int sicslowpan_get_last_rssi();
 
 PROCESS(init_system_proc, "Init system process");
@@ -31,21 +43,22 @@ PROCESS_THREAD(init_system_proc, ev, data)
 {
   PROCESS_BEGIN();
   static struct etimer periodic_timer;
-  uint8_t buff_udp[256], device_address[30], device_id[17];
+  uint8_t buff_udp[SENSOR_PAYLOAD_MAX];
+  char device_address[32];
   static int event_counter = 1;
   int pagesPrinted;
+  int payload_len;
 
-  sprintf((char *)device_id, "%02X%02X%02X%02X%02X%02X%02X%02X",
-          linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1],
-          linkaddr_node_addr.u8[2], linkaddr_node_addr.u8[3],
-          linkaddr_node_addr.u8[4], linkaddr_node_addr.u8[5],
-          linkaddr_node_addr.u8[6], linkaddr_node_addr.u8[7]);
-  sprintf((char *)device_address, "[%c%c%c%c]-Device-%s",
-          device_id[12], device_id[13], device_id[14], device_id[15],
-          device_id);
+  sensor_format_device_address(device_address, sizeof(device_address),
+                               linkaddr_node_addr.u8, LINKADDR_SIZE);
   
   connect_udp_server();
-  etimer_set(&periodic_timer, CLOCK_REPORT);
+  sensor_batch_init(&batch, send_datagram);
+  sensor_link_init(&uplink, send_frame, (uint8_t)random_rand());
+  sensor_config_init(&config, 1);
+  SENSOR_PROFILE_INIT(config.device_num);
+  SENSOR_NETSTAT_INIT(config.device_num);
+  etimer_set(&periodic_timer, config.report_interval);
   printf("Device initialized - %s\n", device_address);
 
   while (1) {
@@ -57,31 +70,20 @@ PROCESS_THREAD(init_system_proc, ev, data)
       /* Generate a random number of pages printed between 1 and 20 */
       pagesPrinted = rand() % 20 + 1;
 
-      /* Prepare a dynamic JSON payload to mimic a printer event.
-       * The eventID, jobID, pagesPrinted and userID change per event.
-       */
-      sprintf((char *)buff_udp,
-              "{"
-                "\"eventID\": \"printer_%03d\","
-                "\"deviceType\": \"printer\","
-                "\"deviceID\": \"printer_1\","
-                "\"timestamp\": \"2025-03-14T09:30:00Z\","
-                "\"eventType\": \"completed\","
-                "\"location\": \"Library\","
-                "\"metadata\": \"jobID:job_%03d; pagesPrinted:%d; userID:student%d\""
-              "}",
-              event_counter,
-              event_counter,
-              pagesPrinted,
-              event_counter);
+      SENSOR_PROFILE_BUILD_BEGIN();
+      payload_len = sensor_payload_printer(buff_udp, sizeof(buff_udp), SENSOR_PAYLOAD_BINARY,
+                                           config.device_num, uplink.boot_id, event_counter,
+                                           pagesPrinted);
+      SENSOR_PROFILE_BUILD_END(payload_len);
+      if (payload_len < 0) {
+        printf("Printer event does not fit in %u bytes, skipped\n", (unsigned)sizeof(buff_udp));
+        continue;
+      }
 
       event_counter++;
 
-      printf("Sending printer event data to UDP Server at border router...\n");
-      simple_udp_sendto(&broadcast_connection,
-                        buff_udp,
-                        strlen((const char *)buff_udp),
-                        &server_addr);
+      printf("Queueing printer event data for UDP Server at border router...\n");
+      sensor_batch_add(&batch, buff_udp, payload_len, 0);
     }
   }
   PROCESS_END();
@@ -95,50 +97,45 @@ void cb_receive_udp(struct simple_udp_connection *c,
                     const uint8_t *data,
                     uint16_t datalen)
 {
+  int sink = sensor_sink_lookup(&sinks, sender_addr);
+
+  if (sink < 0) {
+    return;
+  }
+  if (sensor_link_input(&uplink, sink, data, datalen)) {
+    return;
+  }
   printf("########## UDP #########\n");
-  printf("\nReceived from UDP Server: %s\n", data);
+  printf("\nReceived %u bytes from UDP Server\n", datalen);
 }
 
-void connect_udp_server()
+static void send_datagram(const uint8_t *data, uint16_t len)
 {
-  uip_ip6addr(&server_addr,
-              central_addr[0],
-              central_addr[1],
-              central_addr[2],
-              central_addr[3],
-              central_addr[4],
-              central_addr[5],
-              central_addr[6],
-              central_addr[7]);
-  printf("IPv6 UDP server: ");
-  uip_debug_ipaddr_print(&server_addr);
+  sensor_link_send(&uplink, sensor_sink_select(&sinks), data, len);
+}
 
-  simple_udp_register(&broadcast_connection,
-                        UDP_PORT_OUT,
-                        &server_addr,
-                        UDP_PORT_CENTRAL,
-                        cb_receive_udp);
+static void send_frame(struct sensor_link *l, uint8_t dest, const uint8_t *data, uint16_t len)
+{
+  SENSOR_PROFILE_SEND_BEGIN();
+  simple_udp_sendto(&broadcast_connection, data, len, sensor_sink_addr(&sinks, dest));
+  SENSOR_PROFILE_SEND_END(len);
 }
 
-int ipaddr_sprintf(char *buf, uint8_t buf_len, const uip_ipaddr_t *addr)
+void connect_udp_server()
 {
-  uint16_t a;
-  uint8_t len = 0;
-  int i, f;
-  for (i = 0, f = 0; i < sizeof(uip_ipaddr_t); i += 2) {
-    a = (addr->u8[i] << 8) + addr->u8[i + 1];
-    if (a == 0 && f >= 0) {
-      if (f++ == 0) {
-        len += snprintf(&buf[len], buf_len - len, "::");
-      }
-    } else {
-      if (f > 0) {
-        f = -1;
-      } else if (i > 0) {
-        len += snprintf(&buf[len], buf_len - len, ":");
-      }
-      len += snprintf(&buf[len], buf_len - len, "%x", a);
-    }
+  uint8_t i;
+
+  sensor_sink_init(&sinks);
+  for (i = 0; i < sinks.count; i++) {
+    printf("IPv6 UDP server: ");
+    uip_debug_ipaddr_print(sensor_sink_addr(&sinks, i));
+    printf("\n");
   }
-  return len;
-}
\ No newline at end of file
+
+  /* No remote address, as any of the sinks may send; cb_receive_udp drops other senders */
+  simple_udp_register(&broadcast_connection,
+                      UDP_PORT_OUT,
+                      NULL,
+                      UDP_PORT_CENTRAL,
+                      cb_receive_udp);
+}
@@ -0,0 +1,67 @@
+#include <string.h>
+#include "sensor-batch.h"
+
+static void
+reset(struct sensor_batch *batch)
+{
+  batch->buf[0] = SENSOR_BATCH_MAGIC;
+  batch->buf[1] = 0;
+  batch->len = SENSOR_BATCH_HEADER_LEN;
+  batch->count = 0;
+}
+
+static void
+timeout(void *ptr)
+{
+  sensor_batch_flush((struct sensor_batch *)ptr);
+}
+
+void
+sensor_batch_init(struct sensor_batch *batch, sensor_batch_send_t send)
+{
+  batch->send = send;
+  reset(batch);
+}
+
+void
+sensor_batch_flush(struct sensor_batch *batch)
+{
+  ctimer_stop(&batch->timer);
+  if(batch->count == 0) {
+    return;
+  }
+  batch->buf[1] = batch->count;
+  batch->send(batch->buf, batch->len);
+  reset(batch);
+}
+
+void
+sensor_batch_add(struct sensor_batch *batch, const uint8_t *record,
+                 int len, uint8_t urgent)
+{
+  if(len <= 0) {
+    return;
+  }
+  if(SENSOR_BATCH_MAX_EVENTS <= 1 ||
+     len > 0xff || SENSOR_BATCH_HEADER_LEN + 1 + len > SENSOR_BATCH_MAX_BYTES) {
+    /* Cannot be batched: keep ordering by flushing what is queued first */
+    sensor_batch_flush(batch);
+    batch->send(record, len);
+    return;
+  }
+
+  if(batch->len + 1 + len > SENSOR_BATCH_MAX_BYTES) {
+    sensor_batch_flush(batch);
+  }
+
+  batch->buf[batch->len++] = (uint8_t)len;
+  memcpy(&batch->buf[batch->len], record, len);
+  batch->len += len;
+  batch->count++;
+
+  if(urgent || batch->count >= SENSOR_BATCH_MAX_EVENTS) {
+    sensor_batch_flush(batch);
+  } else if(batch->count == 1) {
+    ctimer_set(&batch->timer, SENSOR_BATCH_MAX_WAIT, timeout, batch);
+  }
+}
@@ -0,0 +1,73 @@
+#ifndef SENSOR_BATCH_H_
+#define SENSOR_BATCH_H_
+
+#include "contiki.h"
+#include "sys/ctimer.h"
+
+/*
+ * Event batching for the mote firmwares.
+ *
+ * Encoded records are appended to a frame buffer and sent as one datagram
+ * once SENSOR_BATCH_MAX_EVENTS records are queued, the next record would not
+ * fit in SENSOR_BATCH_MAX_BYTES, SENSOR_BATCH_MAX_WAIT has elapsed since the
+ * first queued record, or an urgent record (card swipe, motion) is added.
+ *
+ * Batch frame layout:
+ *
+ *   0      SENSOR_BATCH_MAGIC
+ *   1      number of records
+ *   2..    per record: one length byte followed by the record itself
+ *
+ * Records too large for a frame (e.g. the legacy JSON payload) bypass the
+ * batch and are sent on their own, unchanged.
+ */
+
+#define SENSOR_BATCH_MAGIC 0xB2
+
+/* Flush after this many records; 1 disables batching */
+#ifndef SENSOR_BATCH_MAX_EVENTS
+#define SENSOR_BATCH_MAX_EVENTS 8
+#endif
+
+/* Largest batch datagram; keeps the UDP payload inside one 802.15.4 frame */
+#ifndef SENSOR_BATCH_MAX_BYTES
+#define SENSOR_BATCH_MAX_BYTES 80
+#endif
+
+/* Longest a queued record may wait before the batch is flushed */
+#ifndef SENSOR_BATCH_MAX_WAIT
+#define SENSOR_BATCH_MAX_WAIT (CLOCK_SECOND * 10)
+#endif
+
+#define SENSOR_BATCH_HEADER_LEN 2
+
+typedef void (*sensor_batch_send_t)(const uint8_t *data, uint16_t len);
+
+struct sensor_batch {
+  uint8_t buf[SENSOR_BATCH_MAX_BYTES];
+  uint16_t len;
+  uint8_t count;
+  struct ctimer timer;
+  sensor_batch_send_t send;
+};
+
+/**
+ * Initialise an empty batch; send is called with each outgoing datagram.
+ */
+void sensor_batch_init(struct sensor_batch *batch, sensor_batch_send_t send);
+
+/**
+ * Queue an encoded record. Urgent records flush the batch immediately,
+ * carrying any pending readings along with them.
+ * len is the result of the encoder; a record it could not build (-1) is
+ * dropped rather than sent.
+ */
+void sensor_batch_add(struct sensor_batch *batch, const uint8_t *record,
+                      int len, uint8_t urgent);
+
+/**
+ * Send whatever is queued, if anything.
+ */
+void sensor_batch_flush(struct sensor_batch *batch);
+
+#endif /* SENSOR_BATCH_H_ */
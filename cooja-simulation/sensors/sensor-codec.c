@@ -0,0 +1,59 @@
+#include "sensor-codec.h"
+
+static void
+put_byte(struct sensor_record *rec, uint8_t b)
+{
+  if(rec->len >= rec->size) {
+    rec->overflow = 1;
+    return;
+  }
+  rec->buf[rec->len++] = b;
+}
+
+static void
+put_varint(struct sensor_record *rec, uint32_t value)
+{
+  while(value >= 0x80) {
+    put_byte(rec, (uint8_t)(value | 0x80));
+    value >>= 7;
+  }
+  put_byte(rec, (uint8_t)value);
+}
+
+void
+sensor_record_begin(struct sensor_record *rec, uint8_t *buf, uint16_t size,
+                    uint8_t device_type, uint8_t event_type,
+                    uint16_t device_num, uint8_t location, uint32_t counter)
+{
+  rec->buf = buf;
+  rec->size = size;
+  rec->len = 0;
+  rec->overflow = 0;
+
+  put_byte(rec, SENSOR_CODEC_MAGIC);
+  put_byte(rec, device_type);
+  put_byte(rec, event_type);
+  put_varint(rec, device_num);
+  put_varint(rec, location);
+  put_varint(rec, counter);
+}
+
+void
+sensor_record_put_uint(struct sensor_record *rec, uint8_t field, uint32_t value)
+{
+  put_byte(rec, (uint8_t)((field << 3) | SENSOR_WIRE_UVARINT));
+  put_varint(rec, value);
+}
+
+void
+sensor_record_put_int(struct sensor_record *rec, uint8_t field, int32_t value)
+{
+  put_byte(rec, (uint8_t)((field << 3) | SENSOR_WIRE_SVARINT));
+  put_varint(rec, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+int
+sensor_record_end(struct sensor_record *rec)
+{
+  return rec->overflow ? -1 : rec->len;
+}
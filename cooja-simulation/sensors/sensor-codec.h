@@ -0,0 +1,111 @@
+#ifndef SENSOR_CODEC_H_
+#define SENSOR_CODEC_H_
+
+#include <stdint.h>
+
+/*
+ * Compact binary sensor record shared by all mote firmwares.
+ *
+ * A record replaces the ~250 byte JSON payload with numeric codes for the
+ * constant parts (device type, device number, location, event type) and
+ * typed varint fields for the readings:
+ *
+ *   0      SENSOR_CODEC_MAGIC
+ *   1      device type code   (SENSOR_DEVICE_*)
+ *   2      event type code    (SENSOR_EVENT_*)
+ *   3..    uvarint device number   (e.g. 3 for "sensor_03")
+ *          uvarint location code   (SENSOR_LOCATION_*)
+ *          uvarint event counter
+ *          fields: key byte (field id << 3 | wire type) followed by a varint
+ *
+ * The decoder in backend/udp_receivers/payload_decoder.js holds the matching
+ * tables and rebuilds the JSON event the backend API expects.
+ */
+
+/* Build-time switch: 0 sends the legacy JSON payload, 1 the binary record */
+#ifndef SENSOR_PAYLOAD_BINARY
+#define SENSOR_PAYLOAD_BINARY 0
+#endif
+
+#define SENSOR_CODEC_MAGIC 0xB1
+
+/* Device type codes */
+#define SENSOR_DEVICE_CCTV        1
+#define SENSOR_DEVICE_LIGHT       2
+#define SENSOR_DEVICE_CARD_READER 3
+#define SENSOR_DEVICE_PRINTER     4
+#define SENSOR_DEVICE_CO2         5
+
+/* Event type codes */
+#define SENSOR_EVENT_READING         1
+#define SENSOR_EVENT_MOTION_DETECTED 2
+#define SENSOR_EVENT_ON              3
+#define SENSOR_EVENT_OFF             4
+#define SENSOR_EVENT_COMPLETED       5
+#define SENSOR_EVENT_SWIPE           6
+
+/* Location codes */
+#define SENSOR_LOCATION_PARKING_LOT_A      1
+#define SENSOR_LOCATION_BUILDING_B_CORRIDOR 2
+#define SENSOR_LOCATION_BUILDING_A_ENTRANCE 3
+#define SENSOR_LOCATION_LIBRARY            4
+#define SENSOR_LOCATION_BUILDING_C_LAB     5
+
+/* Field ids shared by every device type */
+#define SENSOR_FIELD_BOOT_ID           14  /* link boot id, part of the eventID */
+#define SENSOR_FIELD_MOTE_TIME          15  /* mote clock, ms since boot */
+
+/* Field ids, scoped per device type */
+#define SENSOR_FIELD_CO2_LEVEL          1
+#define SENSOR_FIELD_TEMPERATURE        2
+
+#define SENSOR_FIELD_IMAGE_REFERENCE    1
+
+#define SENSOR_FIELD_BRIGHTNESS         1
+#define SENSOR_FIELD_ENERGY_CONSUMPTION 2
+
+#define SENSOR_FIELD_JOB_ID             1
+#define SENSOR_FIELD_PAGES_PRINTED      2
+#define SENSOR_FIELD_PRINTER_USER_ID    3
+
+#define SENSOR_FIELD_USER_ID            1
+#define SENSOR_FIELD_CARD_ID            2
+
+/* Wire types carried in the low three bits of a field key */
+#define SENSOR_WIRE_UVARINT 0
+#define SENSOR_WIRE_SVARINT 1
+
+struct sensor_record {
+  uint8_t *buf;
+  uint16_t size;
+  uint16_t len;
+  uint8_t overflow;
+};
+
+/**
+ * Start a record in buf and write its fixed header.
+ */
+void sensor_record_begin(struct sensor_record *rec, uint8_t *buf, uint16_t size,
+                         uint8_t device_type, uint8_t event_type,
+                         uint16_t device_num, uint8_t location,
+                         uint32_t counter);
+
+/**
+ * Append an unsigned field.
+ */
+void sensor_record_put_uint(struct sensor_record *rec, uint8_t field,
+                            uint32_t value);
+
+/**
+ * Append a signed field, zigzag encoded so small negatives stay short.
+ */
+void sensor_record_put_int(struct sensor_record *rec, uint8_t field,
+                           int32_t value);
+
+/**
+ * Finish the record.
+ * Returns the encoded length, or -1 if the buffer was too small.
+ */
+int sensor_record_end(struct sensor_record *rec);
+
+#endif /* SENSOR_CODEC_H_ */
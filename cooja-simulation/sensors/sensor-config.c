@@ -0,0 +1,35 @@
+#include <stdlib.h>
+#include "sensor-config.h"
+#if SENSOR_DEVICE_NUM_FROM_NODE_ID
+#include "sys/node-id.h"
+#endif
+
+void
+sensor_config_init(struct sensor_config *cfg, uint16_t device_num)
+{
+#if CONTIKI_TARGET_NATIVE
+  const char *value;
+#endif
+
+  cfg->device_num = device_num;
+  cfg->report_interval = SENSOR_REPORT_INTERVAL;
+
+#if SENSOR_DEVICE_NUM_FROM_NODE_ID
+  /* Cooja gives every mote its own node id; 0 means none was assigned */
+  if(node_id != 0) {
+    cfg->device_num = node_id;
+  }
+#endif
+
+#if CONTIKI_TARGET_NATIVE
+  if((value = getenv("SENSOR_DEVICE_NUM")) != NULL) {
+    cfg->device_num = (uint16_t)atoi(value);
+  }
+  if((value = getenv("SENSOR_REPORT_MS")) != NULL && atol(value) > 0) {
+    cfg->report_interval = (clock_time_t)(atol(value) * CLOCK_SECOND / 1000);
+    if(cfg->report_interval == 0) {
+      cfg->report_interval = 1;
+    }
+  }
+#endif
+}
@@ -0,0 +1,25 @@
+#ifndef SENSOR_CONFIG_H_
+#define SENSOR_CONFIG_H_
+
+#include "contiki.h"
+
+/* Report period of the firmwares; override with -DSENSOR_REPORT_INTERVAL=... */
+#ifndef SENSOR_REPORT_INTERVAL
+#define SENSOR_REPORT_INTERVAL (CLOCK_SECOND * 2)
+#endif
+
+struct sensor_config {
+  uint16_t device_num;
+  clock_time_t report_interval;
+};
+
+/**
+ * Fill cfg with the build defaults. On the native target the environment
+ * variables SENSOR_DEVICE_NUM and SENSOR_REPORT_MS override them, so many
+ * instances of one firmware can run side by side as distinct devices. With
+ * SENSOR_DEVICE_NUM_FROM_NODE_ID (make SCALE=1) the node id does the same
+ * for large simulations.
+ */
+void sensor_config_init(struct sensor_config *cfg, uint16_t device_num);
+
+#endif /* SENSOR_CONFIG_H_ */
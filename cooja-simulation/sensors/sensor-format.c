@@ -0,0 +1,134 @@
+#include <string.h>
+#include "sensor-format.h"
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+void
+sensor_format_begin(struct sensor_format *f, uint8_t *buf, uint16_t size)
+{
+  f->buf = buf;
+  f->size = size;
+  f->len = 0;
+  f->overflow = 0;
+}
+
+static void
+put(struct sensor_format *f, const void *data, uint16_t len)
+{
+  if(f->overflow || len > f->size - f->len) {
+    f->overflow = 1;
+    return;
+  }
+  memcpy(&f->buf[f->len], data, len);
+  f->len += len;
+}
+
+void
+sensor_format_str(struct sensor_format *f, const char *s)
+{
+  put(f, s, strlen(s));
+}
+
+void
+sensor_format_uint(struct sensor_format *f, uint32_t value, uint8_t width)
+{
+  /* Digits are produced backwards into a scratch buffer */
+  char digits[10];
+  uint8_t n = 0;
+
+  do {
+    digits[sizeof(digits) - ++n] = '0' + value % 10;
+    value /= 10;
+  } while(value > 0);
+  while(n < width && n < sizeof(digits)) {
+    digits[sizeof(digits) - ++n] = '0';
+  }
+  put(f, &digits[sizeof(digits) - n], n);
+}
+
+void
+sensor_format_int(struct sensor_format *f, int32_t value)
+{
+  if(value < 0) {
+    put(f, "-", 1);
+    sensor_format_uint(f, -(uint32_t)value, 0);
+  } else {
+    sensor_format_uint(f, value, 0);
+  }
+}
+
+void
+sensor_format_hex(struct sensor_format *f, uint32_t value, uint8_t digits)
+{
+  char out[8];
+  uint8_t i;
+
+  if(digits > sizeof(out)) {
+    digits = sizeof(out);
+  }
+  for(i = digits; i > 0; i--) {
+    out[i - 1] = hex_digits[value & 0xf];
+    value >>= 4;
+  }
+  put(f, out, digits);
+}
+
+void
+sensor_format_ipaddr(struct sensor_format *f, const uint8_t *addr)
+{
+  char group[4];
+  uint16_t a;
+  uint8_t i, n;
+  int8_t zeros = 0;   /* > 0 inside the compressed run, -1 once it is over */
+
+  for(i = 0; i < 16; i += 2) {
+    a = (addr[i] << 8) | addr[i + 1];
+    if(a == 0 && zeros >= 0) {
+      if(zeros++ == 0) {
+        put(f, "::", 2);
+      }
+      continue;
+    }
+    if(zeros > 0) {
+      zeros = -1;
+    } else if(i > 0) {
+      put(f, ":", 1);
+    }
+    /* Lower-case hex without leading zeros */
+    n = 0;
+    do {
+      group[sizeof(group) - ++n] = "0123456789abcdef"[a & 0xf];
+      a >>= 4;
+    } while(a > 0);
+    put(f, &group[sizeof(group) - n], n);
+  }
+}
+
+int
+sensor_format_end(struct sensor_format *f)
+{
+  if(f->overflow || f->len >= f->size) {
+    return -1;
+  }
+  f->buf[f->len] = '\0';
+  return f->len;
+}
+
+int
+sensor_format_device_address(char *buf, uint16_t size,
+                             const uint8_t *lladdr, uint8_t lladdr_len)
+{
+  struct sensor_format f;
+  uint8_t i;
+
+  sensor_format_begin(&f, (uint8_t *)buf, size);
+  sensor_format_str(&f, "[");
+  if(lladdr_len >= 2) {
+    sensor_format_hex(&f, (lladdr[lladdr_len - 2] << 8) | lladdr[lladdr_len - 1], 4);
+  }
+  sensor_format_str(&f, "]-Device-");
+  for(i = 0; i < lladdr_len; i++) {
+    sensor_format_hex(&f, lladdr[i], 2);
+  }
+  return sensor_format_end(&f);
+}
@@ -0,0 +1,51 @@
+#ifndef SENSOR_FORMAT_H_
+#define SENSOR_FORMAT_H_
+
+#include <stdint.h>
+
+/*
+ * Minimal text formatter for the motes, in place of the printf family.
+ *
+ * Writes fixed strings, decimal and hex integers and IPv6 addresses straight
+ * into a caller buffer, without allocating and with a few bytes of stack.
+ * Every call is bounds checked: once something does not fit the formatter
+ * stops writing and sensor_format_end() reports the overflow, so callers
+ * check once at the end instead of after each piece.
+ */
+
+struct sensor_format {
+  uint8_t *buf;
+  uint16_t size;
+  uint16_t len;
+  uint8_t overflow;
+};
+
+void sensor_format_begin(struct sensor_format *f, uint8_t *buf, uint16_t size);
+
+/* Fixed string, without its terminator */
+void sensor_format_str(struct sensor_format *f, const char *s);
+
+/* Decimal, zero padded to at least width digits (0 or 1: no padding) */
+void sensor_format_uint(struct sensor_format *f, uint32_t value, uint8_t width);
+void sensor_format_int(struct sensor_format *f, int32_t value);
+
+/* Upper-case hex, exactly digits digits */
+void sensor_format_hex(struct sensor_format *f, uint32_t value, uint8_t digits);
+
+/* IPv6 address (16 bytes) with the first run of zero groups as "::" */
+void sensor_format_ipaddr(struct sensor_format *f, const uint8_t *addr);
+
+/**
+ * NUL-terminate (the terminator is not counted) and return the length, or -1
+ * if anything did not fit, terminator included.
+ */
+int sensor_format_end(struct sensor_format *f);
+
+/**
+ * The "[XXXX]-Device-XXXXXXXXXXXXXXXX" name the firmwares log at boot, from
+ * the link-layer address. Returns its length, or -1 if buf is too small.
+ */
+int sensor_format_device_address(char *buf, uint16_t size,
+                                 const uint8_t *lladdr, uint8_t lladdr_len);
+
+#endif /* SENSOR_FORMAT_H_ */
@@ -0,0 +1,84 @@
+#include <string.h>
+#include "sensor-link.h"
+
+void
+sensor_link_init(struct sensor_link *link, sensor_link_send_t send,
+                 uint8_t boot_id)
+{
+  memset(link, 0, sizeof(*link));
+  link->send = send;
+  link->boot_id = boot_id;
+}
+
+void
+sensor_link_send(struct sensor_link *link, uint8_t dest,
+                 const uint8_t *data, uint16_t len)
+{
+  struct sensor_link_slot *slot;
+  uint16_t seq;
+
+  if(dest >= SENSOR_LINK_DESTS) {
+    return;
+  }
+  if(SENSOR_LINK_HEADER_LEN + len > SENSOR_LINK_SLOT_BYTES) {
+    link->send(link, dest, data, len);
+    return;
+  }
+
+  seq = link->next_seq[dest]++;
+  slot = &link->ring[link->head];
+  link->head = (link->head + 1) % SENSOR_LINK_RING;
+
+  slot->buf[0] = SENSOR_LINK_MAGIC;
+  slot->buf[1] = link->boot_id;
+  slot->buf[2] = (uint8_t)(seq >> 8);
+  slot->buf[3] = (uint8_t)seq;
+  memcpy(&slot->buf[SENSOR_LINK_HEADER_LEN], data, len);
+  slot->len = (uint8_t)(SENSOR_LINK_HEADER_LEN + len);
+  slot->dest = dest;
+  link->send(link, dest, slot->buf, slot->len);
+}
+
+static void
+resend(struct sensor_link *link, uint8_t dest, uint16_t seq)
+{
+  uint8_t i;
+
+  for(i = 0; i < SENSOR_LINK_RING; i++) {
+    struct sensor_link_slot *slot = &link->ring[i];
+    if(slot->len > 0 && slot->dest == dest &&
+       ((slot->buf[2] << 8) | slot->buf[3]) == seq) {
+      link->retransmits++;
+      link->send(link, dest, slot->buf, slot->len);
+      return;
+    }
+  }
+}
+
+int
+sensor_link_input(struct sensor_link *link, uint8_t dest,
+                  const uint8_t *data, uint16_t len)
+{
+  uint16_t ack;
+  uint32_t bitmap;
+  uint8_t i;
+
+  if(len < SENSOR_LINK_NACK_LEN || data[0] != SENSOR_LINK_NACK) {
+    return 0;
+  }
+  if(data[1] != link->boot_id) {
+    /* Refers to a previous boot: nothing of it is left to resend */
+    return 1;
+  }
+
+  link->nacks++;
+  ack = (data[2] << 8) | data[3];
+  bitmap = ((uint32_t)data[4] << 24) | ((uint32_t)data[5] << 16) |
+           ((uint32_t)data[6] << 8) | data[7];
+  for(i = 0; i < 32 && bitmap != 0; i++, bitmap >>= 1) {
+    if(bitmap & 1) {
+      resend(link, dest, (uint16_t)(ack + 1 + i));
+    }
+  }
+  return 1;
+}
@@ -0,0 +1,101 @@
+#ifndef SENSOR_LINK_H_
+#define SENSOR_LINK_H_
+
+#include <stdint.h>
+#include "sensor-batch.h"
+
+/*
+ * Lightweight reliability for the mote -> gateway UDP link.
+ *
+ * Every outgoing datagram gets a per-mote sequence number and is kept in a
+ * small ring. The gateway tracks gaps in the sequence of each mote and, only
+ * when something is missing, answers on the reverse path with a NACK listing
+ * the missing datagrams; the mote resends those still in its ring. Nothing is
+ * acknowledged per packet, so a healthy link costs 4 header bytes per
+ * datagram and no downlink traffic.
+ *
+ * Sequenced frame (uplink):
+ *
+ *   0      SENSOR_LINK_MAGIC
+ *   1      boot id (random per boot; a new id resets the gateway's tracking)
+ *   2..3   sequence number, big endian, wraps at 65536
+ *   4..    the datagram: batch frame, binary record or JSON
+ *
+ * NACK (downlink, 8 bytes):
+ *
+ *   0      SENSOR_LINK_NACK
+ *   1      boot id the NACK refers to
+ *   2..3   cumulative ack: every sequence number up to this one was received
+ *   4..7   bitmap, big endian: bit i set requests sequence ack + 1 + i
+ *
+ * Datagrams larger than a ring slot (the legacy JSON payload) are sent
+ * unsequenced and unchanged, like oversized records bypass the batch.
+ *
+ * A mote reporting to several sinks (sensor-sink.h) numbers the datagrams of
+ * each destination separately, so every gateway sees a gap-free sequence of
+ * the datagrams meant for it. Destinations share the ring; a NACK only
+ * resends to the destination it came from.
+ */
+
+#define SENSOR_LINK_MAGIC 0xB3
+#define SENSOR_LINK_NACK  0xA1
+
+#define SENSOR_LINK_HEADER_LEN 4
+#define SENSOR_LINK_NACK_LEN   8
+
+/* Datagrams kept for retransmission; older ones can no longer be recovered */
+#ifndef SENSOR_LINK_RING
+#define SENSOR_LINK_RING 4
+#endif
+
+/* Destinations with their own sequence numbers (e.g. one per sink) */
+#ifndef SENSOR_LINK_DESTS
+#define SENSOR_LINK_DESTS 4
+#endif
+
+/* Ring slots hold one full batch frame with its link header */
+#define SENSOR_LINK_SLOT_BYTES (SENSOR_LINK_HEADER_LEN + SENSOR_BATCH_MAX_BYTES)
+
+struct sensor_link;
+
+/* Called with each frame to put on the air, to destination dest */
+typedef void (*sensor_link_send_t)(struct sensor_link *link, uint8_t dest,
+                                   const uint8_t *data, uint16_t len);
+
+struct sensor_link_slot {
+  uint8_t buf[SENSOR_LINK_SLOT_BYTES];
+  uint8_t len;   /* 0 when empty */
+  uint8_t dest;
+};
+
+struct sensor_link {
+  struct sensor_link_slot ring[SENSOR_LINK_RING];
+  uint8_t head;
+  uint8_t boot_id;
+  uint16_t next_seq[SENSOR_LINK_DESTS];
+  sensor_link_send_t send;
+  uint16_t nacks;
+  uint16_t retransmits;
+};
+
+/**
+ * Initialise the link; boot_id should differ between boots (e.g. random_rand()).
+ */
+void sensor_link_init(struct sensor_link *link, sensor_link_send_t send,
+                      uint8_t boot_id);
+
+/**
+ * Send one datagram to destination dest (< SENSOR_LINK_DESTS), sequenced and
+ * kept for retransmission if it fits a slot.
+ */
+void sensor_link_send(struct sensor_link *link, uint8_t dest,
+                      const uint8_t *data, uint16_t len);
+
+/**
+ * Handle a datagram received from destination dest. Returns 1 if it was a
+ * NACK for this link (and the requested frames were resent), 0 otherwise.
+ */
+int sensor_link_input(struct sensor_link *link, uint8_t dest,
+                      const uint8_t *data, uint16_t len);
+
+#endif /* SENSOR_LINK_H_ */
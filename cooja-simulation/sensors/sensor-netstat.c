@@ -0,0 +1,80 @@
+#include "sensor-netstat.h"
+
+#if SENSOR_NETSTAT
+
+#include <stdio.h>
+#include "sys/ctimer.h"
+#include "net/ip/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/queuebuf.h"
+#include "net/rpl/rpl.h"
+#include "sensor-format.h"
+
+static struct ctimer report_timer;
+static uint16_t reported_device;
+
+/* Interface identifier: the low 64 bits of an address, as 16 hex digits */
+static void
+format_iid(struct sensor_format *f, const uip_ipaddr_t *addr)
+{
+  uint8_t i;
+
+  for(i = 8; i < 16; i++) {
+    sensor_format_hex(f, addr->u8[i], 2);
+  }
+}
+
+static void
+report(void *ptr)
+{
+  uip_ds6_addr_t *global = uip_ds6_get_global(ADDR_PREFERRED);
+  rpl_dag_t *dag = rpl_get_any_dag();
+  uip_ipaddr_t *parent = NULL;
+  struct sensor_format f;
+  uint8_t line[160];
+
+  ctimer_reset(&report_timer);
+  if(dag != NULL && dag->preferred_parent != NULL) {
+    parent = rpl_get_parent_ipaddr(dag->preferred_parent);
+  }
+
+  sensor_format_begin(&f, line, sizeof(line));
+  sensor_format_str(&f, "NET 1 dev=");
+  sensor_format_uint(&f, reported_device, 0);
+  sensor_format_str(&f, " addr=");
+  if(global != NULL) {
+    sensor_format_ipaddr(&f, global->ipaddr.u8);
+    sensor_format_str(&f, " id=");
+    format_iid(&f, &global->ipaddr);
+  } else {
+    sensor_format_str(&f, "- id=-");
+  }
+  sensor_format_str(&f, " parent=");
+  if(parent != NULL) {
+    format_iid(&f, parent);
+  } else {
+    sensor_format_str(&f, "-");
+  }
+  sensor_format_str(&f, " rank=");
+  sensor_format_uint(&f, dag != NULL ? dag->rank : 0xffff, 0);
+  sensor_format_str(&f, " sent=");
+  sensor_format_uint(&f, uip_stat.ip.sent, 0);
+  sensor_format_str(&f, " fwd=");
+  sensor_format_uint(&f, uip_stat.ip.forwarded, 0);
+  sensor_format_str(&f, " drop=");
+  sensor_format_uint(&f, uip_stat.ip.drop, 0);
+  sensor_format_str(&f, " qfree=");
+  sensor_format_uint(&f, queuebuf_numfree(), 0);
+  if(sensor_format_end(&f) > 0) {
+    printf("%s\n", (char *)line);
+  }
+}
+
+void
+sensor_netstat_init(uint16_t device_num)
+{
+  reported_device = device_num;
+  ctimer_set(&report_timer, SENSOR_NETSTAT_PERIOD, report, NULL);
+}
+
+#endif /* SENSOR_NETSTAT */
@@ -0,0 +1,45 @@
+#ifndef SENSOR_NETSTAT_H_
+#define SENSOR_NETSTAT_H_
+
+#include <stdint.h>
+
+/*
+ * Routing and forwarding statistics for multi-hop scenarios, compiled in
+ * with `make SCALE=1` (SENSOR_NETSTAT=1, uIP statistics on). Otherwise
+ * SENSOR_NETSTAT_INIT() is a no-op.
+ *
+ * Every SENSOR_NETSTAT_PERIOD the mote prints one line:
+ *
+ *   NET 1 dev=<n> addr=<global IPv6> id=<IID hex> parent=<IID hex or ->
+ *         rank=<RPL rank> sent=<n> fwd=<n> drop=<n> qfree=<queuebufs>
+ *
+ * (on one line). id and parent are the 64-bit interface identifiers of the
+ * mote and of its preferred RPL parent, so following parents from any mote
+ * gives its hop count to the border router. sent, fwd and drop are the uIP
+ * IP-layer counters since boot; drop includes packets lost to full buffers.
+ * ../scenarios/scaling-stats.js collects these lines.
+ */
+
+#ifndef SENSOR_NETSTAT
+#define SENSOR_NETSTAT 0
+#endif
+
+#if SENSOR_NETSTAT
+
+#include "contiki.h"
+
+#ifndef SENSOR_NETSTAT_PERIOD
+#define SENSOR_NETSTAT_PERIOD (CLOCK_SECOND * 30)
+#endif
+
+void sensor_netstat_init(uint16_t device_num);
+
+#define SENSOR_NETSTAT_INIT(device_num) sensor_netstat_init(device_num)
+
+#else /* SENSOR_NETSTAT */
+
+#define SENSOR_NETSTAT_INIT(device_num)
+
+#endif /* SENSOR_NETSTAT */
+
+#endif /* SENSOR_NETSTAT_H_ */
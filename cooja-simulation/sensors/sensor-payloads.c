@@ -0,0 +1,206 @@
+#include "contiki.h"
+#include "sensor-codec.h"
+#include "sensor-format.h"
+#include "sensor-payloads.h"
+
+/*
+ * Mote clock in milliseconds since boot. clock_time() wraps within minutes
+ * on 16-bit platforms, so elapsed ticks are accumulated here; a mote that
+ * builds at least one event per wrap period keeps it exact.
+ */
+static uint32_t
+mote_time_ms(void)
+{
+  static clock_time_t last;
+  static uint32_t ticks;
+  clock_time_t now = clock_time();
+
+  ticks += (clock_time_t)(now - last);
+  last = now;
+  return (ticks / CLOCK_SECOND) * 1000 + (ticks % CLOCK_SECOND) * 1000 / CLOCK_SECOND;
+}
+
+/* "<prefix><device>_<boot id>_<counter>" */
+static void
+format_event_id(struct sensor_format *f, const char *prefix,
+                uint16_t device_num, uint8_t device_width,
+                uint8_t boot_id, uint32_t counter)
+{
+  sensor_format_str(f, prefix);
+  sensor_format_uint(f, device_num, device_width);
+  sensor_format_str(f, "_");
+  sensor_format_uint(f, boot_id, 0);
+  sensor_format_str(f, "_");
+  sensor_format_uint(f, counter, 3);
+}
+
+int
+sensor_payload_co2(uint8_t *buf, uint16_t size, uint8_t binary,
+                   uint16_t device_num, uint8_t boot_id, uint32_t counter,
+                   int co2_level, int temperature)
+{
+  struct sensor_record record;
+  struct sensor_format f;
+
+  if(binary) {
+    sensor_record_begin(&record, buf, size,
+                        SENSOR_DEVICE_CO2, SENSOR_EVENT_READING,
+                        device_num, SENSOR_LOCATION_BUILDING_C_LAB, counter);
+    sensor_record_put_uint(&record, SENSOR_FIELD_CO2_LEVEL, co2_level);
+    sensor_record_put_int(&record, SENSOR_FIELD_TEMPERATURE, temperature);
+    sensor_record_put_uint(&record, SENSOR_FIELD_BOOT_ID, boot_id);
+    sensor_record_put_uint(&record, SENSOR_FIELD_MOTE_TIME, mote_time_ms());
+    return sensor_record_end(&record);
+  }
+  sensor_format_begin(&f, buf, size);
+  sensor_format_str(&f, "{\"eventID\": \"");
+  format_event_id(&f, "sensor_", device_num, 2, boot_id, counter);
+  sensor_format_str(&f, "\",\"deviceType\": \"co2_sensor\",\"deviceID\": \"sensor_");
+  sensor_format_uint(&f, device_num, 2);
+  sensor_format_str(&f, "\",\"moteTime\": ");
+  sensor_format_uint(&f, mote_time_ms(), 0);
+  sensor_format_str(&f, ",\"eventType\": \"reading\",\"location\": \"Building C - Lab\","
+                        "\"metadata\": \"co2Level:");
+  sensor_format_int(&f, co2_level);
+  sensor_format_str(&f, "; temperature:");
+  sensor_format_int(&f, temperature);
+  sensor_format_str(&f, "\"}");
+  return sensor_format_end(&f);
+}
+
+int
+sensor_payload_light(uint8_t *buf, uint16_t size, uint8_t binary,
+                     uint16_t device_num, uint8_t boot_id, uint32_t counter,
+                     int brightness, int energy_consumption)
+{
+  struct sensor_record record;
+  struct sensor_format f;
+  uint8_t off = counter % 2 == 0;
+
+  if(binary) {
+    sensor_record_begin(&record, buf, size,
+                        SENSOR_DEVICE_LIGHT,
+                        off ? SENSOR_EVENT_OFF : SENSOR_EVENT_ON,
+                        device_num, SENSOR_LOCATION_BUILDING_B_CORRIDOR, counter);
+    sensor_record_put_uint(&record, SENSOR_FIELD_BRIGHTNESS, brightness);
+    sensor_record_put_uint(&record, SENSOR_FIELD_ENERGY_CONSUMPTION, energy_consumption);
+    sensor_record_put_uint(&record, SENSOR_FIELD_BOOT_ID, boot_id);
+    sensor_record_put_uint(&record, SENSOR_FIELD_MOTE_TIME, mote_time_ms());
+    return sensor_record_end(&record);
+  }
+  sensor_format_begin(&f, buf, size);
+  sensor_format_str(&f, "{\"eventID\": \"");
+  format_event_id(&f, "light_", device_num, 2, boot_id, counter);
+  sensor_format_str(&f, "\",\"deviceType\": \"light\",\"deviceID\": \"light_");
+  sensor_format_uint(&f, device_num, 2);
+  sensor_format_str(&f, "\",\"moteTime\": ");
+  sensor_format_uint(&f, mote_time_ms(), 0);
+  sensor_format_str(&f, off ? ",\"eventType\": \"off\"," : ",\"eventType\": \"on\",");
+  sensor_format_str(&f, "\"location\": \"Building B - Corridor\",\"metadata\": \"brightness:");
+  sensor_format_int(&f, brightness);
+  sensor_format_str(&f, "; energyConsumption:");
+  sensor_format_int(&f, energy_consumption);
+  sensor_format_str(&f, "W\"}");
+  return sensor_format_end(&f);
+}
+
+int
+sensor_payload_printer(uint8_t *buf, uint16_t size, uint8_t binary,
+                       uint16_t device_num, uint8_t boot_id, uint32_t counter,
+                       int pages_printed)
+{
+  struct sensor_record record;
+  struct sensor_format f;
+
+  if(binary) {
+    sensor_record_begin(&record, buf, size,
+                        SENSOR_DEVICE_PRINTER, SENSOR_EVENT_COMPLETED,
+                        device_num, SENSOR_LOCATION_LIBRARY, counter);
+    sensor_record_put_uint(&record, SENSOR_FIELD_JOB_ID, counter);
+    sensor_record_put_uint(&record, SENSOR_FIELD_PAGES_PRINTED, pages_printed);
+    sensor_record_put_uint(&record, SENSOR_FIELD_PRINTER_USER_ID, counter);
+    sensor_record_put_uint(&record, SENSOR_FIELD_BOOT_ID, boot_id);
+    sensor_record_put_uint(&record, SENSOR_FIELD_MOTE_TIME, mote_time_ms());
+    return sensor_record_end(&record);
+  }
+  sensor_format_begin(&f, buf, size);
+  sensor_format_str(&f, "{\"eventID\": \"");
+  format_event_id(&f, "printer_", device_num, 0, boot_id, counter);
+  sensor_format_str(&f, "\",\"deviceType\": \"printer\",\"deviceID\": \"printer_");
+  sensor_format_uint(&f, device_num, 0);
+  sensor_format_str(&f, "\",\"moteTime\": ");
+  sensor_format_uint(&f, mote_time_ms(), 0);
+  sensor_format_str(&f, ",\"eventType\": \"completed\",\"location\": \"Library\","
+                        "\"metadata\": \"jobID:job_");
+  sensor_format_uint(&f, counter, 3);
+  sensor_format_str(&f, "; pagesPrinted:");
+  sensor_format_int(&f, pages_printed);
+  sensor_format_str(&f, "; userID:student");
+  sensor_format_uint(&f, counter, 0);
+  sensor_format_str(&f, "\"}");
+  return sensor_format_end(&f);
+}
+
+int
+sensor_payload_cctv(uint8_t *buf, uint16_t size, uint8_t binary,
+                    uint16_t device_num, uint8_t boot_id, uint32_t counter)
+{
+  struct sensor_record record;
+  struct sensor_format f;
+
+  if(binary) {
+    sensor_record_begin(&record, buf, size,
+                        SENSOR_DEVICE_CCTV, SENSOR_EVENT_MOTION_DETECTED,
+                        device_num, SENSOR_LOCATION_PARKING_LOT_A, counter);
+    sensor_record_put_uint(&record, SENSOR_FIELD_IMAGE_REFERENCE, counter);
+    sensor_record_put_uint(&record, SENSOR_FIELD_BOOT_ID, boot_id);
+    sensor_record_put_uint(&record, SENSOR_FIELD_MOTE_TIME, mote_time_ms());
+    return sensor_record_end(&record);
+  }
+  sensor_format_begin(&f, buf, size);
+  sensor_format_str(&f, "{\"eventID\":\"");
+  format_event_id(&f, "cctv_", device_num, 0, boot_id, counter);
+  sensor_format_str(&f, "\",\"deviceType\":\"cctv\",\"deviceID\":\"cam_");
+  sensor_format_uint(&f, device_num, 0);
+  sensor_format_str(&f, "\",\"moteTime\":");
+  sensor_format_uint(&f, mote_time_ms(), 0);
+  sensor_format_str(&f, ",\"eventType\":\"motion_detected\",\"location\":\"Parking Lot A\","
+                        "\"metadata\":\"imageReference:img_202503141100_");
+  sensor_format_uint(&f, counter, 3);
+  sensor_format_str(&f, ".jpg\"}");
+  return sensor_format_end(&f);
+}
+
+int
+sensor_payload_card(uint8_t *buf, uint16_t size, uint8_t binary,
+                    uint16_t device_num, uint8_t boot_id, uint32_t counter,
+                    int user_id, int card_id)
+{
+  struct sensor_record record;
+  struct sensor_format f;
+
+  if(binary) {
+    sensor_record_begin(&record, buf, size,
+                        SENSOR_DEVICE_CARD_READER, SENSOR_EVENT_SWIPE,
+                        device_num, SENSOR_LOCATION_BUILDING_A_ENTRANCE, counter);
+    sensor_record_put_uint(&record, SENSOR_FIELD_USER_ID, user_id);
+    sensor_record_put_uint(&record, SENSOR_FIELD_CARD_ID, card_id);
+    sensor_record_put_uint(&record, SENSOR_FIELD_BOOT_ID, boot_id);
+    sensor_record_put_uint(&record, SENSOR_FIELD_MOTE_TIME, mote_time_ms());
+    return sensor_record_end(&record);
+  }
+  sensor_format_begin(&f, buf, size);
+  sensor_format_str(&f, "{\"eventID\":\"");
+  format_event_id(&f, "card_", device_num, 2, boot_id, counter);
+  sensor_format_str(&f, "\",\"deviceType\":\"card_reader\",\"deviceID\":\"reader_");
+  sensor_format_uint(&f, device_num, 2);
+  sensor_format_str(&f, "\",\"moteTime\":");
+  sensor_format_uint(&f, mote_time_ms(), 0);
+  sensor_format_str(&f, ",\"eventType\":\"swipe\",\"location\":\"Building A - Main Entrance\","
+                        "\"metadata\":\"userID:user");
+  sensor_format_int(&f, user_id);
+  sensor_format_str(&f, "; cardID:card");
+  sensor_format_int(&f, card_id);
+  sensor_format_str(&f, "\"}");
+  return sensor_format_end(&f);
+}
@@ -0,0 +1,57 @@
+#ifndef SENSOR_PAYLOADS_H_
+#define SENSOR_PAYLOADS_H_
+
+#include <stdint.h>
+#include "sensor-codec.h"
+
+/*
+ * Event payload builders shared by the mote firmwares and the host load
+ * generator (../loadgen), so both send byte-for-byte the same datagrams.
+ *
+ * Each builder writes one event of the given device number and event counter
+ * into buf, either as the compact binary record of sensor-codec.h
+ * (binary != 0) or as the legacy JSON string, and returns its length, or -1
+ * if buf is too small. Firmwares pass SENSOR_PAYLOAD_BINARY as binary.
+ * JSON is written with sensor-format.c rather than snprintf: the constant
+ * parts are copied as-is and only the numbers are converted.
+ *
+ * The eventID is made of the device type, the device number, the boot id of
+ * the mote's link (sensor-link.h) and the event counter, e.g.
+ * "sensor_03_183_001": counters restart at every boot and every device of a
+ * type counts from 1, so the counter alone would repeat eventIDs across
+ * devices and reboots, and the ledger keeps one event per eventID.
+ *
+ * Every event carries the mote clock at build time (SENSOR_FIELD_MOTE_TIME,
+ * "moteTime" in JSON) instead of a wall-clock timestamp, which the motes do
+ * not have. The gateway maps it to wall-clock time and uses it to time the
+ * hop from the reading to its arrival.
+ */
+
+/* Largest payload of this build: one binary record, or the legacy JSON */
+#if SENSOR_PAYLOAD_BINARY
+#define SENSOR_PAYLOAD_MAX 40
+#else
+#define SENSOR_PAYLOAD_MAX 256
+#endif
+
+int sensor_payload_co2(uint8_t *buf, uint16_t size, uint8_t binary,
+                       uint16_t device_num, uint8_t boot_id, uint32_t counter,
+                       int co2_level, int temperature);
+
+/* Odd counters are "on" events, even counters "off" */
+int sensor_payload_light(uint8_t *buf, uint16_t size, uint8_t binary,
+                         uint16_t device_num, uint8_t boot_id, uint32_t counter,
+                         int brightness, int energy_consumption);
+
+int sensor_payload_printer(uint8_t *buf, uint16_t size, uint8_t binary,
+                           uint16_t device_num, uint8_t boot_id, uint32_t counter,
+                           int pages_printed);
+
+int sensor_payload_cctv(uint8_t *buf, uint16_t size, uint8_t binary,
+                        uint16_t device_num, uint8_t boot_id, uint32_t counter);
+
+int sensor_payload_card(uint8_t *buf, uint16_t size, uint8_t binary,
+                        uint16_t device_num, uint8_t boot_id, uint32_t counter,
+                        int user_id, int card_id);
+
+#endif /* SENSOR_PAYLOADS_H_ */
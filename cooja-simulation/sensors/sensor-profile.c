@@ -0,0 +1,65 @@
+#include "sensor-profile.h"
+
+#if SENSOR_PROFILE
+
+#include <stdio.h>
+#include "sys/ctimer.h"
+#include "sys/energest.h"
+
+#ifndef F_CPU
+#define F_CPU 0
+#endif
+
+struct sensor_profile sensor_profile;
+
+static struct ctimer report_timer;
+static uint16_t profiled_device;
+
+static void
+report(void *ptr)
+{
+  ctimer_reset(&report_timer);
+  energest_flush();
+  printf("PROF 1 dev=%u ev=%lu pb=%lu dg=%lu tb=%lu build=%lu send=%lu "
+         "cpu=%lu lpm=%lu tx=%lu rx=%lu hz=%lu fcpu=%lu\n",
+         profiled_device,
+         (unsigned long)sensor_profile.events,
+         (unsigned long)sensor_profile.payload_bytes,
+         (unsigned long)sensor_profile.datagrams,
+         (unsigned long)sensor_profile.bytes,
+         (unsigned long)sensor_profile.build_ticks,
+         (unsigned long)sensor_profile.send_ticks,
+         (unsigned long)energest_type_time(ENERGEST_TYPE_CPU),
+         (unsigned long)energest_type_time(ENERGEST_TYPE_LPM),
+         (unsigned long)energest_type_time(ENERGEST_TYPE_TRANSMIT),
+         (unsigned long)energest_type_time(ENERGEST_TYPE_LISTEN),
+         (unsigned long)RTIMER_SECOND,
+         (unsigned long)F_CPU);
+}
+
+void
+sensor_profile_init(uint16_t device_num)
+{
+  profiled_device = device_num;
+  ctimer_set(&report_timer, SENSOR_PROFILE_PERIOD, report, NULL);
+}
+
+void
+sensor_profile_build_done(int len)
+{
+  sensor_profile.build_ticks += (rtimer_clock_t)(RTIMER_NOW() - sensor_profile.started);
+  if(len > 0) {
+    sensor_profile.events++;
+    sensor_profile.payload_bytes += len;
+  }
+}
+
+void
+sensor_profile_send_done(uint16_t len)
+{
+  sensor_profile.send_ticks += (rtimer_clock_t)(RTIMER_NOW() - sensor_profile.started);
+  sensor_profile.datagrams++;
+  sensor_profile.bytes += len;
+}
+
+#endif /* SENSOR_PROFILE */
@@ -0,0 +1,71 @@
+#ifndef SENSOR_PROFILE_H_
+#define SENSOR_PROFILE_H_
+
+#include <stdint.h>
+
+/*
+ * Energy and duty-cycle profiling, compiled in with `make PROFILE=1`
+ * (SENSOR_PROFILE=1, Energest on). Otherwise every macro below is a no-op.
+ *
+ * The firmwares bracket payload building and each simple_udp_sendto() with
+ * the BUILD and SEND macros. Time is measured with the rtimer, so one tick
+ * is 1/RTIMER_SECOND s (about 30 us on the Z1): individual events are below
+ * its resolution, but the totals over many events are accurate. Every
+ * SENSOR_PROFILE_PERIOD the mote prints one line of cumulative counters:
+ *
+ *   PROF 1 dev=<n> ev=<events> pb=<payload bytes> dg=<datagrams sent>
+ *          tb=<bytes sent> build=<ticks> send=<ticks> cpu=<ticks>
+ *          lpm=<ticks> tx=<ticks> rx=<ticks> hz=<RTIMER_SECOND> fcpu=<Hz>
+ *
+ * (on one line). cpu, lpm, tx and rx are the Energest totals since boot;
+ * tx + rx is the radio-on time. energy-report.js turns these lines into a
+ * per-mote report.
+ */
+
+#ifndef SENSOR_PROFILE
+#define SENSOR_PROFILE 0
+#endif
+
+#if SENSOR_PROFILE
+
+#include "contiki.h"
+#include "sys/rtimer.h"
+
+#ifndef SENSOR_PROFILE_PERIOD
+#define SENSOR_PROFILE_PERIOD (CLOCK_SECOND * 10)
+#endif
+
+struct sensor_profile {
+  uint32_t events;
+  uint32_t payload_bytes;
+  uint32_t datagrams;
+  uint32_t bytes;
+  uint32_t build_ticks;
+  uint32_t send_ticks;
+  rtimer_clock_t started;
+};
+
+extern struct sensor_profile sensor_profile;
+
+/* Start printing PROF lines every SENSOR_PROFILE_PERIOD */
+void sensor_profile_init(uint16_t device_num);
+void sensor_profile_build_done(int len);
+void sensor_profile_send_done(uint16_t len);
+
+#define SENSOR_PROFILE_INIT(device_num) sensor_profile_init(device_num)
+#define SENSOR_PROFILE_BUILD_BEGIN()    (sensor_profile.started = RTIMER_NOW())
+#define SENSOR_PROFILE_BUILD_END(len)   sensor_profile_build_done(len)
+#define SENSOR_PROFILE_SEND_BEGIN()     (sensor_profile.started = RTIMER_NOW())
+#define SENSOR_PROFILE_SEND_END(len)    sensor_profile_send_done(len)
+
+#else /* SENSOR_PROFILE */
+
+#define SENSOR_PROFILE_INIT(device_num)
+#define SENSOR_PROFILE_BUILD_BEGIN()
+#define SENSOR_PROFILE_BUILD_END(len)
+#define SENSOR_PROFILE_SEND_BEGIN()
+#define SENSOR_PROFILE_SEND_END(len)
+
+#endif /* SENSOR_PROFILE */
+
+#endif /* SENSOR_PROFILE_H_ */
@@ -0,0 +1,134 @@
+#include <string.h>
+#include "sensor-report.h"
+
+void
+sensor_report_init(struct sensor_report *r, uint8_t channels,
+                   clock_time_t sample_interval)
+{
+  uint8_t ch;
+
+  memset(r, 0, sizeof(*r));
+  r->channels = channels < SENSOR_REPORT_MAX_CHANNELS ? channels : SENSOR_REPORT_MAX_CHANNELS;
+  r->sample_interval = sample_interval;
+  r->backoff_max = SENSOR_REPORT_BACKOFF_MAX;
+  r->heartbeat = SENSOR_REPORT_HEARTBEAT;
+  r->interval = sample_interval;
+  for(ch = 0; ch < SENSOR_REPORT_MAX_CHANNELS; ch++) {
+    r->alarm[ch] = SENSOR_REPORT_ALARM_OFF;
+  }
+}
+
+static uint8_t
+alarm_state(const struct sensor_report *r, const int16_t *values)
+{
+  uint8_t ch, above = 0;
+
+  for(ch = 0; ch < r->channels; ch++) {
+    if(r->alarm[ch] != SENSOR_REPORT_ALARM_OFF && values[ch] >= r->alarm[ch]) {
+      above |= 1 << ch;
+    }
+  }
+  return above;
+}
+
+static uint8_t
+changed(const struct sensor_report *r, const int16_t *values)
+{
+  uint8_t ch;
+
+  for(ch = 0; ch < r->channels; ch++) {
+    int32_t delta = (int32_t)values[ch] - r->last[ch];
+    if(delta < 0) {
+      delta = -delta;
+    }
+    /* A deadband of 0 matches every sample, changed or not */
+    if(delta >= r->deadband[ch]) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+uint8_t
+sensor_report_sample(struct sensor_report *r, const int16_t *values,
+                     clock_time_t now)
+{
+  uint8_t above = alarm_state(r, values);
+  uint8_t reason = SENSOR_REPORT_NONE;
+
+  r->samples++;
+  if(!r->reported) {
+    reason = SENSOR_REPORT_FIRST;
+  } else if(above != r->above) {
+    reason = SENSOR_REPORT_ALARM;
+  } else if(changed(r, values)) {
+    reason = SENSOR_REPORT_CHANGE;
+  } else if(r->heartbeat > 0 && now - r->last_report_at >= r->heartbeat) {
+    reason = SENSOR_REPORT_HEARTBEAT_DUE;
+  }
+
+  if(reason == SENSOR_REPORT_NONE || reason == SENSOR_REPORT_HEARTBEAT_DUE) {
+    /* Stable: back off, but never past the heartbeat or the backoff limit */
+    clock_time_t limit = r->backoff_max;
+    if(r->heartbeat > 0 && r->heartbeat < limit) {
+      limit = r->heartbeat;
+    }
+    r->interval = r->interval * 2 <= limit ? r->interval * 2 : limit;
+    if(r->interval < r->sample_interval) {
+      r->interval = r->sample_interval;
+    }
+  } else {
+    r->interval = r->sample_interval;
+  }
+
+  if(reason != SENSOR_REPORT_NONE) {
+    memcpy(r->last, values, r->channels * sizeof(values[0]));
+    r->above = above;
+    r->reported = 1;
+    r->last_report_at = now;
+    r->reports++;
+  }
+  return reason;
+}
+
+/* clock_time_t is 16 bits on some targets: keep intervals within half its range */
+static clock_time_t
+seconds_to_ticks(uint16_t seconds)
+{
+  const clock_time_t max = (clock_time_t)~(clock_time_t)0 >> 1;
+  uint32_t ticks = (uint32_t)seconds * CLOCK_SECOND;
+
+  return ticks < max ? (clock_time_t)ticks : max;
+}
+
+int
+sensor_report_input(struct sensor_report *r, const uint8_t *data, uint16_t len)
+{
+  uint16_t i;
+
+  if(len < 1 || data[0] != SENSOR_REPORT_CONFIG) {
+    return 0;
+  }
+  for(i = 1; i + 3 <= len; i += 3) {
+    uint8_t param = data[i];
+    uint16_t value = (data[i + 1] << 8) | data[i + 2];
+    uint8_t ch = param & 0x0f;
+
+    if(param == SENSOR_REPORT_PARAM_SAMPLE_MS && value > 0) {
+      r->sample_interval = (clock_time_t)((uint32_t)value * CLOCK_SECOND / 1000);
+      if(r->sample_interval == 0) {
+        r->sample_interval = 1;
+      }
+    } else if(param == SENSOR_REPORT_PARAM_BACKOFF_MAX) {
+      r->backoff_max = seconds_to_ticks(value);
+    } else if(param == SENSOR_REPORT_PARAM_HEARTBEAT) {
+      r->heartbeat = seconds_to_ticks(value);
+    } else if((param & 0xf0) == SENSOR_REPORT_PARAM_DEADBAND && ch < r->channels) {
+      r->deadband[ch] = value;
+    } else if((param & 0xf0) == SENSOR_REPORT_PARAM_ALARM && ch < r->channels) {
+      r->alarm[ch] = (int16_t)value;
+    }
+  }
+  r->interval = r->sample_interval;
+  return 1;
+}
@@ -0,0 +1,102 @@
+#ifndef SENSOR_REPORT_H_
+#define SENSOR_REPORT_H_
+
+#include <stdint.h>
+#include "contiki.h"
+
+/*
+ * Change-driven reporting for periodic sensors.
+ *
+ * The firmware samples on a timer and asks sensor_report_sample() whether the
+ * sample is worth sending. It is when a channel moved by at least its
+ * deadband since the last report, crossed its alarm level (either way), or
+ * when nothing was reported for a heartbeat interval. While readings stay
+ * within their deadbands the sampling interval doubles, up to backoff_max;
+ * any change or alarm brings it back to the base interval. A deadband of 0
+ * reports every sample, as the firmwares did before.
+ *
+ * All parameters can be changed at runtime with a config downlink:
+ *
+ *   0      SENSOR_REPORT_CONFIG
+ *   1..    (parameter id, value: 16 bits big endian) pairs
+ *
+ * Parameter ids:
+ *
+ *   0x01        base sample interval, ms
+ *   0x02        backoff_max, seconds (0: no backoff)
+ *   0x03        heartbeat, seconds (0: none)
+ *   0x10 + ch   deadband of channel ch, in the channel's units
+ *   0x20 + ch   alarm level of channel ch (signed), SENSOR_REPORT_ALARM_OFF
+ *               to disable
+ */
+
+#define SENSOR_REPORT_CONFIG 0xA2
+
+#define SENSOR_REPORT_PARAM_SAMPLE_MS   0x01
+#define SENSOR_REPORT_PARAM_BACKOFF_MAX 0x02
+#define SENSOR_REPORT_PARAM_HEARTBEAT   0x03
+#define SENSOR_REPORT_PARAM_DEADBAND    0x10
+#define SENSOR_REPORT_PARAM_ALARM       0x20
+
+#define SENSOR_REPORT_MAX_CHANNELS 4
+#define SENSOR_REPORT_ALARM_OFF    0x7fff
+
+#ifndef SENSOR_REPORT_HEARTBEAT
+#define SENSOR_REPORT_HEARTBEAT (CLOCK_SECOND * 60)
+#endif
+
+#ifndef SENSOR_REPORT_BACKOFF_MAX
+#define SENSOR_REPORT_BACKOFF_MAX (CLOCK_SECOND * 16)
+#endif
+
+/* Why a sample is reported; 0 means it is suppressed */
+#define SENSOR_REPORT_NONE      0
+#define SENSOR_REPORT_FIRST     1
+#define SENSOR_REPORT_CHANGE    2
+#define SENSOR_REPORT_ALARM     3
+#define SENSOR_REPORT_HEARTBEAT_DUE 4
+
+struct sensor_report {
+  /* Configuration */
+  clock_time_t sample_interval;
+  clock_time_t backoff_max;
+  clock_time_t heartbeat;
+  uint16_t deadband[SENSOR_REPORT_MAX_CHANNELS];
+  int16_t alarm[SENSOR_REPORT_MAX_CHANNELS];
+
+  /* State */
+  uint8_t channels;
+  uint8_t reported;          /* a report was sent since boot */
+  uint8_t above;             /* bit ch: channel ch was at or above its alarm */
+  int16_t last[SENSOR_REPORT_MAX_CHANNELS];
+  clock_time_t last_report_at;
+  clock_time_t interval;     /* wait before the next sample */
+
+  /* Counters */
+  uint32_t samples;
+  uint32_t reports;
+};
+
+/**
+ * Start with no deadband or alarm (every sample is reported), the given base
+ * sample interval and the build-time heartbeat and backoff limits.
+ */
+void sensor_report_init(struct sensor_report *r, uint8_t channels,
+                        clock_time_t sample_interval);
+
+/**
+ * Feed one sample (one value per channel) taken at now. Returns the reason
+ * to report it, or SENSOR_REPORT_NONE, and sets r->interval to the wait
+ * before the next sample.
+ */
+uint8_t sensor_report_sample(struct sensor_report *r, const int16_t *values,
+                             clock_time_t now);
+
+/**
+ * Apply a config downlink. Returns 1 if data was one (r->interval is then
+ * reset to the base interval), 0 otherwise.
+ */
+int sensor_report_input(struct sensor_report *r, const uint8_t *data,
+                        uint16_t len);
+
+#endif /* SENSOR_REPORT_H_ */
@@ -0,0 +1,68 @@
+#include "sensor-sink.h"
+#include "net/ip/uiplib.h"
+#if SENSOR_SINK_POLICY == SENSOR_SINK_NEAREST
+#include "net/rpl/rpl.h"
+#endif
+
+static const char *const sink_list[] = { SENSOR_SINKS };
+
+uint8_t
+sensor_sink_init(struct sensor_sink *s)
+{
+  uint8_t i;
+
+  s->count = 0;
+  s->next = 0;
+  for(i = 0; i < sizeof(sink_list) / sizeof(sink_list[0]); i++) {
+    if(s->count < SENSOR_LINK_DESTS &&
+       uiplib_ipaddrconv(sink_list[i], &s->addr[s->count])) {
+      s->count++;
+    }
+  }
+  return s->count;
+}
+
+uint8_t
+sensor_sink_select(struct sensor_sink *s)
+{
+#if SENSOR_SINK_POLICY == SENSOR_SINK_NEAREST
+  rpl_dag_t *dag = rpl_get_any_dag();
+  uint8_t i;
+
+  if(dag != NULL && dag->prefix_info.length > 0) {
+    for(i = 0; i < s->count; i++) {
+      if(uip_ipaddr_prefixcmp(&s->addr[i], &dag->prefix_info.prefix,
+                              dag->prefix_info.length)) {
+        return i;
+      }
+    }
+  }
+  return 0;
+#else
+  uint8_t index = s->next;
+
+  if(s->count > 0) {
+    s->next = (s->next + 1) % s->count;
+  }
+  return index;
+#endif
+}
+
+const uip_ipaddr_t *
+sensor_sink_addr(const struct sensor_sink *s, uint8_t index)
+{
+  return &s->addr[index < s->count ? index : 0];
+}
+
+int
+sensor_sink_lookup(const struct sensor_sink *s, const uip_ipaddr_t *from)
+{
+  uint8_t i;
+
+  for(i = 0; i < s->count; i++) {
+    if(uip_ipaddr_cmp(&s->addr[i], from)) {
+      return i;
+    }
+  }
+  return -1;
+}
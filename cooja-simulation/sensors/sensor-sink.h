@@ -0,0 +1,60 @@
+#ifndef SENSOR_SINK_H_
+#define SENSOR_SINK_H_
+
+#include <stdint.h>
+#include "contiki.h"
+#include "net/ip/uip.h"
+#include "sensor-link.h"
+
+/*
+ * Sink (gateway) addresses of a mote and the choice between them.
+ *
+ * The list is set at build time, e.g. `make SINKS="aaaa::1 bbbb::1"`, and
+ * holds up to SENSOR_LINK_DESTS addresses; each sink is one destination of
+ * sensor-link.c. Two policies pick the sink of every datagram:
+ *
+ *   SENSOR_SINK_NEAREST      the sink in the prefix of the RPL DODAG the mote
+ *                            joined. With one border router per sink, RPL
+ *                            already picked the root of lowest rank, so this
+ *                            is the closest gateway; the mote moves with its
+ *                            DODAG and uses the first sink while it has none.
+ *   SENSOR_SINK_ROUND_ROBIN  every sink in turn, to spread the load of one
+ *                            DODAG over several gateways behind it.
+ *
+ * Gateways deduplicate events between them, so a mote switching sinks never
+ * writes an event twice.
+ */
+
+#define SENSOR_SINK_NEAREST     0
+#define SENSOR_SINK_ROUND_ROBIN 1
+
+#ifndef SENSOR_SINK_POLICY
+#define SENSOR_SINK_POLICY SENSOR_SINK_NEAREST
+#endif
+
+/* Comma-separated string literals; override with -DSENSOR_SINKS=... */
+#ifndef SENSOR_SINKS
+#define SENSOR_SINKS "aaaa::1"
+#endif
+
+struct sensor_sink {
+  uip_ipaddr_t addr[SENSOR_LINK_DESTS];
+  uint8_t count;
+  uint8_t next;   /* round robin position */
+};
+
+/**
+ * Parse SENSOR_SINKS into s. Returns the number of sinks (invalid entries
+ * and entries beyond SENSOR_LINK_DESTS are skipped).
+ */
+uint8_t sensor_sink_init(struct sensor_sink *s);
+
+/* Sink for the next datagram, under SENSOR_SINK_POLICY */
+uint8_t sensor_sink_select(struct sensor_sink *s);
+
+const uip_ipaddr_t *sensor_sink_addr(const struct sensor_sink *s, uint8_t index);
+
+/* Index of the sink with address from, or -1 if it is not one of them */
+int sensor_sink_lookup(const struct sensor_sink *s, const uip_ipaddr_t *from);
+
+#endif /* SENSOR_SINK_H_ */
@@ -1,21 +1,57 @@
 // src/api/api.js
-import axios from 'axios';
-
 const API_BASE_URL = 'http://localhost:5000/api';
 
+/**
+ * Read the NDJSON stream served by GET /sensor-events, handing each chunk of
+ * parsed events to onEvents as soon as it arrives.
+ *
+ * @param {Object} params - Query parameters (deviceType, deviceID, pageSize, limit).
+ * @param {Function} [onEvents] - Called with each array of newly received events.
+ * @returns {Promise<Array>} All events received.
+ */
+const streamSensorEvents = async (params, onEvents) => {
+  const query = new URLSearchParams(params).toString();
+  const response = await fetch(`${API_BASE_URL}/sensor-events${query ? `?${query}` : ''}`);
+  if (!response.ok) {
+    throw new Error(`Request failed with status ${response.status}`);
+  }
+
+  const reader = response.body.getReader();
+  const decoder = new TextDecoder();
+  const events = [];
+  let buffered = '';
+  for (;;) {
+    const { done, value } = await reader.read();
+    buffered += decoder.decode(value, { stream: !done });
+    const lines = buffered.split('\n');
+    // Keep a trailing partial line for the next chunk
+    buffered = done ? '' : lines.pop();
+    const received = lines.filter((line) => line.trim() !== '').map((line) => JSON.parse(line));
+    if (received.length > 0) {
+      events.push(...received);
+      if (onEvents) {
+        onEvents(received);
+      }
+    }
+    if (done) {
+      return events;
+    }
+  }
+};
+
 /**
  * Fetch all sensor events from the backend.
  *
+ * @param {Function} [onEvents] - Called with each chunk of events while the stream is read,
+ *   so the first rows can be rendered before the last page arrives.
  * @returns {Promise<{ events: Array, error: Error | null, loading: boolean }>}
  */
-export const fetchSensorEvents = async () => {
+export const fetchSensorEvents = async (onEvents) => {
   let loading = true;
   let error = null;
   let events = [];
   try {
-    const response = await axios.get(`${API_BASE_URL}/sensor-events`);
-    // Assuming the backend returns sensor events wrapped inside an "events" property
-    events = response.data.events;
+    events = await streamSensorEvents({}, onEvents);
   } catch (err) {
     console.error('Failed to fetch sensor events:', err);
     error = err;
@@ -28,22 +64,66 @@ export const fetchSensorEvents = async () => {
  * Fetch sensor events filtered by the specified device type.
  *
  * @param {string} deviceType - The type of device to filter sensor events by.
+ * @param {Function} [onEvents] - Called with each chunk of events while the stream is read.
  * @returns {Promise<{ events: Array, error: Error | null, loading: boolean }>}
  */
-export const fetchSensorEventsByDevice = async (deviceType) => {
+export const fetchSensorEventsByDevice = async (deviceType, onEvents) => {
   let loading = true;
   let error = null;
   let events = [];
   try {
-    // The API is assumed to support filtering through query parameters.
-    const response = await axios.get(`${API_BASE_URL}/sensor-events`, {
-      params: { deviceType },
-    });
-    events = response.data.events;
+    events = await streamSensorEvents({ deviceType }, onEvents);
   } catch (err) {
     console.error(`Failed to fetch sensor events for device type "${deviceType}":`, err);
     error = err;
   }
   loading = false;
   return { events, error, loading };
-};
\ No newline at end of file
+};
+
+/**
+ * Subscribe to sensor events as they are committed, pushed by the backend as
+ * server-sent events (GET /sensor-events/stream). The browser reconnects on
+ * its own and the backend then resends the events missed meanwhile; when it
+ * cannot, onReset is called and the caller should reload the full list.
+ *
+ * @param {Object} params - Query parameters (deviceType, deviceID).
+ * @param {Object} handlers
+ * @param {Function} handlers.onEvents - Called with each array of newly committed events.
+ * @param {Function} [handlers.onDeleted] - Called with each array of deleted event IDs.
+ * @param {Function} [handlers.onReset] - Called when missed events cannot be resent.
+ * @returns {Function} Closes the subscription.
+ */
+export const subscribeSensorEvents = (params, { onEvents, onDeleted, onReset }) => {
+  const query = new URLSearchParams(params).toString();
+  const source = new EventSource(`${API_BASE_URL}/sensor-events/stream${query ? `?${query}` : ''}`);
+  source.addEventListener('events', (message) => onEvents(JSON.parse(message.data)));
+  if (onDeleted) {
+    source.addEventListener('deleted', (message) => onDeleted(JSON.parse(message.data)));
+  }
+  if (onReset) {
+    source.addEventListener('reset', () => onReset());
+  }
+  return () => source.close();
+};
+
+/**
+ * Fetch the ingest pipeline latency histograms and throughput served by GET /metrics.
+ *
+ * @returns {Promise<{ metrics: Object | null, error: Error | null }>}
+ *   metrics.stages lists each stage with count, p50, p90, p99, p99.9 and max (ms);
+ *   metrics.throughput has accepted and committed events per second.
+ */
+export const fetchLatencyMetrics = async () => {
+  try {
+    const response = await fetch(`${API_BASE_URL}/metrics`);
+    if (!response.ok) {
+      throw new Error(`Request failed with status ${response.status}`);
+    }
+    const { metrics } = await response.json();
+    return { metrics, error: null };
+  } catch (err) {
+    console.error('Failed to fetch latency metrics:', err);
+    return { metrics: null, error: err };
+  }
+};
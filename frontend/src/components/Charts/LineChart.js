@@ -1,22 +1,40 @@
-import React from "react";
+import React, { useMemo } from "react";
 import { Line } from "react-chartjs-2";
 import PropTypes from "prop-types";
+import { lttbIndices } from "./lttb";
+
+const LineChart = ({ dataset, title = "IoT Performance", maxPoints = 1000 }) => {
+  // Long series are downsampled per line with LTTB; the points kept by either
+  // line are drawn for both, so they share their labels
+  const points = useMemo(() => {
+    if (dataset.length <= maxPoints) {
+      return dataset;
+    }
+    const x = (i) => i;
+    const kept = new Set([
+      ...lttbIndices(dataset.length, maxPoints, x, (i) => dataset[i].success),
+      ...lttbIndices(dataset.length, maxPoints, x, (i) => dataset[i].failures),
+    ]);
+    return [...kept].sort((a, b) => a - b).map((i) => dataset[i]);
+  }, [dataset, maxPoints]);
+  const downsampled = points !== dataset;
 
-const LineChart = ({ dataset, title = "IoT Performance" }) => {
   const chartData = {
-    labels: dataset.map((entry) => entry.label),
+    labels: points.map((entry) => entry.label),
     datasets: [
       {
         label: "Successful Connections",
-        data: dataset.map((entry) => entry.success),
+        data: points.map((entry) => entry.success),
         borderColor: "rgba(75, 192, 192, 1)",
         tension: 0.2,
+        pointRadius: downsampled ? 0 : undefined,
       },
       {
         label: "Failed Connections",
-        data: dataset.map((entry) => entry.failures),
+        data: points.map((entry) => entry.failures),
         borderColor: "rgba(255, 99, 132, 1)",
         tension: 0.2,
+        pointRadius: downsampled ? 0 : undefined,
       },
     ],
   };
@@ -27,6 +45,7 @@ const LineChart = ({ dataset, title = "IoT Performance" }) => {
     },
     responsive: true,
     maintainAspectRatio: false,
+    animation: downsampled ? false : undefined,
     scales: {
       x: { title: { display: true, text: "Attempts" } },
       y: { beginAtZero: true, title: { display: true, text: "Values" } },
@@ -49,6 +68,7 @@ LineChart.propTypes = {
       })
   ),
   title: PropTypes.string,
+  maxPoints: PropTypes.number,
 };
 
-export default LineChart;
\ No newline at end of file
+export default LineChart;
@@ -1,16 +1,23 @@
 import { Scatter } from "react-chartjs-2";
 import { Chart as ChartJS, LinearScale, PointElement, Tooltip, Legend } from "chart.js";
-import React from "react";
+import React, { useMemo } from "react";
+import { lttb } from "./lttb";
 
 ChartJS.register(LinearScale, PointElement, Tooltip, Legend);
 
-const ScatterChart = ({ data, title = "IoT Device Locations" }) => {
+const ScatterChart = ({ data = [], title = "IoT Device Locations", maxPoints = 2000 }) => {
+  // Large point clouds are thinned with LTTB along x, which keeps the outliers
+  const points = useMemo(
+    () => (data.length > maxPoints ? lttb(data.slice().sort((a, b) => a.x - b.x), maxPoints) : data),
+    [data, maxPoints]
+  );
+
   const chartData = {
     labels: ["IoT Devices"],
     datasets: [
       {
         label: title,
-        data: data,
+        data: points,
         backgroundColor: "rgba(75, 192, 192, 0.6)",
         borderColor: "rgba(75, 192, 192, 1)",
       },
@@ -19,6 +26,7 @@ const ScatterChart = ({ data, title = "IoT Device Locations" }) => {
 
   const options = {
     responsive: true,
+    animation: points !== data ? false : undefined,
     plugins: {
       legend: { display: true },
     },
@@ -31,4 +39,4 @@ const ScatterChart = ({ data, title = "IoT Device Locations" }) => {
   return <Scatter data={chartData} options={options} />;
 };
 
-export default ScatterChart;
\ No newline at end of file
+export default ScatterChart;
@@ -0,0 +1,66 @@
+/**
+ * Largest-Triangle-Three-Buckets downsampling (Steinarsson, 2013).
+ * Keeps the first and last points. The points in between are split into
+ * threshold - 2 buckets. From each bucket it keeps the point that forms the
+ * largest triangle with the point kept from the previous bucket and the
+ * average of the next bucket. Peaks and troughs survive, so a chart of a
+ * thousand points looks like the full series at a fraction of the drawing cost.
+ *
+ * @param {number} length - Number of points.
+ * @param {number} threshold - Number of points to keep.
+ * @param {Function} x - (i) => x of point i, not decreasing with i.
+ * @param {Function} y - (i) => y of point i.
+ * @returns {number[]} Indices of the points kept, ascending.
+ */
+export const lttbIndices = (length, threshold, x, y) => {
+  if (threshold >= length || threshold < 3) {
+    return Array.from({ length }, (_, i) => i);
+  }
+  const every = (length - 2) / (threshold - 2);
+  const kept = [0];
+  let previous = 0;
+  for (let bucket = 0; bucket < threshold - 2; bucket++) {
+    const nextStart = Math.floor((bucket + 1) * every) + 1;
+    const nextEnd = Math.min(Math.floor((bucket + 2) * every) + 1, length);
+    let avgX = 0;
+    let avgY = 0;
+    for (let i = nextStart; i < nextEnd; i++) {
+      avgX += x(i);
+      avgY += y(i);
+    }
+    avgX /= nextEnd - nextStart;
+    avgY /= nextEnd - nextStart;
+
+    const start = Math.floor(bucket * every) + 1;
+    const end = Math.floor((bucket + 1) * every) + 1;
+    const prevX = x(previous);
+    const prevY = y(previous);
+    let maxArea = -1;
+    let chosen = start;
+    for (let i = start; i < end; i++) {
+      const area = Math.abs((prevX - avgX) * (y(i) - prevY) - (prevX - x(i)) * (avgY - prevY));
+      if (area > maxArea) {
+        maxArea = area;
+        chosen = i;
+      }
+    }
+    kept.push(chosen);
+    previous = chosen;
+  }
+  kept.push(length - 1);
+  return kept;
+};
+
+/**
+ * Downsamples {x, y} points to about threshold points with LTTB.
+ *
+ * @param {Array<{x: number, y: number}>} points - Sorted by x.
+ * @param {number} threshold - Number of points to keep.
+ * @returns {Array<{x: number, y: number}>} The points kept (the input itself when short enough).
+ */
+export const lttb = (points, threshold) => {
+  if (threshold >= points.length) {
+    return points;
+  }
+  return lttbIndices(points.length, threshold, (i) => points[i].x, (i) => points[i].y).map((i) => points[i]);
+};
@@ -2,91 +2,86 @@
 import React, { useState, useEffect } from 'react';
 import { Line } from 'react-chartjs-2';
 import 'chart.js/auto';
+import { fetchLatencyMetrics } from '../../api/api';
 import './PerformanceMetricsTable.css';
 
-// Simulated performance metrics data
-const simulatedMetrics = [
-  {
-    metricType: 'Latency',
-    value: 50,
-    unit: 'ms',
-    timestamp: new Date(new Date().getTime() - 2 * 60 * 1000).toISOString(), // 2 minutes ago
-    notes: 'Normal',
-  },
-  {
-    metricType: 'CPU',
-    value: 70,
-    unit: '%',
-    timestamp: new Date(new Date().getTime() - 3 * 60 * 1000).toISOString(), // 3 minutes ago
-    notes: 'High load',
-  },
-  {
-    metricType: 'Memory',
-    value: 1500,
-    unit: 'MB',
-    timestamp: new Date(new Date().getTime() - 4 * 60 * 1000).toISOString(), // 4 minutes ago
-    notes: 'Stable usage',
-  },
-  {
-    metricType: 'Throughput',
-    value: 300,
-    unit: 'MB',
-    timestamp: new Date(new Date().getTime() - 10 * 60 * 1000).toISOString(), // 10 minutes ago
-    notes: 'Normal throughput',
-  },
-  {
-    metricType: 'Latency',
-    value: 80,
-    unit: 'ms',
-    timestamp: new Date(new Date().getTime() - 20 * 60 * 1000).toISOString(), // 20 minutes ago
-    notes: 'Slight delay detected',
-  },
-  // Add more simulated data as required...
-];
+// How often the backend histograms are polled, and how much history the trend keeps
+const POLL_INTERVAL_MS = 5000;
+const MAX_HISTORY_POINTS = 720; // 1 hour at 5 s
+
+const TIME_RANGES = {
+  'Last 5 min': 5 * 60 * 1000,
+  'Last 1 hr': 60 * 60 * 1000,
+  All: Infinity,
+};
+
+const formatMs = (value) => (value === null || value === undefined ? '–' : `${value.toFixed(1)} ms`);
 
 const PerformanceMetricsTable = () => {
   const [timeRange, setTimeRange] = useState('All');
-  const [filteredMetrics, setFilteredMetrics] = useState(simulatedMetrics);
+  const [metrics, setMetrics] = useState(null);
+  const [history, setHistory] = useState([]);
+  const [error, setError] = useState(null);
 
-  // Filter metrics based on the selected time range on mount and timeRange change
+  // Poll the measured stage latencies and keep a short history for the trend chart
   useEffect(() => {
-    const now = new Date();
-    let filtered = [];
-
-    if (timeRange === 'Last 5 min') {
-      filtered = simulatedMetrics.filter(metric => {
-        const metricDate = new Date(metric.timestamp);
-        return now - metricDate <= 5 * 60 * 1000; // 5 minutes
-      });
-    } else if (timeRange === 'Last 1 hr') {
-      filtered = simulatedMetrics.filter(metric => {
-        const metricDate = new Date(metric.timestamp);
-        return now - metricDate <= 60 * 60 * 1000; // 1 hour
-      });
-    } else {
-      filtered = simulatedMetrics;
-    }
-
-    setFilteredMetrics(filtered);
-  }, [timeRange]);
-
-  // Prepare data for the optional trend line chart for Latency
-  const prepareChartData = () => {
-    const latencyMetrics = filteredMetrics.filter(metric => metric.metricType === 'Latency');
-    return {
-      labels: latencyMetrics.map(metric =>
-        new Date(metric.timestamp).toLocaleTimeString()
-      ),
-      datasets: [
-        {
-          label: 'Latency (ms)',
-          data: latencyMetrics.map(metric => metric.value),
-          fill: false,
-          borderColor: 'blue',
-        },
-      ],
+    let cancelled = false;
+
+    const poll = async () => {
+      const { metrics: latest, error: fetchError } = await fetchLatencyMetrics();
+      if (cancelled) {
+        return;
+      }
+      setError(fetchError);
+      if (!latest) {
+        return;
+      }
+      setMetrics(latest);
+      const endToEnd = latest.stages.find((stage) => stage.stage === 'end_to_end');
+      const apiToCommit = latest.stages.find((stage) => stage.stage === 'api_to_commit');
+      // Events posted without a gateway trace only have the API-to-commit stage
+      const headline = endToEnd && endToEnd.count > 0 ? endToEnd : apiToCommit;
+      setHistory((current) => current.concat({
+        timestamp: new Date().toISOString(),
+        p50: headline ? headline.p50 : null,
+        p99: headline ? headline.p99 : null,
+        committedPerSecond: latest.throughput.committed.perSecond,
+      }).slice(-MAX_HISTORY_POINTS));
+    };
+
+    poll();
+    const timer = setInterval(poll, POLL_INTERVAL_MS);
+    return () => {
+      cancelled = true;
+      clearInterval(timer);
     };
-  };
+  }, []);
+
+  const now = new Date();
+  const visibleHistory = history.filter(
+    (point) => now - new Date(point.timestamp) <= TIME_RANGES[timeRange]
+  );
+
+  // Trend line of the headline latency percentiles over the selected range
+  const prepareChartData = () => ({
+    labels: visibleHistory.map((point) => new Date(point.timestamp).toLocaleTimeString()),
+    datasets: [
+      {
+        label: 'p50 latency (ms)',
+        data: visibleHistory.map((point) => point.p50),
+        fill: false,
+        borderColor: 'blue',
+      },
+      {
+        label: 'p99 latency (ms)',
+        data: visibleHistory.map((point) => point.p99),
+        fill: false,
+        borderColor: 'red',
+      },
+    ],
+  });
+
+  const measuredStages = metrics ? metrics.stages.filter((stage) => stage.count > 0) : [];
 
   return (
     <div className="performance-metrics-container">
@@ -99,44 +94,57 @@ const PerformanceMetricsTable = () => {
             value={timeRange}
             onChange={(e) => setTimeRange(e.target.value)}
           >
-            <option value="Last 5 min">Last 5 min</option>
-            <option value="Last 1 hr">Last 1 hr</option>
-            <option value="All">All</option>
+            {Object.keys(TIME_RANGES).map((range) => (
+              <option key={range} value={range}>{range}</option>
+            ))}
           </select>
         </div>
       </div>
 
+      {error && <div className="error">Failed to load performance metrics: {error.message}</div>}
+
       <div className="content-area">
+        {metrics && (
+          <div className="throughput-summary">
+            <span>Accepted: {metrics.throughput.accepted.perSecond.toFixed(1)} events/s</span>
+            <span>Committed: {metrics.throughput.committed.perSecond.toFixed(1)} events/s</span>
+            <span>({metrics.throughput.committed.total} committed in total)</span>
+          </div>
+        )}
+
         <table className="metrics-table">
           <thead>
             <tr>
-              <th>Metric Type</th>
-              <th>Value (ms / % / MB)</th>
-              <th>Timestamp</th>
-              <th>Notes</th>
+              <th>Stage</th>
+              <th>Events</th>
+              <th>p50</th>
+              <th>p90</th>
+              <th>p99</th>
+              <th>p99.9</th>
+              <th>Max</th>
             </tr>
           </thead>
           <tbody>
-            {filteredMetrics.length > 0 ? (
-              filteredMetrics.map((metric, index) => (
-                <tr key={index}>
-                  <td>{metric.metricType}</td>
-                  <td>
-                    {metric.value} {metric.unit}
-                  </td>
-                  <td>{new Date(metric.timestamp).toLocaleString()}</td>
-                  <td>{metric.notes}</td>
+            {measuredStages.length > 0 ? (
+              measuredStages.map((stage) => (
+                <tr key={stage.stage} title={stage.description}>
+                  <td>{stage.stage}</td>
+                  <td>{stage.count}</td>
+                  <td>{formatMs(stage.p50)}</td>
+                  <td>{formatMs(stage.p90)}</td>
+                  <td>{formatMs(stage.p99)}</td>
+                  <td>{formatMs(stage['p99.9'])}</td>
+                  <td>{formatMs(stage.maxMs)}</td>
                 </tr>
               ))
             ) : (
               <tr>
-                <td colSpan="4">No metrics available for the selected time range.</td>
+                <td colSpan="7">No latency measured yet.</td>
               </tr>
             )}
           </tbody>
         </table>
 
-        {/* Optional: Trend line chart for Latency */}
         <div className="trend-chart">
           <h3>Latency Trend</h3>
           <Line data={prepareChartData()} />
@@ -146,4 +154,4 @@ const PerformanceMetricsTable = () => {
   );
 };
 
-export default PerformanceMetricsTable;
\ No newline at end of file
+export default PerformanceMetricsTable;
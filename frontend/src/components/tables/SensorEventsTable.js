@@ -1,52 +1,82 @@
 // src/components/tables/SensorEventTable.js
-import React, { useState, useEffect } from 'react';
-import { fetchSensorEvents } from '../../api/api';
+import React, { useState, useEffect, useRef, useDeferredValue } from 'react';
+import { fetchSensorEvents, subscribeSensorEvents } from '../../api/api';
+import SensorEventIndex from './sensorEventIndex';
+import useVirtualRows from './useVirtualRows';
 import './SensorEventTable.css'; // Optional: You can add your custom styles here
 
+// Must match the row height in SensorEventTable.css
+const ROW_HEIGHT = 36;
+
 const SensorEventsTable = () => {
-  const [events, setEvents] = useState([]);
-  const [filteredEvents, setFilteredEvents] = useState([]);
+  // Events live in an index outside React state; re-renders are triggered by its version
+  const indexRef = useRef(null);
+  if (indexRef.current === null) {
+    indexRef.current = new SensorEventIndex();
+  }
+  const index = indexRef.current;
+  const [, setVersion] = useState(0);
   const [deviceFilter, setDeviceFilter] = useState('all');
   const [searchTerm, setSearchTerm] = useState('');
   const [loading, setLoading] = useState(true);
   const [error, setError] = useState(null);
 
-  // Fetch sensor events on component mount
+  // Keystrokes stay responsive while a filter over many events renders
+  const deferredSearchTerm = useDeferredValue(searchTerm);
+
+  // Load the events committed so far, then follow the ones pushed by the
+  // backend as they are committed. Rows are added as each chunk arrives,
+  // with at most one re-render per animation frame.
   useEffect(() => {
-    const getEvents = async () => {
-      const { events, error } = await fetchSensorEvents();
+    let frame = null;
+    const refresh = () => {
+      if (frame === null) {
+        frame = requestAnimationFrame(() => {
+          frame = null;
+          setVersion(index.version);
+        });
+      }
+    };
+    const received = (events) => {
+      index.add(events);
+      setLoading(false);
+      refresh();
+    };
+    const load = async () => {
+      const { error } = await fetchSensorEvents(received);
       if (error) {
         setError(error);
-      } else {
-        setEvents(events);
       }
       setLoading(false);
     };
 
-    getEvents();
-  }, []);
-
-  // Apply filtering by device type and event ID every time events, deviceFilter or searchTerm changes.
-  useEffect(() => {
-    let data = events.slice();
-
-    // Filter by Event ID if search term is provided
-    if (searchTerm.trim() !== '') {
-      data = data.filter(event =>
-        event.eventID.toLowerCase().includes(searchTerm.toLowerCase())
-      );
-    }
-
-    // Filter by Device Type if a specific type is selected
-    if (deviceFilter !== 'all') {
-      data = data.filter(event => event.deviceType === deviceFilter);
-    }
+    // Subscribe first so that nothing committed during the load is missed;
+    // events received twice replace themselves in the index
+    const unsubscribe = subscribeSensorEvents({}, {
+      onEvents: received,
+      onDeleted: (eventIDs) => {
+        index.remove(eventIDs);
+        refresh();
+      },
+      onReset: () => {
+        index.clear();
+        refresh();
+        load();
+      },
+    });
+    load();
 
-    // Sort data by Timestamp (newest first)
-    data.sort((a, b) => new Date(b.timestamp) - new Date(a.timestamp));
+    return () => {
+      unsubscribe();
+      if (frame !== null) {
+        cancelAnimationFrame(frame);
+      }
+    };
+  }, [index]);
 
-    setFilteredEvents(data);
-  }, [events, deviceFilter, searchTerm]);
+  // Oldest first, filtered by device type and event ID; shown newest first
+  const rows = index.filter(deviceFilter, deferredSearchTerm);
+  const { containerRef, onScroll, first, last, padTop, padBottom } = useVirtualRows(rows.length, ROW_HEIGHT);
 
   if (loading) {
     return <div className="loading">Loading sensor event data...</div>;
@@ -56,6 +86,11 @@ const SensorEventsTable = () => {
     return <div className="error">Failed to load sensor events. Please try again later.</div>;
   }
 
+  const visible = [];
+  for (let i = first; i < last; i++) {
+    visible.push(rows[rows.length - 1 - i].event);
+  }
+
   return (
     <div className="sensor-events-container">
       <div className="filters">
@@ -67,11 +102,11 @@ const SensorEventsTable = () => {
             onChange={(e) => setDeviceFilter(e.target.value)}
           >
             <option value="all">All Device Types</option>
-            <option value="CCTV">CCTV</option>
-            <option value="CO2">CO2</option>
-            <option value="Smart Light">Smart Light</option>
-            <option value="Printer">Printer</option>
-            <option value="Card Reader">Card Reader</option>
+            <option value="cctv">CCTV</option>
+            <option value="co2_sensor">CO2</option>
+            <option value="light">Smart Light</option>
+            <option value="printer">Printer</option>
+            <option value="card_reader">Card Reader</option>
           </select>
         </label>
         <label htmlFor="eventSearch">
@@ -84,42 +119,49 @@ const SensorEventsTable = () => {
             onChange={(e) => setSearchTerm(e.target.value)}
           />
         </label>
+        <span className="event-count">{rows.length.toLocaleString()} events</span>
       </div>
 
-      <table className="sensor-events-table">
-        <thead>
-          <tr>
-            <th>Timestamp</th>
-            <th>Device ID</th>
-            <th>Device Type</th>
-            <th>Event Type</th>
-            <th>Event ID</th>
-            <th>Location</th>
-            <th>Blockchain Transaction Status</th>
-          </tr>
-        </thead>
-        <tbody>
-          {filteredEvents.length > 0 ? (
-            filteredEvents.map((event) => (
-              <tr key={event.eventID}>
-                <td>{new Date(event.timestamp).toLocaleString()}</td>
-                <td>{event.deviceID}</td>
-                <td>{event.deviceType}</td>
-                <td>{event.eventType}</td>
-                <td>{event.eventID}</td>
-                <td>{event.location}</td>
-                <td>{event.transactionStatus}</td>
-              </tr>
-            ))
-          ) : (
+      <div className="sensor-events-scroll" ref={containerRef} onScroll={onScroll}>
+        <table className="sensor-events-table">
+          <thead>
             <tr>
-              <td colSpan="7">No sensor events found.</td>
+              <th>Timestamp</th>
+              <th>Device ID</th>
+              <th>Device Type</th>
+              <th>Event Type</th>
+              <th>Event ID</th>
+              <th>Location</th>
+              <th>Blockchain Transaction Status</th>
             </tr>
-          )}
-        </tbody>
-      </table>
+          </thead>
+          <tbody>
+            {rows.length > 0 ? (
+              <>
+                {padTop > 0 && <tr className="spacer" style={{ height: padTop }} aria-hidden="true" />}
+                {visible.map((event) => (
+                  <tr key={event.eventID}>
+                    <td>{new Date(event.timestamp).toLocaleString()}</td>
+                    <td>{event.deviceID}</td>
+                    <td>{event.deviceType}</td>
+                    <td>{event.eventType}</td>
+                    <td>{event.eventID}</td>
+                    <td>{event.location}</td>
+                    <td>{event.transactionStatus}</td>
+                  </tr>
+                ))}
+                {padBottom > 0 && <tr className="spacer" style={{ height: padBottom }} aria-hidden="true" />}
+              </>
+            ) : (
+              <tr>
+                <td colSpan="7">No sensor events found.</td>
+              </tr>
+            )}
+          </tbody>
+        </table>
+      </div>
     </div>
   );
 };
 
-export default SensorEventsTable;
\ No newline at end of file
+export default SensorEventsTable;
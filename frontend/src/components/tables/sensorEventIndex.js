@@ -0,0 +1,109 @@
+// src/components/tables/sensorEventIndex.js
+// Client-side index of the events shown by SensorEventsTable, so a million
+// events can be filtered on every keystroke without copying, re-sorting or
+// re-lowercasing them. Events are kept sorted by time, overall and per
+// device type, each with its event ID lowercased once for the search box.
+
+/**
+ * First position in a time-sorted list whose time is > time.
+ */
+const upperBound = (entries, time) => {
+  let low = 0;
+  let high = entries.length;
+  while (low < high) {
+    const mid = (low + high) >>> 1;
+    if (entries[mid].time <= time) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+};
+
+const insert = (entries, entry) => {
+  // Events mostly arrive in time order: append without searching
+  if (entries.length === 0 || entries[entries.length - 1].time <= entry.time) {
+    entries.push(entry);
+  } else {
+    entries.splice(upperBound(entries, entry.time), 0, entry);
+  }
+};
+
+const remove = (entries, entry) => {
+  const i = entries.lastIndexOf(entry);
+  if (i !== -1) {
+    entries.splice(i, 1);
+  }
+};
+
+export default class SensorEventIndex {
+  constructor() {
+    this.clear();
+  }
+
+  clear() {
+    this.byID = new Map();
+    this.all = [];
+    this.byType = new Map();
+    // Bumped on every change; filter results are cached per version
+    this.version = 0;
+    this.cache = null;
+  }
+
+  /**
+   * Adds events, replacing those already indexed under the same event ID.
+   */
+  add(events) {
+    for (const event of events) {
+      const existing = this.byID.get(event.eventID);
+      if (existing) {
+        remove(this.all, existing);
+        remove(this.byType.get(existing.event.deviceType), existing);
+      }
+      const entry = { time: Date.parse(event.timestamp), key: String(event.eventID).toLowerCase(), event };
+      this.byID.set(event.eventID, entry);
+      insert(this.all, entry);
+      if (!this.byType.has(event.deviceType)) {
+        this.byType.set(event.deviceType, []);
+      }
+      insert(this.byType.get(event.deviceType), entry);
+    }
+    this.version++;
+  }
+
+  remove(eventIDs) {
+    for (const eventID of eventIDs) {
+      const entry = this.byID.get(eventID);
+      if (entry) {
+        this.byID.delete(eventID);
+        remove(this.all, entry);
+        remove(this.byType.get(entry.event.deviceType), entry);
+      }
+    }
+    this.version++;
+  }
+
+  /**
+   * Entries of one device type ('all' for every type) whose event ID
+   * contains the search term, oldest first. Without a term this is the
+   * index's own list, not a copy.
+   *
+   * @returns {Array<{time: number, key: string, event: Object}>}
+   */
+  filter(deviceType, term) {
+    const search = term.trim().toLowerCase();
+    const cache = this.cache;
+    const sameData = cache !== null && cache.version === this.version && cache.deviceType === deviceType;
+    if (sameData && cache.search === search) {
+      return cache.result;
+    }
+    // Typing more of the same term only narrows the previous result
+    const source = sameData && search.startsWith(cache.search)
+      ? cache.result
+      : deviceType === 'all' ? this.all : this.byType.get(deviceType) || [];
+    const result = search === '' ? source : source.filter((entry) => entry.key.includes(search));
+    this.cache = { version: this.version, deviceType, search, result };
+    return result;
+  }
+}
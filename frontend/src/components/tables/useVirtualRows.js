@@ -0,0 +1,53 @@
+// src/components/tables/useVirtualRows.js
+import { useCallback, useRef, useState } from 'react';
+
+// Browsers cap element heights (about 17.9 million px in Firefox), so past
+// this height the scrollbar maps onto the rows proportionally
+const MAX_SCROLL_HEIGHT = 10000000;
+
+/**
+ * Windowing for a scrollable list of fixed-height rows: only the rows in
+ * view (plus overscan rows on each side) are rendered, between two spacers
+ * that give the list its full scroll height.
+ *
+ * @param {number} count - Number of rows.
+ * @param {number} rowHeight - Height of every row in px.
+ * @param {number} [overscan] - Rows rendered beyond each edge of the view.
+ * @returns {{ containerRef: Function, onScroll: Function, first: number, last: number,
+ *   padTop: number, padBottom: number }} Ref and scroll handler for the scroll
+ *   container, rows [first, last) to render and the spacer heights around them.
+ */
+const useVirtualRows = (count, rowHeight, overscan = 10) => {
+  const [scrollTop, setScrollTop] = useState(0);
+  const [height, setHeight] = useState(0);
+  const observerRef = useRef(null);
+
+  const containerRef = useCallback((node) => {
+    if (observerRef.current) {
+      observerRef.current.disconnect();
+      observerRef.current = null;
+    }
+    if (node) {
+      observerRef.current = new ResizeObserver(() => setHeight(node.clientHeight));
+      observerRef.current.observe(node);
+    }
+  }, []);
+
+  const onScroll = useCallback((event) => setScrollTop(event.currentTarget.scrollTop), []);
+
+  const total = count * rowHeight;
+  const physical = Math.min(total, MAX_SCROLL_HEIGHT);
+  const ratio = physical > height ? (total - height) / (physical - height) : 1;
+  const top = Math.min(scrollTop, Math.max(physical - height, 0));
+  const virtualTop = top * ratio;
+
+  const first = Math.max(0, Math.floor(virtualTop / rowHeight) - overscan);
+  const last = Math.min(count, Math.ceil((virtualTop + height) / rowHeight) + overscan);
+  // Rows are placed where they are in view, which is their own offset unless scaled
+  const padTop = Math.max(0, Math.round(top + first * rowHeight - virtualTop));
+  const padBottom = Math.max(0, physical - padTop - (last - first) * rowHeight);
+
+  return { containerRef, onScroll, first, last, padTop, padBottom };
+};
+
+export default useVirtualRows;
@@ -0,0 +1,22 @@
+'use strict';
+
+const {
+    SensorContract,
+    CCTVEventContract,
+    SmartLightContract,
+    CardReaderContract,
+    PrinterEventContract,
+    CO2SensorContract
+} = require('./lib/sensorContracts');
+
+module.exports.SensorContract = SensorContract;
+
+// The first contract is the chaincode's default contract
+module.exports.contracts = [
+    SensorContract,
+    CCTVEventContract,
+    SmartLightContract,
+    CardReaderContract,
+    PrinterEventContract,
+    CO2SensorContract
+];
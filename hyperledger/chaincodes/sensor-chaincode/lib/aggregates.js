@@ -0,0 +1,177 @@
+'use strict';
+
+// Per-device, per-hour aggregates (count, sum, min, max, sum of squares) of the
+// numeric metadata fields flagged `aggregate` in the schemas.
+//
+// Writers never read an aggregate: each transaction writes its contribution
+// to its own delta key, agg~delta (deviceID, field, bucket, txID), whether
+// the hour is still open or not, so concurrent transactions touching the same
+// device and hour cannot collide on MVCC read/write conflicts. Readers merge
+// the compacted total, agg~total (deviceID, field, bucket), with the deltas
+// still outstanding for that bucket.
+//
+// Only CompactAggregates folds deltas into totals, for hours closed
+// (CLOSE_GRACE_MS after their end, by the transaction's timestamp). It reads
+// the total and scans the deltas, so a late event for the hour committed
+// meanwhile invalidates the compaction, never the event; it is meant to be
+// run by a single client, and folds the late deltas on its next run.
+
+const { SCHEMAS } = require('./schemas');
+const { BUCKET_MS, bucketStart } = require('./eventIndex');
+
+const DELTA_INDEX = 'agg~delta';
+const TOTAL_INDEX = 'agg~total';
+// Time after its end before an hour is compacted, for events still in flight
+const CLOSE_GRACE_MS = 5 * 60 * 1000;
+
+const AGGREGATED_FIELDS = {};
+for (const [deviceType, schema] of Object.entries(SCHEMAS)) {
+    AGGREGATED_FIELDS[deviceType] = Object.keys(schema).filter((name) => schema[name].aggregate);
+}
+
+const emptyAggregate = () => ({ count: 0, sum: 0, sumsq: 0, min: null, max: null });
+
+function mergeInto(target, delta) {
+    target.count += delta.count;
+    target.sum += delta.sum;
+    target.sumsq += delta.sumsq;
+    if (delta.min !== null && (target.min === null || delta.min < target.min)) {
+        target.min = delta.min;
+    }
+    if (delta.max !== null && (target.max === null || delta.max > target.max)) {
+        target.max = delta.max;
+    }
+    return target;
+}
+
+// Fixed key order keeps the stored bytes identical on every endorser
+const serializeAggregate = (a) => Buffer.from(
+    `{"count":${a.count},"max":${JSON.stringify(a.max)},"min":${JSON.stringify(a.min)},"sum":${a.sum},"sumsq":${a.sumsq}}`);
+
+/**
+ * Adds (sign 1) or retracts (sign -1) an event's aggregated fields in the
+ * transaction's pending deltas. Retractions cannot narrow min/max, which stay
+ * as bounds of everything ever written to the bucket.
+ */
+function recordEvent(ctx, record, bucket, sign) {
+    const fields = AGGREGATED_FIELDS[record.deviceType];
+    if (!fields || fields.length === 0) {
+        return;
+    }
+    if (!ctx.aggregateDeltas) {
+        ctx.aggregateDeltas = new Map();
+    }
+    for (const field of fields) {
+        const value = record.metadata[field];
+        const attributes = [record.deviceID, field, bucket];
+        const key = attributes.join('\u0000');
+        if (!ctx.aggregateDeltas.has(key)) {
+            ctx.aggregateDeltas.set(key, { attributes, delta: emptyAggregate() });
+        }
+        const { delta } = ctx.aggregateDeltas.get(key);
+        mergeInto(delta, {
+            count: sign,
+            sum: sign * value,
+            sumsq: sign * value * value,
+            min: sign > 0 ? value : null,
+            max: sign > 0 ? value : null
+        });
+    }
+}
+
+function txTime(ctx) {
+    const { seconds, nanos } = ctx.stub.getTxTimestamp();
+    return Number(seconds) * 1000 + Math.floor(nanos / 1e6);
+}
+
+/**
+ * Whether a bucket may be compacted at the given time.
+ */
+function isClosed(bucket, now) {
+    return bucketStart(bucket) + BUCKET_MS + CLOSE_GRACE_MS <= now;
+}
+
+/**
+ * Writes the transaction's pending deltas, one key per (device, field,
+ * bucket), without reading any aggregate state.
+ */
+async function flushDeltas(ctx) {
+    if (!ctx.aggregateDeltas) {
+        return;
+    }
+    const txID = ctx.stub.getTxID();
+    for (const { attributes, delta } of ctx.aggregateDeltas.values()) {
+        const key = ctx.stub.createCompositeKey(DELTA_INDEX, [...attributes, txID]);
+        await ctx.stub.putState(key, serializeAggregate(delta));
+    }
+    ctx.aggregateDeltas = null;
+}
+
+/**
+ * Reads one bucket's aggregate: the compacted total merged with its outstanding deltas.
+ *
+ * @returns {Promise<{aggregate: Object, deltaKeys: Array<String>}>}
+ */
+async function readBucket(ctx, deviceID, field, bucket) {
+    const aggregate = emptyAggregate();
+    const totalJSON = await ctx.stub.getState(ctx.stub.createCompositeKey(TOTAL_INDEX, [deviceID, field, bucket]));
+    if (totalJSON && totalJSON.length > 0) {
+        mergeInto(aggregate, JSON.parse(totalJSON.toString()));
+    }
+    const deltaKeys = [];
+    const iterator = await ctx.stub.getStateByPartialCompositeKey(DELTA_INDEX, [deviceID, field, bucket]);
+    let result = await iterator.next();
+    while (!result.done) {
+        deltaKeys.push(result.value.key);
+        mergeInto(aggregate, JSON.parse(result.value.value.toString('utf8')));
+        result = await iterator.next();
+    }
+    await iterator.close();
+    return { aggregate, deltaKeys };
+}
+
+/**
+ * Folds one bucket's deltas into its total and deletes them.
+ *
+ * @returns {Promise<number>} Number of deltas folded.
+ */
+async function compactBucket(ctx, deviceID, field, bucket) {
+    const { aggregate, deltaKeys } = await readBucket(ctx, deviceID, field, bucket);
+    if (deltaKeys.length === 0) {
+        return 0;
+    }
+    await ctx.stub.putState(ctx.stub.createCompositeKey(TOTAL_INDEX, [deviceID, field, bucket]), serializeAggregate(aggregate));
+    for (const key of deltaKeys) {
+        await ctx.stub.deleteState(key);
+    }
+    return deltaKeys.length;
+}
+
+/**
+ * Public view of an aggregate with derived mean and standard deviation.
+ */
+function summarize(bucket, aggregate) {
+    const { count, sum, sumsq, min, max } = aggregate;
+    const mean = count > 0 ? sum / count : null;
+    const variance = count > 0 ? Math.max(0, sumsq / count - mean * mean) : null;
+    return {
+        bucket,
+        count,
+        sum,
+        min,
+        max,
+        mean,
+        stddev: variance === null ? null : Math.sqrt(variance)
+    };
+}
+
+module.exports = {
+    AGGREGATED_FIELDS,
+    isClosed,
+    txTime,
+    recordEvent,
+    flushDeltas,
+    readBucket,
+    compactBucket,
+    summarize
+};
@@ -0,0 +1,88 @@
+'use strict';
+
+// Anchors of event batches kept off the ledger (the backend's anchor ingest
+// mode). The backend stores the events itself and commits, per batch, the
+// root of a Merkle tree over them with the event count and time range. An
+// event is then verified against the anchored root with an inclusion proof
+// computed by the backend. The chaincode never sees the events.
+//
+// One key per batch, anchor (root). Anchoring the same root again returns the
+// stored anchor, so a retried submit is harmless.
+
+const { parseTimestamp } = require('./eventIndex');
+
+const ANCHOR_INDEX = 'anchor';
+const ANCHOR_DOC_TYPE = 'eventAnchor';
+// Chaincode event set by AnchorBatch; its payload is the stored anchor
+const ANCHOR_EVENT = 'EventsAnchored';
+
+const ROOT_PATTERN = /^[0-9a-f]{64}$/;
+
+/**
+ * Validates a batch submitted for anchoring. Its timestamps are read like
+ * those of events, so every endorser stores the same time range.
+ * @param {Object} batch { root, count, startTime, endTime }.
+ * @returns {{start: number, end: number}} The time range in ms since the epoch.
+ */
+function checkBatch(batch) {
+    if (!batch || typeof batch.root !== 'string' || !ROOT_PATTERN.test(batch.root)) {
+        throw new Error('root must be a lowercase hex SHA-256 hash');
+    }
+    if (!Number.isInteger(batch.count) || batch.count < 1) {
+        throw new Error('count must be a positive integer');
+    }
+    const start = parseTimestamp(batch.startTime);
+    const end = parseTimestamp(batch.endTime);
+    if (Number.isNaN(start) || Number.isNaN(end)) {
+        throw new Error('startTime and endTime must be ISO formatted timestamps');
+    }
+    if (end < start) {
+        throw new Error('endTime must not be earlier than startTime');
+    }
+    return { start, end };
+}
+
+// Fixed key order keeps the stored bytes identical on every endorser
+const serializeAnchor = (a) => Buffer.from(
+    `{"anchoredAt":${JSON.stringify(a.anchoredAt)},"count":${a.count},"docType":"${ANCHOR_DOC_TYPE}",` +
+    `"endTime":${JSON.stringify(a.endTime)},"root":${JSON.stringify(a.root)},` +
+    `"startTime":${JSON.stringify(a.startTime)},"txID":${JSON.stringify(a.txID)}}`);
+
+/**
+ * Stores the anchor of a batch unless its root is already anchored, and sets
+ * the EventsAnchored event. Returns the stored anchor bytes.
+ */
+async function anchorBatch(ctx, batch) {
+    const { start, end } = checkBatch(batch);
+    const key = ctx.stub.createCompositeKey(ANCHOR_INDEX, [batch.root]);
+    const existing = await ctx.stub.getState(key);
+    if (existing && existing.length > 0) {
+        return existing;
+    }
+    const txTime = ctx.stub.getTxTimestamp();
+    const value = serializeAnchor({
+        root: batch.root,
+        count: batch.count,
+        startTime: new Date(start).toISOString(),
+        endTime: new Date(end).toISOString(),
+        anchoredAt: new Date(Number(txTime.seconds) * 1000 + Math.floor(txTime.nanos / 1e6)).toISOString(),
+        txID: ctx.stub.getTxID()
+    });
+    await ctx.stub.putState(key, value);
+    ctx.stub.setEvent(ANCHOR_EVENT, value);
+    return value;
+}
+
+async function readAnchor(ctx, root) {
+    const value = await ctx.stub.getState(ctx.stub.createCompositeKey(ANCHOR_INDEX, [root]));
+    if (!value || value.length === 0) {
+        throw new Error(`No batch with root ${root} is anchored`);
+    }
+    return value;
+}
+
+module.exports = {
+    ANCHOR_EVENT,
+    anchorBatch,
+    readAnchor
+};
@@ -0,0 +1,553 @@
+'use strict';
+
+const { Contract } = require('fabric-contract-api');
+const { DEVICE_TYPES, parseMetadata, isNumericField } = require('./schemas');
+const { serializeEvent } = require('./serializer');
+const aggregates = require('./aggregates');
+const anchors = require('./anchors');
+const {
+    TYPE_INDEX,
+    DEVICE_INDEX,
+    parseTimestamp,
+    timeBucket,
+    parseWindow,
+    parsePageSize,
+    indexEvent,
+    unindexEvent,
+    eventsFromIndex,
+    eventsPageFromIndex
+} = require('./eventIndex');
+const sampleEvents = require('./sampleEvents');
+
+const DOC_TYPE = 'sensorEvent';
+
+// Chaincode event set by every transaction that writes or deletes events, so
+// read models off the ledger (the backend's event store) follow block events
+// instead of querying. Fabric keeps one event per transaction: its payload is
+// {"deleted": [eventID...], "written": [stored record...]}.
+const CHANGE_EVENT = 'SensorEventsChanged';
+
+const REQUIRED_FIELDS = ['eventID', 'deviceType', 'deviceID', 'timestamp', 'eventType', 'location', 'metadata'];
+
+/**
+ * Sensor event contract shared by every device type. Events are validated
+ * against their device type's metadata schema, stored with typed metadata and
+ * indexed by type and by device. A contract either accepts every device type
+ * or is restricted to one (the per-device contracts).
+ */
+class BaseSensorContract extends Contract {
+    /**
+     * @param {String} name Contract name.
+     * @param {String} [deviceType] Device type this contract is restricted to; all types when omitted.
+     */
+    constructor(name, deviceType) {
+        super(name);
+        this.deviceTypes = deviceType ? [deviceType] : DEVICE_TYPES;
+    }
+
+    /**
+     * Initializes the ledger with the sample events of the contract's device types.
+     * @param {Context} ctx The transaction context.
+     */
+    async InitLedger(ctx) {
+        for (const deviceType of this.deviceTypes) {
+            for (const event of sampleEvents[deviceType]) {
+                if (!await this.EventExists(ctx, event.eventID)) {
+                    await this._writeEvent(ctx, this._toRecord(event));
+                }
+            }
+        }
+    }
+
+    /**
+     * CreateSensorEvent records one sensor event given as JSON, as submitted by the backend.
+     * @param {Context} ctx The transaction context.
+     * @param {String} eventJSON Event with eventID, deviceType, deviceID, timestamp, eventType,
+     *   location and metadata (firmware "key:value; key:value" string or object).
+     */
+    async CreateSensorEvent(ctx, eventJSON) {
+        let event;
+        try {
+            event = JSON.parse(eventJSON);
+        } catch (err) {
+            throw new Error(`Invalid event JSON: ${err.message}`);
+        }
+        const record = this._toRecord(event);
+        if (await this.EventExists(ctx, record.eventID)) {
+            throw new Error(`The event ${record.eventID} already exists`);
+        }
+        return (await this._writeEvent(ctx, record)).toString();
+    }
+
+    /**
+     * CreateEvent records one sensor event given as separate arguments.
+     * @param {Context} ctx The transaction context.
+     * @param {String} eventID Unique identifier for the event.
+     * @param {String} deviceType The type of device.
+     * @param {String} deviceID Identifier of the device.
+     * @param {String} timestamp ISO formatted timestamp.
+     * @param {String} eventType The event type.
+     * @param {String} location Where the event occurred.
+     * @param {String} metadata Metadata string, e.g. "co2Level:700; temperature:23".
+     */
+    async CreateEvent(ctx, eventID, deviceType, deviceID, timestamp, eventType, location, metadata) {
+        const record = this._toRecord({ eventID, deviceType, deviceID, timestamp, eventType, location, metadata });
+        if (await this.EventExists(ctx, eventID)) {
+            throw new Error(`The event ${eventID} already exists`);
+        }
+        return (await this._writeEvent(ctx, record)).toString();
+    }
+
+    /**
+     * CreateEvents records a batch of sensor events in a single transaction, so that
+     * endorsement and ordering are paid once for the whole batch.
+     * Events already stored byte for byte (e.g. a retried batch) are skipped.
+     * An event whose eventID is taken by a different event is a conflict: it
+     * is not written and not mistaken for a retry. Events failing validation
+     * are rejected. Neither fails the rest of the batch.
+     * @param {Context} ctx The transaction context.
+     * @param {String} eventsJSON JSON array of events, each shaped as for CreateSensorEvent.
+     */
+    async CreateEvents(ctx, eventsJSON) {
+        let events;
+        try {
+            events = JSON.parse(eventsJSON);
+        } catch (err) {
+            throw new Error(`Invalid events JSON: ${err.message}`);
+        }
+        if (!Array.isArray(events) || events.length === 0) {
+            throw new Error('CreateEvents expects a non-empty JSON array of events');
+        }
+
+        const created = [];
+        const skipped = [];
+        const conflicts = [];
+        const rejected = [];
+        const written = new Map(); // eventID -> bytes written by this batch
+        for (const event of events) {
+            if (!event || !event.eventID) {
+                throw new Error('Every event in the batch must have an eventID');
+            }
+            let record;
+            try {
+                record = this._toRecord(event);
+            } catch (err) {
+                rejected.push({ eventID: event.eventID, error: err.message });
+                continue;
+            }
+
+            const value = serializeEvent(record);
+            const stored = written.get(record.eventID) || await ctx.stub.getState(record.eventID);
+            if (stored && stored.length > 0) {
+                if (Buffer.compare(Buffer.from(stored), value) === 0) {
+                    skipped.push(record.eventID);
+                } else {
+                    conflicts.push({ eventID: record.eventID, error: `The event ${record.eventID} already exists with different content` });
+                }
+                continue;
+            }
+            written.set(record.eventID, await this._writeEvent(ctx, record));
+            created.push(record.eventID);
+        }
+        return JSON.stringify({ created, skipped, conflicts, rejected });
+    }
+
+    /**
+     * ReadEvent retrieves a sensor event from the ledger by eventID.
+     * @param {Context} ctx The transaction context.
+     * @param {String} eventID Unique identifier for the event.
+     */
+    async ReadEvent(ctx, eventID) {
+        const eventJSON = await ctx.stub.getState(eventID);
+        if (!eventJSON || eventJSON.length === 0) {
+            throw new Error(`The event ${eventID} does not exist`);
+        }
+        return eventJSON.toString();
+    }
+
+    /**
+     * UpdateEvent replaces an existing sensor event.
+     * @param {Context} ctx The transaction context.
+     * @param {String} eventID Unique identifier for the event.
+     * @param {String} deviceType The type of device.
+     * @param {String} deviceID Identifier of the device.
+     * @param {String} timestamp ISO formatted timestamp.
+     * @param {String} eventType The event type.
+     * @param {String} location Where the event occurred.
+     * @param {String} metadata Updated metadata string.
+     */
+    async UpdateEvent(ctx, eventID, deviceType, deviceID, timestamp, eventType, location, metadata) {
+        const record = this._toRecord({ eventID, deviceType, deviceID, timestamp, eventType, location, metadata });
+        const exists = await this.EventExists(ctx, eventID);
+        if (!exists) {
+            throw new Error(`The event ${eventID} does not exist`);
+        }
+        await this._unindexEvent(ctx, eventID);
+        return (await this._writeEvent(ctx, record)).toString();
+    }
+
+    /**
+     * DeleteEvent removes a sensor event and its index entries from the ledger.
+     * @param {Context} ctx The transaction context.
+     * @param {String} eventID Unique identifier for the event.
+     */
+    async DeleteEvent(ctx, eventID) {
+        const exists = await this.EventExists(ctx, eventID);
+        if (!exists) {
+            throw new Error(`The event ${eventID} does not exist`);
+        }
+        await this._unindexEvent(ctx, eventID);
+        await ctx.stub.deleteState(eventID);
+        this._recordChange(ctx, eventID, null);
+    }
+
+    /**
+     * EventExists checks whether an event with the given eventID exists in the ledger.
+     * @param {Context} ctx The transaction context.
+     * @param {String} eventID Unique identifier for the event.
+     */
+    async EventExists(ctx, eventID) {
+        const eventJSON = await ctx.stub.getState(eventID);
+        return eventJSON && eventJSON.length > 0;
+    }
+
+    /**
+     * GetAllEvents returns every event of the contract's device types. Prefer
+     * GetEventsPage once the ledger holds more than a few thousand events.
+     * @param {Context} ctx The transaction context.
+     */
+    async GetAllEvents(ctx) {
+        const allResults = [];
+        for (const deviceType of this.deviceTypes) {
+            allResults.push(...await eventsFromIndex(ctx, TYPE_INDEX, [deviceType]));
+        }
+        return JSON.stringify(allResults);
+    }
+
+    /**
+     * GetEventsByType returns the events of one device type, optionally limited to a time window.
+     * @param {Context} ctx The transaction context.
+     * @param {String} deviceType The type of device.
+     * @param {String} [startTime] ISO formatted timestamp, inclusive.
+     * @param {String} [endTime] ISO formatted timestamp, inclusive.
+     */
+    async GetEventsByType(ctx, deviceType, startTime, endTime) {
+        this._checkDeviceType(deviceType);
+        if (!startTime && !endTime) {
+            return JSON.stringify(await eventsFromIndex(ctx, TYPE_INDEX, [deviceType]));
+        }
+        const window = parseWindow(startTime, endTime);
+        const results = [];
+        for (const bucket of window.buckets) {
+            results.push(...await eventsFromIndex(ctx, TYPE_INDEX, [deviceType, bucket], window.contains));
+        }
+        return JSON.stringify(results);
+    }
+
+    /**
+     * GetEventsByDevice returns the events of one device, optionally limited to a
+     * time window. Only index entries under the deviceID are scanned.
+     * @param {Context} ctx The transaction context.
+     * @param {String} deviceID Identifier of the device.
+     * @param {String} [startTime] ISO formatted timestamp, inclusive.
+     * @param {String} [endTime] ISO formatted timestamp, inclusive.
+     */
+    async GetEventsByDevice(ctx, deviceID, startTime, endTime) {
+        const ownType = (record) => this.deviceTypes.includes(record.deviceType);
+        if (!startTime && !endTime) {
+            return JSON.stringify(await eventsFromIndex(ctx, DEVICE_INDEX, [deviceID], ownType));
+        }
+        const window = parseWindow(startTime, endTime);
+        const results = [];
+        for (const bucket of window.buckets) {
+            results.push(...await eventsFromIndex(ctx, DEVICE_INDEX, [deviceID, bucket],
+                (record) => ownType(record) && window.contains(record)));
+        }
+        return JSON.stringify(results);
+    }
+
+    /**
+     * GetEventsByTimeRange returns the events whose timestamp falls within the window,
+     * scanning only the hour buckets it covers.
+     * @param {Context} ctx The transaction context.
+     * @param {String} startTime ISO formatted timestamp, inclusive.
+     * @param {String} endTime ISO formatted timestamp, inclusive.
+     */
+    async GetEventsByTimeRange(ctx, startTime, endTime) {
+        const window = parseWindow(startTime, endTime);
+        const results = [];
+        for (const deviceType of this.deviceTypes) {
+            for (const bucket of window.buckets) {
+                results.push(...await eventsFromIndex(ctx, TYPE_INDEX, [deviceType, bucket], window.contains));
+            }
+        }
+        return JSON.stringify(results);
+    }
+
+    /**
+     * GetEventsPage returns one page of events in index order plus the bookmark
+     * to pass back for the next page (empty once the last page has been read).
+     * Pagination is only available to evaluated (query) transactions.
+     * @param {Context} ctx The transaction context.
+     * @param {String} pageSize Number of events per page, at most MAX_PAGE_SIZE.
+     * @param {String} [bookmark] Bookmark returned with the previous page.
+     */
+    async GetEventsPage(ctx, pageSize, bookmark) {
+        // A single-type contract pages through its own prefix only
+        const attributes = this.deviceTypes.length === 1 ? this.deviceTypes : [];
+        return eventsPageFromIndex(ctx, TYPE_INDEX, attributes, pageSize, bookmark);
+    }
+
+    /**
+     * GetEventsByTypePage returns one page of the events of one device type plus
+     * the bookmark for the next page.
+     * @param {Context} ctx The transaction context.
+     * @param {String} deviceType The type of device.
+     * @param {String} pageSize Number of events per page, at most MAX_PAGE_SIZE.
+     * @param {String} [bookmark] Bookmark returned with the previous page.
+     */
+    async GetEventsByTypePage(ctx, deviceType, pageSize, bookmark) {
+        this._checkDeviceType(deviceType);
+        return eventsPageFromIndex(ctx, TYPE_INDEX, [deviceType], pageSize, bookmark);
+    }
+
+    /**
+     * GetEventsByDevicePage returns one page of the events of one device plus
+     * the bookmark for the next page. As in GetEventsByDevice, only events of
+     * the contract's device types are returned; the page may then hold fewer
+     * than pageSize events without being the last (its bookmark is empty once
+     * it is).
+     * @param {Context} ctx The transaction context.
+     * @param {String} deviceID Identifier of the device.
+     * @param {String} pageSize Number of events per page, at most MAX_PAGE_SIZE.
+     * @param {String} [bookmark] Bookmark returned with the previous page.
+     */
+    async GetEventsByDevicePage(ctx, deviceID, pageSize, bookmark) {
+        return eventsPageFromIndex(ctx, DEVICE_INDEX, [deviceID], pageSize, bookmark,
+            (record) => this.deviceTypes.includes(record.deviceType));
+    }
+
+    /**
+     * GetEventsByMetadataRange returns one page of events of a device type whose
+     * numeric metadata field lies within [min, max], e.g. co2Level above 1000.
+     * Runs as a CouchDB rich query over the typed metadata, so it requires a
+     * CouchDB state database.
+     * @param {Context} ctx The transaction context.
+     * @param {String} deviceType The type of device.
+     * @param {String} field Numeric metadata field from the device type's schema.
+     * @param {String} min Lower bound, inclusive (empty for none).
+     * @param {String} max Upper bound, inclusive (empty for none).
+     * @param {String} pageSize Number of events per page, at most MAX_PAGE_SIZE.
+     * @param {String} [bookmark] Bookmark returned with the previous page.
+     */
+    async GetEventsByMetadataRange(ctx, deviceType, field, min, max, pageSize, bookmark) {
+        this._checkDeviceType(deviceType);
+        if (!isNumericField(deviceType, field)) {
+            throw new Error(`${field} is not a numeric ${deviceType} metadata field`);
+        }
+        const range = {};
+        if (min !== undefined && min !== '') {
+            range.$gte = Number(min);
+        }
+        if (max !== undefined && max !== '') {
+            range.$lte = Number(max);
+        }
+        if (Object.values(range).some(Number.isNaN)) {
+            throw new Error('min and max must be numbers');
+        }
+        const query = {
+            selector: { docType: DOC_TYPE, deviceType, [`metadata.${field}`]: range },
+            use_index: ['_design/indexDeviceTypeDoc', 'indexDeviceType']
+        };
+        const size = parsePageSize(pageSize);
+        const { iterator, metadata } = await ctx.stub.getQueryResultWithPagination(
+            JSON.stringify(query), size, bookmark || '');
+        const records = [];
+        let result = await iterator.next();
+        while (!result.done) {
+            records.push(JSON.parse(result.value.value.toString('utf8')));
+            result = await iterator.next();
+        }
+        await iterator.close();
+        return JSON.stringify({
+            records,
+            fetchedRecordsCount: metadata.fetchedRecordsCount,
+            bookmark: metadata.fetchedRecordsCount < size ? '' : metadata.bookmark
+        });
+    }
+
+    /**
+     * GetAggregates returns the hourly aggregates (count, sum, min, max, mean,
+     * stddev) of one metadata field of a device over a time window, e.g. the
+     * co2Level of a CO₂ sensor or the energyConsumption of a light. Once
+     * CompactAggregates has run, a closed hour costs one read plus its late
+     * events; hours not compacted cost one read per transaction that wrote them.
+     * @param {Context} ctx The transaction context.
+     * @param {String} deviceID Identifier of the device.
+     * @param {String} field Aggregated metadata field.
+     * @param {String} startTime ISO formatted timestamp, inclusive.
+     * @param {String} endTime ISO formatted timestamp, inclusive.
+     */
+    async GetAggregates(ctx, deviceID, field, startTime, endTime) {
+        this._checkAggregatedField(field);
+        const window = parseWindow(startTime, endTime);
+        const results = [];
+        for (const bucket of window.buckets) {
+            const { aggregate } = await aggregates.readBucket(ctx, deviceID, field, bucket);
+            if (aggregate.count !== 0) {
+                results.push(aggregates.summarize(bucket, aggregate));
+            }
+        }
+        return JSON.stringify(results);
+    }
+
+    /**
+     * CompactAggregates folds the outstanding per-transaction deltas of a device's
+     * closed hours within the window into one total per hour. Writers never
+     * fold deltas, so this is the only transaction that does; run it from a
+     * single client, e.g. hourly per device. Hours still open at the
+     * transaction's timestamp are left alone, so compaction does not contend
+     * with events still being written; a late event for a closed hour
+     * invalidates the compaction, not the event.
+     * @param {Context} ctx The transaction context.
+     * @param {String} deviceID Identifier of the device.
+     * @param {String} field Aggregated metadata field.
+     * @param {String} startTime ISO formatted timestamp, inclusive.
+     * @param {String} endTime ISO formatted timestamp, inclusive.
+     */
+    async CompactAggregates(ctx, deviceID, field, startTime, endTime) {
+        this._checkAggregatedField(field);
+        const window = parseWindow(startTime, endTime);
+        const now = aggregates.txTime(ctx);
+        let compacted = 0;
+        for (const bucket of window.buckets) {
+            if (!aggregates.isClosed(bucket, now)) {
+                break;
+            }
+            compacted += await aggregates.compactBucket(ctx, deviceID, field, bucket);
+        }
+        return JSON.stringify({ compacted });
+    }
+
+    /**
+     * AnchorBatch records the Merkle root of a batch of events kept off the
+     * ledger, with their count and time range. Anchoring an already anchored
+     * root returns its existing anchor.
+     * @param {Context} ctx The transaction context.
+     * @param {String} batchJSON Batch with root (hex SHA-256), count, startTime and endTime.
+     */
+    async AnchorBatch(ctx, batchJSON) {
+        let batch;
+        try {
+            batch = JSON.parse(batchJSON);
+        } catch (err) {
+            throw new Error(`Invalid batch JSON: ${err.message}`);
+        }
+        return (await anchors.anchorBatch(ctx, batch)).toString();
+    }
+
+    /**
+     * ReadAnchor returns the anchor of a batch: root, count, time range, and the
+     * transaction and time it was anchored by.
+     * @param {Context} ctx The transaction context.
+     * @param {String} root Merkle root of the batch.
+     */
+    async ReadAnchor(ctx, root) {
+        return (await anchors.readAnchor(ctx, root)).toString();
+    }
+
+    /**
+     * Writes the aggregate deltas gathered while the transaction ran and sets
+     * the transaction's change event.
+     */
+    async afterTransaction(ctx) {
+        await aggregates.flushDeltas(ctx);
+        if (ctx.eventChanges) {
+            const deleted = [];
+            const written = [];
+            for (const [eventID, value] of ctx.eventChanges) {
+                if (value) {
+                    written.push(value.toString());
+                } else {
+                    deleted.push(eventID);
+                }
+            }
+            ctx.stub.setEvent(CHANGE_EVENT, Buffer.from(
+                `{"deleted":${JSON.stringify(deleted)},"written":[${written.join(',')}]}`));
+            ctx.eventChanges = null;
+        }
+    }
+
+    _checkAggregatedField(field) {
+        if (!this.deviceTypes.some((deviceType) => aggregates.AGGREGATED_FIELDS[deviceType].includes(field))) {
+            throw new Error(`${field} is not an aggregated metadata field`);
+        }
+    }
+
+    _checkDeviceType(deviceType) {
+        if (!this.deviceTypes.includes(deviceType)) {
+            throw new Error(`Device type "${deviceType}" is not handled by ${this.getName()}`);
+        }
+    }
+
+    /**
+     * Validates an incoming event and builds the stored record, with metadata
+     * parsed into typed fields.
+     */
+    _toRecord(event) {
+        const missing = REQUIRED_FIELDS.filter((field) => event[field] === undefined || event[field] === null);
+        if (missing.length > 0) {
+            throw new Error(`Missing required fields: ${missing.join(', ')}`);
+        }
+        this._checkDeviceType(event.deviceType);
+        if (Number.isNaN(parseTimestamp(event.timestamp))) {
+            throw new Error(`Invalid timestamp "${event.timestamp}"`);
+        }
+        return {
+            eventID: String(event.eventID),
+            deviceType: event.deviceType,
+            deviceID: String(event.deviceID),
+            timestamp: String(event.timestamp),
+            eventType: String(event.eventType),
+            location: String(event.location),
+            metadata: parseMetadata(event.deviceType, event.metadata),
+            docType: DOC_TYPE
+        };
+    }
+
+    /**
+     * Stores a validated record and its index entries, and adds it to the
+     * transaction's aggregate deltas. Returns the stored bytes.
+     */
+    async _writeEvent(ctx, record) {
+        const value = serializeEvent(record);
+        await ctx.stub.putState(record.eventID, value);
+        await indexEvent(ctx, record);
+        aggregates.recordEvent(ctx, record, timeBucket(record.timestamp), 1);
+        this._recordChange(ctx, record.eventID, value);
+        return value;
+    }
+
+    /**
+     * Notes the last state of an event written (stored bytes) or deleted (null)
+     * by the transaction, for its change event.
+     */
+    _recordChange(ctx, eventID, value) {
+        if (!ctx.eventChanges) {
+            ctx.eventChanges = new Map();
+        }
+        ctx.eventChanges.delete(eventID);
+        ctx.eventChanges.set(eventID, value);
+    }
+
+    /**
+     * Removes a stored event's index entries and retracts it from the aggregates.
+     */
+    async _unindexEvent(ctx, eventID) {
+        const record = JSON.parse((await ctx.stub.getState(eventID)).toString());
+        await unindexEvent(ctx, record);
+        aggregates.recordEvent(ctx, record, timeBucket(record.timestamp), -1);
+    }
+}
+
+module.exports = BaseSensorContract;
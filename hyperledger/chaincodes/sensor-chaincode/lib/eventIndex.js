@@ -0,0 +1,172 @@
+'use strict';
+
+// Secondary indexes of the sensor events. Every event is reachable through two
+// composite keys whose value is a placeholder byte:
+//   type~bucket~id    (deviceType, hour bucket, eventID)
+//   device~bucket~id  (deviceID, hour bucket, eventID)
+// Queries scan only the matching key prefix instead of the whole world state.
+//
+// Buckets are UTC hours. Timestamps are read with parseTimestamp(), never with
+// Date.parse() alone, which takes a date-time without an offset as local time:
+// endorsers in different time zones would then write different keys.
+
+const TYPE_INDEX = 'type~bucket~id';
+const DEVICE_INDEX = 'device~bucket~id';
+const INDEX_VALUE = Buffer.from([0]);
+const BUCKET_MS = 60 * 60 * 1000;
+// Longest time window a single query may span (31 days of hourly buckets).
+const MAX_QUERY_BUCKETS = 24 * 31;
+// Largest page returned by the paginated queries.
+const MAX_PAGE_SIZE = 1000;
+
+const ISO_TIMESTAMP = /^\d{4}-\d{2}-\d{2}(T\d{2}:\d{2}(:\d{2}(\.\d+)?)?(Z|[+-]\d{2}:\d{2})?)?$/;
+
+/**
+ * Milliseconds since the epoch of an ISO 8601 timestamp, or NaN if it is not
+ * one. A date-time without Z or an offset is taken as UTC.
+ */
+function parseTimestamp(timestamp) {
+    const match = ISO_TIMESTAMP.exec(timestamp);
+    if (!match) {
+        return NaN;
+    }
+    return Date.parse(match[1] && !match[4] ? `${timestamp}Z` : timestamp);
+}
+
+/**
+ * Hour bucket of an ISO timestamp, e.g. "2025-03-14T20".
+ */
+function timeBucket(timestamp) {
+    const time = parseTimestamp(timestamp);
+    if (Number.isNaN(time)) {
+        throw new Error(`Invalid timestamp "${timestamp}"`);
+    }
+    return new Date(time).toISOString().slice(0, 13);
+}
+
+/**
+ * Start of an hour bucket in milliseconds since the epoch.
+ */
+function bucketStart(bucket) {
+    return Date.parse(`${bucket}:00:00Z`);
+}
+
+/**
+ * Parses an inclusive [startTime, endTime] window into the hour buckets it covers.
+ */
+function parseWindow(startTime, endTime) {
+    const start = parseTimestamp(startTime);
+    const end = parseTimestamp(endTime);
+    if (Number.isNaN(start) || Number.isNaN(end)) {
+        throw new Error('startTime and endTime must be ISO formatted timestamps');
+    }
+    if (end < start) {
+        throw new Error('endTime must not be earlier than startTime');
+    }
+    const buckets = [];
+    for (let time = start - (start % BUCKET_MS); time <= end; time += BUCKET_MS) {
+        if (buckets.length === MAX_QUERY_BUCKETS) {
+            throw new Error(`Time window spans more than ${MAX_QUERY_BUCKETS} hours`);
+        }
+        buckets.push(new Date(time).toISOString().slice(0, 13));
+    }
+    const contains = (record) => {
+        const time = parseTimestamp(record.timestamp);
+        return time >= start && time <= end;
+    };
+    return { buckets, contains };
+}
+
+function parsePageSize(pageSize) {
+    const size = parseInt(pageSize, 10);
+    if (!Number.isInteger(size) || size <= 0 || size > MAX_PAGE_SIZE) {
+        throw new Error(`pageSize must be between 1 and ${MAX_PAGE_SIZE}`);
+    }
+    return size;
+}
+
+function indexKeys(ctx, record) {
+    const bucket = timeBucket(record.timestamp);
+    return [
+        ctx.stub.createCompositeKey(TYPE_INDEX, [record.deviceType, bucket, record.eventID]),
+        ctx.stub.createCompositeKey(DEVICE_INDEX, [record.deviceID, bucket, record.eventID])
+    ];
+}
+
+async function indexEvent(ctx, record) {
+    for (const key of indexKeys(ctx, record)) {
+        await ctx.stub.putState(key, INDEX_VALUE);
+    }
+}
+
+async function unindexEvent(ctx, record) {
+    for (const key of indexKeys(ctx, record)) {
+        await ctx.stub.deleteState(key);
+    }
+}
+
+/**
+ * Reads the events an index iterator points at, keeping those accepted by
+ * the optional filter, and closes the iterator.
+ */
+async function readIndexed(ctx, iterator, filter) {
+    const records = [];
+    let result = await iterator.next();
+    while (!result.done) {
+        const { attributes: keyParts } = ctx.stub.splitCompositeKey(result.value.key);
+        const eventJSON = await ctx.stub.getState(keyParts[keyParts.length - 1]);
+        if (eventJSON && eventJSON.length > 0) {
+            const record = JSON.parse(eventJSON.toString());
+            if (!filter || filter(record)) {
+                records.push(record);
+            }
+        }
+        result = await iterator.next();
+    }
+    await iterator.close();
+    return records;
+}
+
+/**
+ * Resolves the index entries under a key prefix to their events, keeping those
+ * accepted by the optional filter.
+ */
+async function eventsFromIndex(ctx, indexName, attributes, filter) {
+    const iterator = await ctx.stub.getStateByPartialCompositeKey(indexName, attributes);
+    return readIndexed(ctx, iterator, filter);
+}
+
+/**
+ * One page of the events under a key prefix, as the JSON answer of the
+ * paginated queries, keeping those accepted by the optional filter. Events
+ * filtered out still count towards the page size, so a page may hold fewer
+ * records than asked for without being the last one.
+ */
+async function eventsPageFromIndex(ctx, indexName, attributes, pageSize, bookmark, filter) {
+    const size = parsePageSize(pageSize);
+    const { iterator, metadata } = await ctx.stub.getStateByPartialCompositeKeyWithPagination(
+        indexName, attributes, size, bookmark || '');
+    const records = await readIndexed(ctx, iterator, filter);
+    // A short page means the prefix is exhausted
+    return JSON.stringify({
+        records,
+        fetchedRecordsCount: metadata.fetchedRecordsCount,
+        bookmark: metadata.fetchedRecordsCount < size ? '' : metadata.bookmark
+    });
+}
+
+module.exports = {
+    TYPE_INDEX,
+    DEVICE_INDEX,
+    BUCKET_MS,
+    MAX_PAGE_SIZE,
+    parseTimestamp,
+    timeBucket,
+    bucketStart,
+    parseWindow,
+    parsePageSize,
+    indexEvent,
+    unindexEvent,
+    eventsFromIndex,
+    eventsPageFromIndex
+};
@@ -0,0 +1,150 @@
+'use strict';
+
+// Sample events seeded by InitLedger, per device type.
+module.exports = {
+    cctv: [
+        {
+            eventID: 'cctv_001',
+            deviceType: 'cctv',
+            deviceID: 'cam_101',
+            timestamp: '2025-03-14T11:00:00Z',
+            eventType: 'motion_detected',
+            location: 'Parking Lot A',
+            metadata: 'imageReference:img_202503141100_001.jpg'
+        },
+        {
+            eventID: 'cctv_002',
+            deviceType: 'cctv',
+            deviceID: 'cam_101',
+            timestamp: '2025-03-14T11:02:00Z',
+            eventType: 'motion_detected',
+            location: 'Parking Lot A',
+            metadata: 'imageReference:img_202503141102_002.jpg'
+        },
+        {
+            eventID: 'cctv_003',
+            deviceType: 'cctv',
+            deviceID: 'cam_101',
+            timestamp: '2025-03-14T11:04:00Z',
+            eventType: 'motion_detected',
+            location: 'Parking Lot A',
+            metadata: 'imageReference:img_202503141104_003.jpg'
+        }
+    ],
+    light: [
+        {
+            eventID: 'light_001',
+            deviceType: 'light',
+            deviceID: 'light_05',
+            timestamp: '2025-03-14T18:45:00Z',
+            eventType: 'on',
+            location: 'Building B - Corridor',
+            metadata: 'brightness:75; energyConsumption:5W'
+        },
+        {
+            eventID: 'light_002',
+            deviceType: 'light',
+            deviceID: 'light_05',
+            timestamp: '2025-03-14T18:47:00Z',
+            eventType: 'off',
+            location: 'Building B - Corridor',
+            metadata: 'brightness:65; energyConsumption:4W'
+        },
+        {
+            eventID: 'light_003',
+            deviceType: 'light',
+            deviceID: 'light_05',
+            timestamp: '2025-03-14T18:49:00Z',
+            eventType: 'on',
+            location: 'Building B - Corridor',
+            metadata: 'brightness:80; energyConsumption:6W'
+        }
+    ],
+    card_reader: [
+        {
+            eventID: 'card_001',
+            deviceType: 'card_reader',
+            deviceID: 'reader_01',
+            timestamp: '2025-03-14T10:15:30Z',
+            eventType: 'swipe',
+            location: 'Building A - Main Entrance',
+            metadata: 'userID:user1; cardID:card1'
+        },
+        {
+            eventID: 'card_002',
+            deviceType: 'card_reader',
+            deviceID: 'reader_01',
+            timestamp: '2025-03-14T10:17:30Z',
+            eventType: 'swipe',
+            location: 'Building A - Main Entrance',
+            metadata: 'userID:user2; cardID:card2'
+        },
+        {
+            eventID: 'card_003',
+            deviceType: 'card_reader',
+            deviceID: 'reader_01',
+            timestamp: '2025-03-14T10:19:30Z',
+            eventType: 'swipe',
+            location: 'Building A - Main Entrance',
+            metadata: 'userID:user3; cardID:card3'
+        }
+    ],
+    printer: [
+        {
+            eventID: 'printer_001',
+            deviceType: 'printer',
+            deviceID: 'printer_1',
+            timestamp: '2025-03-14T09:30:00Z',
+            eventType: 'completed',
+            location: 'Library',
+            metadata: 'jobID:job_001; pagesPrinted:5; userID:student1'
+        },
+        {
+            eventID: 'printer_002',
+            deviceType: 'printer',
+            deviceID: 'printer_1',
+            timestamp: '2025-03-14T09:32:00Z',
+            eventType: 'completed',
+            location: 'Library',
+            metadata: 'jobID:job_002; pagesPrinted:12; userID:student2'
+        },
+        {
+            eventID: 'printer_003',
+            deviceType: 'printer',
+            deviceID: 'printer_1',
+            timestamp: '2025-03-14T09:34:00Z',
+            eventType: 'completed',
+            location: 'Library',
+            metadata: 'jobID:job_003; pagesPrinted:7; userID:student3'
+        }
+    ],
+    co2_sensor: [
+        {
+            eventID: 'sensor_001',
+            deviceType: 'co2_sensor',
+            deviceID: 'sensor_03',
+            timestamp: '2025-03-14T20:00:00Z',
+            eventType: 'reading',
+            location: 'Building C - Lab',
+            metadata: 'co2Level:500; temperature:20'
+        },
+        {
+            eventID: 'sensor_002',
+            deviceType: 'co2_sensor',
+            deviceID: 'sensor_03',
+            timestamp: '2025-03-14T20:02:00Z',
+            eventType: 'reading',
+            location: 'Building C - Lab',
+            metadata: 'co2Level:650; temperature:22'
+        },
+        {
+            eventID: 'sensor_003',
+            deviceType: 'co2_sensor',
+            deviceID: 'sensor_03',
+            timestamp: '2025-03-14T20:04:00Z',
+            eventType: 'reading',
+            location: 'Building C - Lab',
+            metadata: 'co2Level:800; temperature:21'
+        }
+    ]
+};
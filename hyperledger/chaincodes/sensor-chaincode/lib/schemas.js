@@ -0,0 +1,130 @@
+'use strict';
+
+// Metadata schema per device type. The firmwares send metadata as a
+// "key:value; key:value" string; it is parsed and validated here once, at
+// write time, and stored as typed fields so numeric values can be compared
+// and range-queried on the ledger.
+//   type  'integer' | 'number' | 'string'
+//   unit  suffix accepted (and dropped) after a numeric value, e.g. "5W"
+//   min/max  inclusive bounds for numeric fields
+//   aggregate  keep per-device hourly aggregates of the field (see aggregates.js)
+const SCHEMAS = {
+    cctv: {
+        imageReference: { type: 'string' }
+    },
+    light: {
+        brightness: { type: 'integer', min: 0, max: 100 },
+        energyConsumption: { type: 'number', min: 0, unit: 'W', aggregate: true }
+    },
+    card_reader: {
+        userID: { type: 'string' },
+        cardID: { type: 'string' }
+    },
+    printer: {
+        jobID: { type: 'string' },
+        pagesPrinted: { type: 'integer', min: 0 },
+        userID: { type: 'string' }
+    },
+    co2_sensor: {
+        co2Level: { type: 'integer', min: 0, max: 10000, aggregate: true },
+        temperature: { type: 'number', min: -40, max: 125, aggregate: true }
+    }
+};
+
+const DEVICE_TYPES = Object.keys(SCHEMAS);
+
+/**
+ * Splits a "key:value; key:value" metadata string into raw string values.
+ */
+function splitMetadata(metadata) {
+    const raw = {};
+    for (const pair of metadata.split(';')) {
+        if (pair.trim() === '') {
+            continue;
+        }
+        const separator = pair.indexOf(':');
+        if (separator === -1) {
+            throw new Error(`Malformed metadata entry "${pair.trim()}"`);
+        }
+        raw[pair.slice(0, separator).trim()] = pair.slice(separator + 1).trim();
+    }
+    return raw;
+}
+
+function parseField(deviceType, name, spec, value) {
+    if (spec.type === 'string') {
+        if (typeof value !== 'string' && typeof value !== 'number') {
+            throw new Error(`${deviceType} metadata field ${name} must be a string`);
+        }
+        return String(value);
+    }
+
+    let text = String(value).trim();
+    if (spec.unit && text.endsWith(spec.unit)) {
+        text = text.slice(0, -spec.unit.length).trim();
+    }
+    const number = Number(text);
+    if (text === '' || !Number.isFinite(number)) {
+        throw new Error(`${deviceType} metadata field ${name} must be a number, got "${value}"`);
+    }
+    if (spec.type === 'integer' && !Number.isInteger(number)) {
+        throw new Error(`${deviceType} metadata field ${name} must be an integer, got "${value}"`);
+    }
+    if ((spec.min !== undefined && number < spec.min) || (spec.max !== undefined && number > spec.max)) {
+        throw new Error(`${deviceType} metadata field ${name} is out of range: ${number}`);
+    }
+    return number;
+}
+
+/**
+ * Parses and validates event metadata against the schema of its device type.
+ * Accepts the firmware string form or an already structured object.
+ * Every schema field is required and unknown fields are rejected.
+ *
+ * @param {String} deviceType Device type of the event.
+ * @param {String|Object} metadata Raw metadata.
+ * @returns {Object} Typed metadata fields.
+ */
+function parseMetadata(deviceType, metadata) {
+    const schema = SCHEMAS[deviceType];
+    if (!schema) {
+        throw new Error(`Unknown device type "${deviceType}"`);
+    }
+    let raw;
+    if (typeof metadata === 'string') {
+        raw = splitMetadata(metadata);
+    } else if (metadata && typeof metadata === 'object' && !Array.isArray(metadata)) {
+        raw = metadata;
+    } else {
+        throw new Error(`Metadata of a ${deviceType} event must be a string or an object`);
+    }
+
+    for (const name of Object.keys(raw)) {
+        if (!schema[name]) {
+            throw new Error(`Unknown ${deviceType} metadata field "${name}"`);
+        }
+    }
+    const typed = {};
+    for (const [name, spec] of Object.entries(schema)) {
+        if (raw[name] === undefined || raw[name] === null) {
+            throw new Error(`Missing ${deviceType} metadata field "${name}"`);
+        }
+        typed[name] = parseField(deviceType, name, spec, raw[name]);
+    }
+    return typed;
+}
+
+/**
+ * True when the field exists in the device type's schema and is numeric.
+ */
+function isNumericField(deviceType, name) {
+    const spec = SCHEMAS[deviceType] && SCHEMAS[deviceType][name];
+    return Boolean(spec) && spec.type !== 'string';
+}
+
+module.exports = {
+    SCHEMAS,
+    DEVICE_TYPES,
+    parseMetadata,
+    isNumericField
+};
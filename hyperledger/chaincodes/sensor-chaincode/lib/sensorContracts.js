@@ -0,0 +1,70 @@
+'use strict';
+
+const BaseSensorContract = require('./baseSensorContract');
+
+/**
+ * Generic sensor contract: accepts events of every device type. This is the
+ * default contract of the chaincode and the one the backend submits to.
+ */
+class SensorContract extends BaseSensorContract {
+    constructor() {
+        super('SensorContract');
+    }
+}
+
+// Per-device contracts, kept so clients of the former one-chaincode-per-device
+// deployments can keep calling the same transactions by contract name.
+
+class CCTVEventContract extends BaseSensorContract {
+    constructor() {
+        super('CCTVEventContract', 'cctv');
+    }
+}
+
+class SmartLightContract extends BaseSensorContract {
+    constructor() {
+        super('SmartLightContract', 'light');
+    }
+}
+
+class CardReaderContract extends BaseSensorContract {
+    constructor() {
+        super('CardReaderContract', 'card_reader');
+    }
+
+    /**
+     * RecordEvent is the card reader's historical name for CreateEvent.
+     * @param {Context} ctx The transaction context.
+     * @param {String} eventID Unique identifier for the event (e.g., "card_004").
+     * @param {String} deviceType The type of device (should be "card_reader").
+     * @param {String} deviceID Identifier of the card reader.
+     * @param {String} timestamp ISO formatted timestamp.
+     * @param {String} eventType The event type (e.g., "swipe").
+     * @param {String} location Where the swipe happened.
+     * @param {String} metadata Metadata string (e.g., "userID:user4; cardID:card4").
+     */
+    async RecordEvent(ctx, eventID, deviceType, deviceID, timestamp, eventType, location, metadata) {
+        return this.CreateEvent(ctx, eventID, deviceType, deviceID, timestamp, eventType, location, metadata);
+    }
+}
+
+class PrinterEventContract extends BaseSensorContract {
+    constructor() {
+        super('PrinterEventContract', 'printer');
+    }
+}
+
+class CO2SensorContract extends BaseSensorContract {
+    constructor() {
+        super('CO2SensorContract', 'co2_sensor');
+    }
+}
+
+module.exports = {
+    SensorContract,
+    CCTVEventContract,
+    SmartLightContract,
+    CardReaderContract,
+    PrinterEventContract,
+    CO2SensorContract
+};
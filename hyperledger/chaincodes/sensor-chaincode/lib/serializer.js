@@ -0,0 +1,51 @@
+'use strict';
+
+// Deterministic serializers, compiled once per device type when the chaincode
+// loads. Every stored event has a fixed shape, so the key order is decided up
+// front and a write is a single pass of string concatenation rather than a
+// recursive key sort plus a generic stringify. Output is byte-identical to
+// stringify(sortKeysRecursive(record)) for the same record.
+
+const { SCHEMAS } = require('./schemas');
+
+const RECORD_FIELDS = ['eventID', 'deviceType', 'deviceID', 'timestamp', 'eventType', 'location', 'metadata', 'docType'];
+
+const scalar = (value) => JSON.stringify(value);
+
+/**
+ * Builds a serializer for objects with exactly the given fields.
+ * @param {Array<[String, Function]>} fields Field names with their value serializers.
+ */
+function compileObjectSerializer(fields) {
+    const sorted = fields.slice().sort(([a], [b]) => (a < b ? -1 : a > b ? 1 : 0));
+    const names = sorted.map(([name]) => name);
+    const writers = sorted.map(([, write]) => write);
+    const prefixes = names.map((name, i) => `${i === 0 ? '{' : ','}${JSON.stringify(name)}:`);
+    return (object) => {
+        let out = '';
+        for (let i = 0; i < names.length; i++) {
+            out += prefixes[i] + writers[i](object[names[i]]);
+        }
+        return `${out}}`;
+    };
+}
+
+const serializers = {};
+for (const [deviceType, schema] of Object.entries(SCHEMAS)) {
+    const metadata = compileObjectSerializer(Object.keys(schema).map((name) => [name, scalar]));
+    serializers[deviceType] = compileObjectSerializer(
+        RECORD_FIELDS.map((name) => [name, name === 'metadata' ? metadata : scalar]));
+}
+
+/**
+ * Serializes a validated event record (typed metadata included) to the bytes
+ * stored in the world state.
+ */
+function serializeEvent(record) {
+    return Buffer.from(serializers[record.deviceType](record));
+}
+
+module.exports = {
+    RECORD_FIELDS,
+    serializeEvent
+};
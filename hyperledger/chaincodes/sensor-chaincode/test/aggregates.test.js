@@ -0,0 +1,127 @@
+'use strict';
+
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const { SensorContract } = require('..');
+const MemoryLedger = require('./memoryLedger');
+
+// The ledger's clock is 2025-03-15T00:00:00Z: hour 20 of the 14th is closed,
+// hour 23 is still within its grace period
+const CLOSED = '2025-03-14T20';
+const OPEN = '2025-03-14T23';
+
+let counter = 0;
+const reading = (co2Level, timestamp) => ({
+    eventID: `sensor_03_7_${String(++counter).padStart(3, '0')}`,
+    deviceType: 'co2_sensor',
+    deviceID: 'sensor_03',
+    timestamp,
+    eventType: 'reading',
+    location: 'Building C - Lab',
+    metadata: `co2Level:${co2Level}; temperature:21`
+});
+
+/**
+ * Runs a transaction function up to, not including, its commit, so several
+ * can be endorsed against the same state before any commits.
+ */
+const endorse = async (ledger, contract, name, ...args) => {
+    const ctx = ledger.begin();
+    const result = await contract[name](ctx, ...args);
+    await contract.afterTransaction(ctx, result);
+    return { ctx, result };
+};
+
+const createEvents = (ledger, contract, events) =>
+    ledger.submit(contract, 'CreateEvents', JSON.stringify(events));
+
+const getAggregates = async (ledger, contract, bucket) =>
+    JSON.parse(await ledger.evaluate(contract, 'GetAggregates', 'sensor_03', 'co2Level',
+        `${bucket}:00:00Z`, `${bucket}:59:59Z`));
+
+const compact = async (ledger, contract) =>
+    JSON.parse(await ledger.submit(contract, 'CompactAggregates', 'sensor_03', 'co2Level',
+        '2025-03-14T00:00:00Z', '2025-03-14T23:59:59Z'));
+
+const aggregateKeys = (ctx) => [...ctx.tx.reads, ...ctx.tx.ranges].filter((key) => key.includes('agg~'));
+
+test('writers of the same device and hour do not conflict', async () => {
+    const ledger = new MemoryLedger();
+    const contract = new SensorContract();
+    for (const bucket of [OPEN, CLOSED]) {
+        const first = await endorse(ledger, contract, 'CreateEvents',
+            JSON.stringify([reading(700, `${bucket}:10:00Z`)]));
+        const second = await endorse(ledger, contract, 'CreateEvents',
+            JSON.stringify([reading(900, `${bucket}:20:00Z`), reading(800, `${bucket}:30:00Z`)]));
+        // Late events for a closed hour are written as deltas too, without reading the total
+        assert.deepEqual(aggregateKeys(first.ctx), []);
+        assert.deepEqual(aggregateKeys(second.ctx), []);
+        ledger.commit(first.ctx);
+        ledger.commit(second.ctx);
+
+        assert.equal(ledger.entries('agg~delta', ['sensor_03', 'co2Level', bucket]).length, 2);
+        const [aggregate] = await getAggregates(ledger, contract, bucket);
+        assert.equal(aggregate.count, 3);
+        assert.equal(aggregate.sum, 2400);
+        assert.equal(aggregate.min, 700);
+        assert.equal(aggregate.max, 900);
+        assert.equal(aggregate.mean, 800);
+    }
+    assert.deepEqual(ledger.entries('agg~total'), []);
+});
+
+test('CompactAggregates folds the deltas of closed hours only', async () => {
+    const ledger = new MemoryLedger();
+    const contract = new SensorContract();
+    await createEvents(ledger, contract, [reading(700, `${CLOSED}:10:00Z`), reading(650, `${OPEN}:10:00Z`)]);
+    await createEvents(ledger, contract, [reading(900, `${CLOSED}:20:00Z`), reading(750, `${OPEN}:20:00Z`)]);
+    const before = await getAggregates(ledger, contract, CLOSED);
+
+    assert.deepEqual(await compact(ledger, contract), { compacted: 2 });
+    assert.deepEqual(ledger.entries('agg~delta', ['sensor_03', 'co2Level', CLOSED]), []);
+    assert.equal(ledger.entries('agg~total', ['sensor_03', 'co2Level', CLOSED]).length, 1);
+    assert.deepEqual(await getAggregates(ledger, contract, CLOSED), before);
+    // The open hour keeps its deltas
+    assert.equal(ledger.entries('agg~delta', ['sensor_03', 'co2Level', OPEN]).length, 2);
+    assert.deepEqual(ledger.entries('agg~total', ['sensor_03', 'co2Level', OPEN]), []);
+
+    // A late event after compaction is merged on read, and folded by the next run
+    await createEvents(ledger, contract, [reading(500, `${CLOSED}:30:00Z`)]);
+    assert.equal((await getAggregates(ledger, contract, CLOSED))[0].count, 3);
+    assert.deepEqual(await compact(ledger, contract), { compacted: 1 });
+    const [aggregate] = await getAggregates(ledger, contract, CLOSED);
+    assert.equal(aggregate.count, 3);
+    assert.equal(aggregate.min, 500);
+    assert.deepEqual(await compact(ledger, contract), { compacted: 0 });
+});
+
+test('a late event invalidates a concurrent compaction, not itself', async () => {
+    const ledger = new MemoryLedger();
+    const contract = new SensorContract();
+    await createEvents(ledger, contract, [reading(700, `${CLOSED}:10:00Z`)]);
+
+    const compaction = await endorse(ledger, contract, 'CompactAggregates', 'sensor_03', 'co2Level',
+        `${CLOSED}:00:00Z`, `${CLOSED}:59:59Z`);
+    const late = await endorse(ledger, contract, 'CreateEvents', JSON.stringify([reading(900, `${CLOSED}:40:00Z`)]));
+    ledger.commit(late.ctx);
+    assert.throws(() => ledger.commit(compaction.ctx), /PHANTOM_READ_CONFLICT/);
+
+    assert.deepEqual(await compact(ledger, contract), { compacted: 2 });
+    assert.equal((await getAggregates(ledger, contract, CLOSED))[0].sum, 1600);
+});
+
+test('deleting an event retracts its count and sum', async () => {
+    const ledger = new MemoryLedger();
+    const contract = new SensorContract();
+    const kept = reading(700, `${CLOSED}:10:00Z`);
+    const deleted = reading(900, `${CLOSED}:20:00Z`);
+    await createEvents(ledger, contract, [kept, deleted]);
+    await compact(ledger, contract);
+    await ledger.submit(contract, 'DeleteEvent', deleted.eventID);
+
+    const [aggregate] = await getAggregates(ledger, contract, CLOSED);
+    assert.equal(aggregate.count, 1);
+    assert.equal(aggregate.sum, 700);
+    // min and max stay bounds of everything written
+    assert.equal(aggregate.max, 900);
+});
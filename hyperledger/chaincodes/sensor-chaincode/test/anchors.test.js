@@ -0,0 +1,39 @@
+'use strict';
+
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const { SensorContract } = require('..');
+const MemoryLedger = require('./memoryLedger');
+
+const ROOT = 'ab'.repeat(32);
+
+const anchor = async (ledger, contract, batch) =>
+    JSON.parse(await ledger.submit(contract, 'AnchorBatch', JSON.stringify({ root: ROOT, count: 3, ...batch })));
+
+test('AnchorBatch reads timestamps without an offset as UTC', async () => {
+    const ledger = new MemoryLedger();
+    const contract = new SensorContract();
+    const stored = await anchor(ledger, contract, { startTime: '2025-03-14T20:10:00', endTime: '2025-03-14T22:20:00+02:00' });
+    assert.equal(stored.startTime, '2025-03-14T20:10:00.000Z');
+    assert.equal(stored.endTime, '2025-03-14T20:20:00.000Z');
+    assert.equal(stored.anchoredAt, '2025-03-15T00:00:00.000Z');
+    assert.equal(ledger.events.length, 1);
+
+    // A retried submit returns the anchor already stored
+    const retried = await anchor(ledger, contract, { startTime: '2025-03-14T20:10:00Z', endTime: '2025-03-14T20:20:00Z' });
+    assert.deepEqual(retried, stored);
+    assert.deepEqual(JSON.parse(await ledger.evaluate(contract, 'ReadAnchor', ROOT)), stored);
+});
+
+test('AnchorBatch rejects timestamps Date.parse would guess at', async () => {
+    const ledger = new MemoryLedger();
+    const contract = new SensorContract();
+    for (const startTime of ['March 14, 2025 20:10', '2025-03-14 20:10:00', undefined]) {
+        await assert.rejects(anchor(ledger, contract, { startTime, endTime: '2025-03-14T20:20:00Z' }),
+            /startTime and endTime must be ISO formatted timestamps/);
+    }
+    await assert.rejects(anchor(ledger, contract, { startTime: '2025-03-14T20:30:00Z', endTime: '2025-03-14T20:20:00Z' }),
+        /endTime must not be earlier than startTime/);
+    await assert.rejects(anchor(ledger, contract, { root: 'AB'.repeat(32), startTime: '2025-03-14T20:10:00Z', endTime: '2025-03-14T20:20:00Z' }),
+        /lowercase hex/);
+});
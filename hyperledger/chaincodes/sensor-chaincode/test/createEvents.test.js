@@ -0,0 +1,62 @@
+'use strict';
+
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const { SensorContract } = require('..');
+const MemoryLedger = require('./memoryLedger');
+
+const reading = (eventID, co2Level, timestamp = '2025-03-14T20:10:00Z') => ({
+    eventID,
+    deviceType: 'co2_sensor',
+    deviceID: 'sensor_03',
+    timestamp,
+    eventType: 'reading',
+    location: 'Building C - Lab',
+    metadata: `co2Level:${co2Level}; temperature:21`
+});
+
+const createEvents = async (ledger, contract, events) =>
+    JSON.parse(await ledger.submit(contract, 'CreateEvents', JSON.stringify(events)));
+
+test('CreateEvents writes new events and skips identical retries', async () => {
+    const ledger = new MemoryLedger();
+    const contract = new SensorContract();
+    const batch = [reading('sensor_03_7_001', 700), reading('sensor_03_7_002', 710)];
+
+    assert.deepEqual(await createEvents(ledger, contract, batch),
+        { created: ['sensor_03_7_001', 'sensor_03_7_002'], skipped: [], conflicts: [], rejected: [] });
+    // A retried batch, with its keys in another order
+    const retried = batch.map(({ metadata, ...rest }) => ({ metadata, ...rest }));
+    assert.deepEqual(await createEvents(ledger, contract, retried),
+        { created: [], skipped: ['sensor_03_7_001', 'sensor_03_7_002'], conflicts: [], rejected: [] });
+});
+
+test('CreateEvents reports a different event reusing an eventID as a conflict', async () => {
+    const ledger = new MemoryLedger();
+    const contract = new SensorContract();
+    await createEvents(ledger, contract, [reading('sensor_001', 700)]);
+
+    const result = await createEvents(ledger, contract, [
+        reading('sensor_001', 900),
+        reading('sensor_002', 720),
+        reading('sensor_002', 730)
+    ]);
+    assert.deepEqual(result.created, ['sensor_002']);
+    assert.deepEqual(result.skipped, []);
+    assert.deepEqual(result.conflicts.map(({ eventID }) => eventID), ['sensor_001', 'sensor_002']);
+    assert.match(result.conflicts[0].error, /already exists with different content/);
+    // The first event of each eventID is the one kept
+    assert.match(await ledger.evaluate(contract, 'ReadEvent', 'sensor_001'), /"co2Level":700/);
+    assert.match(await ledger.evaluate(contract, 'ReadEvent', 'sensor_002'), /"co2Level":720/);
+});
+
+test('CreateEvents rejects invalid events without failing the batch', async () => {
+    const ledger = new MemoryLedger();
+    const contract = new SensorContract();
+    const result = await createEvents(ledger, contract, [
+        reading('bad', 700, 'yesterday'),
+        reading('good', 700)
+    ]);
+    assert.deepEqual(result.created, ['good']);
+    assert.deepEqual(result.rejected, [{ eventID: 'bad', error: 'Invalid timestamp "yesterday"' }]);
+});
@@ -0,0 +1,90 @@
+'use strict';
+
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const { SensorContract } = require('..');
+const { parseTimestamp, timeBucket, parseWindow } = require('../lib/eventIndex');
+const MemoryLedger = require('./memoryLedger');
+
+const event = (eventID, deviceType, deviceID, timestamp) => ({
+    eventID,
+    deviceType,
+    deviceID,
+    timestamp,
+    eventType: 'reading',
+    location: 'Building C - Lab',
+    metadata: deviceType === 'co2_sensor' ? 'co2Level:700; temperature:21' : 'brightness:80; energyConsumption:12.5'
+});
+
+test('timestamps without an offset are UTC', () => {
+    assert.equal(parseTimestamp('2025-03-14T20:10:00'), Date.parse('2025-03-14T20:10:00Z'));
+    assert.equal(parseTimestamp('2025-03-14T20:10'), Date.parse('2025-03-14T20:10:00Z'));
+    assert.equal(parseTimestamp('2025-03-14T22:10:00+02:00'), Date.parse('2025-03-14T20:10:00Z'));
+    assert.equal(parseTimestamp('2025-03-14'), Date.parse('2025-03-14T00:00:00Z'));
+    for (const invalid of ['yesterday', '14/03/2025', '2025-03-14 20:10:00', '', undefined]) {
+        assert.ok(Number.isNaN(parseTimestamp(invalid)), String(invalid));
+    }
+    assert.equal(timeBucket('2025-03-14T22:10:00+02:00'), '2025-03-14T20');
+    assert.throws(() => timeBucket('yesterday'), /Invalid timestamp "yesterday"/);
+});
+
+test('a window covers the hours it touches, and is bounded', () => {
+    const window = parseWindow('2025-03-14T20:30:00Z', '2025-03-14T22:00:00Z');
+    assert.deepEqual(window.buckets, ['2025-03-14T20', '2025-03-14T21', '2025-03-14T22']);
+    assert.equal(window.contains({ timestamp: '2025-03-14T20:29:59Z' }), false);
+    assert.equal(window.contains({ timestamp: '2025-03-14T22:00:00' }), true);
+    assert.throws(() => parseWindow('2025-03-14T22:00:00Z', '2025-03-14T20:00:00Z'), /earlier than startTime/);
+    assert.throws(() => parseWindow('2025-01-01T00:00:00Z', '2025-03-01T00:00:00Z'), /more than 744 hours/);
+    assert.throws(() => parseWindow('2025-03-14', 'tomorrow'), /ISO formatted/);
+});
+
+test('queries by device and type scan only their index', async () => {
+    const ledger = new MemoryLedger();
+    const contract = new SensorContract();
+    await ledger.submit(contract, 'CreateEvents', JSON.stringify([
+        event('sensor_03_7_001', 'co2_sensor', 'sensor_03', '2025-03-14T20:10:00Z'),
+        event('sensor_03_7_002', 'co2_sensor', 'sensor_03', '2025-03-14T21:10:00Z'),
+        event('sensor_04_9_001', 'co2_sensor', 'sensor_04', '2025-03-14T20:20:00Z'),
+        event('light_01_2_001', 'light', 'light_01', '2025-03-14T20:30:00Z')
+    ]));
+    const ids = (json) => JSON.parse(json).map((record) => record.eventID);
+
+    assert.deepEqual(ids(await ledger.evaluate(contract, 'GetEventsByDevice', 'sensor_03')),
+        ['sensor_03_7_001', 'sensor_03_7_002']);
+    assert.deepEqual(ids(await ledger.evaluate(contract, 'GetEventsByDevice', 'sensor_03',
+        '2025-03-14T21:00:00Z', '2025-03-14T21:59:59Z')), ['sensor_03_7_002']);
+    assert.deepEqual(ids(await ledger.evaluate(contract, 'GetEventsByType', 'light')), ['light_01_2_001']);
+    assert.deepEqual(ids(await ledger.evaluate(contract, 'GetEventsByTimeRange',
+        '2025-03-14T20:15:00Z', '2025-03-14T20:59:59Z')).sort(), ['light_01_2_001', 'sensor_04_9_001']);
+
+    // Updating an event's timestamp moves its index entries
+    await ledger.submit(contract, 'UpdateEvent', 'sensor_03_7_001', 'co2_sensor', 'sensor_03',
+        '2025-03-14T22:10:00Z', 'reading', 'Building C - Lab', 'co2Level:710; temperature:21');
+    assert.deepEqual(ids(await ledger.evaluate(contract, 'GetEventsByDevice', 'sensor_03',
+        '2025-03-14T20:00:00Z', '2025-03-14T20:59:59Z')), []);
+    await ledger.submit(contract, 'DeleteEvent', 'sensor_03_7_002');
+    assert.deepEqual(ids(await ledger.evaluate(contract, 'GetEventsByDevice', 'sensor_03')), ['sensor_03_7_001']);
+    assert.equal(ledger.entries('device~bucket~id', ['sensor_03']).length, 1);
+});
+
+test('pages end with an empty bookmark', async () => {
+    const ledger = new MemoryLedger();
+    const contract = new SensorContract();
+    const events = [1, 2, 3, 4, 5].map((n) =>
+        event(`sensor_03_7_00${n}`, 'co2_sensor', 'sensor_03', `2025-03-14T20:0${n}:00Z`));
+    await ledger.submit(contract, 'CreateEvents', JSON.stringify(events));
+
+    const seen = [];
+    let bookmark = '';
+    let pages = 0;
+    do {
+        const page = JSON.parse(await ledger.evaluate(contract, 'GetEventsByDevicePage', 'sensor_03', '2', bookmark));
+        seen.push(...page.records.map((record) => record.eventID));
+        bookmark = page.bookmark;
+        pages++;
+    } while (bookmark);
+    assert.equal(pages, 3);
+    assert.deepEqual(seen, events.map((record) => record.eventID));
+    await assert.rejects(ledger.evaluate(contract, 'GetEventsByDevicePage', 'sensor_03', '1001', ''),
+        /pageSize must be between 1 and 1000/);
+});
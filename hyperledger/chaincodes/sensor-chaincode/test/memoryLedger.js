@@ -0,0 +1,167 @@
+'use strict';
+
+// In-memory stand-in for the peer, for the unit tests: each transaction gets
+// a ctx whose stub reads the committed world state (not its own writes, as
+// on a peer) and buffers its writes until commit(). commit() validates the
+// transaction like the peer does, failing with MVCC_READ_CONFLICT when a key
+// it read, or a key in a range it scanned, was changed by a transaction
+// committed since it began. Only the stub calls the chaincode makes exist.
+
+const SEPARATOR = '\u0000';
+
+const compositeKey = (objectType, attributes) =>
+    `${SEPARATOR}${objectType}${SEPARATOR}${attributes.map((attribute) => `${attribute}${SEPARATOR}`).join('')}`;
+
+class MemoryLedger {
+    constructor() {
+        this.state = new Map();     // key -> { value, version }
+        this.tombstones = new Map(); // deleted key -> version
+        this.version = 0;           // transactions committed
+        this.txCount = 0;
+        this.now = Date.parse('2025-03-15T00:00:00Z');
+        this.events = [];           // { txID, name, payload } of committed transactions
+    }
+
+    /**
+     * Starts a transaction against the state committed so far.
+     */
+    begin() {
+        const ledger = this;
+        const tx = {
+            txID: `tx${++this.txCount}`,
+            startVersion: this.version,
+            timestamp: this.now,
+            reads: new Set(),
+            ranges: [],
+            writes: new Map(),      // key -> Buffer, or null for a delete
+            events: []
+        };
+        const iterator = (keys) => {
+            let i = 0;
+            return {
+                next: async () => (i < keys.length
+                    ? { done: false, value: { key: keys[i], value: ledger.state.get(keys[i++]).value } }
+                    : { done: true }),
+                close: async () => {}
+            };
+        };
+        const scan = (prefix, after = '') => {
+            tx.ranges.push(prefix);
+            return [...this.state.keys()].filter((key) => key.startsWith(prefix) && key > after).sort();
+        };
+        const stub = {
+            getTxID: () => tx.txID,
+            getTxTimestamp: () => ({ seconds: Math.floor(tx.timestamp / 1000), nanos: (tx.timestamp % 1000) * 1e6 }),
+            getState: async (key) => {
+                tx.reads.add(key);
+                const entry = this.state.get(key);
+                return entry ? entry.value : Buffer.alloc(0);
+            },
+            putState: async (key, value) => {
+                tx.writes.set(key, Buffer.from(value));
+            },
+            deleteState: async (key) => {
+                tx.writes.set(key, null);
+            },
+            createCompositeKey: compositeKey,
+            splitCompositeKey: (key) => {
+                const parts = key.split(SEPARATOR);
+                return { objectType: parts[1], attributes: parts.slice(2, -1) };
+            },
+            getStateByPartialCompositeKey: async (objectType, attributes) =>
+                iterator(scan(compositeKey(objectType, attributes))),
+            getStateByPartialCompositeKeyWithPagination: async (objectType, attributes, pageSize, bookmark) => {
+                const keys = scan(compositeKey(objectType, attributes), bookmark).slice(0, pageSize);
+                return {
+                    iterator: iterator(keys),
+                    metadata: { fetchedRecordsCount: keys.length, bookmark: keys.length > 0 ? keys[keys.length - 1] : '' }
+                };
+            },
+            setEvent: (name, payload) => {
+                tx.events.push({ txID: tx.txID, name, payload: Buffer.from(payload) });
+            }
+        };
+        return { stub, tx };
+    }
+
+    /**
+     * Validates and applies a transaction's writes.
+     */
+    commit({ tx }) {
+        const changedSince = (key) => {
+            const entry = this.state.get(key);
+            return entry ? entry.version > tx.startVersion : this.deleted(key, tx.startVersion);
+        };
+        for (const key of tx.reads) {
+            if (changedSince(key)) {
+                throw new Error(`MVCC_READ_CONFLICT on ${JSON.stringify(key)}`);
+            }
+        }
+        for (const prefix of tx.ranges) {
+            for (const key of this.changedKeys(tx.startVersion)) {
+                if (key.startsWith(prefix)) {
+                    throw new Error(`PHANTOM_READ_CONFLICT on ${JSON.stringify(key)}`);
+                }
+            }
+        }
+        this.version++;
+        for (const [key, value] of tx.writes) {
+            if (value === null) {
+                this.state.delete(key);
+                this.tombstones.set(key, this.version);
+            } else {
+                this.state.set(key, { value, version: this.version });
+                this.tombstones.delete(key);
+            }
+        }
+        this.events.push(...tx.events);
+    }
+
+    deleted(key, sinceVersion) {
+        return (this.tombstones.get(key) || 0) > sinceVersion;
+    }
+
+    changedKeys(sinceVersion) {
+        const keys = [];
+        for (const [key, { version }] of this.state) {
+            if (version > sinceVersion) {
+                keys.push(key);
+            }
+        }
+        for (const [key, version] of this.tombstones) {
+            if (version > sinceVersion) {
+                keys.push(key);
+            }
+        }
+        return keys;
+    }
+
+    /**
+     * Runs one transaction function to commit and returns its result.
+     */
+    async submit(contract, name, ...args) {
+        const ctx = this.begin();
+        const result = await contract[name](ctx, ...args);
+        await contract.afterTransaction(ctx, result);
+        this.commit(ctx);
+        return result;
+    }
+
+    /**
+     * Runs one transaction function without committing it, as a query.
+     */
+    async evaluate(contract, name, ...args) {
+        return contract[name](this.begin(), ...args);
+    }
+
+    /**
+     * Keys under a composite key prefix, as [attributes, value] pairs.
+     */
+    entries(objectType, attributes = []) {
+        const prefix = compositeKey(objectType, attributes);
+        return [...this.state.keys()].filter((key) => key.startsWith(prefix)).sort()
+            .map((key) => [key.split(SEPARATOR).slice(2, -1), this.state.get(key).value]);
+    }
+}
+
+module.exports = MemoryLedger;
@@ -0,0 +1,424 @@
+//go:build pkcs11
+// +build pkcs11
+
+/*
+Copyright IBM Corp. All Rights Reserved.
+
+SPDX-License-Identifier: Apache-2.0
+*/
+
+// Benchmark of HSM signing throughput: the single-session HSM signer of the
+// sample against the session pool of the signing package, with the same
+// number of concurrent callers.
+//
+// In sign mode only the HSM is exercised: every caller signs digests in a loop
+// for the given duration, and the report shows signatures/s and signing
+// latency. In submit mode every caller submits CreateAsset transactions to the
+// test network through its own Gateway connection sharing the HSM identity,
+// and the report shows transactions/s and submit latency (endorse, order and
+// commit included).
+//
+// From the hardware-security-module/application-go folder:
+//
+//	SOFTHSM2_CONF="${HOME}/softhsm2.conf" go run -tags pkcs11 ./benchmark -mode sign -sessions 1,2,4,8
+//	SOFTHSM2_CONF="${HOME}/softhsm2.conf" go run -tags pkcs11 ./benchmark -mode submit -transactions 1000
+package main
+
+import (
+	"crypto/ecdsa"
+	"crypto/elliptic"
+	"crypto/sha256"
+	"crypto/x509"
+	"encoding/binary"
+	"encoding/pem"
+	"errors"
+	"flag"
+	"fmt"
+	"os"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	"github.com/hyperledger/fabric-gateway/pkg/client"
+	"github.com/hyperledger/fabric-gateway/pkg/hash"
+	"github.com/hyperledger/fabric-gateway/pkg/identity"
+	"github.com/hyperledger/fabric-samples/hardware-security-module/application-go/signing"
+	"google.golang.org/grpc"
+	"google.golang.org/grpc/credentials"
+)
+
+const (
+	mspID        = "Org1MSP"
+	certPath     = "../crypto-material/hsm/HSMUser/signcerts/cert.pem"
+	tlsCertPath  = "../../test-network/organizations/peerOrganizations/org1.example.com/peers/peer0.org1.example.com/tls/ca.crt"
+	peerEndpoint = "dns:///localhost:7051"
+	tokenLabel   = "ForFabric"
+	tokenPin     = "98765432"
+)
+
+// signerUnderTest is one signing configuration of the benchmark.
+type signerUnderTest struct {
+	name     string
+	sessions int
+	sign     identity.Sign
+	close    func()
+}
+
+// result of one configuration.
+type result struct {
+	name       string
+	sessions   int
+	operations int
+	failures   int
+	elapsed    time.Duration
+	latencies  []time.Duration
+}
+
+func main() {
+	mode := flag.String("mode", "sign", "sign: HSM signing only; submit: transactions against the test network")
+	sessionList := flag.String("sessions", "1,2,4,8", "comma-separated pool sizes compared with the single-session signer")
+	concurrency := flag.Int("concurrency", 32, "concurrent callers")
+	duration := flag.Duration("duration", 10*time.Second, "run time of each configuration (sign mode)")
+	transactions := flag.Int("transactions", 500, "transactions submitted by each configuration (submit mode)")
+	flag.Parse()
+
+	poolSizes, err := parseSessions(*sessionList)
+	if err != nil {
+		fmt.Fprintln(os.Stderr, err)
+		os.Exit(2)
+	}
+	if *mode != "sign" && *mode != "submit" {
+		fmt.Fprintf(os.Stderr, "unknown mode %q\n", *mode)
+		os.Exit(2)
+	}
+
+	certificatePEM, err := os.ReadFile(certPath)
+	if err != nil {
+		panic(err)
+	}
+	ski := getSKI(certificatePEM)
+	library := findSoftHSMLibrary()
+
+	fmt.Printf("HSM signing benchmark: mode %s, %d concurrent callers, library %s\n\n", *mode, *concurrency, library)
+
+	configurations := []func() *signerUnderTest{
+		func() *signerUnderTest { return newSingleSessionSigner(library, ski) },
+	}
+	for _, sessions := range poolSizes {
+		sessions := sessions
+		configurations = append(configurations, func() *signerUnderTest { return newPoolSigner(library, ski, sessions, *concurrency) })
+	}
+
+	var results []result
+	for _, configure := range configurations {
+		signer := configure()
+		var r result
+		if *mode == "sign" {
+			r = runSign(signer, certificatePEM, *concurrency, *duration)
+		} else {
+			r = runSubmit(signer, certificatePEM, *concurrency, *transactions)
+		}
+		signer.close()
+		results = append(results, r)
+	}
+
+	printResults(*mode, results)
+}
+
+// newSingleSessionSigner is the sample's signer: one HSM signer, hence one
+// PKCS#11 session. The signer is not safe for concurrent use, so calls are
+// serialized, as they are for every client sharing the sample's signer.
+func newSingleSessionSigner(library string, ski []byte) *signerUnderTest {
+	factory, err := identity.NewHSMSignerFactory(library)
+	if err != nil {
+		panic(err)
+	}
+	sign, closeSigner, err := factory.NewHSMSigner(identity.HSMSignerOptions{
+		Label:      tokenLabel,
+		Pin:        tokenPin,
+		Identifier: string(ski),
+	})
+	if err != nil {
+		panic(err)
+	}
+
+	var lock sync.Mutex
+	return &signerUnderTest{
+		name:     "single",
+		sessions: 1,
+		sign: func(digest []byte) ([]byte, error) {
+			lock.Lock()
+			defer lock.Unlock()
+			return sign(digest)
+		},
+		close: func() {
+			_ = closeSigner()
+			factory.Dispose()
+		},
+	}
+}
+
+func newPoolSigner(library string, ski []byte, sessions int, concurrency int) *signerUnderTest {
+	pool, err := signing.NewPool(signing.Options{
+		Library:   library,
+		Label:     tokenLabel,
+		Pin:       tokenPin,
+		Sessions:  sessions,
+		QueueSize: concurrency,
+	})
+	if err != nil {
+		panic(err)
+	}
+
+	return &signerUnderTest{
+		name:     "pool",
+		sessions: sessions,
+		sign:     pool.Signer(ski),
+		close: func() {
+			stats := pool.Stats()
+			fmt.Printf("  pool of %d: %d signatures, %d failures, %d key lookups, mean queue wait %v, mean sign time %v\n",
+				stats.Sessions, stats.Signatures, stats.Failures, stats.KeyLookups, stats.MeanQueueWait, stats.MeanSignTime)
+			_ = pool.Close()
+		},
+	}
+}
+
+// runSign signs digests from every caller until the duration is over. The
+// first signature is checked against the certificate's public key.
+func runSign(signer *signerUnderTest, certificatePEM []byte, concurrency int, duration time.Duration) result {
+	publicKey := getPublicKey(certificatePEM)
+	digest := sha256.Sum256([]byte("hsm signing benchmark"))
+	signature, err := signer.sign(digest[:])
+	if err != nil {
+		panic(fmt.Errorf("%s signer failed: %w", signer.name, err))
+	}
+	if !ecdsa.VerifyASN1(publicKey, digest[:], signature) {
+		panic(fmt.Errorf("%s signer produced a signature that does not verify", signer.name))
+	}
+
+	deadline := time.Now().Add(duration)
+	var counter atomic.Uint64
+	return runCallers(signer, concurrency, func(int) bool { return time.Now().Before(deadline) }, func() error {
+		message := make([]byte, 8)
+		binary.BigEndian.PutUint64(message, counter.Add(1))
+		digest := sha256.Sum256(message)
+		_, err := signer.sign(digest[:])
+		return err
+	})
+}
+
+// runSubmit submits CreateAsset transactions from every caller, each over its
+// own Gateway connection signed by the signer under test, until the given
+// number of transactions has been submitted.
+func runSubmit(signer *signerUnderTest, certificatePEM []byte, concurrency int, transactions int) result {
+	clientConnection := newGrpcConnection()
+	defer clientConnection.Close()
+
+	id := newIdentity(certificatePEM)
+	contracts := make([]*client.Contract, concurrency)
+	for i := range contracts {
+		gateway, err := client.Connect(id, client.WithSign(signer.sign), client.WithHash(hash.SHA256),
+			client.WithClientConnection(clientConnection))
+		if err != nil {
+			panic(err)
+		}
+		defer gateway.Close()
+		contracts[i] = gateway.GetNetwork(channelName()).GetContract(chaincodeName())
+	}
+
+	runID := time.Now().UnixNano()
+	var submitted atomic.Int64
+	var next atomic.Int64
+	return runCallers(signer, concurrency, func(int) bool { return submitted.Add(1) <= int64(transactions) }, func() error {
+		n := next.Add(1)
+		contract := contracts[int(n)%concurrency]
+		_, err := contract.SubmitTransaction("CreateAsset", fmt.Sprintf("bench%d-%d", runID, n), "yellow", "5", "Tom", "1300")
+		return err
+	})
+}
+
+// runCallers runs operation from concurrency goroutines for as long as more
+// returns true, timing every call.
+func runCallers(signer *signerUnderTest, concurrency int, more func(int) bool, operation func() error) result {
+	latencies := make([][]time.Duration, concurrency)
+	failures := make([]int, concurrency)
+	var firstError error
+	var firstErrorOnce sync.Once
+
+	var callers sync.WaitGroup
+	started := time.Now()
+	for caller := 0; caller < concurrency; caller++ {
+		callers.Add(1)
+		go func(caller int) {
+			defer callers.Done()
+			for more(caller) {
+				operationStarted := time.Now()
+				if err := operation(); err != nil {
+					failures[caller]++
+					firstErrorOnce.Do(func() { firstError = err })
+					continue
+				}
+				latencies[caller] = append(latencies[caller], time.Since(operationStarted))
+			}
+		}(caller)
+	}
+	callers.Wait()
+	elapsed := time.Since(started)
+
+	r := result{name: signer.name, sessions: signer.sessions, elapsed: elapsed}
+	for caller := range latencies {
+		r.latencies = append(r.latencies, latencies[caller]...)
+		r.failures += failures[caller]
+	}
+	r.operations = len(r.latencies)
+	sort.Slice(r.latencies, func(i, j int) bool { return r.latencies[i] < r.latencies[j] })
+	if firstError != nil {
+		fmt.Printf("  %s/%d: %d failed operation(s), first error: %v\n", r.name, r.sessions, r.failures, firstError)
+	}
+
+	return r
+}
+
+func printResults(mode string, results []result) {
+	unit := "signatures/s"
+	if mode == "submit" {
+		unit = "transactions/s"
+	}
+
+	fmt.Println()
+	fmt.Printf("%-8s %8s %10s %8s %14s %10s %10s %10s %9s\n", "signer", "sessions", "operations", "failures", unit, "p50", "p99", "max", "speedup")
+	baseline := 0.0
+	for _, r := range results {
+		rate := float64(r.operations) / r.elapsed.Seconds()
+		if baseline == 0 {
+			baseline = rate
+		}
+		fmt.Printf("%-8s %8d %10d %8d %14.1f %10s %10s %10s %8.2fx\n", r.name, r.sessions, r.operations, r.failures, rate,
+			formatDuration(percentile(r.latencies, 50)), formatDuration(percentile(r.latencies, 99)),
+			formatDuration(percentile(r.latencies, 100)), rate/baseline)
+	}
+}
+
+// percentile of sorted latencies, nearest rank.
+func percentile(sorted []time.Duration, p float64) time.Duration {
+	if len(sorted) == 0 {
+		return 0
+	}
+	rank := int(p/100*float64(len(sorted))+0.5) - 1
+	if rank < 0 {
+		rank = 0
+	}
+	if rank >= len(sorted) {
+		rank = len(sorted) - 1
+	}
+	return sorted[rank]
+}
+
+func formatDuration(d time.Duration) string {
+	return strconv.FormatFloat(float64(d)/float64(time.Millisecond), 'f', 2, 64) + "ms"
+}
+
+func parseSessions(list string) ([]int, error) {
+	var sizes []int
+	for _, field := range strings.Split(list, ",") {
+		size, err := strconv.Atoi(strings.TrimSpace(field))
+		if err != nil || size < 1 {
+			return nil, fmt.Errorf("invalid pool size %q in -sessions", field)
+		}
+		sizes = append(sizes, size)
+	}
+	return sizes, nil
+}
+
+func channelName() string {
+	if cname := os.Getenv("CHANNEL_NAME"); cname != "" {
+		return cname
+	}
+	return "mychannel"
+}
+
+func chaincodeName() string {
+	if ccname := os.Getenv("CHAINCODE_NAME"); ccname != "" {
+		return ccname
+	}
+	return "basic"
+}
+
+// The helpers below are those of hsm-sample.go.
+
+func newGrpcConnection() *grpc.ClientConn {
+	certificatePEM, err := os.ReadFile(tlsCertPath)
+	if err != nil {
+		panic(err)
+	}
+	certificate, err := identity.CertificateFromPEM(certificatePEM)
+	if err != nil {
+		panic(err)
+	}
+
+	certPool := x509.NewCertPool()
+	certPool.AddCert(certificate)
+	transportCredentials := credentials.NewClientTLSFromCert(certPool, "peer0.org1.example.com")
+
+	connection, err := grpc.NewClient(peerEndpoint, grpc.WithTransportCredentials(transportCredentials))
+	if err != nil {
+		panic(fmt.Errorf("failed to create gRPC connection: %w", err))
+	}
+
+	return connection
+}
+
+func newIdentity(certificatePEM []byte) *identity.X509Identity {
+	cert, err := identity.CertificateFromPEM(certificatePEM)
+	if err != nil {
+		panic(err)
+	}
+	id, err := identity.NewX509Identity(mspID, cert)
+	if err != nil {
+		panic(err)
+	}
+
+	return id
+}
+
+func getPublicKey(certPEM []byte) *ecdsa.PublicKey {
+	block, _ := pem.Decode(certPEM)
+
+	x590cert, err := x509.ParseCertificate(block.Bytes)
+	if err != nil {
+		panic(err)
+	}
+
+	return x590cert.PublicKey.(*ecdsa.PublicKey)
+}
+
+func getSKI(certPEM []byte) []byte {
+	pk := getPublicKey(certPEM)
+	ski := sha256.Sum256(elliptic.Marshal(pk.Curve, pk.X, pk.Y))
+	return ski[:]
+}
+
+func findSoftHSMLibrary() string {
+
+	libraryLocations := []string{
+		"/usr/lib/softhsm/libsofthsm2.so",
+		"/usr/lib/x86_64-linux-gnu/softhsm/libsofthsm2.so",
+		"/usr/local/lib/softhsm/libsofthsm2.so",
+		"/usr/lib/libacsp-pkcs11.so",
+		"/opt/homebrew/lib/softhsm/libsofthsm2.so",
+	}
+	pkcs11lib := os.Getenv("PKCS11_LIB")
+	if pkcs11lib != "" {
+		libraryLocations = append(libraryLocations, pkcs11lib)
+	}
+	for _, libraryLocation := range libraryLocations {
+		if _, err := os.Stat(libraryLocation); !errors.Is(err, os.ErrNotExist) {
+			return libraryLocation
+		}
+	}
+
+	panic("No SoftHSM library can be found. The benchmark requires SoftHSM to be installed")
+}
@@ -4,12 +4,12 @@ go 1.23.0
 
 require (
 	github.com/hyperledger/fabric-gateway v1.7.0
+	github.com/miekg/pkcs11 v1.1.1
 	google.golang.org/grpc v1.67.1
 )
 
 require (
 	github.com/hyperledger/fabric-protos-go-apiv2 v0.3.4 // indirect
-	github.com/miekg/pkcs11 v1.1.1 // indirect
 	golang.org/x/crypto v0.28.0 // indirect
 	golang.org/x/net v0.28.0 // indirect
 	golang.org/x/sys v0.26.0 // indirect
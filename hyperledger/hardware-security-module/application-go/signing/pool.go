@@ -0,0 +1,387 @@
+//go:build pkcs11
+// +build pkcs11
+
+/*
+Copyright IBM Corp. All Rights Reserved.
+
+SPDX-License-Identifier: Apache-2.0
+*/
+
+// Package signing provides an HSM signing service for Fabric Gateway clients
+// that signs concurrently over a pool of PKCS#11 sessions.
+//
+// The single HSM signer of the sample holds one PKCS#11 session, and a session
+// can only run one signing operation at a time, so every transaction proposal
+// of every client sharing the identity is signed one after another. A Pool
+// opens several sessions on the token instead, each owned by one worker
+// goroutine; signing requests are queued to the workers through a bounded
+// queue, so callers block (rather than pile up) once every session is busy and
+// the queue is full. Private key handles are looked up once per SKI and
+// shared by all sessions, since PKCS#11 token object handles are valid in
+// every session of the application.
+package signing
+
+import (
+	"errors"
+	"fmt"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	"github.com/hyperledger/fabric-gateway/pkg/identity"
+	"github.com/miekg/pkcs11"
+)
+
+// ErrPoolClosed is returned by signers of a pool that has been closed.
+var ErrPoolClosed = errors.New("signing pool is closed")
+
+// Options configure a Pool.
+type Options struct {
+	Library   string // Path of the PKCS#11 library
+	Label     string // Label of the token holding the keys
+	Pin       string // User PIN of the token
+	Sessions  int    // Number of sessions, and of signing workers (default 4)
+	QueueSize int    // Signing requests waiting for a free session before Sign blocks (default 4 per session)
+}
+
+// Stats are running totals of a Pool.
+type Stats struct {
+	Sessions      int
+	QueueSize     int
+	Queued        int // Requests currently waiting for a session
+	Signatures    uint64
+	Failures      uint64
+	Reopened      uint64 // Sessions reopened after a session error
+	KeyLookups    uint64 // Key handle lookups (key cache misses)
+	MeanQueueWait time.Duration
+	MeanSignTime  time.Duration
+}
+
+type signRequest struct {
+	ski    []byte
+	digest []byte
+	queued time.Time
+	result chan signResult
+}
+
+type signResult struct {
+	signature []byte
+	err       error
+}
+
+// Pool signs message digests with private keys held in a PKCS#11 token.
+type Pool struct {
+	ctx       *pkcs11.Ctx
+	slot      uint
+	pin       string
+	requests  chan *signRequest
+	done      chan struct{}
+	closeOnce sync.Once
+	workers   sync.WaitGroup
+	sessions  int
+
+	keysLock sync.RWMutex
+	keys     map[string]pkcs11.ObjectHandle // Private key handles by SKI
+
+	signatures  atomic.Uint64
+	failures    atomic.Uint64
+	reopened    atomic.Uint64
+	keyLookups  atomic.Uint64
+	queueWaitNs atomic.Int64
+	signNs      atomic.Int64
+}
+
+// NewPool loads the PKCS#11 library, logs in to the token with the given
+// label and opens the pool's sessions.
+func NewPool(options Options) (*Pool, error) {
+	if options.Sessions <= 0 {
+		options.Sessions = 4
+	}
+	if options.QueueSize <= 0 {
+		options.QueueSize = 4 * options.Sessions
+	}
+
+	ctx := pkcs11.New(options.Library)
+	if ctx == nil {
+		return nil, fmt.Errorf("failed to load PKCS#11 library %s", options.Library)
+	}
+	if err := ctx.Initialize(); err != nil {
+		ctx.Destroy()
+		return nil, fmt.Errorf("failed to initialize PKCS#11 library: %w", err)
+	}
+
+	pool := &Pool{
+		ctx:      ctx,
+		pin:      options.Pin,
+		requests: make(chan *signRequest, options.QueueSize),
+		done:     make(chan struct{}),
+		sessions: options.Sessions,
+		keys:     make(map[string]pkcs11.ObjectHandle),
+	}
+
+	slot, err := pool.findSlot(options.Label)
+	if err != nil {
+		pool.finalize()
+		return nil, err
+	}
+	pool.slot = slot
+
+	sessions := make([]pkcs11.SessionHandle, 0, options.Sessions)
+	for i := 0; i < options.Sessions; i++ {
+		session, err := pool.openSession()
+		if err != nil {
+			for _, opened := range sessions {
+				_ = ctx.CloseSession(opened)
+			}
+			pool.finalize()
+			return nil, err
+		}
+		sessions = append(sessions, session)
+	}
+
+	for _, session := range sessions {
+		pool.workers.Add(1)
+		go pool.work(session)
+	}
+
+	return pool, nil
+}
+
+// Signer returns a Fabric Gateway signing function for the private key with
+// the given subject key identifier. It may be called from any number of
+// goroutines.
+func (p *Pool) Signer(ski []byte) identity.Sign {
+	return func(digest []byte) ([]byte, error) {
+		return p.Sign(ski, digest)
+	}
+}
+
+// Sign signs a message digest with the private key with the given subject key
+// identifier, returning an ASN.1 DER encoded low-S ECDSA signature. It blocks
+// while the request queue is full.
+func (p *Pool) Sign(ski []byte, digest []byte) ([]byte, error) {
+	request := &signRequest{
+		ski:    ski,
+		digest: digest,
+		queued: time.Now(),
+		result: make(chan signResult, 1),
+	}
+
+	select {
+	case p.requests <- request:
+	case <-p.done:
+		return nil, ErrPoolClosed
+	}
+
+	select {
+	case result := <-request.result:
+		return result.signature, result.err
+	case <-p.done:
+		return nil, ErrPoolClosed
+	}
+}
+
+// Stats returns the pool's running totals.
+func (p *Pool) Stats() Stats {
+	stats := Stats{
+		Sessions:   p.sessions,
+		QueueSize:  cap(p.requests),
+		Queued:     len(p.requests),
+		Signatures: p.signatures.Load(),
+		Failures:   p.failures.Load(),
+		Reopened:   p.reopened.Load(),
+		KeyLookups: p.keyLookups.Load(),
+	}
+	if completed := stats.Signatures + stats.Failures; completed > 0 {
+		stats.MeanQueueWait = time.Duration(p.queueWaitNs.Load() / int64(completed))
+		stats.MeanSignTime = time.Duration(p.signNs.Load() / int64(completed))
+	}
+	return stats
+}
+
+// Close stops the workers once their current signature is done, closes the
+// sessions and unloads the PKCS#11 library. Pending requests fail with
+// ErrPoolClosed.
+func (p *Pool) Close() error {
+	p.closeOnce.Do(func() {
+		close(p.done)
+		p.workers.Wait()
+		p.finalize()
+	})
+	return nil
+}
+
+// work signs queued requests on one session until the pool is closed.
+func (p *Pool) work(session pkcs11.SessionHandle) {
+	defer p.workers.Done()
+	defer func() {
+		_ = p.ctx.CloseSession(session)
+	}()
+
+	for {
+		select {
+		case request := <-p.requests:
+			started := time.Now()
+			p.queueWaitNs.Add(int64(started.Sub(request.queued)))
+
+			var signature []byte
+			var err error
+			session, signature, err = p.signWithRetry(session, request)
+			p.signNs.Add(int64(time.Since(started)))
+			if err != nil {
+				p.failures.Add(1)
+			} else {
+				p.signatures.Add(1)
+			}
+			request.result <- signResult{signature, err}
+		case <-p.done:
+			return
+		}
+	}
+}
+
+// signWithRetry signs once, and once more after recovering from a stale key
+// handle or a broken session. Returns the session to use from now on.
+func (p *Pool) signWithRetry(session pkcs11.SessionHandle, request *signRequest) (pkcs11.SessionHandle, []byte, error) {
+	signature, err := p.sign(session, request)
+	switch {
+	case err == nil:
+		return session, signature, nil
+	case isKeyError(err):
+		p.forgetKey(request.ski)
+	case isSessionError(err):
+		_ = p.ctx.CloseSession(session)
+		reopened, openErr := p.openSession()
+		if openErr != nil {
+			return session, nil, fmt.Errorf("%w (reopening session: %v)", err, openErr)
+		}
+		p.reopened.Add(1)
+		session = reopened
+	default:
+		return session, nil, err
+	}
+
+	signature, err = p.sign(session, request)
+	return session, signature, err
+}
+
+func (p *Pool) sign(session pkcs11.SessionHandle, request *signRequest) ([]byte, error) {
+	privateKey, err := p.keyHandle(session, request.ski)
+	if err != nil {
+		return nil, err
+	}
+
+	mechanism := []*pkcs11.Mechanism{pkcs11.NewMechanism(pkcs11.CKM_ECDSA, nil)}
+	if err := p.ctx.SignInit(session, mechanism, privateKey); err != nil {
+		return nil, fmt.Errorf("failed to initialize signing: %w", err)
+	}
+	rawSignature, err := p.ctx.Sign(session, request.digest)
+	if err != nil {
+		return nil, fmt.Errorf("failed to sign: %w", err)
+	}
+
+	return marshalSignature(rawSignature)
+}
+
+// keyHandle returns the cached handle of the private key with the given SKI,
+// looking it up on the given session on first use.
+func (p *Pool) keyHandle(session pkcs11.SessionHandle, ski []byte) (pkcs11.ObjectHandle, error) {
+	p.keysLock.RLock()
+	handle, ok := p.keys[string(ski)]
+	p.keysLock.RUnlock()
+	if ok {
+		return handle, nil
+	}
+
+	p.keyLookups.Add(1)
+	handle, err := p.findPrivateKey(session, ski)
+	if err != nil {
+		return 0, err
+	}
+
+	p.keysLock.Lock()
+	p.keys[string(ski)] = handle
+	p.keysLock.Unlock()
+
+	return handle, nil
+}
+
+func (p *Pool) forgetKey(ski []byte) {
+	p.keysLock.Lock()
+	delete(p.keys, string(ski))
+	p.keysLock.Unlock()
+}
+
+func (p *Pool) findPrivateKey(session pkcs11.SessionHandle, ski []byte) (pkcs11.ObjectHandle, error) {
+	template := []*pkcs11.Attribute{
+		pkcs11.NewAttribute(pkcs11.CKA_CLASS, pkcs11.CKO_PRIVATE_KEY),
+		pkcs11.NewAttribute(pkcs11.CKA_ID, ski),
+		pkcs11.NewAttribute(pkcs11.CKA_KEY_TYPE, pkcs11.CKK_EC),
+	}
+	if err := p.ctx.FindObjectsInit(session, template); err != nil {
+		return 0, fmt.Errorf("failed to search for private key: %w", err)
+	}
+	handles, _, err := p.ctx.FindObjects(session, 1)
+	if finalErr := p.ctx.FindObjectsFinal(session); err == nil && finalErr != nil {
+		err = finalErr
+	}
+	if err != nil {
+		return 0, fmt.Errorf("failed to search for private key: %w", err)
+	}
+	if len(handles) == 0 {
+		return 0, fmt.Errorf("no private key found with SKI %x", ski)
+	}
+
+	return handles[0], nil
+}
+
+func (p *Pool) findSlot(label string) (uint, error) {
+	slots, err := p.ctx.GetSlotList(true)
+	if err != nil {
+		return 0, fmt.Errorf("failed to list PKCS#11 slots: %w", err)
+	}
+	for _, slot := range slots {
+		tokenInfo, err := p.ctx.GetTokenInfo(slot)
+		if err == nil && tokenInfo.Label == label {
+			return slot, nil
+		}
+	}
+
+	return 0, fmt.Errorf("no PKCS#11 token found with label %s", label)
+}
+
+// openSession opens a session on the pool's token and makes sure the
+// application is logged in. The login state is shared by every session of the
+// application, so only the first login of the pool does anything, unless the
+// token has since logged the application out.
+func (p *Pool) openSession() (pkcs11.SessionHandle, error) {
+	session, err := p.ctx.OpenSession(p.slot, pkcs11.CKF_SERIAL_SESSION|pkcs11.CKF_RW_SESSION)
+	if err != nil {
+		return 0, fmt.Errorf("failed to open PKCS#11 session: %w", err)
+	}
+
+	err = p.ctx.Login(session, pkcs11.CKU_USER, p.pin)
+	if err != nil && !errors.Is(err, pkcs11.Error(pkcs11.CKR_USER_ALREADY_LOGGED_IN)) {
+		_ = p.ctx.CloseSession(session)
+		return 0, fmt.Errorf("failed to log in to PKCS#11 token: %w", err)
+	}
+
+	return session, nil
+}
+
+func (p *Pool) finalize() {
+	_ = p.ctx.Finalize()
+	p.ctx.Destroy()
+}
+
+func isKeyError(err error) bool {
+	return errors.Is(err, pkcs11.Error(pkcs11.CKR_KEY_HANDLE_INVALID)) ||
+		errors.Is(err, pkcs11.Error(pkcs11.CKR_OBJECT_HANDLE_INVALID))
+}
+
+func isSessionError(err error) bool {
+	return errors.Is(err, pkcs11.Error(pkcs11.CKR_SESSION_HANDLE_INVALID)) ||
+		errors.Is(err, pkcs11.Error(pkcs11.CKR_SESSION_CLOSED)) ||
+		errors.Is(err, pkcs11.Error(pkcs11.CKR_DEVICE_ERROR)) ||
+		errors.Is(err, pkcs11.Error(pkcs11.CKR_USER_NOT_LOGGED_IN))
+}
@@ -0,0 +1,47 @@
+//go:build pkcs11
+// +build pkcs11
+
+/*
+Copyright IBM Corp. All Rights Reserved.
+
+SPDX-License-Identifier: Apache-2.0
+*/
+
+package signing
+
+import (
+	"crypto/elliptic"
+	"encoding/asn1"
+	"fmt"
+	"math/big"
+)
+
+type ecdsaSignature struct {
+	R, S *big.Int
+}
+
+// marshalSignature converts the raw r || s signature of CKM_ECDSA to the
+// ASN.1 DER encoding Fabric expects, with S in its low form (S <= N/2) as
+// Fabric rejects high-S signatures. The curve is inferred from the length.
+func marshalSignature(rawSignature []byte) ([]byte, error) {
+	var curve elliptic.Curve
+	switch len(rawSignature) {
+	case 64:
+		curve = elliptic.P256()
+	case 96:
+		curve = elliptic.P384()
+	default:
+		return nil, fmt.Errorf("unexpected ECDSA signature length %d", len(rawSignature))
+	}
+
+	half := len(rawSignature) / 2
+	r := new(big.Int).SetBytes(rawSignature[:half])
+	s := new(big.Int).SetBytes(rawSignature[half:])
+
+	order := curve.Params().N
+	if s.Cmp(new(big.Int).Rsh(order, 1)) > 0 {
+		s.Sub(order, s)
+	}
+
+	return asn1.Marshal(ecdsaSignature{r, s})
+}